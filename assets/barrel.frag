@@ -4,13 +4,17 @@ in vec3 normal;
 in vec2 tex_coord;
 in vec4 frag_position;
 in mat3 tbn;
+flat in vec4 instance_parameters;
 out vec4 frag_colour;
 
 uniform sampler2D tex0;
 uniform sampler2D tex1;
 uniform sampler2D tex2;
-uniform vec3 tint_colour;
-uniform float tint_amount;
+
+layout(std140, binding = 2) uniform material
+{
+    vec3 tint_colour;
+};
 
 layout(std140, binding = 0) uniform camera
 {
@@ -80,6 +84,7 @@ void main()
         colour += calc_point(i);
     }
 
-    frag_colour = vec4(mix(colour * albedo.rgb, tint_colour, tint_amount), 1.0);
+    // the first instance parameter is how much of the tint to apply
+    frag_colour = vec4(mix(colour * albedo.rgb, tint_colour, instance_parameters.x), 1.0);
 }
 
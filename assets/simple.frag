@@ -51,8 +51,9 @@ vec3 calc_point(int index)
     vec3 point_colour = points[index].point_colour;
     vec3 attenuation = points[index].attenuation;
 
-    vec3 n = texture(tex2, tex_coord).xyz;
-    n = (n * 2.0) - 1.0;
+    // normal maps may be two channel (BC5) so always reconstruct z from x and y
+    vec2 xy = (texture(tex2, tex_coord).xy * 2.0) - 1.0;
+    vec3 n = vec3(xy, sqrt(max(1.0 - dot(xy, xy), 0.0)));
     n = normalize(tbn * n);
 
     float distance = length(point - frag_position.xyz);
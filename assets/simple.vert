@@ -9,8 +9,7 @@ out vec3 normal;
 out vec2 tex_coord;
 out vec4 frag_position;
 out mat3 tbn;
-
-uniform mat4 model;
+flat out vec4 instance_parameters;
 
 layout(std140, binding = 0) uniform camera
 {
@@ -19,8 +18,24 @@ layout(std140, binding = 0) uniform camera
     vec3 eye;
 };
 
+struct Instance
+{
+    mat4 model;
+    vec4 parameters;
+};
+
+// per entity data, indexed by instance so entities sharing a mesh and material are drawn together (see InstanceData)
+layout(std430, binding = 3) readonly buffer instances
+{
+    Instance instance_data[];
+};
+
 void main()
 {
+    Instance instance = instance_data[gl_BaseInstance + gl_InstanceID];
+    mat4 model = instance.model;
+    instance_parameters = instance.parameters;
+
     gl_Position = projection * view * model * vec4(in_position, 1.0);
     normal = normalize(transpose(inverse(mat3(model))) * in_normal);
     tex_coord = in_uv;
@@ -0,0 +1,61 @@
+#version 460 core
+
+// variant of simple.vert for meshes in the packed vertex format, the instance model matrix is expected to include the
+// mesh dequantisation (see Mesh::dequantisation)
+
+layout(location = 0) in vec3 in_position;
+layout(location = 1) in vec2 in_normal;
+layout(location = 2) in vec2 in_tangent;
+layout(location = 3) in vec2 in_uv;
+
+out vec3 normal;
+out vec2 tex_coord;
+out vec4 frag_position;
+out mat3 tbn;
+flat out vec4 instance_parameters;
+
+layout(std140, binding = 0) uniform camera
+{
+    mat4 view;
+    mat4 projection;
+    vec3 eye;
+};
+
+struct Instance
+{
+    mat4 model;
+    vec4 parameters;
+};
+
+layout(std430, binding = 3) readonly buffer instances
+{
+    Instance instance_data[];
+};
+
+vec3 octahedral_decode(vec2 e)
+{
+    vec3 v = vec3(e, 1.0 - abs(e.x) - abs(e.y));
+    float t = max(-v.z, 0.0);
+    v.xy += vec2(v.x >= 0.0 ? -t : t, v.y >= 0.0 ? -t : t);
+    return normalize(v);
+}
+
+void main()
+{
+    Instance instance = instance_data[gl_BaseInstance + gl_InstanceID];
+    mat4 model = instance.model;
+    instance_parameters = instance.parameters;
+
+    vec3 in_n = octahedral_decode(in_normal);
+    vec3 in_t = octahedral_decode(in_tangent);
+
+    gl_Position = projection * view * model * vec4(in_position, 1.0);
+    normal = normalize(transpose(inverse(mat3(model))) * in_n);
+    tex_coord = in_uv;
+
+    vec3 t = normalize(vec3(model * vec4(in_t, 0.0)));
+    vec3 b = cross(normal, t);
+    tbn = mat3(t, b, normal);
+
+    frag_position = model * vec4(in_position, 1);
+}
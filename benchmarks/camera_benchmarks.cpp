@@ -0,0 +1,46 @@
+#include <numbers>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+#include "graphics/camera.h"
+#include "maths/vector3.h"
+
+namespace
+{
+
+/**
+ * Extract the frustum planes from a number of cameras (e.g. the main camera and shadow cascades), moving each one so
+ * the planes have to be recomputed.
+ */
+auto camera_frustum_planes(benchmark::State &state) -> void
+{
+    auto cameras = std::vector<game::Camera>{};
+    for (auto i = 0; i < state.range(0); ++i)
+    {
+        cameras.emplace_back(
+            game::Vector3{static_cast<float>(i), 10.0f, 0.0f},
+            game::Vector3{0.0f, 0.0f, -1.0f},
+            game::Vector3{0.0f, 1.0f, 0.0f},
+            std::numbers::pi_v<float> / 4.0f,
+            1920.0f,
+            1080.0f,
+            0.1f,
+            100.0f);
+    }
+
+    for (auto _ : state)
+    {
+        for (auto &camera : cameras)
+        {
+            camera.adjust_yaw(0.001f);
+            benchmark::DoNotOptimize(camera.frustum_planes());
+        }
+    }
+
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+}
+
+BENCHMARK(camera_frustum_planes)->RangeMultiplier(4)->Range(1, 64);
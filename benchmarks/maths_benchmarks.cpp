@@ -0,0 +1,184 @@
+#include <cstddef>
+#include <cstdint>
+#include <numbers>
+#include <tuple>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+#include "graphics/camera.h"
+#include "maths/aabb.h"
+#include "maths/frustum_cull.h"
+#include "maths/matrix4.h"
+#include "maths/quaternion.h"
+#include "maths/transform.h"
+#include "maths/vector3.h"
+
+namespace
+{
+
+/**
+ * Create some transforms which are all different, so nothing can be hoisted out of the loop.
+ *
+ * @param count
+ *   Number of transforms.
+ *
+ * @returns
+ *   The transforms.
+ */
+auto create_transforms(std::size_t count) -> std::vector<game::Transform>
+{
+    auto transforms = std::vector<game::Transform>{};
+    transforms.reserve(count);
+
+    for (auto i = std::size_t{}; i < count; ++i)
+    {
+        const auto f = static_cast<float>(i);
+        transforms.emplace_back(
+            game::Vector3{f, f * 2.0f, -f}, game::Vector3{1.0f + f * 0.01f}, game::Quaternion{0.0f, 0.38f, 0.0f, 0.92f});
+    }
+
+    return transforms;
+}
+
+/**
+ * Multiply a run of matrices together, as when concatenating a hierarchy of transforms.
+ */
+auto matrix4_multiply(benchmark::State &state) -> void
+{
+    const auto count = static_cast<std::size_t>(state.range(0));
+    const auto transforms = create_transforms(count);
+
+    auto matrices = std::vector<game::Matrix4>{};
+    for (const auto &transform : transforms)
+    {
+        matrices.push_back(transform);
+    }
+
+    for (auto _ : state)
+    {
+        auto result = game::Matrix4{};
+
+        for (const auto &matrix : matrices)
+        {
+            result *= matrix;
+        }
+
+        benchmark::DoNotOptimize(result);
+    }
+
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+/**
+ * Convert transforms to matrices, as is done for every entity every frame.
+ */
+auto transform_to_matrix4(benchmark::State &state) -> void
+{
+    const auto count = static_cast<std::size_t>(state.range(0));
+    const auto transforms = create_transforms(count);
+    auto matrices = std::vector<game::Matrix4>(count);
+
+    for (auto _ : state)
+    {
+        for (auto i = std::size_t{}; i < count; ++i)
+        {
+            matrices[i] = transforms[i];
+        }
+
+        benchmark::DoNotOptimize(matrices.data());
+        benchmark::ClobberMemory();
+    }
+
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+/**
+ * Create a camera and boxes scattered around it, roughly a quarter of which are visible.
+ *
+ * @param count
+ *   Number of boxes.
+ *
+ * @returns
+ *   The camera and the boxes.
+ */
+auto create_cull_scene(std::size_t count) -> std::tuple<game::Camera, std::vector<game::AABB>>
+{
+    auto camera = game::Camera{
+        {0.0f, 0.0f, 0.0f},
+        {0.0f, 0.0f, -1.0f},
+        {0.0f, 1.0f, 0.0f},
+        std::numbers::pi_v<float> / 4.0f,
+        1920.0f,
+        1080.0f,
+        0.1f,
+        100.0f};
+
+    auto boxes = std::vector<game::AABB>{};
+    boxes.reserve(count);
+
+    for (const auto &transform : create_transforms(count))
+    {
+        // spread the boxes around the camera rather than along a line
+        const auto position = game::Vector3{transform.position.x, 0.0f, transform.position.z} -
+                              game::Vector3{static_cast<float>(count) / 2.0f, 0.0f, -static_cast<float>(count) / 2.0f};
+        boxes.push_back({.min = position - game::Vector3{1.0f}, .max = position + game::Vector3{1.0f}});
+    }
+
+    return {camera, boxes};
+}
+
+/**
+ * Test boxes against a frustum one at a time.
+ */
+auto intersects_frustum(benchmark::State &state) -> void
+{
+    const auto [camera, boxes] = create_cull_scene(static_cast<std::size_t>(state.range(0)));
+    const auto &planes = camera.frustum_planes();
+
+    for (auto _ : state)
+    {
+        auto visible = std::size_t{};
+
+        for (const auto &box : boxes)
+        {
+            visible += game::intersects_frustum(box, planes) ? 1u : 0u;
+        }
+
+        benchmark::DoNotOptimize(visible);
+    }
+
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+/**
+ * Test boxes against a frustum in batches, as the renderer does every frame.
+ */
+auto frustum_cull(benchmark::State &state) -> void
+{
+    const auto [camera, aabbs] = create_cull_scene(static_cast<std::size_t>(state.range(0)));
+    const auto &planes = camera.frustum_planes();
+
+    auto boxes = game::AABBArray{};
+    for (const auto &aabb : aabbs)
+    {
+        boxes.push_back(aabb);
+    }
+
+    auto visible = std::vector<std::uint64_t>{};
+
+    for (auto _ : state)
+    {
+        game::cull(planes, boxes, visible);
+        benchmark::DoNotOptimize(visible.data());
+    }
+
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+}
+
+BENCHMARK(frustum_cull)->RangeMultiplier(8)->Range(8, 4096);
+BENCHMARK(intersects_frustum)->RangeMultiplier(8)->Range(8, 4096);
+BENCHMARK(matrix4_multiply)->RangeMultiplier(8)->Range(8, 4096);
+BENCHMARK(transform_to_matrix4)->RangeMultiplier(8)->Range(8, 4096);
@@ -0,0 +1,119 @@
+#include <cstdint>
+#include <string_view>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+#include "events/key.h"
+#include "events/key_event.h"
+#include "events/mouse_event.h"
+#include "messaging/message_bus.h"
+#include "messaging/subscriber.h"
+
+namespace
+{
+
+/**
+ * Subscriber which does the minimum with each message, so the benchmarks measure the dispatch.
+ */
+struct CountingSubscriber : game::Subscriber
+{
+    auto handle_key_press(const game::KeyEvent &) -> void override
+    {
+        ++count;
+    }
+
+    auto handle_mouse_move(const game::MouseEvent &) -> void override
+    {
+        ++count;
+    }
+
+    auto handle_level_complete(std::string_view) -> void override
+    {
+        ++count;
+    }
+
+    std::uint64_t count = 0u;
+};
+
+/**
+ * Create a bus with some subscribers to a message type.
+ *
+ * @param type
+ *   The type to subscribe to.
+ * @param subscribers
+ *   The subscribers, must outlive the bus.
+ *
+ * @returns
+ *   The bus.
+ */
+auto create_bus(game::MessageType type, std::vector<CountingSubscriber> &subscribers) -> game::MessageBus
+{
+    auto bus = game::MessageBus{};
+
+    for (auto &subscriber : subscribers)
+    {
+        bus.subscribe(type, &subscriber);
+    }
+
+    return bus;
+}
+
+/**
+ * Post a key press to a varying number of subscribers.
+ */
+auto post_key_press(benchmark::State &state) -> void
+{
+    auto subscribers = std::vector<CountingSubscriber>(static_cast<std::size_t>(state.range(0)));
+    auto bus = create_bus(game::MessageType::KEY_PRESS, subscribers);
+    const auto event = game::KeyEvent{game::Key::A, game::KeyState::DOWN};
+
+    for (auto _ : state)
+    {
+        bus.post_key_press(event);
+    }
+
+    benchmark::DoNotOptimize(subscribers.front().count);
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+/**
+ * Post a mouse move to a varying number of subscribers, this happens many times a frame.
+ */
+auto post_mouse_move(benchmark::State &state) -> void
+{
+    auto subscribers = std::vector<CountingSubscriber>(static_cast<std::size_t>(state.range(0)));
+    auto bus = create_bus(game::MessageType::MOUSE_MOVE, subscribers);
+    const auto event = game::MouseEvent{1.0f, 2.0f};
+
+    for (auto _ : state)
+    {
+        bus.post_mouse_move(event);
+    }
+
+    benchmark::DoNotOptimize(subscribers.front().count);
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+/**
+ * Post a level complete to a varying number of subscribers.
+ */
+auto post_level_complete(benchmark::State &state) -> void
+{
+    auto subscribers = std::vector<CountingSubscriber>(static_cast<std::size_t>(state.range(0)));
+    auto bus = create_bus(game::MessageType::LEVEL_COMPLETE, subscribers);
+
+    for (auto _ : state)
+    {
+        bus.post_level_complete("level_apple");
+    }
+
+    benchmark::DoNotOptimize(subscribers.front().count);
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+}
+
+BENCHMARK(post_key_press)->RangeMultiplier(4)->Range(1, 256);
+BENCHMARK(post_mouse_move)->RangeMultiplier(4)->Range(1, 256);
+BENCHMARK(post_level_complete)->RangeMultiplier(4)->Range(1, 256);
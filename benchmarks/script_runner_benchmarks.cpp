@@ -0,0 +1,88 @@
+#include <cstdint>
+
+#include <benchmark/benchmark.h>
+
+#include "maths/vector3.h"
+#include "scripting/lua_script.h"
+#include "scripting/script_runner.h"
+
+namespace
+{
+
+/** Script with functions covering the common shapes of call the game makes. */
+constexpr auto script_source = R"(
+function noop()
+end
+
+function sum(n)
+        local total = 0
+        for i = 1, n do
+                total = total + i
+        end
+        return total
+end
+
+function step(position, speed)
+        return Vector3(position.x + speed, position.y, position.z - speed)
+end
+)";
+
+/**
+ * Call a function with no arguments or results, the fixed cost of crossing into lua.
+ */
+auto execute_noop(benchmark::State &state) -> void
+{
+    auto script = game::LuaScript{script_source};
+    const auto runner = game::ScriptRunner{script};
+
+    for (auto _ : state)
+    {
+        runner.execute("noop");
+    }
+}
+
+/**
+ * Call a function which does a varying amount of work in lua.
+ */
+auto execute_sum(benchmark::State &state) -> void
+{
+    auto script = game::LuaScript{script_source};
+    const auto runner = game::ScriptRunner{script};
+    const auto n = static_cast<std::int64_t>(state.range(0));
+
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(runner.execute<std::int64_t>("sum", n));
+    }
+
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+/**
+ * Call a function a varying number of times with a Vector3 in and out, as a script driven entity does each frame.
+ */
+auto execute_vector3(benchmark::State &state) -> void
+{
+    auto script = game::LuaScript{script_source};
+    const auto runner = game::ScriptRunner{script};
+
+    for (auto _ : state)
+    {
+        auto position = game::Vector3{};
+
+        for (auto i = 0; i < state.range(0); ++i)
+        {
+            position = runner.execute<game::Vector3>("step", position, 0.1f);
+        }
+
+        benchmark::DoNotOptimize(position);
+    }
+
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+}
+
+BENCHMARK(execute_noop);
+BENCHMARK(execute_sum)->RangeMultiplier(8)->Range(1, 4096);
+BENCHMARK(execute_vector3)->RangeMultiplier(4)->Range(1, 256);
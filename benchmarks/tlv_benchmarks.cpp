@@ -0,0 +1,162 @@
+#include <cstddef>
+#include <cstdint>
+#include <format>
+#include <map>
+#include <span>
+#include <utility>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+#include "graphics/texture.h"
+#include "graphics/vertex_data.h"
+#include "tlv/tlv_archive.h"
+#include "tlv/tlv_entry.h"
+#include "tlv/tlv_reader.h"
+#include "tlv/tlv_writer.h"
+
+#pragma comment(lib, "opengl32.lib")
+
+namespace
+{
+
+/** Number of assets of each type in the largest benchmark archive. */
+constexpr auto asset_count = 10'000u;
+
+/**
+ * Build an archive, shaped like a real one (lots of small composites), once for each size.
+ *
+ * @param count
+ *   Number of assets of each type.
+ *
+ * @returns
+ *   The archive.
+ */
+auto archive_buffer(std::size_t count) -> const std::vector<std::byte> &
+{
+    static auto buffers = std::map<std::size_t, std::vector<std::byte>>{};
+
+    if (const auto existing = buffers.find(count); existing != std::ranges::end(buffers))
+    {
+        return existing->second;
+    }
+
+    auto buffer = [count]
+    {
+        const auto data = std::vector<std::byte>(64u);
+        const auto vertices = std::vector<game::VertexData>(24u);
+        const auto indices = std::vector<std::uint32_t>(36u);
+
+        auto writer = game::TLVWriter{};
+        writer.write_header();
+
+        for (auto i = std::size_t{}; i < count; ++i)
+        {
+            writer.write(
+                std::format("texture_{}", i), 4u, 4u, game::TextureFormat::RGBA, game::TextureUsage::SRGB, data);
+            writer.write(std::format("mesh_{}", i), vertices, indices);
+        }
+
+        writer.write_index();
+        return writer.yield();
+    }();
+
+    return buffers.emplace(count, std::move(buffer)).first->second;
+}
+
+/**
+ * Iterate over every entry, and every member of every composite, checking as we go. This is the cost of reading an
+ * archive that has not been validated.
+ */
+auto iterate_checked(benchmark::State &state) -> void
+{
+    const auto &buffer = archive_buffer(static_cast<std::size_t>(state.range(0)));
+
+    for (auto _ : state)
+    {
+        auto count = std::size_t{};
+
+        for (const auto &entry : game::TLVReader{buffer})
+        {
+            if (entry.type() == game::TLVType::TEXTURE_DESCRIPTION)
+            {
+                count += entry.texture_description_view().data.size();
+            }
+            else if (entry.type() == game::TLVType::MESH_DATA)
+            {
+                count += entry.mesh_value().indices.size();
+            }
+        }
+
+        benchmark::DoNotOptimize(count);
+    }
+
+    state.SetBytesProcessed(state.iterations() * static_cast<std::int64_t>(buffer.size()));
+}
+
+/**
+ * As iterate_checked but through a validated archive, so no checks are made.
+ */
+auto iterate_validated(benchmark::State &state) -> void
+{
+    const auto &buffer = archive_buffer(static_cast<std::size_t>(state.range(0)));
+    const auto archive = game::TLVArchive{buffer};
+
+    for (auto _ : state)
+    {
+        auto count = std::size_t{};
+
+        for (const auto &entry : archive.reader())
+        {
+            if (entry.type() == game::TLVType::TEXTURE_DESCRIPTION)
+            {
+                count += entry.texture_description_view().data.size();
+            }
+            else if (entry.type() == game::TLVType::MESH_DATA)
+            {
+                count += entry.mesh_value().indices.size();
+            }
+        }
+
+        benchmark::DoNotOptimize(count);
+    }
+
+    state.SetBytesProcessed(state.iterations() * static_cast<std::int64_t>(buffer.size()));
+}
+
+/**
+ * Cost of opening (and so validating) the archive, which is paid once.
+ */
+auto open_archive(benchmark::State &state) -> void
+{
+    const auto &buffer = archive_buffer(static_cast<std::size_t>(state.range(0)));
+
+    for (auto _ : state)
+    {
+        const auto archive = game::TLVArchive{buffer};
+        benchmark::DoNotOptimize(archive.entry_count());
+    }
+
+    state.SetBytesProcessed(state.iterations() * static_cast<std::int64_t>(buffer.size()));
+}
+
+/**
+ * Find and view a texture by name, as the renderer does when loading a level.
+ */
+auto find_texture(benchmark::State &state) -> void
+{
+    const auto archive = game::TLVArchive{archive_buffer(asset_count)};
+    const auto name = std::format("texture_{}", asset_count / 2u);
+
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(archive.find(name, game::TLVType::TEXTURE_DESCRIPTION)->texture_description_view());
+    }
+}
+
+}
+
+BENCHMARK(iterate_checked)->RangeMultiplier(10)->Range(10, asset_count);
+BENCHMARK(iterate_validated)->RangeMultiplier(10)->Range(10, asset_count);
+BENCHMARK(open_archive)->RangeMultiplier(10)->Range(10, asset_count);
+BENCHMARK(find_texture);
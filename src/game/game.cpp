@@ -1,10 +1,15 @@
 #include "game/game.h"
 
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstddef>
 #include <format>
 #include <iostream>
 #include <numbers>
 #include <print>
 #include <string_view>
+#include <thread>
 #include <type_traits>
 #include <unordered_map>
 #include <variant>
@@ -14,6 +19,7 @@
 #include "events/key.h"
 #include "events/stop_event.h"
 #include "game/player.h"
+#include "graphics/aabb_tree.h"
 #include "graphics/camera.h"
 #include "graphics/cube_map.h"
 #include "graphics/debug_ui.h"
@@ -30,18 +36,58 @@
 #include "maths/vector3.h"
 #include "messaging/message_bus.h"
 #include "messaging/subscriber.h"
+#include "resources/async_loader.h"
+#include "resources/bundle_manager.h"
+#include "resources/file.h"
 #include "resources/resource_cache.h"
 #include "resources/resource_loader.h"
-#include "tlv/tlv_reader.h"
+#include "resources/resource_pins.h"
+#include "tlv/tlv_archive.h"
 #include "utils/error.h"
 #include "utils/exception.h"
 #include "utils/log.h"
 
+namespace
+{
+
+/** Budget for the combined CPU and GPU memory of resident meshes. */
+constexpr auto mesh_budget = std::size_t{128u} * 1024u * 1024u;
+
+/** Budget for the combined CPU and GPU memory of resident textures. */
+constexpr auto texture_budget = std::size_t{512u} * 1024u * 1024u;
+
+/** Bundle for each level, in the order they are played. */
+constexpr auto level_bundles = std::array{"apple"sv, "kiwi"sv};
+
+/**
+ * Load the bundles for a level and start loading the next level's in the background, all other level bundles are
+ * released.
+ *
+ * @param bundles
+ *   The bundle manager.
+ * @param level
+ *   The current level number.
+ */
+auto request_level_bundles(game::BundleManager &bundles, std::size_t level) -> void
+{
+    const auto current = level_bundles[level % level_bundles.size()];
+    const auto next = level_bundles[(level + 1u) % level_bundles.size()];
+
+    bundles.prefetch(current, game::LoadPriority::LEVEL_CRITICAL);
+    bundles.prefetch(next, game::LoadPriority::BACKGROUND);
+
+    const auto retained = std::array{game::shared_bundle, current, next};
+    bundles.retain(retained);
+}
+
+}
+
 namespace game
 {
 
 Game::Game()
     : running_{true}
+    , level_num_{0u}
 {
 }
 
@@ -66,47 +112,79 @@ auto Game::run(std::string_view resource_root) -> void
     auto mesh_factory = MeshFactory{};
     auto resource_cache = DefaultCache{};
 
-    const auto *sampler = resource_cache.insert<Sampler>("default");
+    const auto *sampler = resource_cache.get(resource_cache.insert<Sampler>("default"));
 
-    const auto tlv_file = resource_loader.load("resource");
-    const auto reader = TLVReader{tlv_file.as_data()};
+    // leave a core for the main thread
+    auto async_loader = AsyncLoader{resource_loader, std::max(std::thread::hardware_concurrency(), 2u) - 1u};
 
-    log::info("textures loaded");
+    // kick everything off up front so the io overlaps, the main thread only waits when it needs a result, only the
+    // shared bundle and those for the current and next level are mapped
+    auto bundles = BundleManager{resource_loader, async_loader, "resource"};
+    bundles.prefetch(shared_bundle, LoadPriority::BLOCKING);
 
-    const auto simple_vert_file = resource_loader.load("simple.vert");
-    const auto checkerboard_frag_file = resource_loader.load("checkerboard.frag");
+    auto bundles_level = level_num_;
+    request_level_bundles(bundles, bundles_level);
 
-    const auto vertex_shader = Shader{simple_vert_file.as_string(), ShaderType::VERTEX};
-    const auto checkerboard_shader = Shader{checkerboard_frag_file.as_string(), ShaderType::FRAGMENT};
+    auto vertex_shader_future = async_loader.load_shader("simple.vert", ShaderType::VERTEX, LoadPriority::BLOCKING);
+    auto checkerboard_shader_future =
+        async_loader.load_shader("checkerboard.frag", ShaderType::FRAGMENT, LoadPriority::BLOCKING);
+
+    const auto &archive = bundles.get(shared_bundle);
+
+    auto skybox_future = async_loader.load_cube_map(
+        archive, {{"right", "left", "top", "bottom", "front", "back"}}, LoadPriority::LEVEL_CRITICAL);
+
+    const auto vertex_shader = async_loader.wait(vertex_shader_future);
+    const auto checkerboard_shader = async_loader.wait(checkerboard_shader_future);
     resource_cache.insert<Material>("floor", vertex_shader, checkerboard_shader);
 
-    resource_cache.insert<Texture>(
+    // meshes and textures can be reloaded, so anything not pinned by the scene can be evicted to stay in budget
+    resource_cache.set_budget<Mesh>(mesh_budget);
+    resource_cache.set_budget<Texture>(texture_budget);
+
+    resource_cache.insert_reloadable<Texture>(
         "floor_albedo",
-        TextureDescription{
-            .width = 1u,
-            .height = 1u,
-            .format = TextureFormat::RGB,
-            .usage = TextureUsage::SRGB,
-            .data = {static_cast<std::byte>(0xff), static_cast<std::byte>(0xff), static_cast<std::byte>(0xff)}},
-        sampler);
-    resource_cache.insert<Mesh>("floor", mesh_factory.cube());
+        [sampler]
+        {
+            return Texture{
+                TextureDescription{
+                    .width = 1u,
+                    .height = 1u,
+                    .format = TextureFormat::RGB,
+                    .usage = TextureUsage::SRGB,
+                    .data =
+                        {static_cast<std::byte>(0xff), static_cast<std::byte>(0xff), static_cast<std::byte>(0xff)}},
+                sampler};
+        });
+    resource_cache.insert_reloadable<Mesh>("floor", [&mesh_factory] { return Mesh{mesh_factory.cube()}; });
 
     const auto renderer = Renderer{resource_loader, mesh_factory, window.width(), window.height()};
 
+    // entities hold raw pointers, so everything they use stays pinned while they exist
+    auto pins = DefaultPins{resource_cache};
+
     auto entities = std::vector<Entity>{
-        {resource_cache.get<Mesh>("floor"),
-         resource_cache.get<Material>("floor"),
+        {pins.get<Mesh>("floor"),
+         pins.get<Material>("floor"),
          {0.0f, -3.0f, 0.0f},
          {100.0f, 1.0f, 100.0f},
-         std::vector<const Texture *>{
-             resource_cache.get<Texture>("floor_albedo"), resource_cache.get<Texture>("floor_albedo")}}};
+         std::vector<const Texture *>{pins.get<Texture>("floor_albedo"), pins.get<Texture>("floor_albedo")}}};
 
-    auto skybox = CubeMap{reader, {{"right", "left", "top", "bottom", "front", "back"}}};
+    auto skybox = async_loader.wait(skybox_future);
+    log::info("textures loaded");
     auto skybox_sampler = Sampler{};
 
+    // the entities never move, so the tree only needs building once
+    const auto tree_items =
+        entities | std::views::transform([](const auto &e) { return AABBTree::Item{std::addressof(e), e.bounds()}; }) |
+        std::ranges::to<std::vector>();
+    auto tree = AABBTree{};
+    tree.build(tree_items);
+
     auto scene = Scene{
         .entities = entities | std::views::transform([](const auto &e) { return std::addressof(e); }) |
                     std::ranges::to<std::vector>(),
+        .tree = &tree,
         .ambient = {.r = 0.3f, .g = 0.3f, .b = 0.3f},
         .directional = {.direction = {-1.0f, -1.0f, -1.0f}, .colour = {.r = 0.5f, .g = 0.5f, .b = 0.5f}},
         .points =
@@ -170,6 +248,15 @@ auto Game::run(std::string_view resource_root) -> void
         wireframe_renderer.draw(player.camera());
         scene.debug_lines = {wireframe_renderer.yield()};
 
+        if (bundles_level != level_num_)
+        {
+            bundles_level = level_num_;
+            request_level_bundles(bundles, bundles_level);
+        }
+
+        // finish off any background loads, without letting them cause a long frame
+        async_loader.pump(std::chrono::milliseconds{2});
+
         renderer.render(player.camera(), scene, gamma);
 
         window.swap();
@@ -179,5 +266,7 @@ auto Game::run(std::string_view resource_root) -> void
 auto Game::handle_level_complete(std::string_view level_name) -> void
 {
     log::info("level complete: {}", level_name);
+
+    ++level_num_;
 }
 }
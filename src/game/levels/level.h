@@ -1,5 +1,6 @@
 #pragma once
 
+#include "graphics/aabb_tree.h"
 #include "graphics/scene.h"
 
 namespace game
@@ -22,6 +23,9 @@ class Level
 
   protected:
     Scene scene_;
+
+    /** Tree of the entities in scene_, levels should update it as their entities move. */
+    AABBTree tree_;
 };
 
 }
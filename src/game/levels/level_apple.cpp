@@ -5,43 +5,20 @@
 #include "game/levels/level.h"
 #include "game/player.h"
 #include "game/transformed_entity.h"
+#include "graphics/aabb_tree.h"
 #include "graphics/entity.h"
+#include "graphics/instance_data.h"
 #include "graphics/material.h"
 #include "graphics/mesh.h"
 #include "graphics/texture.h"
 #include "maths/colour.h"
+#include "maths/frustum_cull.h"
 #include "messaging/message_bus.h"
 #include "resources/resource_cache.h"
-#include "tlv/tlv_reader.h"
+#include "tlv/tlv_archive.h"
 
 namespace
 {
-auto intersects_frustum(const game::AABB &aabb, const std::array<game::FrustumPlane, 6u> &planes) -> bool
-{
-    for (const auto &plane : planes)
-    {
-        auto positive_vertex = aabb.min;
-        if (plane.normal.x >= 0)
-        {
-            positive_vertex.x = aabb.max.x;
-        }
-        if (plane.normal.y >= 0)
-        {
-            positive_vertex.y = aabb.max.y;
-        }
-        if (plane.normal.z >= 0)
-        {
-            positive_vertex.z = aabb.max.z;
-        }
-
-        if (game::Vector3::dot(plane.normal, positive_vertex) + plane.distance < 0.0f)
-        {
-            return false;
-        }
-    }
-
-    return true;
-}
 
 constexpr auto CameraDelta = [](const game::Vector3 &in,
                                 const game::GameTransformState &state) -> game::TransformerResult
@@ -53,8 +30,7 @@ constexpr auto Invert = [](const game::Vector3 &in, const game::GameTransformSta
 constexpr auto CheckVisible = [](const game::Vector3 &in,
                                  const game::GameTransformState &state) -> game::TransformerResult
 {
-    const auto planes = state.camera.frustum_planes();
-    return {in, !intersects_frustum(state.aabb, planes)};
+    return {in, !game::intersects_frustum(state.aabb, state.camera.frustum_planes())};
 };
 
 std::vector<const game::Texture *> textures()
@@ -67,27 +43,29 @@ std::vector<const game::Texture *> textures()
 namespace game
 {
 
-LevelApple::LevelApple(DefaultCache &resource_cache, const TLVReader &reader, const Player &player, MessageBus &bus)
-    : entities_{}
-    , floor_{resource_cache.get<Mesh>("floor"), resource_cache.get<Material>("floor"), {0.0f, -3.0f, 0.0f}, {100.0f, 1.0f, 100.0f}, std::vector<const Texture*>{
-    resource_cache.get<Texture>("floor_albedo"),        
-    resource_cache.get<Texture>("floor_albedo")        
+LevelApple::LevelApple(DefaultCache &resource_cache, const TLVArchive &archive, const Player &player, MessageBus &bus)
+    : pins_{resource_cache}
+    , entities_{}
+    , floor_{pins_.get<Mesh>("floor"), pins_.get<Material>("floor"), {0.0f, -3.0f, 0.0f}, {100.0f, 1.0f, 100.0f}, std::vector<const Texture*>{
+    pins_.get<Texture>("floor_albedo"),        
+    pins_.get<Texture>("floor_albedo")        
     }}
-    , skybox_{reader, {{"right", "left", "top", "bottom", "front", "back"}}}
+    , skybox_{archive, {{"right", "left", "top", "bottom", "front", "back"}}}
     , skybox_sampler_{}
     , state_{.camera = player.camera(), .aabb = {}, .last_camera_pos = player.camera().position()}
     , bus_{bus}, resource_cache_{resource_cache}
+    , barrel_material_{resource_cache.find<Material>("barrel")}
 
 {
     const Texture *barrel_textures[]{
-        resource_cache.get<Texture>("barrel_albedo"),
-        resource_cache.get<Texture>("barrel_specular"),
-        resource_cache.get<Texture>("barrel_normal")};
+        pins_.get<Texture>("barrel_albedo"),
+        pins_.get<Texture>("barrel_specular"),
+        pins_.get<Texture>("barrel_normal")};
 
     entities_.emplace_back(
         Entity{
-            resource_cache.get<Mesh>("barrel"),
-            resource_cache.get<Material>("barrel"),
+            pins_.get<Mesh>("barrel"),
+            pins_.get<Material>("barrel"),
             {0.0f, 0.0f, 0.0f},
             {0.05f},
             barrel_textures},
@@ -95,8 +73,8 @@ LevelApple::LevelApple(DefaultCache &resource_cache, const TLVReader &reader, co
         std::make_unique<Chain<GameTransformState>>());
     entities_.emplace_back(
         Entity{
-            resource_cache.get<Mesh>("barrel"),
-            resource_cache.get<Material>("barrel"),
+            pins_.get<Mesh>("barrel"),
+            pins_.get<Material>("barrel"),
             {5.0f, 0.0f, 0.0f},
             {0.05f},
             barrel_textures},
@@ -106,6 +84,7 @@ LevelApple::LevelApple(DefaultCache &resource_cache, const TLVReader &reader, co
     scene_ = Scene{
         .entities = entities_ | std::views::transform([](const auto &e) { return std::addressof(e.entity); }) |
                     std::ranges::to<std::vector>(),
+        .tree = &tree_,
         .ambient = {.r = 0.3f, .g = 0.3f, .b = 0.3f},
         .directional = {.direction = {-1.0f, -1.0f, -1.0f}, .colour = {.r = 0.5f, .g = 0.5f, .b = 0.5f}},
         .points =
@@ -129,6 +108,11 @@ LevelApple::LevelApple(DefaultCache &resource_cache, const TLVReader &reader, co
         .skybox_sampler = &skybox_sampler_};
 
     scene_.entities.push_back(&floor_);
+
+    tree_.build(
+        scene_.entities |
+        std::views::transform([](const auto *e) { return AABBTree::Item{.entity = e, .bounds = e->bounds()}; }) |
+        std::ranges::to<std::vector>());
 }
 
 auto LevelApple::update(const Player &player) -> void
@@ -142,6 +126,8 @@ auto LevelApple::update(const Player &player) -> void
         entity.translate(entity_delta);
         aabb.min += entity_delta;
         aabb.max += entity_delta;
+
+        tree_.update(std::addressof(entity), entity.bounds());
     }
 
     state_.last_camera_pos = player.camera().position();
@@ -154,12 +140,17 @@ auto LevelApple::update(const Player &player) -> void
 
 auto LevelApple::restart() -> void
 {
-    resource_cache_.get<Material>("barrel")->set_uniform_callback(
-        [this](const Material *material, const Entity *entity)
+    auto *barrel_material = resource_cache_.get(barrel_material_);
+
+    // the colour is the same for every barrel so lives in the parameter block, only the amount changes per entity
+    barrel_material->set_parameter(
+        barrel_material->parameter<Colour>("tint_colour"), Colour{.r = 0.0f, .g = 0.0f, .b = 1.0f});
+
+    // the amount is an instance parameter so every barrel can still be drawn in one go
+    barrel_material->set_instance_callback(
+        [this](const Material *, const Entity *entity, InstanceData &instance)
         {
-            const auto tint_amount = entity == std::addressof(entities_[0].entity) ? 1.0f : 0.5f;
-            material->set_uniform("tint_colour", Colour{.r = 0.0f, .g = 0.0f, .b = 1.0f});
-            material->set_uniform("tint_amount", tint_amount);
+            instance.parameters[0] = entity == std::addressof(entities_[0].entity) ? 1.0f : 0.5f;
         });
 }
 
@@ -10,8 +10,10 @@
 #include "graphics/mesh.h"
 #include "graphics/sampler.h"
 #include "graphics/texture.h"
+#include "resources/handle.h"
 #include "resources/resource_cache.h"
-#include "tlv/tlv_reader.h"
+#include "resources/resource_pins.h"
+#include "tlv/tlv_archive.h"
 
 namespace game
 {
@@ -22,13 +24,14 @@ class MessageBus;
 class LevelKiwi : public Level
 {
   public:
-    LevelKiwi(DefaultCache &resource_cache, const TLVReader &reader, const Player &player, MessageBus &bus);
+    LevelKiwi(DefaultCache &resource_cache, const TLVArchive &archive, const Player &player, MessageBus &bus);
     ~LevelKiwi() override = default;
 
     auto update(const Player &player) -> void override;
     auto restart() -> void override;
 
   private:
+    DefaultPins pins_;
     std::vector<TransformedEntity> entities_;
     Entity floor_;
     CubeMap skybox_;
@@ -36,6 +39,7 @@ class LevelKiwi : public Level
     GameTransformState state_;
     MessageBus &bus_;
     DefaultCache &resource_cache_;
+    Handle<Material> barrel_material_;
 };
 
 }
@@ -0,0 +1,1004 @@
+#include "graphics/aabb_tree.h"
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <limits>
+#include <optional>
+#include <ranges>
+#include <span>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+#include "maths/aabb.h"
+#include "maths/frustum_cull.h"
+#include "maths/frustum_plane.h"
+#include "maths/vector3.h"
+#include "utils/error.h"
+#include "utils/thread_pool.h"
+
+namespace
+{
+
+/** Number of bins candidate splits are evaluated over when building. */
+constexpr auto bin_count = 16u;
+
+/** Deferred subtrees per thread for a parallel build, more than one so uneven subtrees balance out. */
+constexpr auto subtrees_per_thread = 4u;
+
+/** Fewest reinsertions before a rebuild, so small trees are not rebuilt every few moves. */
+constexpr auto min_rebuild_reinserts = std::size_t{64u};
+
+/**
+ * Where a box is relative to a frustum.
+ */
+enum class Containment
+{
+    OUTSIDE,
+    INTERSECTS,
+    INSIDE
+};
+
+/**
+ * Get a component of a vector by index.
+ *
+ * @param v
+ *   The vector.
+ * @param axis
+ *   The axis, 0 for x, 1 for y and 2 for z.
+ *
+ * @returns
+ *   The component.
+ */
+auto component(const game::Vector3 &v, std::size_t axis) -> float
+{
+    switch (axis)
+    {
+        case 0u: return v.x;
+        case 1u: return v.y;
+        default: return v.z;
+    }
+}
+
+/**
+ * Get the smallest box containing two boxes.
+ *
+ * @param a
+ *   The first box.
+ * @param b
+ *   The second box.
+ *
+ * @returns
+ *   The union of the boxes.
+ */
+auto merge(const game::AABB &a, const game::AABB &b) -> game::AABB
+{
+    return {
+        .min = {std::min(a.min.x, b.min.x), std::min(a.min.y, b.min.y), std::min(a.min.z, b.min.z)},
+        .max = {std::max(a.max.x, b.max.x), std::max(a.max.y, b.max.y), std::max(a.max.z, b.max.z)},
+    };
+}
+
+/**
+ * Get half the surface area of a box, which is proportional to the chance of a random ray hitting it. Used as the
+ * cost of a box when deciding how to group them.
+ *
+ * @param aabb
+ *   The box.
+ *
+ * @returns
+ *   Half the surface area.
+ */
+auto area(const game::AABB &aabb) -> float
+{
+    const auto size = aabb.max - aabb.min;
+    return size.x * size.y + size.y * size.z + size.z * size.x;
+}
+
+/**
+ * Grow a box by a margin on every side.
+ *
+ * @param aabb
+ *   The box.
+ * @param margin
+ *   How far to grow it.
+ *
+ * @returns
+ *   The grown box.
+ */
+auto fatten(const game::AABB &aabb, float margin) -> game::AABB
+{
+    return {.min = aabb.min - game::Vector3{margin}, .max = aabb.max + game::Vector3{margin}};
+}
+
+/**
+ * Check if a box is entirely inside another.
+ *
+ * @param outer
+ *   The outer box.
+ * @param inner
+ *   The inner box.
+ *
+ * @returns
+ *   True if inner is inside outer.
+ */
+auto contains(const game::AABB &outer, const game::AABB &inner) -> bool
+{
+    return (outer.min.x <= inner.min.x) && (outer.min.y <= inner.min.y) && (outer.min.z <= inner.min.z) &&
+           (outer.max.x >= inner.max.x) && (outer.max.y >= inner.max.y) && (outer.max.z >= inner.max.z);
+}
+
+/**
+ * Check if two boxes overlap, touching counts as overlapping.
+ *
+ * @param a
+ *   The first box.
+ * @param b
+ *   The second box.
+ *
+ * @returns
+ *   True if the boxes overlap.
+ */
+auto overlaps(const game::AABB &a, const game::AABB &b) -> bool
+{
+    return (a.min.x <= b.max.x) && (a.max.x >= b.min.x) && (a.min.y <= b.max.y) && (a.max.y >= b.min.y) &&
+           (a.min.z <= b.max.z) && (a.max.z >= b.min.z);
+}
+
+/**
+ * Check if a box overlaps a sphere.
+ *
+ * @param aabb
+ *   The box.
+ * @param centre
+ *   Centre of the sphere.
+ * @param radius
+ *   Radius of the sphere.
+ *
+ * @returns
+ *   True if they overlap.
+ */
+auto overlaps(const game::AABB &aabb, const game::Vector3 &centre, float radius) -> bool
+{
+    // distance to the closest point in the box
+    const auto closest = game::Vector3{
+        std::clamp(centre.x, aabb.min.x, aabb.max.x),
+        std::clamp(centre.y, aabb.min.y, aabb.max.y),
+        std::clamp(centre.z, aabb.min.z, aabb.max.z)};
+    const auto offset = closest - centre;
+
+    return game::Vector3::dot(offset, offset) <= radius * radius;
+}
+
+/**
+ * Intersect a ray with a box.
+ *
+ * @param aabb
+ *   The box.
+ * @param origin
+ *   Start of the ray.
+ * @param direction
+ *   Direction of the ray.
+ * @param max_distance
+ *   End of the ray, as a multiple of direction.
+ *
+ * @returns
+ *   Distance along the ray at which it enters the box (zero if it starts inside), or an empty optional if it misses.
+ */
+auto intersect(
+    const game::AABB &aabb,
+    const game::Vector3 &origin,
+    const game::Vector3 &direction,
+    float max_distance) -> std::optional<float>
+{
+    auto near = 0.0f;
+    auto far = max_distance;
+
+    // clip the ray against the pair of planes on each axis in turn
+    for (auto axis = 0u; axis < 3u; ++axis)
+    {
+        const auto o = component(origin, axis);
+        const auto d = component(direction, axis);
+        const auto min = component(aabb.min, axis);
+        const auto max = component(aabb.max, axis);
+
+        if (d == 0.0f)
+        {
+            if ((o < min) || (o > max))
+            {
+                return std::nullopt;
+            }
+
+            continue;
+        }
+
+        const auto t1 = (min - o) / d;
+        const auto t2 = (max - o) / d;
+
+        near = std::max(near, std::min(t1, t2));
+        far = std::min(far, std::max(t1, t2));
+
+        if (near > far)
+        {
+            return std::nullopt;
+        }
+    }
+
+    return near;
+}
+
+/**
+ * Classify a box against a frustum.
+ *
+ * @param aabb
+ *   The box.
+ * @param planes
+ *   The frustum planes.
+ *
+ * @returns
+ *   Where the box is.
+ */
+auto classify(const game::AABB &aabb, const std::array<game::FrustumPlane, 6u> &planes) -> Containment
+{
+    auto result = Containment::INSIDE;
+
+    for (const auto &plane : planes)
+    {
+        // the corners furthest along and against the normal, as in intersects_frustum
+        auto positive_vertex = aabb.min;
+        auto negative_vertex = aabb.max;
+        if (plane.normal.x >= 0)
+        {
+            std::swap(positive_vertex.x, negative_vertex.x);
+        }
+        if (plane.normal.y >= 0)
+        {
+            std::swap(positive_vertex.y, negative_vertex.y);
+        }
+        if (plane.normal.z >= 0)
+        {
+            std::swap(positive_vertex.z, negative_vertex.z);
+        }
+
+        if (game::Vector3::dot(plane.normal, positive_vertex) + plane.distance < 0.0f)
+        {
+            return Containment::OUTSIDE;
+        }
+
+        if (game::Vector3::dot(plane.normal, negative_vertex) + plane.distance < 0.0f)
+        {
+            result = Containment::INTERSECTS;
+        }
+    }
+
+    return result;
+}
+
+}
+
+namespace game
+{
+
+struct AABBTree::BuildItem
+{
+    /** The entity. */
+    const Entity *entity;
+
+    /** Exact bounds of the entity. */
+    AABB bounds;
+
+    /** Fattened bounds of the entity. */
+    AABB fat_bounds;
+
+    /** Centre of the bounds, which is what is split on. */
+    Vector3 centre;
+};
+
+AABBTree::AABBTree(float margin)
+    : nodes_{}
+    , root_{null_node}
+    , free_list_{null_node}
+    , leaves_{}
+    , margin_{margin}
+    , reinsert_count_{}
+{
+}
+
+auto AABBTree::build(std::span<const Item> items) -> void
+{
+    auto build_items = std::vector<BuildItem>{};
+    build_items.reserve(items.size());
+
+    for (const auto &[entity, bounds] : items)
+    {
+        build_items.push_back(
+            {.entity = entity,
+             .bounds = bounds,
+             .fat_bounds = fatten(bounds, margin_),
+             .centre = (bounds.min + bounds.max) * 0.5f});
+    }
+
+    auto nodes = std::vector<Node>{};
+    nodes.reserve(items.empty() ? 0u : items.size() * 2u - 1u);
+
+    if (!build_items.empty())
+    {
+        build_subtree(build_items, nodes, 0u, nullptr);
+    }
+
+    finish_build(std::move(nodes));
+}
+
+auto AABBTree::build(std::span<const Item> items, ThreadPool &pool, std::size_t priority) -> void
+{
+    auto build_items = std::vector<BuildItem>(items.size());
+
+    // even the setup is worth spreading out for the large levels this is for
+    pool.parallel_for(
+        priority,
+        items.size(),
+        [&](auto index)
+        {
+            const auto &[entity, bounds] = items[index];
+            build_items[index] = {
+                .entity = entity,
+                .bounds = bounds,
+                .fat_bounds = fatten(bounds, margin_),
+                .centre = (bounds.min + bounds.max) * 0.5f};
+        });
+
+    auto nodes = std::vector<Node>{};
+    nodes.reserve(items.empty() ? 0u : items.size() * 2u - 1u);
+
+    if (!build_items.empty())
+    {
+        // split the top of the tree on this thread until there are enough subtrees to keep every thread busy
+        const auto subtree_count = std::bit_ceil((pool.thread_count() + 1u) * subtrees_per_thread);
+        const auto split_depth = static_cast<std::size_t>(std::bit_width(subtree_count)) - 1u;
+
+        auto deferred = std::vector<std::tuple<std::uint32_t, std::span<BuildItem>>>{};
+        build_subtree(build_items, nodes, split_depth, &deferred);
+
+        auto subtrees = std::vector<std::vector<Node>>(deferred.size());
+        pool.parallel_for(
+            priority,
+            deferred.size(),
+            [&](auto index)
+            {
+                const auto &[_, subtree_items] = deferred[index];
+                subtrees[index].reserve(subtree_items.size() * 2u - 1u);
+                build_subtree(subtree_items, subtrees[index], 0u, nullptr);
+            });
+
+        // splice each subtree in, its root replaces the placeholder and the rest go on the end
+        for (auto i = std::size_t{}; i < deferred.size(); ++i)
+        {
+            const auto placeholder = std::get<0>(deferred[i]);
+            const auto offset = static_cast<std::uint32_t>(nodes.size()) - 1u;
+            const auto remap = [&](std::uint32_t index)
+            { return index == null_node ? null_node : index == 0u ? placeholder : index + offset; };
+
+            for (auto local = std::size_t{}; local < subtrees[i].size(); ++local)
+            {
+                auto node = subtrees[i][local];
+                node.children = {remap(node.children[0]), remap(node.children[1])};
+
+                if (local == 0u)
+                {
+                    node.parent = nodes[placeholder].parent;
+                    nodes[placeholder] = node;
+                }
+                else
+                {
+                    node.parent = remap(node.parent);
+                    nodes.push_back(node);
+                }
+            }
+        }
+    }
+
+    finish_build(std::move(nodes));
+}
+
+auto AABBTree::rebuild() -> void
+{
+    auto items = std::vector<Item>{};
+    items.reserve(leaves_.size());
+
+    for (const auto &[entity, leaf] : leaves_)
+    {
+        items.push_back({.entity = entity, .bounds = nodes_[leaf].item_bounds});
+    }
+
+    build(items);
+}
+
+auto AABBTree::insert(const Entity *entity, const AABB &bounds) -> void
+{
+    expect(!leaves_.contains(entity), "entity already in tree");
+
+    const auto leaf = allocate_node();
+    nodes_[leaf] = {
+        .bounds = fatten(bounds, margin_),
+        .item_bounds = bounds,
+        .entity = entity,
+        .parent = null_node,
+        .children = {null_node, null_node},
+        .height = 0u};
+
+    leaves_.emplace(entity, leaf);
+    insert_leaf(leaf);
+}
+
+auto AABBTree::remove(const Entity *entity) -> void
+{
+    const auto leaf = leaves_.find(entity);
+    expect(leaf != std::ranges::cend(leaves_), "entity not in tree");
+
+    remove_leaf(leaf->second);
+    free_node(leaf->second);
+    leaves_.erase(leaf);
+}
+
+auto AABBTree::update(const Entity *entity, const AABB &bounds) -> void
+{
+    const auto leaf = leaves_.find(entity);
+    expect(leaf != std::ranges::cend(leaves_), "entity not in tree");
+
+    auto &node = nodes_[leaf->second];
+    node.item_bounds = bounds;
+
+    if (::contains(node.bounds, bounds))
+    {
+        return;
+    }
+
+    // the entity has left the entities it was grouped with, so find it a new place rather than growing the boxes of its
+    // old ancestors to follow it
+    remove_leaf(leaf->second);
+    nodes_[leaf->second].bounds = fatten(bounds, margin_);
+    insert_leaf(leaf->second);
+
+    // reinsertion is greedy, once every entity could have moved a build will give a noticeably better tree
+    if (++reinsert_count_ > std::max(leaves_.size(), min_rebuild_reinserts))
+    {
+        rebuild();
+    }
+}
+
+auto AABBTree::contains(const Entity *entity) const -> bool
+{
+    return leaves_.contains(entity);
+}
+
+auto AABBTree::size() const -> std::size_t
+{
+    return leaves_.size();
+}
+
+auto AABBTree::height() const -> std::size_t
+{
+    return root_ == null_node ? 0u : nodes_[root_].height;
+}
+
+auto AABBTree::reinsert_count() const -> std::size_t
+{
+    return reinsert_count_;
+}
+
+auto AABBTree::query_frustum(const std::array<FrustumPlane, 6u> &planes, std::vector<const Entity *> &result) const
+    -> void
+{
+    if (root_ == null_node)
+    {
+        return;
+    }
+
+    auto stack = std::vector<std::uint32_t>{root_};
+
+    while (!stack.empty())
+    {
+        const auto &node = nodes_[stack.back()];
+        const auto index = stack.back();
+        stack.pop_back();
+
+        switch (classify(node.bounds, planes))
+        {
+            using enum Containment;
+            case OUTSIDE: break;
+            case INSIDE: collect(index, result); break;
+            case INTERSECTS:
+                if (node.children[0] == null_node)
+                {
+                    if (intersects_frustum(node.item_bounds, planes))
+                    {
+                        result.push_back(node.entity);
+                    }
+                }
+                else
+                {
+                    stack.push_back(node.children[0]);
+                    stack.push_back(node.children[1]);
+                }
+                break;
+        }
+    }
+}
+
+auto AABBTree::query_aabb(const AABB &aabb, std::vector<const Entity *> &result) const -> void
+{
+    if (root_ == null_node)
+    {
+        return;
+    }
+
+    auto stack = std::vector<std::uint32_t>{root_};
+
+    while (!stack.empty())
+    {
+        const auto &node = nodes_[stack.back()];
+        stack.pop_back();
+
+        if (!overlaps(node.bounds, aabb))
+        {
+            continue;
+        }
+
+        if (node.children[0] == null_node)
+        {
+            if (overlaps(node.item_bounds, aabb))
+            {
+                result.push_back(node.entity);
+            }
+        }
+        else
+        {
+            stack.push_back(node.children[0]);
+            stack.push_back(node.children[1]);
+        }
+    }
+}
+
+auto AABBTree::query_sphere(const Vector3 &centre, float radius, std::vector<const Entity *> &result) const -> void
+{
+    if (root_ == null_node)
+    {
+        return;
+    }
+
+    auto stack = std::vector<std::uint32_t>{root_};
+
+    while (!stack.empty())
+    {
+        const auto &node = nodes_[stack.back()];
+        stack.pop_back();
+
+        if (!overlaps(node.bounds, centre, radius))
+        {
+            continue;
+        }
+
+        if (node.children[0] == null_node)
+        {
+            if (overlaps(node.item_bounds, centre, radius))
+            {
+                result.push_back(node.entity);
+            }
+        }
+        else
+        {
+            stack.push_back(node.children[0]);
+            stack.push_back(node.children[1]);
+        }
+    }
+}
+
+auto AABBTree::query_ray(
+    const Vector3 &origin,
+    const Vector3 &direction,
+    float max_distance,
+    std::vector<const Entity *> &result) const -> void
+{
+    if (root_ == null_node)
+    {
+        return;
+    }
+
+    auto hits = std::vector<std::tuple<float, const Entity *>>{};
+    auto stack = std::vector<std::uint32_t>{root_};
+
+    while (!stack.empty())
+    {
+        const auto &node = nodes_[stack.back()];
+        stack.pop_back();
+
+        if (!intersect(node.bounds, origin, direction, max_distance))
+        {
+            continue;
+        }
+
+        if (node.children[0] == null_node)
+        {
+            if (const auto distance = intersect(node.item_bounds, origin, direction, max_distance); distance)
+            {
+                hits.emplace_back(*distance, node.entity);
+            }
+        }
+        else
+        {
+            stack.push_back(node.children[0]);
+            stack.push_back(node.children[1]);
+        }
+    }
+
+    std::ranges::sort(hits, {}, [](const auto &hit) { return std::get<0>(hit); });
+
+    for (const auto &[_, entity] : hits)
+    {
+        result.push_back(entity);
+    }
+}
+
+auto AABBTree::build_subtree(
+    std::span<BuildItem> items,
+    std::vector<Node> &nodes,
+    std::size_t split_depth,
+    std::vector<std::tuple<std::uint32_t, std::span<BuildItem>>> *deferred) -> std::uint32_t
+{
+    const auto index = static_cast<std::uint32_t>(nodes.size());
+    nodes.push_back(
+        {.bounds = {},
+         .item_bounds = {},
+         .entity = nullptr,
+         .parent = null_node,
+         .children = {null_node, null_node},
+         .height = 0u});
+
+    if (items.size() == 1u)
+    {
+        nodes[index].bounds = items.front().fat_bounds;
+        nodes[index].item_bounds = items.front().bounds;
+        nodes[index].entity = items.front().entity;
+        return index;
+    }
+
+    // the placeholder is filled in by whoever builds the rest of the subtree
+    if ((deferred != nullptr) && (split_depth == 0u))
+    {
+        deferred->emplace_back(index, items);
+        return index;
+    }
+
+    // split on the longest axis of the centres, that is where the entities are most spread out
+    auto centre_bounds = AABB{.min = items.front().centre, .max = items.front().centre};
+    for (const auto &item : items)
+    {
+        centre_bounds = merge(centre_bounds, {.min = item.centre, .max = item.centre});
+    }
+
+    const auto extent = centre_bounds.max - centre_bounds.min;
+    const auto axis = (extent.x >= extent.y) && (extent.x >= extent.z) ? 0u : extent.y >= extent.z ? 1u : 2u;
+    const auto axis_min = component(centre_bounds.min, axis);
+    const auto axis_extent = component(extent, axis);
+
+    auto split = items.size() / 2u;
+
+    if (axis_extent > 0.0f)
+    {
+        const auto bin_of = [&](const BuildItem &item)
+        {
+            const auto position = (component(item.centre, axis) - axis_min) / axis_extent;
+            return std::min<std::size_t>(static_cast<std::size_t>(position * bin_count), bin_count - 1u);
+        };
+
+        auto bin_bounds = std::array<std::optional<AABB>, bin_count>{};
+        auto bin_sizes = std::array<std::size_t, bin_count>{};
+
+        for (const auto &item : items)
+        {
+            const auto bin = bin_of(item);
+            bin_bounds[bin] = bin_bounds[bin] ? merge(*bin_bounds[bin], item.fat_bounds) : item.fat_bounds;
+            ++bin_sizes[bin];
+        }
+
+        // cost of splitting after each bin, i.e. the area of each side weighted by how many entities it has
+        auto left_costs = std::array<float, bin_count>{};
+        auto left_bounds = std::optional<AABB>{};
+        auto left_size = std::size_t{};
+        for (auto bin = 0u; bin < bin_count - 1u; ++bin)
+        {
+            if (bin_bounds[bin])
+            {
+                left_bounds = left_bounds ? merge(*left_bounds, *bin_bounds[bin]) : *bin_bounds[bin];
+                left_size += bin_sizes[bin];
+            }
+
+            left_costs[bin] = left_bounds ? area(*left_bounds) * static_cast<float>(left_size) : 0.0f;
+        }
+
+        auto best_bin = std::optional<std::size_t>{};
+        auto best_cost = std::numeric_limits<float>::max();
+        auto right_bounds = std::optional<AABB>{};
+        auto right_size = std::size_t{};
+        for (auto bin = bin_count - 1u; bin > 0u; --bin)
+        {
+            if (bin_bounds[bin])
+            {
+                right_bounds = right_bounds ? merge(*right_bounds, *bin_bounds[bin]) : *bin_bounds[bin];
+                right_size += bin_sizes[bin];
+            }
+
+            // both sides need at least one entity
+            if ((right_size == 0u) || (right_size == items.size()))
+            {
+                continue;
+            }
+
+            const auto cost = left_costs[bin - 1u] + area(*right_bounds) * static_cast<float>(right_size);
+            if (cost < best_cost)
+            {
+                best_cost = cost;
+                best_bin = bin;
+            }
+        }
+
+        if (best_bin)
+        {
+            const auto right =
+                std::ranges::partition(items, [&](const auto &item) { return bin_of(item) < *best_bin; });
+            split = static_cast<std::size_t>(std::ranges::begin(right) - std::ranges::begin(items));
+        }
+    }
+
+    const auto next_depth = split_depth == 0u ? 0u : split_depth - 1u;
+    const auto left = build_subtree(items.first(split), nodes, next_depth, deferred);
+    const auto right = build_subtree(items.subspan(split), nodes, next_depth, deferred);
+
+    nodes[index].children = {left, right};
+    nodes[left].parent = index;
+    nodes[right].parent = index;
+
+    return index;
+}
+
+auto AABBTree::finish_build(std::vector<Node> nodes) -> void
+{
+    nodes_ = std::move(nodes);
+    root_ = nodes_.empty() ? null_node : 0u;
+    free_list_ = null_node;
+    reinsert_count_ = 0u;
+
+    leaves_.clear();
+    leaves_.reserve(nodes_.size() / 2u + 1u);
+
+    // children always come after their parents, so going backwards every node is updated after its children
+    for (auto index = static_cast<std::uint32_t>(nodes_.size()); index-- > 0u;)
+    {
+        if (nodes_[index].children[0] == null_node)
+        {
+            leaves_.emplace(nodes_[index].entity, index);
+        }
+        else
+        {
+            update_node(index);
+        }
+    }
+}
+
+auto AABBTree::allocate_node() -> std::uint32_t
+{
+    if (free_list_ == null_node)
+    {
+        ensure(nodes_.size() < null_node, "too many nodes in tree");
+        nodes_.push_back({});
+        return static_cast<std::uint32_t>(nodes_.size() - 1u);
+    }
+
+    const auto index = free_list_;
+    free_list_ = nodes_[index].parent;
+    return index;
+}
+
+auto AABBTree::free_node(std::uint32_t index) -> void
+{
+    nodes_[index].entity = nullptr;
+    nodes_[index].parent = free_list_;
+    free_list_ = index;
+}
+
+auto AABBTree::insert_leaf(std::uint32_t leaf) -> void
+{
+    if (root_ == null_node)
+    {
+        root_ = leaf;
+        nodes_[leaf].parent = null_node;
+        return;
+    }
+
+    // walk down to the best sibling, at each node the leaf either pairs with it or descends into the child whose area
+    // would grow the least (as every ancestor grows by the same amount either way)
+    const auto leaf_bounds = nodes_[leaf].bounds;
+    auto index = root_;
+
+    while (nodes_[index].children[0] != null_node)
+    {
+        const auto &node = nodes_[index];
+        const auto node_area = area(node.bounds);
+        const auto combined_area = area(merge(node.bounds, leaf_bounds));
+
+        const auto pair_cost = 2.0f * combined_area;
+        const auto inherited_cost = 2.0f * (combined_area - node_area);
+
+        const auto child_cost = [&](std::uint32_t child)
+        {
+            const auto &child_node = nodes_[child];
+            const auto merged_area = area(merge(child_node.bounds, leaf_bounds));
+
+            return child_node.children[0] == null_node ? merged_area + inherited_cost
+                                                       : merged_area - area(child_node.bounds) + inherited_cost;
+        };
+
+        const auto cost0 = child_cost(node.children[0]);
+        const auto cost1 = child_cost(node.children[1]);
+
+        if ((pair_cost < cost0) && (pair_cost < cost1))
+        {
+            break;
+        }
+
+        index = cost0 < cost1 ? node.children[0] : node.children[1];
+    }
+
+    const auto sibling = index;
+    const auto old_parent = nodes_[sibling].parent;
+
+    const auto new_parent = allocate_node();
+    nodes_[new_parent] = {
+        .bounds = merge(leaf_bounds, nodes_[sibling].bounds),
+        .item_bounds = {},
+        .entity = nullptr,
+        .parent = old_parent,
+        .children = {sibling, leaf},
+        .height = nodes_[sibling].height + 1u};
+
+    nodes_[sibling].parent = new_parent;
+    nodes_[leaf].parent = new_parent;
+
+    if (old_parent == null_node)
+    {
+        root_ = new_parent;
+    }
+    else
+    {
+        auto &children = nodes_[old_parent].children;
+        children[children[0] == sibling ? 0u : 1u] = new_parent;
+    }
+
+    fix_upwards(old_parent);
+}
+
+auto AABBTree::remove_leaf(std::uint32_t leaf) -> void
+{
+    if (leaf == root_)
+    {
+        root_ = null_node;
+        return;
+    }
+
+    const auto parent = nodes_[leaf].parent;
+    const auto grandparent = nodes_[parent].parent;
+    const auto &siblings = nodes_[parent].children;
+    const auto sibling = siblings[0] == leaf ? siblings[1] : siblings[0];
+
+    // the sibling takes the place of the parent
+    nodes_[sibling].parent = grandparent;
+
+    if (grandparent == null_node)
+    {
+        root_ = sibling;
+    }
+    else
+    {
+        auto &children = nodes_[grandparent].children;
+        children[children[0] == parent ? 0u : 1u] = sibling;
+    }
+
+    free_node(parent);
+    fix_upwards(grandparent);
+}
+
+auto AABBTree::fix_upwards(std::uint32_t index) -> void
+{
+    while (index != null_node)
+    {
+        index = balance(index);
+        update_node(index);
+        index = nodes_[index].parent;
+    }
+}
+
+auto AABBTree::balance(std::uint32_t index) -> std::uint32_t
+{
+    const auto &node = nodes_[index];
+    if ((node.children[0] == null_node) || (node.height < 2u))
+    {
+        return index;
+    }
+
+    const auto height0 = static_cast<std::int64_t>(nodes_[node.children[0]].height);
+    const auto height1 = static_cast<std::int64_t>(nodes_[node.children[1]].height);
+
+    if (std::abs(height1 - height0) < 2)
+    {
+        return index;
+    }
+
+    // the taller child replaces the node, which keeps the other child and takes the shorter of the taller child's
+    // children in its place, the taller grandchild stays with the child that moved up
+    const auto side = height1 > height0 ? 1u : 0u;
+    const auto up = node.children[side];
+    const auto [grandchild0, grandchild1] = nodes_[up].children;
+    const auto taller_first = nodes_[grandchild0].height > nodes_[grandchild1].height;
+    const auto taller = taller_first ? grandchild0 : grandchild1;
+    const auto shorter = taller_first ? grandchild1 : grandchild0;
+
+    const auto parent = node.parent;
+    nodes_[up].parent = parent;
+    nodes_[up].children = {index, taller};
+    nodes_[index].parent = up;
+    nodes_[index].children[side] = shorter;
+    nodes_[shorter].parent = index;
+
+    if (parent == null_node)
+    {
+        root_ = up;
+    }
+    else
+    {
+        auto &children = nodes_[parent].children;
+        children[children[0] == index ? 0u : 1u] = up;
+    }
+
+    update_node(index);
+    update_node(up);
+
+    return up;
+}
+
+auto AABBTree::update_node(std::uint32_t index) -> void
+{
+    auto &node = nodes_[index];
+    const auto &child0 = nodes_[node.children[0]];
+    const auto &child1 = nodes_[node.children[1]];
+
+    node.bounds = merge(child0.bounds, child1.bounds);
+    node.height = std::max(child0.height, child1.height) + 1u;
+}
+
+auto AABBTree::collect(std::uint32_t index, std::vector<const Entity *> &result) const -> void
+{
+    auto stack = std::vector<std::uint32_t>{index};
+
+    while (!stack.empty())
+    {
+        const auto &node = nodes_[stack.back()];
+        stack.pop_back();
+
+        if (node.children[0] == null_node)
+        {
+            result.push_back(node.entity);
+        }
+        else
+        {
+            stack.push_back(node.children[0]);
+            stack.push_back(node.children[1]);
+        }
+    }
+}
+
+}
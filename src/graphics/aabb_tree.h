@@ -0,0 +1,351 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <span>
+#include <tuple>
+#include <unordered_map>
+#include <vector>
+
+#include "maths/aabb.h"
+#include "maths/frustum_plane.h"
+#include "maths/vector3.h"
+
+namespace game
+{
+
+class Entity;
+class ThreadPool;
+
+/**
+ * A dynamic bounding volume hierarchy of entities, so visibility, proximity and picking queries only visit the parts
+ * of a scene near what they are looking for rather than every entity.
+ *
+ * Each entity is a leaf whose box is its bounds fattened by a margin, so an entity which moves a little does not touch
+ * the tree at all. One which leaves its fattened box is removed and reinserted next to whatever it is now near.
+ * Insertions are kept balanced with tree rotations, but being greedy they are not as good as a build, so the tree
+ * rebuilds itself once there have been more reinsertions than it has entities.
+ *
+ * Queries test the exact bounds of each entity, the fattened boxes are only used to skip whole subtrees. Queries are
+ * const and safe to run concurrently with each other.
+ */
+class AABBTree
+{
+  public:
+    /**
+     * An entity and its bounds, for building a tree.
+     */
+    struct Item
+    {
+        /** The entity. */
+        const Entity *entity;
+
+        /** World space bounds of the entity. */
+        AABB bounds;
+    };
+
+    /**
+     * Construct a new empty tree.
+     *
+     * @param margin
+     *   How far each leaf box extends past the bounds of its entity on every side.
+     */
+    explicit AABBTree(float margin = 0.1f);
+
+    /**
+     * Replace the contents of the tree with a tree built top down from scratch, this gives a better tree than inserting
+     * the entities one at a time.
+     *
+     * @param items
+     *   The entities to add, each entity must only appear once.
+     */
+    auto build(std::span<const Item> items) -> void;
+
+    /**
+     * Replace the contents of the tree with a tree built top down from scratch, with independent subtrees built
+     * concurrently on a thread pool, e.g. when loading a level.
+     *
+     * @param items
+     *   The entities to add, each entity must only appear once.
+     * @param pool
+     *   Pool to build subtrees on.
+     * @param priority
+     *   Priority of the build tasks.
+     */
+    auto build(std::span<const Item> items, ThreadPool &pool, std::size_t priority) -> void;
+
+    /**
+     * Rebuild the tree from scratch with the current entities and bounds.
+     */
+    auto rebuild() -> void;
+
+    /**
+     * Add an entity.
+     *
+     * @param entity
+     *   The entity to add, must not already be in the tree.
+     * @param bounds
+     *   World space bounds of the entity.
+     */
+    auto insert(const Entity *entity, const AABB &bounds) -> void;
+
+    /**
+     * Remove an entity.
+     *
+     * @param entity
+     *   The entity to remove, must be in the tree.
+     */
+    auto remove(const Entity *entity) -> void;
+
+    /**
+     * Update the bounds of an entity, e.g. after it has moved. The entity is only reinserted if the bounds have left
+     * its fattened box, which may in turn trigger a rebuild.
+     *
+     * @param entity
+     *   The entity to update, must be in the tree.
+     * @param bounds
+     *   New world space bounds of the entity.
+     */
+    auto update(const Entity *entity, const AABB &bounds) -> void;
+
+    /**
+     * Check if an entity is in the tree.
+     *
+     * @param entity
+     *   The entity to check.
+     *
+     * @returns
+     *   True if the entity is in the tree.
+     */
+    auto contains(const Entity *entity) const -> bool;
+
+    /**
+     * Get the number of entities in the tree.
+     *
+     * @returns
+     *   Number of entities.
+     */
+    auto size() const -> std::size_t;
+
+    /**
+     * Get the height of the tree, i.e. the number of edges from the root to the deepest leaf.
+     *
+     * @returns
+     *   Height of the tree, zero if it has fewer than two entities.
+     */
+    auto height() const -> std::size_t;
+
+    /**
+     * Get the number of reinsertions since the tree was last built.
+     *
+     * @returns
+     *   Number of reinsertions.
+     */
+    auto reinsert_count() const -> std::size_t;
+
+    /**
+     * Find all entities which are at least partially inside a frustum, the same entities intersects_frustum would
+     * accept. Subtrees entirely inside the frustum are accepted without testing each entity.
+     *
+     * @param planes
+     *   The frustum planes, with normals pointing into the frustum.
+     * @param result
+     *   The entities are appended to this, so the memory can be reused.
+     */
+    auto query_frustum(const std::array<FrustumPlane, 6u> &planes, std::vector<const Entity *> &result) const -> void;
+
+    /**
+     * Find all entities whose bounds overlap a box.
+     *
+     * @param aabb
+     *   The box to test.
+     * @param result
+     *   The entities are appended to this, so the memory can be reused.
+     */
+    auto query_aabb(const AABB &aabb, std::vector<const Entity *> &result) const -> void;
+
+    /**
+     * Find all entities whose bounds overlap a sphere.
+     *
+     * @param centre
+     *   Centre of the sphere.
+     * @param radius
+     *   Radius of the sphere.
+     * @param result
+     *   The entities are appended to this, so the memory can be reused.
+     */
+    auto query_sphere(const Vector3 &centre, float radius, std::vector<const Entity *> &result) const -> void;
+
+    /**
+     * Find all entities whose bounds are hit by a ray, nearest first.
+     *
+     * @param origin
+     *   Start of the ray.
+     * @param direction
+     *   Direction of the ray.
+     * @param max_distance
+     *   End of the ray, as a multiple of direction (so a distance if direction is normalised).
+     * @param result
+     *   The entities are appended to this, so the memory can be reused.
+     */
+    auto query_ray(
+        const Vector3 &origin,
+        const Vector3 &direction,
+        float max_distance,
+        std::vector<const Entity *> &result) const -> void;
+
+  private:
+    /** Index of a node which does not exist. */
+    static constexpr auto null_node = std::numeric_limits<std::uint32_t>::max();
+
+    /**
+     * A node in the tree, either a leaf with an entity or an internal node with two children.
+     */
+    struct Node
+    {
+        /** Fattened bounds of the entity for a leaf, union of the children otherwise. */
+        AABB bounds;
+
+        /** Exact bounds of the entity, only for leaves. */
+        AABB item_bounds;
+
+        /** The entity, only for leaves. */
+        const Entity *entity;
+
+        /** Index of the parent, or the next free node if this node is free. */
+        std::uint32_t parent;
+
+        /** Indices of the children, null_node for leaves. */
+        std::array<std::uint32_t, 2u> children;
+
+        /** Height of the subtree, zero for leaves. */
+        std::uint32_t height;
+    };
+
+    /**
+     * An entity being built into a tree.
+     */
+    struct BuildItem;
+
+    /**
+     * Build a subtree top down.
+     *
+     * @param items
+     *   The entities in the subtree, reordered as they are split.
+     * @param nodes
+     *   Where to add the nodes, the root of the subtree is added first and parents are always added before their
+     *   children.
+     * @param split_depth
+     *   Depth at which to stop splitting and defer the rest of the subtree to deferred.
+     * @param deferred
+     *   Where to defer subtrees below split_depth to, along with the node they should replace. Nothing is deferred if
+     *   this is null.
+     *
+     * @returns
+     *   Index of the root of the subtree.
+     */
+    static auto build_subtree(
+        std::span<BuildItem> items,
+        std::vector<Node> &nodes,
+        std::size_t split_depth,
+        std::vector<std::tuple<std::uint32_t, std::span<BuildItem>>> *deferred) -> std::uint32_t;
+
+    /**
+     * Replace the contents of the tree with a built tree.
+     *
+     * @param nodes
+     *   The nodes, every parent must come before its children.
+     */
+    auto finish_build(std::vector<Node> nodes) -> void;
+
+    /**
+     * Get a node which is not in use.
+     *
+     * @returns
+     *   Index of the node.
+     */
+    auto allocate_node() -> std::uint32_t;
+
+    /**
+     * Return a node to the free list.
+     *
+     * @param index
+     *   Index of the node.
+     */
+    auto free_node(std::uint32_t index) -> void;
+
+    /**
+     * Add a leaf to the tree, next to the node which increases the total area of the tree the least.
+     *
+     * @param leaf
+     *   Index of the leaf.
+     */
+    auto insert_leaf(std::uint32_t leaf) -> void;
+
+    /**
+     * Remove a leaf from the tree, its sibling takes the place of its parent.
+     *
+     * @param leaf
+     *   Index of the leaf.
+     */
+    auto remove_leaf(std::uint32_t leaf) -> void;
+
+    /**
+     * Recalculate the bounds and height of a node and all of its ancestors, rebalancing them on the way.
+     *
+     * @param index
+     *   Index of the first node to recalculate, may be null_node.
+     */
+    auto fix_upwards(std::uint32_t index) -> void;
+
+    /**
+     * Rotate the taller child of a node above it, if the heights of its children differ by more than one.
+     *
+     * @param index
+     *   Index of the node.
+     *
+     * @returns
+     *   Index of the node now in its place.
+     */
+    auto balance(std::uint32_t index) -> std::uint32_t;
+
+    /**
+     * Recalculate the bounds and height of an internal node from its children.
+     *
+     * @param index
+     *   Index of the node.
+     */
+    auto update_node(std::uint32_t index) -> void;
+
+    /**
+     * Append the entities of every leaf in a subtree.
+     *
+     * @param index
+     *   Index of the root of the subtree.
+     * @param result
+     *   Where to append the entities.
+     */
+    auto collect(std::uint32_t index, std::vector<const Entity *> &result) const -> void;
+
+    /** All nodes, including free ones. */
+    std::vector<Node> nodes_;
+
+    /** Index of the root, null_node if the tree is empty. */
+    std::uint32_t root_;
+
+    /** Index of the first free node, null_node if there are none. */
+    std::uint32_t free_list_;
+
+    /** Leaf of each entity. */
+    std::unordered_map<const Entity *, std::uint32_t> leaves_;
+
+    /** How far leaf boxes extend past the bounds of their entity. */
+    float margin_;
+
+    /** Number of reinsertions since the tree was last built. */
+    std::size_t reinsert_count_;
+};
+
+}
@@ -42,6 +42,14 @@ class Buffer
      */
     auto native_handle() const -> ::GLuint;
 
+    /**
+     * Get the size of the buffer.
+     *
+     * @returns
+     *   Size of the buffer in bytes.
+     */
+    auto size() const -> std::uint32_t;
+
   private:
     /** OpenGL buffer handle. */
     AutoRelease<::GLuint> buffer_;
@@ -36,6 +36,9 @@ Camera::Camera(
     float far_plane)
     : view_(Matrix4::look_at(position, look_at, up))
     , projection_(Matrix4::perspective(fov, width, height, near_plane, far_plane))
+    , view_projection_{}
+    , frustum_planes_{}
+    , dirty_{true}
     , position_(position)
     , direction_(look_at)
     , up_(up)
@@ -49,7 +52,7 @@ Camera::Camera(
     , far_plane_(far_plane)
 {
     direction_ = create_direction(pitch_, yaw_);
-    view_ = Matrix4::look_at(position_, position_ + direction_, up_);
+    update_view();
     adjust_pitch(0.0f);
 }
 
@@ -61,7 +64,7 @@ auto Camera::position() const -> Vector3
 auto Camera::set_position(const Vector3 &position) -> void
 {
     position_ = position;
-    view_ = Matrix4::look_at(position_, position_ + direction_, up_);
+    update_view();
 }
 
 auto Camera::direction() const -> Vector3
@@ -88,7 +91,7 @@ auto Camera::adjust_yaw(float adjust) -> void
     right_ = Vector3::normalise(Vector3::cross(direction_, world_up));
     up_ = Vector3::normalise(Vector3::cross(right_, direction_));
 
-    view_ = Matrix4::look_at(position_, position_ + direction_, up_);
+    update_view();
 }
 
 auto Camera::adjust_pitch(float adjust) -> void
@@ -100,14 +103,14 @@ auto Camera::adjust_pitch(float adjust) -> void
     right_ = Vector3::normalise(Vector3::cross(direction_, world_up));
     up_ = Vector3::normalise(Vector3::cross(right_, direction_));
 
-    view_ = Matrix4::look_at(position_, position_ + direction_, up_);
+    update_view();
 }
 
 auto Camera::translate(const Vector3 &translation) -> void
 {
     position_ += translation;
     direction_ = create_direction(pitch_, yaw_);
-    view_ = Matrix4::look_at(position_, position_ + direction_, up_);
+    update_view();
 }
 
 auto Camera::view() const -> const Matrix4 &
@@ -145,40 +148,16 @@ auto Camera::far_plane() const -> float
     return far_plane_;
 }
 
-auto Camera::frustum_planes() const -> std::array<FrustumPlane, 6u>
-{
-    auto planes = std::array<FrustumPlane, 6u>{};
-
-    const auto view_proj = projection_ * view_;
-
-    return {{
-        {view_proj[3] - view_proj[2],
-         view_proj[7] - view_proj[6],
-         view_proj[11] - view_proj[10],
-         view_proj[15] - view_proj[14]},
-        {view_proj[3] + view_proj[2],
-         view_proj[7] + view_proj[6],
-         view_proj[11] + view_proj[10],
-         view_proj[15] + view_proj[14]},
-        {view_proj[3] + view_proj[0],
-         view_proj[7] + view_proj[4],
-         view_proj[11] + view_proj[8],
-         view_proj[15] + view_proj[12]},
-        {view_proj[3] - view_proj[0],
-         view_proj[7] - view_proj[4],
-         view_proj[11] - view_proj[8],
-         view_proj[15] - view_proj[12]},
-        {view_proj[3] + view_proj[1],
-         view_proj[7] + view_proj[5],
-         view_proj[11] + view_proj[9],
-         view_proj[15] + view_proj[13]},
-        {view_proj[3] - view_proj[1],
-         view_proj[7] - view_proj[5],
-         view_proj[11] - view_proj[9],
-         view_proj[15] - view_proj[13]},
-    }};
+auto Camera::view_projection() const -> const Matrix4 &
+{
+    update_frustum();
+    return view_projection_;
+}
 
-    return planes;
+auto Camera::frustum_planes() const -> const std::array<FrustumPlane, 6u> &
+{
+    update_frustum();
+    return frustum_planes_;
 }
 
 auto Camera::frustum_corners() const -> std::array<Vector3, 8u>
@@ -213,4 +192,33 @@ auto Camera::frustum_corners() const -> std::array<Vector3, 8u>
     return corners;
 }
 
+auto Camera::update_view() -> void
+{
+    view_ = Matrix4::look_at(position_, position_ + direction_, up_);
+    dirty_ = true;
+}
+
+auto Camera::update_frustum() const -> void
+{
+    if (!dirty_)
+    {
+        return;
+    }
+
+    view_projection_ = projection_ * view_;
+
+    // each plane is the sum or difference of the last row and one of the other rows
+    const auto &vp = view_projection_;
+    frustum_planes_ = {{
+        {vp[3] - vp[2], vp[7] - vp[6], vp[11] - vp[10], vp[15] - vp[14]},
+        {vp[3] + vp[2], vp[7] + vp[6], vp[11] + vp[10], vp[15] + vp[14]},
+        {vp[3] + vp[0], vp[7] + vp[4], vp[11] + vp[8], vp[15] + vp[12]},
+        {vp[3] - vp[0], vp[7] - vp[4], vp[11] - vp[8], vp[15] - vp[12]},
+        {vp[3] + vp[1], vp[7] + vp[5], vp[11] + vp[9], vp[15] + vp[13]},
+        {vp[3] - vp[1], vp[7] - vp[5], vp[11] - vp[9], vp[15] - vp[13]},
+    }};
+
+    dirty_ = false;
+}
+
 }
@@ -12,6 +12,9 @@ namespace game
 
 /**
  * Camera class to represent a camera in 3D space. This what the world is rendered from.
+ *
+ * The view-projection matrix and frustum planes are cached, they are recalculated the first time they are asked for
+ * after the camera moves. This means the const accessors are not safe to call concurrently.
  */
 class Camera
 {
@@ -126,6 +129,14 @@ class Camera
      */
     auto projection() const -> const Matrix4 &;
 
+    /**
+     * Get the combined view-projection matrix of the camera, i.e. projection() * view().
+     *
+     * @returns
+     *   The view-projection matrix of the camera.
+     */
+    auto view_projection() const -> const Matrix4 &;
+
     /**
      * Get the field of view of the camera.
      *
@@ -167,12 +178,12 @@ class Camera
     auto far_plane() const -> float;
 
     /**
-     * Calulates the frustum planes of the camera.
+     * Get the frustum planes of the camera, with normals pointing into the frustum.
      *
      * @returns
      *   The frustum planes of the camera.
      */
-    auto frustum_planes() const -> std::array<FrustumPlane, 6u>;
+    auto frustum_planes() const -> const std::array<FrustumPlane, 6u> &;
 
     /**
      * Calculates the frustum corners of the camera.
@@ -183,12 +194,32 @@ class Camera
     auto frustum_corners() const -> std::array<Vector3, 8u>;
 
   private:
+    /**
+     * Recalculate the view matrix from the position, direction and up vector.
+     */
+    auto update_view() -> void;
+
+    /**
+     * Recalculate the view-projection matrix and frustum planes, if the camera has moved since they were last
+     * calculated.
+     */
+    auto update_frustum() const -> void;
+
     /** View matrix of the camera. */
     Matrix4 view_;
 
     /** Projection matrix of the camera. */
     Matrix4 projection_;
 
+    /** Cached view-projection matrix. */
+    mutable Matrix4 view_projection_;
+
+    /** Cached frustum planes. */
+    mutable std::array<FrustumPlane, 6u> frustum_planes_;
+
+    /** Whether the cached view-projection matrix and frustum planes are out of date. */
+    mutable bool dirty_;
+
     /** The position of the camera in world space. */
     Vector3 position_;
 
@@ -13,8 +13,11 @@
 #include <stb_image.h>
 
 #include "graphics/opengl.h"
+#include "graphics/texture.h"
 #include "third_party/opengl/glext.h"
-#include "tlv/tlv_reader.h"
+#include "tlv/tlv_archive.h"
+#include "tlv/tlv_compression.h"
+#include "tlv/tlv_entry.h"
 #include "utils/auto_release.h"
 #include "utils/error.h"
 
@@ -52,22 +55,37 @@ CubeMap::CubeMap(std::vector<std::span<const std::byte>> faces, std::uint32_t wi
     }
 }
 
-CubeMap::CubeMap(const TLVReader &reader, std::array<std::string_view, 6> image_names)
+CubeMap::CubeMap(const TLVArchive &archive, std::array<std::string_view, 6> image_names)
     : handle_{0u, [](auto texture) { ::glDeleteTextures(1u, &texture); }}
 {
+    // compressed faces are decompressed into staging copies, which have to outlive the upload
+    auto staging = std::vector<TLVStagingBuffer>{};
+    auto faces = std::array<TextureDescriptionView, 6u>{};
 
-    // load each face from the tlv
-    const auto descs =
-        image_names | std::views::transform(
-                          [&reader](const auto &e)
-                          {
-                              const auto desc =
-                                  std::ranges::find_if(reader, [e](const auto &e2) { return e2.is_texture(e); });
-                              ensure(desc != std::ranges::end(reader), "cannot find image");
+    for (auto index = 0u; index < faces.size(); ++index)
+    {
+        const auto desc = archive.find(image_names[index], TLVType::TEXTURE_DESCRIPTION);
+        ensure(desc.has_value(), "cannot find image {}", image_names[index]);
+
+        if (desc->is_compressed())
+        {
+            staging.emplace_back(*desc).decompress();
+            faces[index] = staging.back().entry().texture_description_view();
+        }
+        else
+        {
+            faces[index] = desc->texture_description_view();
+        }
+    }
 
-                              return (*desc).texture_description_value();
-                          });
+    // bit gross but we can reuse the other ctor
+    auto cube_map = CubeMap{faces};
+    std::ranges::swap(handle_, cube_map.handle_);
+}
 
+CubeMap::CubeMap(const std::array<TextureDescriptionView, 6u> &descs)
+    : handle_{0u, [](auto texture) { ::glDeleteTextures(1u, &texture); }}
+{
     const auto width = descs.front().width;
     const auto height = descs.front().height;
 
@@ -79,24 +97,72 @@ CubeMap::CubeMap(const TLVReader &reader, std::array<std::string_view, 6> image_
             [width, height](const auto &e) { return e == std::make_tuple(width, height); }),
         "all width and heights need to be the same");
 
+    const auto mip_levels = descs.front().mip_levels;
+    ensure(
+        std::ranges::all_of(descs, [mip_levels](const auto &e) { return e.mip_levels == mip_levels; }),
+        "all faces need the same number of mip levels");
+    ensure(
+        (mip_levels >= 1u) && (mip_levels <= mip_level_count(width, height)), "invalid mip level count {}", mip_levels);
+
+    const auto format = descs.front().format;
+    ensure(
+        std::ranges::all_of(descs, [format](const auto &e) { return e.format == format; }),
+        "all faces need the same format");
+    ensure((format == TextureFormat::RGB) || is_compressed(format), "cube map faces must be RGB or compressed");
+
+    const auto internal_format = is_compressed(format) ? to_opengl(descs.front().usage, format) : GL_SRGB8;
+
     ::glCreateTextures(GL_TEXTURE_CUBE_MAP, 1u, &handle_);
-    ::glTextureStorage2D(handle_, 1, GL_SRGB8, width, height);
+    ::glTextureStorage2D(handle_, mip_levels, internal_format, width, height);
 
-    // load each face
+    // rows of the smaller levels are not 4 byte aligned, which is the default unpack alignment, the guard puts the
+    // default back once every face is uploaded (or one throws) so later uploads aren't affected
+    ::glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    const auto restore_alignment =
+        AutoRelease<::GLint>{4, [](auto alignment) { ::glPixelStorei(GL_UNPACK_ALIGNMENT, alignment); }};
+
+    // load each level of each face, the faces are already decoded so this is a straight copy
     for (const auto &[index, desc] : std::views::enumerate(descs))
     {
-        ::glTextureSubImage3D(
-            handle_,
-            0,
-            0,
-            0,
-            static_cast<::GLint>(index),
-            desc.width,
-            desc.height,
-            1,
-            GL_RGB,
-            GL_UNSIGNED_BYTE,
-            desc.data.data());
+        auto offset = std::size_t{};
+        for (auto level = 0u; level < mip_levels; ++level)
+        {
+            const auto level_size = mip_level_size(format, width, height, level);
+            ensure(offset + level_size <= desc.data.size(), "face data too small for mip level {}", level);
+
+            if (is_compressed(format))
+            {
+                ::glCompressedTextureSubImage3D(
+                    handle_,
+                    level,
+                    0,
+                    0,
+                    static_cast<::GLint>(index),
+                    std::max(width >> level, 1u),
+                    std::max(height >> level, 1u),
+                    1,
+                    internal_format,
+                    static_cast<::GLsizei>(level_size),
+                    desc.data.data() + offset);
+            }
+            else
+            {
+                ::glTextureSubImage3D(
+                    handle_,
+                    level,
+                    0,
+                    0,
+                    static_cast<::GLint>(index),
+                    std::max(width >> level, 1u),
+                    std::max(height >> level, 1u),
+                    1,
+                    GL_RGB,
+                    GL_UNSIGNED_BYTE,
+                    desc.data.data() + offset);
+            }
+
+            offset += level_size;
+        }
     }
 }
 
@@ -8,12 +8,13 @@
 #include <vector>
 
 #include "graphics/opengl.h"
+#include "graphics/texture.h"
 #include "utils/auto_release.h"
 
 namespace game
 {
 
-class TLVReader;
+class TLVArchive;
 
 /**
  * Class representing a cube map texture. Used for skyboxes.
@@ -33,15 +34,23 @@ class CubeMap
      */
     CubeMap(std::vector<std::span<const std::byte>> faces, std::uint32_t width, std::uint32_t height);
 
+    /**
+     * Construct a new CubeMap object from faces which have already been decoded.
+     *
+     * @param descs
+     *   The description of each face, all must have the same dimensions, format and number of mip levels.
+     */
+    CubeMap(const std::array<TextureDescriptionView, 6u> &descs);
+
     /**
      * Construct a new CubeMap object.
      *
-     * @param reader
-     *   The TLV reader to read the cube map data from.
+     * @param archive
+     *   The TLV archive to read the cube map data from.
      * @param image_names
      *   The names of the images to load for each face of the cube map.
      */
-    CubeMap(const TLVReader &reader, std::array<std::string_view, 6> image_names);
+    CubeMap(const TLVArchive &archive, std::array<std::string_view, 6> image_names);
 
     /**
      * Get the native OpenGL texture handle.
@@ -6,6 +6,8 @@
 #include "graphics/material.h"
 #include "graphics/mesh.h"
 #include "graphics/texture.h"
+#include "maths/aabb.h"
+#include "maths/matrix4.h"
 #include "maths/vector3.h"
 
 namespace game
@@ -64,4 +66,10 @@ auto Entity::position() const -> Vector3
     return transform_.position;
 }
 
+auto Entity::bounds() const -> AABB
+{
+    // qualified as the transform() member hides the free function
+    return game::transform(mesh_->bounds(), Matrix4{transform_});
+}
+
 }
@@ -3,6 +3,7 @@
 #include <span>
 #include <vector>
 
+#include "maths/aabb.h"
 #include "maths/matrix4.h"
 #include "maths/quaternion.h"
 #include "maths/transform.h"
@@ -118,6 +119,14 @@ class Entity
      */
     auto position() const -> Vector3;
 
+    /**
+     * Get the world space bounds of this entity, i.e. the bounds of its mesh after its transform.
+     *
+     * @returns
+     *   The bounds of this entity.
+     */
+    auto bounds() const -> AABB;
+
   private:
     /** Mesh for this entity. */
     const Mesh *mesh_;
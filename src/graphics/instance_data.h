@@ -0,0 +1,27 @@
+#pragma once
+
+#include <array>
+
+#include "maths/matrix4.h"
+
+namespace game
+{
+
+/** Binding point of the "instances" shader storage block, which holds the per instance data of instanced draws. */
+constexpr auto instance_block_binding = 3u;
+
+/**
+ * Per instance data of an entity, laid out to match the std430 Instance struct in the instanced shaders.
+ */
+struct InstanceData
+{
+    /** Model matrix of the entity, with the dequantisation of its mesh folded in. */
+    Matrix4 model;
+
+    /** Material specific values, e.g. a tint, read by the shader as a vec4. */
+    std::array<float, 4u> parameters;
+};
+
+static_assert(sizeof(InstanceData) == 80u, "InstanceData must match the std430 layout");
+
+}
@@ -1,12 +1,24 @@
 #include "graphics/material.h"
 
-#include <format>
+#include <algorithm>
+#include <charconv>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <optional>
 #include <ranges>
+#include <span>
 #include <string>
+#include <string_view>
+#include <system_error>
 
 #include "entity.h"
+#include "graphics/buffer.h"
+#include "graphics/instance_data.h"
 #include "graphics/opengl.h"
 #include "graphics/shader.h"
+#include "graphics/uniform.h"
+#include "resources/resource_footprint.h"
 #include "utils/auto_release.h"
 #include "utils/error.h"
 
@@ -15,7 +27,14 @@ namespace game
 Material::Material(const Shader &vertex_shader, const Shader &fragment_shader)
     : handle_{}
     , uniforms_{}
+    , model_uniform_{}
+    , parameters_{}
+    , parameter_data_{}
+    , parameter_buffer_{}
+    , parameters_dirty_{}
+    , instanced_{}
     , uniform_callback_{}
+    , instance_callback_{}
 {
     expect(vertex_shader.type() == ShaderType::VERTEX, "shader is not a vertex shader");
     expect(fragment_shader.type() == ShaderType::FRAGMENT, "shader is not a fragment shader");
@@ -40,6 +59,24 @@ Material::Material(const Shader &vertex_shader, const Shader &fragment_shader)
         game::ensure(result, "failed to link program\n{}", log);
     }
 
+    // find the parameter block, if there is one
+
+    const auto material_block = ::glGetUniformBlockIndex(handle_, "material");
+    if (material_block != GL_INVALID_INDEX)
+    {
+        auto block_size = ::GLint{};
+        ::glGetActiveUniformBlockiv(handle_, material_block, GL_UNIFORM_BLOCK_DATA_SIZE, &block_size);
+
+        // start zeroed, the same as uniforms which are never set
+        parameter_data_.resize(static_cast<std::size_t>(block_size));
+        parameter_buffer_.emplace(static_cast<std::uint32_t>(block_size));
+        parameters_dirty_ = true;
+    }
+
+    // check whether the program reads per instance data
+
+    instanced_ = ::glGetProgramResourceIndex(handle_, GL_SHADER_STORAGE_BLOCK, "instances") != GL_INVALID_INDEX;
+
     // get uniforms
 
     auto uniform_count = ::GLint{};
@@ -60,12 +97,50 @@ Material::Material(const Shader &vertex_shader, const Shader &fragment_shader)
             ::glGetActiveUniform(handle_, i, max_name_length, &length, &count, &type, name.data());
             name.resize(length);
 
+            const auto index = static_cast<::GLuint>(i);
+            auto block = ::GLint{};
+            ::glGetActiveUniformsiv(handle_, 1, &index, GL_UNIFORM_BLOCK_INDEX, &block);
+
+            // members of blocks do not have locations, only those of the material block are of interest
+            if (block != -1)
+            {
+                if (static_cast<::GLuint>(block) == material_block)
+                {
+                    auto offset = ::GLint{};
+                    ::glGetActiveUniformsiv(handle_, 1, &index, GL_UNIFORM_OFFSET, &offset);
+                    parameters_[name] = static_cast<std::uint32_t>(offset);
+                }
+
+                continue;
+            }
+
             const auto location = ::glGetUniformLocation(handle_, name.c_str());
+
+            // texture samplers are always bound to the unit matching their name, so they can be set once here rather
+            // than every time a texture is bound
+            if (name.starts_with("tex"))
+            {
+                const auto *name_end = name.data() + name.size();
+                auto unit = 0;
+
+                if (const auto [end, error] = std::from_chars(name.data() + 3, name_end, unit);
+                    error == std::errc{} && end == name_end)
+                {
+                    ::glProgramUniform1i(handle_, location, unit);
+                }
+            }
+
             uniforms_[name] = location;
         }
     }
 
-    log::info("new material ({} uniforms)", uniform_count);
+    if (const auto model = uniforms_.find("model"); model != std::ranges::cend(uniforms_))
+    {
+        model_uniform_ = Uniform<Matrix4>{model->second};
+    }
+
+    log::info(
+        "new material ({} uniforms, {} parameters, instanced: {})", uniforms_.size(), parameters_.size(), instanced_);
 }
 
 auto Material::use() const -> void
@@ -73,56 +148,57 @@ auto Material::use() const -> void
     ::glUseProgram(handle_);
 }
 
-auto Material::set_uniform(std::string_view name, int obj) const -> void
+auto Material::model_uniform() const -> Uniform<Matrix4>
 {
-    const auto uniform = uniforms_.find(name);
-    expect(uniform != std::ranges::cend(uniforms_), "missing uniform {}", name);
-
-    ::glUniform1i(uniform->second, obj);
+    return model_uniform_;
 }
 
-auto Material::set_uniform(std::string_view name, float obj) const -> void
+auto Material::set_uniform(Uniform<int> uniform, int obj) const -> void
 {
-    const auto uniform = uniforms_.find(name);
-    expect(uniform != std::ranges::cend(uniforms_), "missing uniform {}", name);
+    ::glProgramUniform1i(handle_, uniform.location(), obj);
+}
 
-    ::glUniform1f(uniform->second, obj);
+auto Material::set_uniform(Uniform<float> uniform, float obj) const -> void
+{
+    ::glProgramUniform1f(handle_, uniform.location(), obj);
 }
 
-auto Material::set_uniform(std::string_view name, const Matrix4 &obj) const -> void
+auto Material::set_uniform(Uniform<Matrix4> uniform, const Matrix4 &obj) const -> void
 {
-    const auto uniform = uniforms_.find(name);
-    expect(uniform != std::ranges::cend(uniforms_), "missing uniform {}", name);
+    ::glProgramUniformMatrix4fv(handle_, uniform.location(), 1, GL_FALSE, obj.data().data());
+}
 
-    ::glUniformMatrix4fv(uniform->second, 1, GL_FALSE, obj.data().data());
+auto Material::set_uniform(Uniform<Colour> uniform, const Colour &obj) const -> void
+{
+    ::glProgramUniform3fv(handle_, uniform.location(), 1, reinterpret_cast<const ::GLfloat *>(std::addressof(obj)));
 }
 
-auto Material::set_uniform(std::string_view name, const Colour &obj) const -> void
+auto Material::parameter_buffer() const -> ::GLuint
 {
-    const auto uniform = uniforms_.find(name);
-    expect(uniform != std::ranges::cend(uniforms_), "missing uniform {}", name);
+    if (!parameter_buffer_)
+    {
+        return 0u;
+    }
+
+    if (parameters_dirty_)
+    {
+        parameter_buffer_->write(parameter_data_, 0u);
+        parameters_dirty_ = false;
+    }
 
-    ::glUniform3fv(uniform->second, 1, reinterpret_cast<const ::GLfloat *>(std::addressof(obj)));
+    return parameter_buffer_->native_handle();
 }
 
 auto Material::bind_cube_map(const CubeMap *cube_map, const Sampler *sampler) const -> void
 {
     ::glBindTextureUnit(0, cube_map->native_handle());
     ::glBindSampler(0, sampler->native_handle());
-
-    const auto uniform_name = std::format("tex{}", 0);
-
-    set_uniform(uniform_name, 0);
 }
 
 auto Material::bind_texture(std::uint32_t index, const Texture *texture, const Sampler *sampler) const -> void
 {
     ::glBindTextureUnit(index, texture->native_handle());
     ::glBindSampler(index, sampler->native_handle());
-
-    const auto uniform_name = std::format("tex{}", index);
-
-    set_uniform(uniform_name, static_cast<int>(index));
 }
 
 auto Material::bind_texture(std::uint32_t index, const Texture *texture) const -> void
@@ -151,8 +227,78 @@ auto Material::invoke_uniform_callback(const Entity *entity) const -> void
     }
 }
 
+auto Material::instanced() const -> bool
+{
+    return instanced_;
+}
+
+auto Material::set_instance_callback(InstanceCallback instance_callback) -> void
+{
+    instance_callback_ = std::move(instance_callback);
+}
+
+auto Material::invoke_instance_callback(const Entity *entity, InstanceData &instance) const -> void
+{
+    if (instance_callback_)
+    {
+        instance_callback_(this, entity, instance);
+    }
+}
+
+auto Material::uniform_location(std::string_view name) const -> ::GLint
+{
+    const auto uniform = uniforms_.find(name);
+    expect(uniform != std::ranges::cend(uniforms_), "missing uniform {}", name);
+
+    return uniform->second;
+}
+
+auto Material::parameter_offset(std::string_view name, std::size_t size) const -> std::uint32_t
+{
+    const auto parameter = parameters_.find(name);
+    expect(parameter != std::ranges::cend(parameters_), "missing parameter {}", name);
+    expect(parameter->second + size <= parameter_data_.size(), "parameter {} too large", name);
+
+    return parameter->second;
+}
+
+auto Material::write_parameter(std::uint32_t offset, std::span<const std::byte> data) -> void
+{
+    expect(offset + data.size() <= parameter_data_.size(), "parameter write out of range");
+
+    const auto destination = std::span{parameter_data_}.subspan(offset, data.size());
+    if (std::ranges::equal(destination, data))
+    {
+        return;
+    }
+
+    std::ranges::copy(data, std::ranges::begin(destination));
+    parameters_dirty_ = true;
+}
+
 auto Material::native_handle() const -> ::GLuint
 {
     return handle_;
 }
+
+auto Material::footprint() const -> ResourceFootprint
+{
+    auto cpu_bytes = sizeof(Material) + parameter_data_.capacity();
+    for (const auto &[name, location] : uniforms_)
+    {
+        cpu_bytes += name.capacity() + sizeof(location);
+    }
+    for (const auto &[name, offset] : parameters_)
+    {
+        cpu_bytes += name.capacity() + sizeof(offset);
+    }
+
+    // the linked program binary is the best measure of driver memory we can get
+    auto binary_length = ::GLint{};
+    ::glGetProgramiv(handle_, GL_PROGRAM_BINARY_LENGTH, &binary_length);
+
+    const auto parameter_bytes = parameter_buffer_ ? parameter_buffer_->size() : 0u;
+
+    return {.cpu_bytes = cpu_bytes, .gpu_bytes = static_cast<std::size_t>(binary_length) + parameter_bytes};
+}
 }
@@ -1,18 +1,27 @@
 #pragma once
 
+#include <cstddef>
 #include <cstdint>
 #include <functional>
+#include <memory>
+#include <optional>
 #include <span>
 #include <string_view>
 #include <tuple>
+#include <type_traits>
+#include <vector>
 
+#include "graphics/buffer.h"
 #include "graphics/cube_map.h"
+#include "graphics/instance_data.h"
 #include "graphics/opengl.h"
 #include "graphics/sampler.h"
 #include "graphics/shader.h"
 #include "graphics/texture.h"
+#include "graphics/uniform.h"
 #include "maths/colour.h"
 #include "maths/matrix4.h"
+#include "resources/resource_footprint.h"
 #include "utils/auto_release.h"
 #include "utils/string_map.h"
 
@@ -23,11 +32,16 @@ class Entity;
 
 /**
  * Class representing a material. A material is a combination of a vertex and fragment shader. It also allows for
- * setting uniforms.
+ * setting uniforms, through handles resolved from their names once, and parameters, which live in a uniform block named
+ * "material" (bound to material_block_binding) that is only uploaded when it changes.
  *
  * The renderer will use this class to set various required uniforms (e.g. model matrix). If you want to set uniforms
  * yourself, you will need to use the callback. This is just a byproduct of the current design of the game. But the
  * renderer will invoke the callback for you with currently rendered entity after the material has been bound.
+ *
+ * Materials whose vertex shader reads the "instances" storage block are instanced, entities which share one and a mesh
+ * are drawn together. Such materials get their per entity values through the instance callback instead, which fills in
+ * the InstanceData of each entity.
  */
 class Material
 {
@@ -43,6 +57,18 @@ class Material
      */
     using UniformCallback = std::function<void(const Material *, const Entity *)>;
 
+    /**
+     * Type of the instance callback. This is invoked when an entity is queued for rendering, before any drawing.
+     *
+     * @param material
+     *   The material that is being rendered.
+     * @param entity
+     *   The entity that is being rendered.
+     * @param instance
+     *   The per instance data of the entity, the callback should fill in the parameters.
+     */
+    using InstanceCallback = std::function<void(const Material *, const Entity *, InstanceData &)>;
+
     /**
      * Construct a new Material object. It is undefined behaviour to pass any shader other than a vertex and fragment
      * (in that order).
@@ -61,48 +87,108 @@ class Material
     auto use() const -> void;
 
     /**
-     * Set a Matrix4 uniform in the shader. The uniform must be set after the material has been bound. It is undefined
-     * if the name doesn't exist in the shader.
+     * Resolve a uniform to a handle, which can then be set without looking the name up again. Handles should be
+     * resolved once (e.g. when a level starts) rather than every time the uniform is set.
      *
      * @param name
-     *   The name of the uniform to set.
+     *   The name of the uniform, must exist in the shader and be of type T.
+     *
+     * @returns
+     *   Handle to the uniform.
+     */
+    template <class T>
+    auto uniform(std::string_view name) const -> Uniform<T>
+    {
+        return Uniform<T>{uniform_location(name)};
+    }
+
+    /**
+     * Get the handle to the model matrix uniform, which the renderer sets for every entity.
+     *
+     * @returns
+     *   Handle to the "model" uniform, refers to no uniform if the shader does not have one.
+     */
+    auto model_uniform() const -> Uniform<Matrix4>;
+
+    /**
+     * Set a Matrix4 uniform in the shader, the material does not need to be bound.
+     *
+     * @param uniform
+     *   The uniform to set.
      * @param obj
      *   The object to set the uniform to.
      */
-    auto set_uniform(std::string_view name, const Matrix4 &obj) const -> void;
+    auto set_uniform(Uniform<Matrix4> uniform, const Matrix4 &obj) const -> void;
 
     /**
-     * Set a Colour uniform in the shader. The uniform must be set after the material has been bound. It is undefined if
-     * the name doesn't exist in the shader.
+     * Set a Colour uniform in the shader, the material does not need to be bound.
      *
-     * @param name
-     *   The name of the uniform to set.
+     * @param uniform
+     *   The uniform to set.
      * @param obj
      *   The object to set the uniform to.
      */
-    auto set_uniform(std::string_view name, const Colour &obj) const -> void;
+    auto set_uniform(Uniform<Colour> uniform, const Colour &obj) const -> void;
 
     /**
-     * Set an int uniform in the shader. The uniform must be set after the material has been bound. It is undefined if
-     * the name doesn't exist in the shader.
+     * Set an int uniform in the shader, the material does not need to be bound.
      *
-     * @param name
-     *   The name of the uniform to set.
+     * @param uniform
+     *   The uniform to set.
      * @param obj
      *   The object to set the uniform to.
      */
-    auto set_uniform(std::string_view name, int obj) const -> void;
+    auto set_uniform(Uniform<int> uniform, int obj) const -> void;
 
     /**
-     * Set a float uniform in the shader. The uniform must be set after the material has been bound. It is undefined if
-     * the name doesn't exist in the shader.
+     * Set a float uniform in the shader, the material does not need to be bound.
      *
-     * @param name
-     *   The name of the uniform to set.
+     * @param uniform
+     *   The uniform to set.
      * @param obj
      *   The object to set the uniform to.
      */
-    auto set_uniform(std::string_view name, float obj) const -> void;
+    auto set_uniform(Uniform<float> uniform, float obj) const -> void;
+
+    /**
+     * Resolve a member of the "material" uniform block to a handle.
+     *
+     * @param name
+     *   The name of the member, must exist in the block and have the same std140 layout as T.
+     *
+     * @returns
+     *   Handle to the parameter.
+     */
+    template <class T>
+        requires std::is_trivially_copyable_v<T>
+    auto parameter(std::string_view name) const -> MaterialParameter<T>
+    {
+        return MaterialParameter<T>{parameter_offset(name, sizeof(T))};
+    }
+
+    /**
+     * Set a member of the "material" uniform block. The block is only uploaded if a parameter actually changes, so
+     * parameters which rarely change cost nothing per frame.
+     *
+     * @param parameter
+     *   The parameter to set.
+     * @param obj
+     *   The object to set the parameter to.
+     */
+    template <class T>
+        requires std::is_trivially_copyable_v<T>
+    auto set_parameter(MaterialParameter<T> parameter, const T &obj) -> void
+    {
+        write_parameter(parameter.offset(), std::as_bytes(std::span{std::addressof(obj), 1u}));
+    }
+
+    /**
+     * Get the buffer holding the "material" uniform block, uploading any changed parameters first.
+     *
+     * @returns
+     *   Native OpenGL handle of the buffer, zero if the shader has no "material" block.
+     */
+    auto parameter_buffer() const -> ::GLuint;
 
     /**
      * Bind a CubeMap to tex0 in the shader
@@ -160,6 +246,34 @@ class Material
      */
     auto invoke_uniform_callback(const Entity *entity) const -> void;
 
+    /**
+     * Check whether the material is instanced, i.e. its shader reads the model matrix and parameters of each entity
+     * from the "instances" storage block rather than uniforms.
+     *
+     * @returns
+     *   True if the material is instanced, otherwise false.
+     */
+    auto instanced() const -> bool;
+
+    /**
+     * Set a callback that will be invoked for each entity using the material when it is queued for rendering.
+     *
+     * @param instance_callback
+     *   The callback to set.
+     */
+    auto set_instance_callback(InstanceCallback instance_callback) -> void;
+
+    /**
+     * Invoke the instance callback for an entity. This is used to set per instance values that are specific to the
+     * entity.
+     *
+     * @param entity
+     *   The entity to invoke the callback for.
+     * @param instance
+     *   The per instance data of the entity.
+     */
+    auto invoke_instance_callback(const Entity *entity, InstanceData &instance) const -> void;
+
     /**
      * Get the native OpenGL handle for the material.
      *
@@ -168,15 +282,78 @@ class Material
      */
     auto native_handle() const -> ::GLuint;
 
+    /**
+     * Get the memory used by the material.
+     *
+     * @returns
+     *   The footprint of the material.
+     */
+    auto footprint() const -> ResourceFootprint;
+
   private:
+    /**
+     * Look up the location of a uniform.
+     *
+     * @param name
+     *   The name of the uniform, must exist in the shader.
+     *
+     * @returns
+     *   Location of the uniform.
+     */
+    auto uniform_location(std::string_view name) const -> ::GLint;
+
+    /**
+     * Look up the offset of a member of the "material" block.
+     *
+     * @param name
+     *   The name of the member, must exist in the block.
+     * @param size
+     *   Size of the member in bytes, must fit in the block.
+     *
+     * @returns
+     *   Offset of the member in bytes.
+     */
+    auto parameter_offset(std::string_view name, std::size_t size) const -> std::uint32_t;
+
+    /**
+     * Write to the CPU copy of the "material" block, marking it as needing an upload if anything changed.
+     *
+     * @param offset
+     *   Offset to write at.
+     * @param data
+     *   Data to write.
+     */
+    auto write_parameter(std::uint32_t offset, std::span<const std::byte> data) -> void;
+
     /** OpenGL program handle. */
     AutoRelease<::GLuint> handle_;
 
     /** Collection of uniforms in the shader. */
-    StringMap<::GLuint> uniforms_;
+    StringMap<::GLint> uniforms_;
+
+    /** The model matrix uniform. */
+    Uniform<Matrix4> model_uniform_;
+
+    /** Offsets of the members of the "material" block. */
+    StringMap<std::uint32_t> parameters_;
+
+    /** CPU copy of the "material" block. */
+    std::vector<std::byte> parameter_data_;
+
+    /** GPU copy of the "material" block, if the shader has one. */
+    std::optional<Buffer> parameter_buffer_;
+
+    /** Whether the CPU copy has changed since it was last uploaded. */
+    mutable bool parameters_dirty_;
+
+    /** Whether the shader has an "instances" storage block. */
+    bool instanced_;
 
     /** Optional uniform callback. */
     UniformCallback uniform_callback_;
+
+    /** Optional instance callback. */
+    InstanceCallback instance_callback_;
 };
 
 }
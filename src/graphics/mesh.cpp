@@ -1,67 +1,304 @@
 #include "graphics/mesh.h"
 
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <limits>
 #include <ranges>
+#include <span>
+#include <tuple>
 
 #include "buffer_writer.h"
 #include "graphics/buffer.h"
+#include "graphics/mesh_data.h"
 #include "graphics/opengl.h"
 #include "graphics/vertex_data.h"
+#include "graphics/vertex_layout.h"
+#include "maths/aabb.h"
+#include "maths/matrix4.h"
+#include "maths/vector3.h"
+#include "resources/resource_footprint.h"
+#include "tlv/tlv_archive.h"
+#include "tlv/tlv_compression.h"
+#include "tlv/tlv_entry.h"
 #include "tlv/tlv_reader.h"
 #include "utils/auto_release.h"
 #include "utils/error.h"
+#include "utils/exception.h"
+
+namespace
+{
+
+/**
+ * Convert an index type to the OpenGL type.
+ *
+ * @param index_type
+ *   The index type.
+ *
+ * @returns
+ *   The OpenGL type.
+ */
+auto to_opengl(game::IndexType index_type) -> ::GLenum
+{
+    switch (index_type)
+    {
+        using enum game::IndexType;
+        case UINT16: return GL_UNSIGNED_SHORT;
+        case UINT32: return GL_UNSIGNED_INT;
+    }
+
+    throw game::Exception("unknown index type");
+}
+
+/**
+ * Convert a vertex attribute type to the OpenGL type and whether it is normalised.
+ *
+ * @param type
+ *   The attribute type.
+ *
+ * @returns
+ *   Tuple of OpenGL type and normalised flag.
+ */
+auto to_opengl(game::VertexAttributeType type) -> std::tuple<::GLenum, ::GLboolean>
+{
+    switch (type)
+    {
+        using enum game::VertexAttributeType;
+        case FLOAT: return {GL_FLOAT, GL_FALSE};
+        case HALF_FLOAT: return {GL_HALF_FLOAT, GL_FALSE};
+        case UNORM16: return {GL_UNSIGNED_SHORT, GL_TRUE};
+        case SNORM16: return {GL_SHORT, GL_TRUE};
+    }
+
+    throw game::Exception("unknown vertex attribute type");
+}
+
+/**
+ * Convert a half precision float to a float.
+ *
+ * @param bits
+ *   The bits of the half.
+ *
+ * @returns
+ *   The value as a float.
+ */
+auto half_to_float(std::uint16_t bits) -> float
+{
+    const auto sign = (bits & 0x8000u) != 0u ? -1.0f : 1.0f;
+    const auto exponent = (bits >> 10u) & 0x1fu;
+    const auto mantissa = static_cast<float>(bits & 0x3ffu);
+
+    if (exponent == 0u)
+    {
+        return sign * std::ldexp(mantissa, -24);
+    }
+
+    if (exponent == 0x1fu)
+    {
+        return sign * std::numeric_limits<float>::infinity();
+    }
+
+    return sign * std::ldexp(mantissa + 1024.0f, static_cast<int>(exponent) - 25);
+}
+
+/**
+ * Read a single component of a vertex attribute, as the vertex shader would see it.
+ *
+ * @param data
+ *   Pointer to the component, need not be aligned.
+ * @param type
+ *   The attribute type.
+ *
+ * @returns
+ *   The component.
+ */
+auto read_component(const std::byte *data, game::VertexAttributeType type) -> float
+{
+    switch (type)
+    {
+        using enum game::VertexAttributeType;
+        case FLOAT:
+        {
+            auto value = float{};
+            std::memcpy(&value, data, sizeof(value));
+            return value;
+        }
+        case HALF_FLOAT:
+        {
+            auto value = std::uint16_t{};
+            std::memcpy(&value, data, sizeof(value));
+            return half_to_float(value);
+        }
+        case UNORM16:
+        {
+            auto value = std::uint16_t{};
+            std::memcpy(&value, data, sizeof(value));
+            return static_cast<float>(value) / 65535.0f;
+        }
+        case SNORM16:
+        {
+            auto value = std::int16_t{};
+            std::memcpy(&value, data, sizeof(value));
+            return std::max(static_cast<float>(value) / 32767.0f, -1.0f);
+        }
+    }
+
+    throw game::Exception("unknown vertex attribute type");
+}
+
+/**
+ * Calculate the bounds of the (possibly quantised) vertex positions, i.e. the attribute at location 0.
+ *
+ * @param data
+ *   The mesh data.
+ *
+ * @returns
+ *   The bounds, before dequantisation. An empty box at the origin if there are no positions.
+ */
+auto position_bounds(const game::PackedMeshData &data) -> game::AABB
+{
+    const auto position = std::ranges::find(data.layout.attributes, 0u, &game::VertexAttribute::location);
+    if ((position == std::ranges::cend(data.layout.attributes)) || (data.layout.stride == 0u) ||
+        (data.vertices.size() < data.layout.stride))
+    {
+        return {};
+    }
+
+    const auto components = std::min(position->components, 3u);
+    const auto size = game::component_size(position->type);
+
+    auto min = std::array<float, 3u>{};
+    auto max = std::array<float, 3u>{};
+    min.fill(std::numeric_limits<float>::max());
+    max.fill(std::numeric_limits<float>::lowest());
+
+    // any missing components are zero, as they would be in the shader
+    for (auto i = components; i < 3u; ++i)
+    {
+        min[i] = 0.0f;
+        max[i] = 0.0f;
+    }
+
+    for (auto vertex = std::size_t{}; vertex + data.layout.stride <= data.vertices.size();
+         vertex += data.layout.stride)
+    {
+        const auto *attribute = data.vertices.data() + vertex + position->offset;
+
+        for (auto i = 0u; i < components; ++i)
+        {
+            const auto value = read_component(attribute + i * size, position->type);
+            min[i] = std::min(min[i], value);
+            max[i] = std::max(max[i], value);
+        }
+    }
+
+    return {.min = {min[0], min[1], min[2]}, .max = {max[0], max[1], max[2]}};
+}
+
+}
 
 namespace game
 {
 
 Mesh::Mesh(const MeshData &data)
+    : Mesh(PackedMeshData{
+          .layout = float_vertex_layout(),
+          .vertices = std::as_bytes(data.vertices),
+          .indices = std::as_bytes(data.indices)})
+{
+}
+
+Mesh::Mesh(const PackedMeshData &data)
     : vao_{0u, [](auto vao) { ::glDeleteVertexArrays(1, &vao); }}
-    , vbo_{static_cast<uint32_t>(data.vertices.size_bytes() + data.indices.size_bytes())}
-    , index_count_(static_cast<std::uint32_t>(data.indices.size()))
-    , index_offset_(data.vertices.size_bytes())
+    , vbo_{static_cast<uint32_t>(data.vertices.size() + data.indices.size())}
+    , index_count_(static_cast<std::uint32_t>(data.indices.size() / index_size(data.layout.index_type)))
+    , index_offset_(data.vertices.size())
+    , index_type_(to_opengl(data.layout.index_type))
+    , dequantisation_(data.layout.position_offset, data.layout.position_scale)
+    , bounds_(transform(position_bounds(data), dequantisation_))
 {
-    // write the vertex data and then the index data to the buffer
+    // write the vertex data and then the index data to the buffer, the vertex data is always a multiple of the stride
+    // which keeps the indices aligned
     BufferWriter writer{vbo_};
     writer.write(data.vertices);
     writer.write(data.indices);
 
     ::glCreateVertexArrays(1, &vao_);
-    ::glVertexArrayVertexBuffer(vao_, 0, vbo_.native_handle(), 0, sizeof(VertexData));
+    ::glVertexArrayVertexBuffer(vao_, 0, vbo_.native_handle(), 0, data.layout.stride);
     ::glVertexArrayElementBuffer(vao_, vbo_.native_handle());
 
-    // hard coded vertex layout
+    for (const auto &attribute : data.layout.attributes)
+    {
+        const auto [type, normalised] = to_opengl(attribute.type);
 
-    ::glEnableVertexArrayAttrib(vao_, 0);
-    ::glEnableVertexArrayAttrib(vao_, 1);
-    ::glEnableVertexArrayAttrib(vao_, 2);
-    ::glEnableVertexArrayAttrib(vao_, 3);
-
-    ::glVertexArrayAttribFormat(vao_, 0, 3, GL_FLOAT, GL_FALSE, offsetof(VertexData, position));
-    ::glVertexArrayAttribFormat(vao_, 1, 3, GL_FLOAT, GL_FALSE, offsetof(VertexData, normal));
-    ::glVertexArrayAttribFormat(vao_, 2, 3, GL_FLOAT, GL_FALSE, offsetof(VertexData, tangent));
-    ::glVertexArrayAttribFormat(vao_, 3, 2, GL_FLOAT, GL_FALSE, offsetof(VertexData, uv));
-
-    ::glVertexArrayAttribBinding(vao_, 0, 0);
-    ::glVertexArrayAttribBinding(vao_, 1, 0);
-    ::glVertexArrayAttribBinding(vao_, 2, 0);
-    ::glVertexArrayAttribBinding(vao_, 3, 0);
+        ::glEnableVertexArrayAttrib(vao_, attribute.location);
+        ::glVertexArrayAttribFormat(vao_, attribute.location, attribute.components, type, normalised, attribute.offset);
+        ::glVertexArrayAttribBinding(vao_, attribute.location, 0);
+    }
 }
 
-Mesh::Mesh(const TLVReader &reader, std::string_view name)
+Mesh::Mesh(const TLVArchive &archive, std::string_view name)
     : vao_{0u, [](auto vao) { ::glDeleteVertexArrays(1, &vao); }}
     , vbo_{1u}
     , index_count_{}
     , index_offset_{}
+    , index_type_{}
+    , dequantisation_{}
+    , bounds_{}
 {
-    auto mesh_data = std::ranges::find_if(reader, [name](const auto &e) { return e.is_mesh(name); });
-    ensure(mesh_data != std::ranges::end(reader), "could not find mesh");
-
     // bit of a hack but we can use the other constructor to do all the opengl setup and the just "steal" its members
-    auto mesh = Mesh{(*mesh_data).mesh_value()};
+    auto mesh = [&]
+    {
+        // the packer writes one or the other depending on the vertex format it was asked for
+        if (const auto packed_mesh_data = archive.find(name, TLVType::PACKED_MESH_DATA); packed_mesh_data)
+        {
+            if (packed_mesh_data->is_compressed())
+            {
+                auto staging = TLVStagingBuffer{*packed_mesh_data};
+                staging.decompress();
+
+                return Mesh{staging.entry().packed_mesh_value()};
+            }
+
+            return Mesh{packed_mesh_data->packed_mesh_value()};
+        }
+
+        const auto mesh_data = archive.find(name, TLVType::MESH_DATA);
+        ensure(mesh_data.has_value(), "could not find mesh {}", name);
+
+        // a compressed mesh is decompressed into a staging copy, which is aligned regardless of the archive
+        if (mesh_data->is_compressed())
+        {
+            auto staging = TLVStagingBuffer{*mesh_data};
+            staging.decompress();
+
+            return Mesh{staging.entry().mesh_value()};
+        }
+
+        if (archive.alignment() >= alignof(VertexData))
+        {
+            return Mesh{mesh_data->mesh_value()};
+        }
+
+        // older archives make no alignment guarantee so the arrays cannot be viewed in place, copy them out instead
+        const auto members = mesh_data->members();
+        auto cursor = std::ranges::next(std::ranges::begin(members));
+        const auto vertices = (*cursor).vertex_data_array_value();
+        const auto indices = (*++cursor).uint32_array_value();
+
+        return Mesh{MeshData{vertices, indices}};
+    }();
 
     std::ranges::swap(vao_, mesh.vao_);
     std::ranges::swap(vbo_, mesh.vbo_);
     std::ranges::swap(index_count_, mesh.index_count_);
     std::ranges::swap(index_offset_, mesh.index_offset_);
+    std::ranges::swap(index_type_, mesh.index_type_);
+    std::ranges::swap(dequantisation_, mesh.dequantisation_);
+    std::ranges::swap(bounds_, mesh.bounds_);
 }
 
 auto Mesh::bind() const -> void
@@ -84,4 +321,29 @@ auto Mesh::index_offset() const -> std::uintptr_t
     return index_offset_;
 }
 
+auto Mesh::index_type() const -> ::GLenum
+{
+    return index_type_;
+}
+
+auto Mesh::dequantisation() const -> const Matrix4 &
+{
+    return dequantisation_;
+}
+
+auto Mesh::bounds() const -> const AABB &
+{
+    return bounds_;
+}
+
+auto Mesh::footprint() const -> ResourceFootprint
+{
+    return {.cpu_bytes = sizeof(Mesh), .gpu_bytes = vbo_.size()};
+}
+
+auto Mesh::native_handle() const -> ::GLuint
+{
+    return vao_;
+}
+
 }
@@ -6,18 +6,25 @@
 #include "graphics/buffer.h"
 #include "graphics/mesh_data.h"
 #include "graphics/opengl.h"
+#include "graphics/vertex_layout.h"
+#include "maths/aabb.h"
+#include "maths/matrix4.h"
+#include "resources/resource_footprint.h"
 #include "utils/auto_release.h"
 
 namespace game
 {
 
-class TLVReader;
+class TLVArchive;
 
 /**
  * This class encapsulates the GPU buffer for a renderable mesh.
  *
  * Internally the data is stored on the GPU as a collection of unique vertices and the indices that reference them. The
  * index data is stored in the same GPU buffer as the vertex data.
+ *
+ * The vertex format is described by a VertexLayout, so meshes can be stored either as VertexData or in a packed
+ * (quantised) format. Packed positions must be mapped back to model space with dequantisation().
  */
 class Mesh
 {
@@ -31,14 +38,22 @@ class Mesh
     Mesh(const MeshData &data);
 
     /**
-     * Construct a new Mesh object from a TLVReader.
+     * Construct a new Mesh object from data in an arbitrary vertex format.
      *
-     * @param reader
-     *   The TLVReader to use.
+     * @param data
+     *   The packed mesh data to use.
+     */
+    Mesh(const PackedMeshData &data);
+
+    /**
+     * Construct a new Mesh object from a TLVArchive.
+     *
+     * @param archive
+     *   The TLVArchive to use.
      * @param name
      *   The name of the mesh in the tlv.
      */
-    Mesh(const TLVReader &reader, std::string_view name);
+    Mesh(const TLVArchive &archive, std::string_view name);
 
     /**
      * Bind the mesh for rendering.
@@ -66,6 +81,47 @@ class Mesh
      */
     auto index_offset() const -> std::uintptr_t;
 
+    /**
+     * Get the OpenGL type of the indices, for passing to draw calls.
+     *
+     * @returns
+     *  The index type.
+     */
+    auto index_type() const -> ::GLenum;
+
+    /**
+     * Get the transform from the (possibly quantised) vertex positions to model space. This should be applied before
+     * the model matrix, it is the identity for unpacked meshes.
+     *
+     * @returns
+     *   The dequantisation transform.
+     */
+    auto dequantisation() const -> const Matrix4 &;
+
+    /**
+     * Get the bounds of the vertex positions in model space (i.e. with dequantisation() already applied).
+     *
+     * @returns
+     *   The bounds of the mesh.
+     */
+    auto bounds() const -> const AABB &;
+
+    /**
+     * Get the memory used by the mesh.
+     *
+     * @returns
+     *   The footprint of the mesh.
+     */
+    auto footprint() const -> ResourceFootprint;
+
+    /**
+     * Get the native OpenGL vertex array handle.
+     *
+     * @returns
+     *   The native OpenGL vertex array handle.
+     */
+    auto native_handle() const -> ::GLuint;
+
   private:
     /** OpenGL vertex array object handle. */
     AutoRelease<::GLuint> vao_;
@@ -78,6 +134,15 @@ class Mesh
 
     /** Offset of the index data into the underlying GPU buffer. */
     std::uintptr_t index_offset_;
+
+    /** OpenGL type of the indices. */
+    ::GLenum index_type_;
+
+    /** Transform from vertex positions to model space. */
+    Matrix4 dequantisation_;
+
+    /** Bounds of the vertex positions in model space. */
+    AABB bounds_;
 };
 
 }
@@ -1,9 +1,11 @@
 #pragma once
 
+#include <cstddef>
 #include <cstdint>
 #include <span>
 
 #include "graphics/vertex_data.h"
+#include "graphics/vertex_layout.h"
 
 namespace game
 {
@@ -13,4 +15,20 @@ struct MeshData
     std::span<const std::uint32_t> indices;
 };
 
+/**
+ * Mesh data in an arbitrary (usually quantised) vertex format. The vertex and index data are views into some other
+ * buffer which must outlive this object.
+ */
+struct PackedMeshData
+{
+    /** Layout of the vertex and index data. */
+    VertexLayout layout;
+
+    /** Interleaved vertex data, layout.stride bytes per vertex. */
+    std::span<const std::byte> vertices;
+
+    /** Index data, the size of each index is given by layout.index_type. */
+    std::span<const std::byte> indices;
+};
+
 }
@@ -33,6 +33,14 @@
     DO(::PFNGLUNIFORM3FVPROC, glUniform3fv)                                                                            \
     DO(::PFNGLUNIFORM1IPROC, glUniform1i)                                                                              \
     DO(::PFNGLUNIFORM1FPROC, glUniform1f)                                                                              \
+    DO(::PFNGLPROGRAMUNIFORM1IPROC, glProgramUniform1i)                                                                \
+    DO(::PFNGLPROGRAMUNIFORM1FPROC, glProgramUniform1f)                                                                \
+    DO(::PFNGLPROGRAMUNIFORM3FVPROC, glProgramUniform3fv)                                                              \
+    DO(::PFNGLPROGRAMUNIFORMMATRIX4FVPROC, glProgramUniformMatrix4fv)                                                  \
+    DO(::PFNGLGETUNIFORMBLOCKINDEXPROC, glGetUniformBlockIndex)                                                        \
+    DO(::PFNGLGETACTIVEUNIFORMBLOCKIVPROC, glGetActiveUniformBlockiv)                                                  \
+    DO(::PFNGLGETACTIVEUNIFORMSIVPROC, glGetActiveUniformsiv)                                                          \
+    DO(::PFNGLGETPROGRAMRESOURCEINDEXPROC, glGetProgramResourceIndex)                                                  \
     DO(::PFNGLCREATEBUFFERSPROC, glCreateBuffers)                                                                      \
     DO(::PFNGLNAMEDBUFFERSTORAGEPROC, glNamedBufferStorage)                                                            \
     DO(::PFNGLCREATEVERTEXARRAYSPROC, glCreateVertexArrays)                                                            \
@@ -47,6 +55,8 @@
     DO(::PFNGLTEXTURESTORAGE2DPROC, glTextureStorage2D)                                                                \
     DO(::PFNGLTEXTURESUBIMAGE2DPROC, glTextureSubImage2D)                                                              \
     DO(::PFNGLTEXTURESUBIMAGE3DPROC, glTextureSubImage3D)                                                              \
+    DO(::PFNGLCOMPRESSEDTEXTURESUBIMAGE2DPROC, glCompressedTextureSubImage2D)                                          \
+    DO(::PFNGLCOMPRESSEDTEXTURESUBIMAGE3DPROC, glCompressedTextureSubImage3D)                                          \
     DO(::PFNGLCREATESAMPLERSPROC, glCreateSamplers)                                                                    \
     DO(::PFNGLDELETESAMPLERSPROC, glDeleteSamplers)                                                                    \
     DO(::PFNGLBINDTEXTUREUNITPROC, glBindTextureUnit)                                                                  \
@@ -59,6 +69,7 @@
     DO(::PFNGLBINDFRAMEBUFFERPROC, glBindFramebuffer)                                                                  \
     DO(::PFNGLNAMEDFRAMEBUFFERTEXTUREPROC, glNamedFramebufferTexture)                                                  \
     DO(::PFNGLBLITNAMEDFRAMEBUFFERPROC, glBlitNamedFramebuffer)                                                        \
+    DO(::PFNGLDRAWELEMENTSINSTANCEDBASEINSTANCEPROC, glDrawElementsInstancedBaseInstance)                              \
     DO(::PFNGLDRAWARRAYSEXTPROC, glDrawArraysEXT)
 
 // expand x-macro to define function pointers
@@ -0,0 +1,120 @@
+#include "graphics/render_backend.h"
+
+#include <cstdint>
+#include <span>
+#include <vector>
+
+#include "graphics/opengl.h"
+
+namespace game
+{
+
+auto OpenGLRenderBackend::use_program(::GLuint program) -> void
+{
+    ::glUseProgram(program);
+}
+
+auto OpenGLRenderBackend::bind_vertex_array(::GLuint vertex_array) -> void
+{
+    ::glBindVertexArray(vertex_array);
+}
+
+auto OpenGLRenderBackend::bind_texture(std::uint32_t unit, ::GLuint texture) -> void
+{
+    ::glBindTextureUnit(unit, texture);
+}
+
+auto OpenGLRenderBackend::bind_sampler(std::uint32_t unit, ::GLuint sampler) -> void
+{
+    ::glBindSampler(unit, sampler);
+}
+
+auto OpenGLRenderBackend::bind_uniform_buffer(std::uint32_t index, ::GLuint buffer) -> void
+{
+    ::glBindBufferBase(GL_UNIFORM_BUFFER, index, buffer);
+}
+
+auto OpenGLRenderBackend::draw_elements(std::uint32_t index_count, ::GLenum index_type, std::uintptr_t index_offset)
+    -> void
+{
+    ::glDrawElements(GL_TRIANGLES, index_count, index_type, reinterpret_cast<void *>(index_offset));
+}
+
+auto OpenGLRenderBackend::draw_elements_instanced(
+    std::uint32_t index_count,
+    ::GLenum index_type,
+    std::uintptr_t index_offset,
+    std::uint32_t instance_count,
+    std::uint32_t base_instance) -> void
+{
+    ::glDrawElementsInstancedBaseInstance(
+        GL_TRIANGLES,
+        index_count,
+        index_type,
+        reinterpret_cast<void *>(index_offset),
+        instance_count,
+        base_instance);
+}
+
+auto RecordingRenderBackend::use_program(::GLuint program) -> void
+{
+    commands_.push_back({.type = RenderCommandType::USE_PROGRAM, .handle = program});
+}
+
+auto RecordingRenderBackend::bind_vertex_array(::GLuint vertex_array) -> void
+{
+    commands_.push_back({.type = RenderCommandType::BIND_VERTEX_ARRAY, .handle = vertex_array});
+}
+
+auto RecordingRenderBackend::bind_texture(std::uint32_t unit, ::GLuint texture) -> void
+{
+    commands_.push_back({.type = RenderCommandType::BIND_TEXTURE, .unit = unit, .handle = texture});
+}
+
+auto RecordingRenderBackend::bind_sampler(std::uint32_t unit, ::GLuint sampler) -> void
+{
+    commands_.push_back({.type = RenderCommandType::BIND_SAMPLER, .unit = unit, .handle = sampler});
+}
+
+auto RecordingRenderBackend::bind_uniform_buffer(std::uint32_t index, ::GLuint buffer) -> void
+{
+    commands_.push_back({.type = RenderCommandType::BIND_UNIFORM_BUFFER, .unit = index, .handle = buffer});
+}
+
+auto RecordingRenderBackend::draw_elements(std::uint32_t index_count, ::GLenum index_type, std::uintptr_t index_offset)
+    -> void
+{
+    commands_.push_back(
+        {.type = RenderCommandType::DRAW_ELEMENTS,
+         .index_count = index_count,
+         .index_type = index_type,
+         .index_offset = index_offset});
+}
+
+auto RecordingRenderBackend::draw_elements_instanced(
+    std::uint32_t index_count,
+    ::GLenum index_type,
+    std::uintptr_t index_offset,
+    std::uint32_t instance_count,
+    std::uint32_t base_instance) -> void
+{
+    commands_.push_back(
+        {.type = RenderCommandType::DRAW_ELEMENTS_INSTANCED,
+         .index_count = index_count,
+         .index_type = index_type,
+         .index_offset = index_offset,
+         .instance_count = instance_count,
+         .base_instance = base_instance});
+}
+
+auto RecordingRenderBackend::commands() const -> std::span<const RenderCommand>
+{
+    return commands_;
+}
+
+auto RecordingRenderBackend::clear() -> void
+{
+    commands_.clear();
+}
+
+}
@@ -0,0 +1,216 @@
+#pragma once
+
+#include <cstdint>
+#include <span>
+#include <vector>
+
+#include "graphics/opengl.h"
+
+namespace game
+{
+
+/**
+ * Interface for the OpenGL calls made when submitting draws. Drawing through this rather than calling OpenGL directly
+ * means the order and number of state changes can be checked without a GPU.
+ */
+class RenderBackend
+{
+  public:
+    virtual ~RenderBackend() = default;
+
+    /**
+     * Make a program current.
+     *
+     * @param program
+     *   Handle of the program.
+     */
+    virtual auto use_program(::GLuint program) -> void = 0;
+
+    /**
+     * Bind a vertex array.
+     *
+     * @param vertex_array
+     *   Handle of the vertex array.
+     */
+    virtual auto bind_vertex_array(::GLuint vertex_array) -> void = 0;
+
+    /**
+     * Bind a texture to a texture unit.
+     *
+     * @param unit
+     *   The texture unit.
+     * @param texture
+     *   Handle of the texture.
+     */
+    virtual auto bind_texture(std::uint32_t unit, ::GLuint texture) -> void = 0;
+
+    /**
+     * Bind a sampler to a texture unit.
+     *
+     * @param unit
+     *   The texture unit.
+     * @param sampler
+     *   Handle of the sampler.
+     */
+    virtual auto bind_sampler(std::uint32_t unit, ::GLuint sampler) -> void = 0;
+
+    /**
+     * Bind a buffer to a uniform block binding point.
+     *
+     * @param index
+     *   The binding point.
+     * @param buffer
+     *   Handle of the buffer.
+     */
+    virtual auto bind_uniform_buffer(std::uint32_t index, ::GLuint buffer) -> void = 0;
+
+    /**
+     * Draw indexed triangles with the current state.
+     *
+     * @param index_count
+     *   Number of indices to draw.
+     * @param index_type
+     *   Type of the indices.
+     * @param index_offset
+     *   Offset of the first index in the element buffer.
+     */
+    virtual auto draw_elements(std::uint32_t index_count, ::GLenum index_type, std::uintptr_t index_offset) -> void = 0;
+
+    /**
+     * Draw several instances of indexed triangles with the current state.
+     *
+     * @param index_count
+     *   Number of indices to draw.
+     * @param index_type
+     *   Type of the indices.
+     * @param index_offset
+     *   Offset of the first index in the element buffer.
+     * @param instance_count
+     *   Number of instances to draw.
+     * @param base_instance
+     *   Index of the first instance, available to shaders as gl_BaseInstance.
+     */
+    virtual auto draw_elements_instanced(
+        std::uint32_t index_count,
+        ::GLenum index_type,
+        std::uintptr_t index_offset,
+        std::uint32_t instance_count,
+        std::uint32_t base_instance) -> void = 0;
+};
+
+/**
+ * Backend which makes the OpenGL calls.
+ */
+class OpenGLRenderBackend final : public RenderBackend
+{
+  public:
+    auto use_program(::GLuint program) -> void override;
+
+    auto bind_vertex_array(::GLuint vertex_array) -> void override;
+
+    auto bind_texture(std::uint32_t unit, ::GLuint texture) -> void override;
+
+    auto bind_sampler(std::uint32_t unit, ::GLuint sampler) -> void override;
+
+    auto bind_uniform_buffer(std::uint32_t index, ::GLuint buffer) -> void override;
+
+    auto draw_elements(std::uint32_t index_count, ::GLenum index_type, std::uintptr_t index_offset) -> void override;
+
+    auto draw_elements_instanced(
+        std::uint32_t index_count,
+        ::GLenum index_type,
+        std::uintptr_t index_offset,
+        std::uint32_t instance_count,
+        std::uint32_t base_instance) -> void override;
+};
+
+/**
+ * Enumeration of the calls a backend can be asked to make.
+ */
+enum class RenderCommandType
+{
+    USE_PROGRAM,
+    BIND_VERTEX_ARRAY,
+    BIND_TEXTURE,
+    BIND_SAMPLER,
+    BIND_UNIFORM_BUFFER,
+    DRAW_ELEMENTS,
+    DRAW_ELEMENTS_INSTANCED,
+};
+
+/**
+ * A call recorded by RecordingRenderBackend. Only the members relevant to the type are set, the rest are zero.
+ */
+struct RenderCommand
+{
+    /** The call. */
+    RenderCommandType type;
+
+    /** Texture unit or binding point, for texture, sampler and uniform buffer binds. */
+    std::uint32_t unit;
+
+    /** Handle of the program, vertex array, texture, sampler or buffer. */
+    ::GLuint handle;
+
+    /** Number of indices, for draws. */
+    std::uint32_t index_count;
+
+    /** Type of the indices, for draws. */
+    ::GLenum index_type;
+
+    /** Offset of the first index, for draws. */
+    std::uintptr_t index_offset;
+
+    /** Number of instances, for instanced draws. */
+    std::uint32_t instance_count;
+
+    /** Index of the first instance, for instanced draws. */
+    std::uint32_t base_instance;
+
+    auto operator==(const RenderCommand &) const -> bool = default;
+};
+
+/**
+ * Backend which records the calls rather than making them, for testing and debugging.
+ */
+class RecordingRenderBackend final : public RenderBackend
+{
+  public:
+    auto use_program(::GLuint program) -> void override;
+
+    auto bind_vertex_array(::GLuint vertex_array) -> void override;
+
+    auto bind_texture(std::uint32_t unit, ::GLuint texture) -> void override;
+
+    auto bind_sampler(std::uint32_t unit, ::GLuint sampler) -> void override;
+
+    auto bind_uniform_buffer(std::uint32_t index, ::GLuint buffer) -> void override;
+
+    auto draw_elements(std::uint32_t index_count, ::GLenum index_type, std::uintptr_t index_offset) -> void override;
+
+    auto draw_elements_instanced(
+        std::uint32_t index_count,
+        ::GLenum index_type,
+        std::uintptr_t index_offset,
+        std::uint32_t instance_count,
+        std::uint32_t base_instance) -> void override;
+
+    /**
+     * Get the recorded calls.
+     *
+     * @returns
+     *   The calls, in the order they were made.
+     */
+    auto commands() const -> std::span<const RenderCommand>;
+
+    /**
+     * Forget the recorded calls.
+     */
+    auto clear() -> void;
+
+  private:
+    /** The recorded calls. */
+    std::vector<RenderCommand> commands_;
+};
+
+}
@@ -0,0 +1,261 @@
+#include "graphics/render_queue.h"
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <ranges>
+#include <span>
+#include <utility>
+#include <vector>
+
+#include "graphics/instance_data.h"
+#include "graphics/opengl.h"
+#include "graphics/state_cache.h"
+#include "graphics/uniform.h"
+#include "utils/error.h"
+
+namespace
+{
+
+/** Number of bits sorted by each radix sort pass. */
+constexpr auto radix_bits = 8u;
+
+/** Number of buckets in each radix sort pass. */
+constexpr auto radix_size = 1u << radix_bits;
+
+/** Number of radix sort passes needed to sort a whole key. */
+constexpr auto radix_passes = 64u / radix_bits;
+
+/**
+ * Quantise a normalised depth to 16 bits.
+ *
+ * @param depth
+ *   The depth, clamped to [0, 1].
+ *
+ * @returns
+ *   The quantised depth.
+ */
+auto quantise_depth(float depth) -> std::uint64_t
+{
+    return static_cast<std::uint64_t>(std::clamp(depth, 0.0f, 1.0f) * 65535.0f + 0.5f);
+}
+
+/**
+ * Hash a set of textures to 16 bits, so identical sets sort next to each other.
+ *
+ * @param textures
+ *   The textures.
+ *
+ * @returns
+ *   The hash.
+ */
+auto hash_textures(std::span<const game::TextureBinding> textures) -> std::uint64_t
+{
+    // fnv-1a over the handles
+    auto hash = 2166136261u;
+    for (const auto &[texture, sampler] : textures)
+    {
+        hash = (hash ^ texture) * 16777619u;
+        hash = (hash ^ sampler) * 16777619u;
+    }
+
+    return (hash >> 16u) ^ (hash & 0xffffu);
+}
+
+}
+
+namespace game
+{
+
+auto make_sort_key(
+    RenderPass pass,
+    ::GLuint program,
+    std::span<const TextureBinding> textures,
+    ::GLuint vertex_array,
+    float depth) -> std::uint64_t
+{
+    // 14 bits of program, 16 of textures and 16 of vertex array
+    const auto state = (std::uint64_t{program & 0x3fffu} << 32u) | (hash_textures(textures) << 16u) |
+                       std::uint64_t{vertex_array & 0xffffu};
+    const auto quantised_depth = quantise_depth(depth);
+
+    switch (pass)
+    {
+        using enum RenderPass;
+
+        case SOLID: return (std::uint64_t{0u} << 62u) | (state << 16u) | quantised_depth;
+        case BLENDED: return (std::uint64_t{1u} << 62u) | ((0xffffu - quantised_depth) << 46u) | state;
+        default: throw Exception("unknown render pass: {}", std::to_underlying(pass));
+    }
+}
+
+RenderQueue::RenderQueue()
+    : draws_{}
+    , textures_{}
+    , instances_{}
+    , ordered_instances_{}
+    , entries_{}
+    , scratch_{}
+{
+}
+
+auto RenderQueue::clear() -> void
+{
+    draws_.clear();
+    textures_.clear();
+    instances_.clear();
+    ordered_instances_.clear();
+    entries_.clear();
+}
+
+auto RenderQueue::push(
+    const DrawCall &draw_call,
+    std::span<const TextureBinding> textures,
+    const InstanceData &instance) -> void
+{
+    entries_.push_back(
+        {.key = make_sort_key(draw_call.pass, draw_call.program, textures, draw_call.vertex_array, draw_call.depth),
+         .index = static_cast<std::uint32_t>(draws_.size())});
+
+    draws_.push_back(
+        {.draw_call = draw_call,
+         .first_texture = static_cast<std::uint32_t>(textures_.size()),
+         .texture_count = static_cast<std::uint32_t>(textures.size())});
+
+    textures_.insert(std::ranges::cend(textures_), std::ranges::cbegin(textures), std::ranges::cend(textures));
+
+    instances_.push_back(instance);
+    ordered_instances_.push_back(instance);
+}
+
+auto RenderQueue::sort() -> void
+{
+    // least significant digit radix sort, which is stable and linear in the number of draws
+
+    // build the histograms for every digit in a single pass
+    auto histograms = std::array<std::array<std::uint32_t, radix_size>, radix_passes>{};
+    for (const auto &entry : entries_)
+    {
+        for (auto digit = 0u; digit < radix_passes; ++digit)
+        {
+            ++histograms[digit][(entry.key >> (digit * radix_bits)) & (radix_size - 1u)];
+        }
+    }
+
+    scratch_.resize(entries_.size());
+
+    for (auto digit = 0u; digit < radix_passes; ++digit)
+    {
+        auto &histogram = histograms[digit];
+
+        // most of the key is the same for every draw (e.g. the pass), there is nothing to do for those digits
+        if (std::ranges::any_of(histogram, [&](auto count) { return count == entries_.size(); }))
+        {
+            continue;
+        }
+
+        // turn the counts into offsets
+        auto offset = 0u;
+        for (auto &count : histogram)
+        {
+            offset += std::exchange(count, offset);
+        }
+
+        for (const auto &entry : entries_)
+        {
+            scratch_[histogram[(entry.key >> (digit * radix_bits)) & (radix_size - 1u)]++] = entry;
+        }
+
+        std::ranges::swap(entries_, scratch_);
+    }
+
+    // instanced draws index the instance data by their position in the sorted order
+    ordered_instances_.clear();
+    for (const auto &entry : entries_)
+    {
+        ordered_instances_.push_back(instances_[entry.index]);
+    }
+}
+
+auto RenderQueue::submit(StateCache &cache, const PrepareCallback &prepare) const -> void
+{
+    for (auto first = std::size_t{}; first < entries_.size();)
+    {
+        const auto &queued_draw = draws_[entries_[first].index];
+        const auto &[draw_call, first_texture, texture_count] = queued_draw;
+
+        cache.use_program(draw_call.program);
+        cache.bind_vertex_array(draw_call.vertex_array);
+
+        if (draw_call.parameter_buffer != 0u)
+        {
+            cache.bind_uniform_buffer(material_block_binding, draw_call.parameter_buffer);
+        }
+
+        for (auto unit = 0u; unit < texture_count; ++unit)
+        {
+            const auto &[texture, sampler] = textures_[first_texture + unit];
+            cache.bind_texture(unit, texture, sampler);
+        }
+
+        auto last = first + 1u;
+
+        if (draw_call.instanced)
+        {
+            // sorting puts draws with the same state next to each other, so they can be drawn as one
+            while ((last < entries_.size()) && can_merge(queued_draw, draws_[entries_[last].index]))
+            {
+                ++last;
+            }
+
+            cache.draw_elements_instanced(
+                draw_call.index_count,
+                draw_call.index_type,
+                draw_call.index_offset,
+                static_cast<std::uint32_t>(last - first),
+                static_cast<std::uint32_t>(first));
+        }
+        else
+        {
+            if (prepare)
+            {
+                prepare(draw_call, ordered_instances_[first]);
+            }
+
+            cache.draw_elements(draw_call.index_count, draw_call.index_type, draw_call.index_offset);
+        }
+
+        first = last;
+    }
+}
+
+auto RenderQueue::instances() const -> std::span<const InstanceData>
+{
+    return ordered_instances_;
+}
+
+auto RenderQueue::size() const -> std::size_t
+{
+    return draws_.size();
+}
+
+auto RenderQueue::can_merge(const QueuedDraw &first, const QueuedDraw &other) const -> bool
+{
+    const auto &a = first.draw_call;
+    const auto &b = other.draw_call;
+
+    if (!a.instanced || !b.instanced || (a.pass != b.pass) || (a.program != b.program) ||
+        (a.vertex_array != b.vertex_array) || (a.parameter_buffer != b.parameter_buffer) ||
+        (a.index_count != b.index_count) || (a.index_type != b.index_type) || (a.index_offset != b.index_offset))
+    {
+        return false;
+    }
+
+    const auto first_textures = std::span{textures_}.subspan(first.first_texture, first.texture_count);
+    const auto other_textures = std::span{textures_}.subspan(other.first_texture, other.texture_count);
+
+    return std::ranges::equal(first_textures, other_textures);
+}
+
+}
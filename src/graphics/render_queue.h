@@ -0,0 +1,240 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <span>
+#include <vector>
+
+#include "graphics/instance_data.h"
+#include "graphics/opengl.h"
+#include "graphics/state_cache.h"
+#include "graphics/uniform.h"
+
+namespace game
+{
+
+class Entity;
+
+/**
+ * Enumeration of render passes, in the order they are drawn.
+ */
+enum class RenderPass
+{
+    /** Opaque geometry, drawn front to back and grouped by state. */
+    SOLID,
+
+    /** Blended geometry, drawn back to front. */
+    BLENDED,
+};
+
+/**
+ * A texture and the sampler to read it with.
+ */
+struct TextureBinding
+{
+    /** Handle of the texture. */
+    ::GLuint texture;
+
+    /** Handle of the sampler. */
+    ::GLuint sampler;
+
+    auto operator==(const TextureBinding &) const -> bool = default;
+};
+
+/**
+ * Everything needed to draw a mesh, apart from its textures and per draw uniforms.
+ */
+struct DrawCall
+{
+    /** Pass to draw in. */
+    RenderPass pass;
+
+    /** Handle of the program. */
+    ::GLuint program;
+
+    /** Handle of the vertex array. */
+    ::GLuint vertex_array;
+
+    /** Handle of the buffer holding the parameters of the material, bound to material_block_binding (zero if none). */
+    ::GLuint parameter_buffer;
+
+    /** Number of indices to draw. */
+    std::uint32_t index_count;
+
+    /** Type of the indices. */
+    ::GLenum index_type;
+
+    /** Offset of the first index in the element buffer. */
+    std::uintptr_t index_offset;
+
+    /** Distance from the camera, normalised to [0, 1]. */
+    float depth;
+
+    /** Whether the program reads its model matrix from the instance block, so the draw can be merged with others. */
+    bool instanced;
+
+    /** Entity being drawn, for setting per draw uniforms (optional). */
+    const Entity *entity;
+};
+
+/**
+ * Build the key draws are sorted by. From most to least significant the key holds the pass, then for solid draws the
+ * program, textures, vertex array and depth (front to back) and for blended draws the depth (back to front) followed by
+ * the same state. Handles are truncated to fit, which only costs extra state changes if two collide.
+ *
+ * @param pass
+ *   Pass to draw in.
+ * @param program
+ *   Handle of the program.
+ * @param textures
+ *   Textures to bind.
+ * @param vertex_array
+ *   Handle of the vertex array.
+ * @param depth
+ *   Distance from the camera, normalised to [0, 1].
+ *
+ * @returns
+ *   The sort key.
+ */
+auto make_sort_key(
+    RenderPass pass,
+    ::GLuint program,
+    std::span<const TextureBinding> textures,
+    ::GLuint vertex_array,
+    float depth) -> std::uint64_t;
+
+/**
+ * Collects the draws for a frame, sorts them to minimise state changes and submits them through a StateCache.
+ *
+ * Runs of instanced draws which share all their state once sorted are submitted as a single instanced draw. Every draw
+ * has an InstanceData, see instances(), which must be bound to instance_block_binding before submitting.
+ *
+ * The queue keeps its memory between frames, so it should be cleared and refilled each frame rather than recreated.
+ */
+class RenderQueue
+{
+  public:
+    /**
+     * Callback invoked after the state of a non instanced draw has been bound and before it is drawn, for setting per
+     * draw uniforms. It is passed the InstanceData pushed with the draw, so values already computed for it (e.g. the
+     * model matrix) can be set rather than rebuilt.
+     */
+    using PrepareCallback = std::function<void(const DrawCall &, const InstanceData &)>;
+
+    /**
+     * Construct a new empty queue.
+     */
+    RenderQueue();
+
+    /**
+     * Remove all draws.
+     */
+    auto clear() -> void;
+
+    /**
+     * Add a draw.
+     *
+     * @param draw_call
+     *   The draw.
+     * @param textures
+     *   Textures to bind, to consecutive units starting at zero.
+     * @param instance
+     *   Per instance data, only read by the shader if the draw is instanced.
+     */
+    auto push(const DrawCall &draw_call, std::span<const TextureBinding> textures, const InstanceData &instance)
+        -> void;
+
+    /**
+     * Sort the draws by their keys, draws with equal keys keep the order they were pushed in.
+     */
+    auto sort() -> void;
+
+    /**
+     * Bind the state for and draw each draw, in sorted order if sort() has been called since the last push().
+     *
+     * @param cache
+     *   Cache to bind state through.
+     * @param prepare
+     *   Callback for each draw (optional).
+     */
+    auto submit(StateCache &cache, const PrepareCallback &prepare) const -> void;
+
+    /**
+     * Get the per instance data of the draws, in the order they are submitted. An instanced draw starting at the nth
+     * draw uses n as its base instance, so these can be uploaded as is.
+     *
+     * @returns
+     *   Per instance data of each draw.
+     */
+    auto instances() const -> std::span<const InstanceData>;
+
+    /**
+     * Get the number of draws.
+     *
+     * @returns
+     *   Number of draws.
+     */
+    auto size() const -> std::size_t;
+
+  private:
+    /**
+     * A key and the draw it belongs to, this is what gets sorted.
+     */
+    struct SortEntry
+    {
+        /** The sort key. */
+        std::uint64_t key;
+
+        /** Index of the draw. */
+        std::uint32_t index;
+    };
+
+    /**
+     * A draw and where its textures are.
+     */
+    struct QueuedDraw
+    {
+        /** The draw. */
+        DrawCall draw_call;
+
+        /** Index of the first texture in textures_. */
+        std::uint32_t first_texture;
+
+        /** Number of textures. */
+        std::uint32_t texture_count;
+    };
+
+    /**
+     * Check whether a draw can be drawn as another instance of a draw.
+     *
+     * @param first
+     *   The draw being instanced.
+     * @param other
+     *   The draw to check.
+     *
+     * @returns
+     *   True if both draws are instanced and share all their state, otherwise false.
+     */
+    auto can_merge(const QueuedDraw &first, const QueuedDraw &other) const -> bool;
+
+    /** Draws in the order they were pushed. */
+    std::vector<QueuedDraw> draws_;
+
+    /** Textures of all draws. */
+    std::vector<TextureBinding> textures_;
+
+    /** Per instance data of the draws, in the order they were pushed. */
+    std::vector<InstanceData> instances_;
+
+    /** Per instance data of the draws, in the order they are submitted. */
+    std::vector<InstanceData> ordered_instances_;
+
+    /** Keys of the draws, in the order they are submitted. */
+    std::vector<SortEntry> entries_;
+
+    /** Scratch space for sorting. */
+    std::vector<SortEntry> scratch_;
+};
+
+}
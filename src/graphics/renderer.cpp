@@ -1,21 +1,31 @@
 #include "graphics/renderer.h"
 
+#include <bit>
+#include <cstddef>
 #include <cstdint>
 #include <ranges>
+#include <span>
+#include <vector>
 
 #include "buffer_writer.h"
 #include "entity.h"
+#include "graphics/aabb_tree.h"
 #include "graphics/camera.h"
 #include "graphics/cube_map.h"
 #include "graphics/frame_buffer.h"
+#include "graphics/instance_data.h"
 #include "graphics/material.h"
 #include "graphics/mesh.h"
 #include "graphics/mesh_factory.h"
 #include "graphics/opengl.h"
+#include "graphics/render_backend.h"
+#include "graphics/render_queue.h"
 #include "graphics/sampler.h"
 #include "graphics/scene.h"
+#include "graphics/state_cache.h"
 #include "graphics/texture.h"
 #include "maths/colour.h"
+#include "maths/frustum_cull.h"
 #include "maths/matrix4.h"
 #include "maths/vector3.h"
 #include "resources/resource_loader.h"
@@ -122,6 +132,15 @@ Renderer::Renderer(
     , fb_(width, height)
     , post_process_sprite_(mesh_factory.sprite())
     , post_process_material_(create_post_process_material(resource_loader))
+    , gamma_uniform_(post_process_material_.uniform<float>("gamma"))
+    , entity_bounds_{}
+    , entity_visible_{}
+    , visible_entities_{}
+    , backend_{}
+    , render_queue_{}
+    , texture_bindings_{}
+    , instance_buffer_{}
+    , stats_{}
 {
 }
 
@@ -178,33 +197,108 @@ auto Renderer::render(const Camera &camera, const Scene &scene, float gamma) con
     ::glDrawElements(
         GL_TRIANGLES,
         skybox_cube_.index_count(),
-        GL_UNSIGNED_INT,
+        skybox_cube_.index_type(),
         reinterpret_cast<void *>(skybox_cube_.index_offset()));
 
     skybox_cube_.unbind();
 
     ::glDepthMask(GL_TRUE);
 
-    // render the entities
+    // cull the entities against the camera frustum, hierarchically if the scene has a tree and in batches otherwise
 
-    for (const auto *entity : scene.entities)
+    visible_entities_.clear();
+
+    if (scene.tree != nullptr)
+    {
+        scene.tree->query_frustum(camera.frustum_planes(), visible_entities_);
+    }
+    else
+    {
+        entity_bounds_.clear();
+        for (const auto *entity : scene.entities)
+        {
+            entity_bounds_.push_back(entity->bounds());
+        }
+
+        cull(camera.frustum_planes(), entity_bounds_, entity_visible_);
+
+        for (const auto &[index, entity] : std::views::enumerate(scene.entities))
+        {
+            if (is_visible(entity_visible_, static_cast<std::size_t>(index)))
+            {
+                visible_entities_.push_back(entity);
+            }
+        }
+    }
+
+    // queue the entities that survived, sorted to group draws which share state
+
+    render_queue_.clear();
+
+    for (const auto *entity : visible_entities_)
     {
         const auto *mesh = entity->mesh();
         const auto *material = entity->material();
 
-        material->use();
-        const auto model = Matrix4{entity->transform()};
-        material->set_uniform("model", model);
-        // set any material specific uniforms
-        material->invoke_uniform_callback(entity);
-        material->bind_textures(entity->textures());
-
-        mesh->bind();
-        ::glDrawElements(
-            GL_TRIANGLES, mesh->index_count(), GL_UNSIGNED_INT, reinterpret_cast<void *>(mesh->index_offset()));
-        mesh->unbind();
+        texture_bindings_.clear();
+        for (const auto *texture : entity->textures())
+        {
+            texture_bindings_.push_back(
+                {.texture = texture->native_handle(), .sampler = texture->sampler()->native_handle()});
+        }
+
+        // packed meshes store positions relative to their bounds, fold the mapping back to model space in here
+        auto instance = InstanceData{.model = Matrix4{entity->transform()} * mesh->dequantisation(), .parameters = {}};
+        material->invoke_instance_callback(entity, instance);
+
+        render_queue_.push(
+            {.pass = RenderPass::SOLID,
+             .program = material->native_handle(),
+             .vertex_array = mesh->native_handle(),
+             .parameter_buffer = material->parameter_buffer(),
+             .index_count = mesh->index_count(),
+             .index_type = mesh->index_type(),
+             .index_offset = mesh->index_offset(),
+             .depth = Vector3::distance(camera.position(), entity->position()) / camera.far_plane(),
+             .instanced = material->instanced(),
+             .entity = entity},
+            texture_bindings_,
+            instance);
+    }
+
+    render_queue_.sort();
+
+    // upload the per instance data in the order it will be drawn, growing the buffer if this frame needs more than any
+    // before it
+    if (const auto instances = std::as_bytes(render_queue_.instances()); !instances.empty())
+    {
+        if (!instance_buffer_ || (instance_buffer_->size() < instances.size()))
+        {
+            instance_buffer_.emplace(static_cast<std::uint32_t>(std::bit_ceil(instances.size())));
+        }
+
+        instance_buffer_->write(instances, 0u);
+        ::glBindBufferBase(GL_SHADER_STORAGE_BUFFER, instance_block_binding, instance_buffer_->native_handle());
     }
 
+    // the skybox was bound directly, so the cache starts each frame with nothing known
+    auto state_cache = StateCache{backend_};
+    render_queue_.submit(
+        state_cache,
+        [](const DrawCall &draw_call, const InstanceData &instance)
+        {
+            // only materials which are not instanced get here, they read the model matrix (built when the entity was
+            // queued) from a uniform
+            const auto *entity = draw_call.entity;
+            const auto *material = entity->material();
+
+            material->set_uniform(material->model_uniform(), instance.model);
+            // set any material specific uniforms
+            material->invoke_uniform_callback(entity);
+        });
+
+    stats_ = state_cache.stats();
+
     // draw any debug lines
     if (const auto &dbl = scene.debug_lines; dbl)
     {
@@ -222,12 +316,17 @@ auto Renderer::render(const Camera &camera, const Scene &scene, float gamma) con
     post_process_material_.use();
     post_process_sprite_.bind();
     post_process_material_.bind_texture(0, &fb_.colour_texture(), scene.skybox_sampler);
-    post_process_material_.set_uniform("gamma", gamma);
+    post_process_material_.set_uniform(gamma_uniform_, gamma);
     ::glDrawElements(
         GL_TRIANGLES,
         post_process_sprite_.index_count(),
-        GL_UNSIGNED_INT,
+        post_process_sprite_.index_type(),
         reinterpret_cast<void *>(post_process_sprite_.index_offset()));
     post_process_sprite_.unbind();
 }
+
+auto Renderer::stats() const -> const RenderStats &
+{
+    return stats_;
+}
 }
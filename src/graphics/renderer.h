@@ -1,6 +1,8 @@
 #pragma once
 
 #include <cstdint>
+#include <optional>
+#include <vector>
 
 #include "graphics/buffer.h"
 #include "graphics/camera.h"
@@ -8,7 +10,12 @@
 #include "graphics/material.h"
 #include "graphics/mesh.h"
 #include "graphics/mesh_factory.h"
+#include "graphics/render_backend.h"
+#include "graphics/render_queue.h"
 #include "graphics/scene.h"
+#include "graphics/state_cache.h"
+#include "graphics/uniform.h"
+#include "maths/frustum_cull.h"
 #include "resources/resource_loader.h"
 
 namespace game
@@ -17,7 +24,8 @@ namespace game
 /**
  * A simple opinionated forward renderer.
  *
- * This will render a scene from a camera, add basic skybox and HDR.
+ * This will render a scene from a camera, add basic skybox and HDR. Entities whose bounds are entirely outside the
+ * camera frustum are culled before anything is submitted, the rest are sorted to minimise state changes.
  */
 class Renderer
 {
@@ -49,6 +57,14 @@ class Renderer
      */
     auto render(const Camera &camera, const Scene &scene, float gamma) const -> void;
 
+    /**
+     * Get the counts of the entity draws and state changes made by the last call to render().
+     *
+     * @returns
+     *   The counts.
+     */
+    auto stats() const -> const RenderStats &;
+
   private:
     /** OpenGL buffer for camera data. */
     Buffer camera_buffer_;
@@ -73,6 +89,33 @@ class Renderer
 
     /** Post processing material. */
     Material post_process_material_;
+
+    /** The gamma uniform of the post processing material. */
+    Uniform<float> gamma_uniform_;
+
+    /** World space bounds of the entities being rendered, kept between frames to reuse the memory. */
+    mutable AABBArray entity_bounds_;
+
+    /** Visibility bitmask of the entities being rendered, kept between frames to reuse the memory. */
+    mutable std::vector<std::uint64_t> entity_visible_;
+
+    /** The entities which survived culling, kept between frames to reuse the memory. */
+    mutable std::vector<const Entity *> visible_entities_;
+
+    /** Backend the entity draws are submitted to. */
+    mutable OpenGLRenderBackend backend_;
+
+    /** Queue the entity draws are sorted in, kept between frames to reuse the memory. */
+    mutable RenderQueue render_queue_;
+
+    /** Textures of the entity being queued, kept between frames to reuse the memory. */
+    mutable std::vector<TextureBinding> texture_bindings_;
+
+    /** Per instance data of the entity draws, created on first use and grown as needed. */
+    mutable std::optional<Buffer> instance_buffer_;
+
+    /** Counts from the last frame. */
+    mutable RenderStats stats_;
 };
 
 }
@@ -15,6 +15,7 @@
 namespace game
 {
 
+class AABBTree;
 class Entity;
 
 /**
@@ -64,6 +65,9 @@ struct Scene
     /** Collection of entities to render. */
     std::vector<const Entity *> entities;
 
+    /** Optional hierarchy of the entities, with up to date bounds, culled rather than testing every entity. */
+    const AABBTree *tree;
+
     /** The ambient light in the scene. */
     Colour ambient;
 
@@ -0,0 +1,125 @@
+#include "graphics/state_cache.h"
+
+#include <cstdint>
+
+#include "graphics/opengl.h"
+#include "graphics/render_backend.h"
+#include "utils/error.h"
+
+namespace game
+{
+
+StateCache::StateCache(RenderBackend &backend)
+    : backend_(backend)
+    , program_(unknown)
+    , vertex_array_(unknown)
+    , textures_{}
+    , samplers_{}
+    , uniform_buffers_{}
+    , stats_{}
+{
+    invalidate();
+}
+
+auto StateCache::use_program(::GLuint program) -> void
+{
+    if (program == program_)
+    {
+        ++stats_.redundant_changes;
+        return;
+    }
+
+    backend_.use_program(program);
+    program_ = program;
+    ++stats_.program_changes;
+}
+
+auto StateCache::bind_vertex_array(::GLuint vertex_array) -> void
+{
+    if (vertex_array == vertex_array_)
+    {
+        ++stats_.redundant_changes;
+        return;
+    }
+
+    backend_.bind_vertex_array(vertex_array);
+    vertex_array_ = vertex_array;
+    ++stats_.vertex_array_changes;
+}
+
+auto StateCache::bind_texture(std::uint32_t unit, ::GLuint texture, ::GLuint sampler) -> void
+{
+    expect(unit < max_texture_units, "texture unit {} out of range", unit);
+
+    if (texture == textures_[unit])
+    {
+        ++stats_.redundant_changes;
+    }
+    else
+    {
+        backend_.bind_texture(unit, texture);
+        textures_[unit] = texture;
+        ++stats_.texture_changes;
+    }
+
+    if (sampler == samplers_[unit])
+    {
+        ++stats_.redundant_changes;
+    }
+    else
+    {
+        backend_.bind_sampler(unit, sampler);
+        samplers_[unit] = sampler;
+        ++stats_.sampler_changes;
+    }
+}
+
+auto StateCache::bind_uniform_buffer(std::uint32_t index, ::GLuint buffer) -> void
+{
+    expect(index < max_uniform_buffers, "uniform buffer binding {} out of range", index);
+
+    if (buffer == uniform_buffers_[index])
+    {
+        ++stats_.redundant_changes;
+        return;
+    }
+
+    backend_.bind_uniform_buffer(index, buffer);
+    uniform_buffers_[index] = buffer;
+    ++stats_.uniform_buffer_changes;
+}
+
+auto StateCache::draw_elements(std::uint32_t index_count, ::GLenum index_type, std::uintptr_t index_offset) -> void
+{
+    backend_.draw_elements(index_count, index_type, index_offset);
+    ++stats_.draw_count;
+    ++stats_.instance_count;
+}
+
+auto StateCache::draw_elements_instanced(
+    std::uint32_t index_count,
+    ::GLenum index_type,
+    std::uintptr_t index_offset,
+    std::uint32_t instance_count,
+    std::uint32_t base_instance) -> void
+{
+    backend_.draw_elements_instanced(index_count, index_type, index_offset, instance_count, base_instance);
+    ++stats_.draw_count;
+    stats_.instance_count += instance_count;
+}
+
+auto StateCache::invalidate() -> void
+{
+    program_ = unknown;
+    vertex_array_ = unknown;
+    textures_.fill(unknown);
+    samplers_.fill(unknown);
+    uniform_buffers_.fill(unknown);
+}
+
+auto StateCache::stats() const -> const RenderStats &
+{
+    return stats_;
+}
+
+}
@@ -0,0 +1,175 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+
+#include "graphics/opengl.h"
+#include "graphics/render_backend.h"
+
+namespace game
+{
+
+/** Number of texture units tracked by StateCache. */
+constexpr auto max_texture_units = 16u;
+
+/** Number of uniform block binding points tracked by StateCache. */
+constexpr auto max_uniform_buffers = 8u;
+
+/**
+ * Counts of the work submitted in a frame.
+ */
+struct RenderStats
+{
+    /** Number of draw calls. */
+    std::size_t draw_count;
+
+    /** Number of instances drawn, a non instanced draw counts as one. */
+    std::size_t instance_count;
+
+    /** Number of times the program changed. */
+    std::size_t program_changes;
+
+    /** Number of times the vertex array changed. */
+    std::size_t vertex_array_changes;
+
+    /** Number of texture binds. */
+    std::size_t texture_changes;
+
+    /** Number of sampler binds. */
+    std::size_t sampler_changes;
+
+    /** Number of uniform buffer binds. */
+    std::size_t uniform_buffer_changes;
+
+    /** Number of binds skipped because the state was already set. */
+    std::size_t redundant_changes;
+};
+
+/**
+ * Forwards state changes to a backend, skipping any which would not change anything. The cache assumes it is the only
+ * thing changing the state it tracks, anything bound around it should be followed by a call to invalidate().
+ */
+class StateCache
+{
+  public:
+    /**
+     * Construct a new state cache, with all state unknown.
+     *
+     * @param backend
+     *   The backend to forward state changes to, must outlive the cache.
+     */
+    explicit StateCache(RenderBackend &backend);
+
+    /**
+     * Make a program current.
+     *
+     * @param program
+     *   Handle of the program.
+     */
+    auto use_program(::GLuint program) -> void;
+
+    /**
+     * Bind a vertex array.
+     *
+     * @param vertex_array
+     *   Handle of the vertex array.
+     */
+    auto bind_vertex_array(::GLuint vertex_array) -> void;
+
+    /**
+     * Bind a texture and sampler to a texture unit.
+     *
+     * @param unit
+     *   The texture unit, must be less than max_texture_units.
+     * @param texture
+     *   Handle of the texture.
+     * @param sampler
+     *   Handle of the sampler.
+     */
+    auto bind_texture(std::uint32_t unit, ::GLuint texture, ::GLuint sampler) -> void;
+
+    /**
+     * Bind a buffer to a uniform block binding point.
+     *
+     * @param index
+     *   The binding point, must be less than max_uniform_buffers.
+     * @param buffer
+     *   Handle of the buffer.
+     */
+    auto bind_uniform_buffer(std::uint32_t index, ::GLuint buffer) -> void;
+
+    /**
+     * Draw indexed triangles with the current state.
+     *
+     * @param index_count
+     *   Number of indices to draw.
+     * @param index_type
+     *   Type of the indices.
+     * @param index_offset
+     *   Offset of the first index in the element buffer.
+     */
+    auto draw_elements(std::uint32_t index_count, ::GLenum index_type, std::uintptr_t index_offset) -> void;
+
+    /**
+     * Draw several instances of indexed triangles with the current state.
+     *
+     * @param index_count
+     *   Number of indices to draw.
+     * @param index_type
+     *   Type of the indices.
+     * @param index_offset
+     *   Offset of the first index in the element buffer.
+     * @param instance_count
+     *   Number of instances to draw.
+     * @param base_instance
+     *   Index of the first instance.
+     */
+    auto draw_elements_instanced(
+        std::uint32_t index_count,
+        ::GLenum index_type,
+        std::uintptr_t index_offset,
+        std::uint32_t instance_count,
+        std::uint32_t base_instance) -> void;
+
+    /**
+     * Forget all state, so the next change of each is always forwarded.
+     */
+    auto invalidate() -> void;
+
+    /**
+     * Get the counts of work forwarded to the backend since the cache was created.
+     *
+     * @returns
+     *   The counts.
+     */
+    auto stats() const -> const RenderStats &;
+
+  private:
+    /** Value for state which is not known. */
+    static constexpr auto unknown = std::numeric_limits<::GLuint>::max();
+
+    /** Backend to forward to. */
+    RenderBackend &backend_;
+
+    /** Current program. */
+    ::GLuint program_;
+
+    /** Current vertex array. */
+    ::GLuint vertex_array_;
+
+    /** Current texture of each unit. */
+    std::array<::GLuint, max_texture_units> textures_;
+
+    /** Current sampler of each unit. */
+    std::array<::GLuint, max_texture_units> samplers_;
+
+    /** Current buffer of each uniform block binding point. */
+    std::array<::GLuint, max_uniform_buffers> uniform_buffers_;
+
+    /** Counts of forwarded work. */
+    RenderStats stats_;
+};
+
+}
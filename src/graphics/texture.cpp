@@ -1,6 +1,7 @@
 #include "graphics/texture.h"
 
 #include <algorithm>
+#include <bit>
 #include <cstddef>
 #include <cstdint>
 #include <format>
@@ -16,40 +17,16 @@
 
 #include "graphics/opengl.h"
 #include "graphics/sampler.h"
-#include "tlv/tlv_reader.h"
+#include "resources/resource_footprint.h"
+#include "tlv/tlv_archive.h"
+#include "tlv/tlv_compression.h"
+#include "tlv/tlv_entry.h"
+#include "utils/auto_release.h"
 #include "utils/error.h"
 #include "utils/exception.h"
 #include "utils/formatter.h"
 #include "utils/log.h"
 
-namespace
-{
-
-/**
- * Helper function to convert a TextureUsage and TextureFormat to an OpenGL format.
- *
- * @param usage
- *   The usage of the texture.
- * @param format
- *   The format of the texture.
- *
- *  @returns
- *  The OpenGL format.
- */
-::GLenum to_opengl(game::TextureUsage usage, game::TextureFormat format)
-{
-    switch (usage)
-    {
-        using enum game::TextureUsage;
-        using enum game::TextureFormat;
-
-        case SRGB: return format == RGBA ? GL_SRGB8_ALPHA8 : GL_SRGB8;
-        case DATA: return format == RGBA ? GL_RGBA8 : GL_RGB8;
-        default: throw game::Exception("unknown usage");
-    }
-}
-
-}
 namespace game
 {
 
@@ -61,6 +38,7 @@ Texture::Texture(
     const Sampler *sampler)
     : handle_{0u, [](auto texture) { ::glDeleteTextures(1u, &texture); }}
     , sampler_(sampler)
+    , gpu_bytes_{}
 {
     log::info("creating tex with: {}x{} usage={} data={}", width, height, to_string(usage), data.size());
 
@@ -92,46 +70,126 @@ Texture::Texture(
     }
 
     ::glTextureStorage2D(handle_, 1, format, width, height);
+    gpu_bytes_ = static_cast<std::size_t>(w) * static_cast<std::size_t>(h) * static_cast<std::size_t>(num_channels);
+
     ::glTextureSubImage2D(
         handle_, 0, 0, 0, width, height, num_channels == 4 ? GL_RGBA : GL_RGB, GL_UNSIGNED_BYTE, raw_data.get());
 }
 
 Texture::Texture(const TextureDescription &description, const Sampler *sampler)
+    : Texture(
+          TextureDescriptionView{
+              .width = description.width,
+              .height = description.height,
+              .format = description.format,
+              .usage = description.usage,
+              .mip_levels = description.mip_levels,
+              .data = description.data},
+          sampler)
+{
+}
+
+Texture::Texture(const TextureDescriptionView &description, const Sampler *sampler)
     : handle_{0u, [](auto texture) { ::glDeleteTextures(1u, &texture); }}
     , sampler_(sampler)
+    , gpu_bytes_{}
 {
     log::info("creating tex with: {}", description);
 
+    ensure(
+        (description.mip_levels >= 1u) &&
+            (description.mip_levels <= mip_level_count(description.width, description.height)),
+        "invalid mip level count {}",
+        description.mip_levels);
+
     ::glCreateTextures(GL_TEXTURE_2D, 1, &handle_);
 
     ::glTextureStorage2D(
-        handle_, 1, to_opengl(description.usage, description.format), description.width, description.height);
-    ::glTextureSubImage2D(
         handle_,
-        0,
-        0,
-        0,
+        description.mip_levels,
+        to_opengl(description.usage, description.format),
         description.width,
-        description.height,
-        description.format == TextureFormat::RGBA ? GL_RGBA : GL_RGB,
-        GL_UNSIGNED_BYTE,
-        description.data.data());
+        description.height);
+
+    // rows of the smaller levels are not 4 byte aligned, which is the default unpack alignment, so relax it for the
+    // upload and put the default back afterwards (even if a level throws) for anything else uploading pixels
+    ::glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    const auto restore_alignment =
+        AutoRelease<::GLint>{4, [](auto alignment) { ::glPixelStorei(GL_UNPACK_ALIGNMENT, alignment); }};
+
+    // levels are tightly packed one after another, so upload each straight from the view
+    auto offset = std::size_t{};
+    for (auto level = 0u; level < description.mip_levels; ++level)
+    {
+        const auto level_size = mip_level_size(description.format, description.width, description.height, level);
+        ensure(offset + level_size <= description.data.size(), "texture data too small for mip level {}", level);
+
+        const auto level_width = std::max(description.width >> level, 1u);
+        const auto level_height = std::max(description.height >> level, 1u);
+
+        if (is_compressed(description.format))
+        {
+            // compressed blocks are uploaded as is, the driver does no conversion
+            ::glCompressedTextureSubImage2D(
+                handle_,
+                level,
+                0,
+                0,
+                level_width,
+                level_height,
+                to_opengl(description.usage, description.format),
+                static_cast<::GLsizei>(level_size),
+                description.data.data() + offset);
+        }
+        else
+        {
+            ::glTextureSubImage2D(
+                handle_,
+                level,
+                0,
+                0,
+                level_width,
+                level_height,
+                description.format == TextureFormat::RGBA ? GL_RGBA : GL_RGB,
+                GL_UNSIGNED_BYTE,
+                description.data.data() + offset);
+        }
+
+        offset += level_size;
+    }
+
+    gpu_bytes_ = offset;
 }
 
-Texture::Texture(const TLVReader &reader, std::string_view name, const Sampler *sampler)
+Texture::Texture(const TLVArchive &archive, std::string_view name, const Sampler *sampler)
     : handle_{0u, [](auto texture) { ::glDeleteTextures(1u, &texture); }}
     , sampler_(sampler)
+    , gpu_bytes_{}
 {
-    auto desc = std::ranges::find_if(reader, [name](const auto &e) { return e.is_texture(name); });
-    ensure(desc != std::ranges::end(reader), "could not find texture");
+    const auto desc = archive.find(name, TLVType::TEXTURE_DESCRIPTION);
+    ensure(desc.has_value(), "could not find texture {}", name);
+
+    // bit gross but we can reuse the other ctor, once a compressed texture has been decompressed
+    auto tex = [&]
+    {
+        if (desc->is_compressed())
+        {
+            auto staging = TLVStagingBuffer{*desc};
+            staging.decompress();
+
+            return Texture{staging.entry().texture_description_view(), sampler_};
+        }
 
-    // bit gross but we can reuse the other ctor
-    auto tex = Texture{(*desc).texture_description_value(), sampler_};
+        return Texture{desc->texture_description_view(), sampler_};
+    }();
     std::ranges::swap(handle_, tex.handle_);
+    std::ranges::swap(gpu_bytes_, tex.gpu_bytes_);
 }
 
 Texture::Texture(TextureUsage usage, std::uint32_t width, std::uint32_t height)
     : handle_{0u, [](auto texture) { ::glDeleteTextures(1u, &texture); }}
+    , sampler_{}
+    , gpu_bytes_{}
 {
     TextureUsage valid_usage[] = {TextureUsage::FRAMEBUFFER, TextureUsage::DEPTH};
     expect(std::ranges::contains(valid_usage, usage), "invalid usage");
@@ -144,6 +202,10 @@ Texture::Texture(TextureUsage usage, std::uint32_t width, std::uint32_t height)
         case DEPTH: ::glTextureStorage2D(handle_, 1, GL_DEPTH_COMPONENT24, width, height); break;
         default: break;
     }
+
+    // drivers generally pad 24 bit depth to 32 bits
+    const auto bytes_per_pixel = usage == TextureUsage::FRAMEBUFFER ? 6u : 4u;
+    gpu_bytes_ = std::size_t{width} * height * bytes_per_pixel;
 }
 
 auto Texture::native_handle() const -> ::GLuint
@@ -156,6 +218,78 @@ auto Texture::sampler() const -> const Sampler *
     return sampler_;
 }
 
+auto Texture::footprint() const -> ResourceFootprint
+{
+    return {.cpu_bytes = sizeof(Texture), .gpu_bytes = gpu_bytes_};
+}
+
+auto mip_level_count(std::uint32_t width, std::uint32_t height) -> std::uint32_t
+{
+    return static_cast<std::uint32_t>(std::bit_width(std::max({width, height, 1u})));
+}
+
+auto to_opengl(TextureUsage usage, TextureFormat format) -> ::GLenum
+{
+    switch (usage)
+    {
+        using enum TextureUsage;
+        using enum TextureFormat;
+
+        case SRGB:
+            switch (format)
+            {
+                case RGB: return GL_SRGB8;
+                case RGBA: return GL_SRGB8_ALPHA8;
+                case BC1: return GL_COMPRESSED_SRGB_S3TC_DXT1_EXT;
+                case BC3: return GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT5_EXT;
+                case BC7: return GL_COMPRESSED_SRGB_ALPHA_BPTC_UNORM;
+                default: throw Exception("format {} cannot be used for SRGB", format);
+            }
+        case DATA:
+            switch (format)
+            {
+                case RGB: return GL_RGB8;
+                case RGBA: return GL_RGBA8;
+                case BC1: return GL_COMPRESSED_RGB_S3TC_DXT1_EXT;
+                case BC3: return GL_COMPRESSED_RGBA_S3TC_DXT5_EXT;
+                case BC4: return GL_COMPRESSED_RED_RGTC1;
+                case BC5: return GL_COMPRESSED_RG_RGTC2;
+                case BC7: return GL_COMPRESSED_RGBA_BPTC_UNORM;
+            }
+            throw Exception("unknown format");
+        default: throw Exception("unknown usage");
+    }
+}
+
+auto is_compressed(TextureFormat format) -> bool
+{
+    return (format != TextureFormat::RGB) && (format != TextureFormat::RGBA);
+}
+
+auto mip_level_size(TextureFormat format, std::uint32_t width, std::uint32_t height, std::uint32_t level)
+    -> std::size_t
+{
+    const auto level_width = std::size_t{std::max(width >> level, 1u)};
+    const auto level_height = std::size_t{std::max(height >> level, 1u)};
+
+    // compressed formats store 4x4 blocks, so partial blocks at the edges still take a whole block
+    const auto blocks = ((level_width + 3u) / 4u) * ((level_height + 3u) / 4u);
+
+    switch (format)
+    {
+        using enum TextureFormat;
+        case RGB: return level_width * level_height * 3u;
+        case RGBA: return level_width * level_height * 4u;
+        case BC1:
+        case BC4: return blocks * 8u;
+        case BC3:
+        case BC5:
+        case BC7: return blocks * 16u;
+    }
+
+    throw Exception("unknown format");
+}
+
 auto to_string(TextureUsage obj) -> std::string
 {
     switch (obj)
@@ -176,6 +310,11 @@ auto to_string(TextureFormat obj) -> std::string
         using enum TextureFormat;
         case RGB: return "RGB";
         case RGBA: return "RGBA";
+        case BC1: return "BC1";
+        case BC3: return "BC3";
+        case BC4: return "BC4";
+        case BC5: return "BC5";
+        case BC7: return "BC7";
     }
     return "UNKNOWN";
 }
@@ -183,6 +322,24 @@ auto to_string(TextureFormat obj) -> std::string
 auto to_string(const TextureDescription &obj) -> std::string
 {
     return std::format(
-        "width={} height={} format={} usage={} data={}", obj.width, obj.height, obj.format, obj.usage, obj.data.size());
+        "width={} height={} format={} usage={} mip_levels={} data={}",
+        obj.width,
+        obj.height,
+        obj.format,
+        obj.usage,
+        obj.mip_levels,
+        obj.data.size());
+}
+
+auto to_string(const TextureDescriptionView &obj) -> std::string
+{
+    return std::format(
+        "width={} height={} format={} usage={} mip_levels={} data={}",
+        obj.width,
+        obj.height,
+        obj.format,
+        obj.usage,
+        obj.mip_levels,
+        obj.data.size());
 }
 }
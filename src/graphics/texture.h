@@ -8,12 +8,13 @@
 #include <vector>
 
 #include "graphics/opengl.h"
+#include "resources/resource_footprint.h"
 #include "utils/auto_release.h"
 
 namespace game
 {
 
-class TLVReader;
+class TLVArchive;
 class Sampler;
 
 /**
@@ -33,7 +34,22 @@ enum class TextureUsage
 enum class TextureFormat
 {
     RGB,
-    RGBA
+    RGBA,
+
+    /** Block compressed RGB, 4 bits per texel. */
+    BC1,
+
+    /** Block compressed RGBA, 8 bits per texel. */
+    BC3,
+
+    /** Block compressed single channel, 4 bits per texel. */
+    BC4,
+
+    /** Block compressed two channel, 8 bits per texel. Used for normal maps (z is reconstructed). */
+    BC5,
+
+    /** Block compressed RGBA, 8 bits per texel. */
+    BC7
 };
 
 /**
@@ -53,10 +69,93 @@ struct TextureDescription
     /** Usage of the texture. */
     TextureUsage usage;
 
-    /** The raw pixel data of the texture. */
+    /** Number of mip levels in data. */
+    std::uint32_t mip_levels = 1u;
+
+    /** The raw pixel data of the texture, all mip levels tightly packed starting with level 0. */
     std::vector<std::byte> data;
 };
 
+/**
+ * A non-owning description of a texture to load. The pixel data is a view into some other buffer (e.g. a memory mapped
+ * file) which must outlive this object.
+ */
+struct TextureDescriptionView
+{
+    /** Width of the texture. */
+    std::uint32_t width;
+
+    /** Height of the texture. */
+    std::uint32_t height;
+
+    /** Format of the texture. */
+    TextureFormat format;
+
+    /** Usage of the texture. */
+    TextureUsage usage;
+
+    /** Number of mip levels in data. */
+    std::uint32_t mip_levels = 1u;
+
+    /** View of the raw pixel data of the texture, all mip levels tightly packed starting with level 0. */
+    std::span<const std::byte> data;
+};
+
+/**
+ * Get the number of levels in a full mip chain, down to 1x1.
+ *
+ * @param width
+ *   Width of level 0.
+ * @param height
+ *   Height of level 0.
+ *
+ * @returns
+ *   Number of mip levels.
+ */
+auto mip_level_count(std::uint32_t width, std::uint32_t height) -> std::uint32_t;
+
+/**
+ * Check if a texture format is block compressed.
+ *
+ * @param format
+ *   The format to check.
+ *
+ * @returns
+ *   True if the format is block compressed, false otherwise.
+ */
+auto is_compressed(TextureFormat format) -> bool;
+
+/**
+ * Convert a texture usage and format to an OpenGL internal format. Only SRGB and DATA usages are supported.
+ *
+ * @param usage
+ *   The usage of the texture.
+ * @param format
+ *   The format of the texture.
+ *
+ * @returns
+ *   The OpenGL internal format.
+ */
+auto to_opengl(TextureUsage usage, TextureFormat format) -> ::GLenum;
+
+/**
+ * Get the size in bytes of a single mip level. Block compressed levels are always a whole number of 4x4 blocks.
+ *
+ * @param format
+ *   Format of the texture.
+ * @param width
+ *   Width of level 0.
+ * @param height
+ *   Height of level 0.
+ * @param level
+ *   The mip level.
+ *
+ * @returns
+ *   Size of the level in bytes.
+ */
+auto mip_level_size(TextureFormat format, std::uint32_t width, std::uint32_t height, std::uint32_t level)
+    -> std::size_t;
+
 /**
  * Represents a texture in OpenGL. Textures store a non-owning pointer to their sampler.
  */
@@ -95,16 +194,26 @@ class Texture
     Texture(const TextureDescription &description, const Sampler *sampler);
 
     /**
-     * Constructs a texture from a TLV reader.
+     * Constructs a texture from a non-owning description. The pixel data is uploaded directly from the view.
+     *
+     * @param description
+     *   The description of the texture.
+     * @param sampler
+     *   The sampler to use for the texture.
+     */
+    Texture(const TextureDescriptionView &description, const Sampler *sampler);
+
+    /**
+     * Constructs a texture from a TLV archive.
      *
-     * @param reader
-     *   The TLV reader to use.
+     * @param archive
+     *   The TLV archive to use.
      * @param name
      *   The name of the texture in the tlv.
      * @param sampler
      *   The sampler to use for the texture.
      */
-    Texture(const TLVReader &reader, std::string_view name, const Sampler *sampler);
+    Texture(const TLVArchive &archive, std::string_view name, const Sampler *sampler);
 
     /**
      * Constructs a texture with the given usage, width and height. Note this texture is not initialized. Calling with a
@@ -135,12 +244,23 @@ class Texture
      */
     auto sampler() const -> const Sampler *;
 
+    /**
+     * Get the memory used by the texture.
+     *
+     * @returns
+     *   The footprint of the texture.
+     */
+    auto footprint() const -> ResourceFootprint;
+
   private:
     /** OpenGL handle of the texture. */
     AutoRelease<::GLuint> handle_;
 
     /** Sampler of the texture. */
     const Sampler *sampler_;
+
+    /** Size of the texture storage (all mip levels) in bytes. */
+    std::size_t gpu_bytes_;
 };
 
 /**
@@ -175,4 +295,15 @@ auto to_string(TextureFormat obj) -> std::string;
  *   The string representation of the texture description.
  */
 auto to_string(const TextureDescription &obj) -> std::string;
+
+/**
+ * Converts a texture description view to a string.
+ *
+ * @param obj
+ *   The texture description view to convert.
+ *
+ * @returns
+ *   The string representation of the texture description view.
+ */
+auto to_string(const TextureDescriptionView &obj) -> std::string;
 }
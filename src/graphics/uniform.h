@@ -0,0 +1,90 @@
+#pragma once
+
+#include <cstdint>
+
+#include "graphics/opengl.h"
+
+namespace game
+{
+
+/** Binding point of the "material" uniform block, which holds the parameters of a material. */
+constexpr auto material_block_binding = 2u;
+
+/**
+ * Handle to a uniform of a specific type in a material, resolved from its name once so setting it is just an OpenGL
+ * call. A default constructed handle refers to no uniform, setting it does nothing.
+ */
+template <class T>
+class Uniform
+{
+  public:
+    /**
+     * Construct a handle which refers to no uniform.
+     */
+    constexpr Uniform()
+        : Uniform(-1)
+    {
+    }
+
+    /**
+     * Construct a handle to a uniform.
+     *
+     * @param location
+     *   Location of the uniform in the program.
+     */
+    constexpr explicit Uniform(::GLint location)
+        : location_(location)
+    {
+    }
+
+    /**
+     * Get the location of the uniform.
+     *
+     * @returns
+     *   Location of the uniform in the program, -1 if the handle refers to no uniform.
+     */
+    constexpr auto location() const -> ::GLint
+    {
+        return location_;
+    }
+
+  private:
+    /** Location of the uniform in the program. */
+    ::GLint location_;
+};
+
+/**
+ * Handle to a member of the parameter block of a material, resolved from its name once so setting it is just a copy.
+ */
+template <class T>
+class MaterialParameter
+{
+  public:
+    /**
+     * Construct a handle to a parameter.
+     *
+     * @param offset
+     *   Offset of the parameter in the block, in bytes.
+     */
+    constexpr explicit MaterialParameter(std::uint32_t offset)
+        : offset_(offset)
+    {
+    }
+
+    /**
+     * Get the offset of the parameter.
+     *
+     * @returns
+     *   Offset of the parameter in the block, in bytes.
+     */
+    constexpr auto offset() const -> std::uint32_t
+    {
+        return offset_;
+    }
+
+  private:
+    /** Offset of the parameter in the block. */
+    std::uint32_t offset_;
+};
+
+}
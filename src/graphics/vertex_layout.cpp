@@ -0,0 +1,113 @@
+#include "graphics/vertex_layout.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <format>
+#include <iterator>
+#include <string>
+
+#include "graphics/vertex_data.h"
+#include "utils/exception.h"
+#include "utils/formatter.h"
+
+namespace game
+{
+
+auto float_vertex_layout() -> VertexLayout
+{
+    return {
+        .stride = sizeof(VertexData),
+        .index_type = IndexType::UINT32,
+        .position_offset = {0.0f},
+        .position_scale = {1.0f},
+        .attributes = {
+            {.location = 0u,
+             .components = 3u,
+             .type = VertexAttributeType::FLOAT,
+             .offset = offsetof(VertexData, position)},
+            {.location = 1u,
+             .components = 3u,
+             .type = VertexAttributeType::FLOAT,
+             .offset = offsetof(VertexData, normal)},
+            {.location = 2u,
+             .components = 3u,
+             .type = VertexAttributeType::FLOAT,
+             .offset = offsetof(VertexData, tangent)},
+            {.location = 3u, .components = 2u, .type = VertexAttributeType::FLOAT, .offset = offsetof(VertexData, uv)},
+        }};
+}
+
+auto index_size(IndexType index_type) -> std::size_t
+{
+    switch (index_type)
+    {
+        using enum IndexType;
+        case UINT16: return sizeof(std::uint16_t);
+        case UINT32: return sizeof(std::uint32_t);
+    }
+
+    throw Exception("unknown index type");
+}
+
+auto component_size(VertexAttributeType type) -> std::size_t
+{
+    switch (type)
+    {
+        using enum VertexAttributeType;
+        case FLOAT: return sizeof(float);
+        case HALF_FLOAT:
+        case UNORM16:
+        case SNORM16: return sizeof(std::uint16_t);
+    }
+
+    throw Exception("unknown vertex attribute type");
+}
+
+auto to_string(VertexAttributeType obj) -> std::string
+{
+    switch (obj)
+    {
+        using enum VertexAttributeType;
+        case FLOAT: return "FLOAT";
+        case HALF_FLOAT: return "HALF_FLOAT";
+        case UNORM16: return "UNORM16";
+        case SNORM16: return "SNORM16";
+    }
+    return "UNKNOWN";
+}
+
+auto to_string(IndexType obj) -> std::string
+{
+    switch (obj)
+    {
+        using enum IndexType;
+        case UINT16: return "UINT16";
+        case UINT32: return "UINT32";
+    }
+    return "UNKNOWN";
+}
+
+auto to_string(const VertexLayout &obj) -> std::string
+{
+    auto str = std::format(
+        "stride={} index_type={} position_offset={} position_scale={}",
+        obj.stride,
+        obj.index_type,
+        obj.position_offset,
+        obj.position_scale);
+
+    for (const auto &attribute : obj.attributes)
+    {
+        std::format_to(
+            std::back_inserter(str),
+            " [{}: {}x{} @{}]",
+            attribute.location,
+            attribute.components,
+            attribute.type,
+            attribute.offset);
+    }
+
+    return str;
+}
+
+}
@@ -0,0 +1,145 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "maths/vector3.h"
+
+namespace game
+{
+
+/**
+ * Enumeration of the component types a vertex attribute can be stored as.
+ */
+enum class VertexAttributeType : std::uint32_t
+{
+    /** 32 bit float. */
+    FLOAT,
+
+    /** 16 bit float. */
+    HALF_FLOAT,
+
+    /** 16 bit unsigned integer, normalised to [0, 1] when read by a shader. */
+    UNORM16,
+
+    /** 16 bit signed integer, normalised to [-1, 1] when read by a shader. */
+    SNORM16
+};
+
+/**
+ * Enumeration of index types.
+ */
+enum class IndexType : std::uint32_t
+{
+    UINT16,
+    UINT32
+};
+
+/**
+ * Description of a single attribute in an interleaved vertex stream.
+ */
+struct VertexAttribute
+{
+    /** Shader location of the attribute. */
+    std::uint32_t location;
+
+    /** Number of components. */
+    std::uint32_t components;
+
+    /** Type of each component. */
+    VertexAttributeType type;
+
+    /** Offset of the attribute from the start of the vertex. */
+    std::uint32_t offset;
+};
+
+/**
+ * Description of an interleaved vertex stream and its indices.
+ *
+ * Quantised positions are in the range [0, 1] (or [-1, 1]) and are mapped back to model space with
+ * position_offset + position * position_scale, see Mesh::dequantisation.
+ */
+struct VertexLayout
+{
+    /** Size of a single vertex in bytes. */
+    std::uint32_t stride;
+
+    /** Type of the indices. */
+    IndexType index_type;
+
+    /** Offset added to (scaled) positions to get model space positions. */
+    Vector3 position_offset;
+
+    /** Scale applied to positions to get model space positions. */
+    Vector3 position_scale;
+
+    /** The attributes in the stream. */
+    std::vector<VertexAttribute> attributes;
+};
+
+/**
+ * Get the layout of a stream of VertexData with 32 bit indices, this is what all unpacked meshes use.
+ *
+ * @returns
+ *   The layout of VertexData.
+ */
+auto float_vertex_layout() -> VertexLayout;
+
+/**
+ * Get the size of a single index.
+ *
+ * @param index_type
+ *   The index type.
+ *
+ * @returns
+ *   Size of an index in bytes.
+ */
+auto index_size(IndexType index_type) -> std::size_t;
+
+/**
+ * Get the size of a single component of an attribute.
+ *
+ * @param type
+ *   The component type.
+ *
+ * @returns
+ *   Size of a component in bytes.
+ */
+auto component_size(VertexAttributeType type) -> std::size_t;
+
+/**
+ * Converts a vertex attribute type to a string.
+ *
+ * @param obj
+ *   The vertex attribute type to convert.
+ *
+ * @returns
+ *   The string representation of the vertex attribute type.
+ */
+auto to_string(VertexAttributeType obj) -> std::string;
+
+/**
+ * Converts an index type to a string.
+ *
+ * @param obj
+ *   The index type to convert.
+ *
+ * @returns
+ *   The string representation of the index type.
+ */
+auto to_string(IndexType obj) -> std::string;
+
+/**
+ * Converts a vertex layout to a string.
+ *
+ * @param obj
+ *   The vertex layout to convert.
+ *
+ * @returns
+ *   The string representation of the vertex layout.
+ */
+auto to_string(const VertexLayout &obj) -> std::string;
+
+}
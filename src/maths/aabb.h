@@ -1,5 +1,9 @@
 #pragma once
 
+#include <algorithm>
+#include <array>
+
+#include "maths/matrix4.h"
 #include "maths/vector3.h"
 
 namespace game
@@ -17,4 +21,43 @@ struct AABB
     Vector3 max;
 };
 
+/**
+ * Transform a box, the result is the smallest axis aligned box which contains the transformed box. Each row of the
+ * matrix contributes its smallest and largest product with the extent of the box on each axis.
+ *
+ * @param aabb
+ *   The box to transform.
+ * @param matrix
+ *   The transform, which must be affine.
+ *
+ * @returns
+ *   The transformed box.
+ */
+inline auto transform(const AABB &aabb, const Matrix4 &matrix) -> AABB
+{
+    const auto min = std::array<float, 3u>{aabb.min.x, aabb.min.y, aabb.min.z};
+    const auto max = std::array<float, 3u>{aabb.max.x, aabb.max.y, aabb.max.z};
+
+    auto result_min = std::array<float, 3u>{matrix[12], matrix[13], matrix[14]};
+    auto result_max = result_min;
+
+    for (auto row = 0u; row < 3u; ++row)
+    {
+        for (auto column = 0u; column < 3u; ++column)
+        {
+            const auto element = matrix[column * 4u + row];
+            const auto a = element * min[column];
+            const auto b = element * max[column];
+
+            result_min[row] += std::min(a, b);
+            result_max[row] += std::max(a, b);
+        }
+    }
+
+    return {
+        .min = {result_min[0], result_min[1], result_min[2]},
+        .max = {result_max[0], result_max[1], result_max[2]},
+    };
+}
+
 }
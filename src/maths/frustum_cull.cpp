@@ -0,0 +1,183 @@
+#include "maths/frustum_cull.h"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+#include "maths/aabb.h"
+#include "maths/frustum_plane.h"
+#include "maths/simd.h"
+#include "maths/vector3.h"
+#include "utils/error.h"
+
+namespace
+{
+
+/** Number of boxes in each register. */
+constexpr auto lane_count = 4u;
+
+/**
+ * A plane ready to be tested against a batch of boxes.
+ */
+struct BatchPlane
+{
+    /** Each component of the normal, splatted across a register. */
+    std::array<game::simd::Float4, 3u> normal;
+
+    /** The distance, splatted across a register. */
+    game::simd::Float4 distance;
+
+    /** For each axis, the components of the corner of every box furthest along the normal. */
+    std::array<const float *, 3u> corner;
+};
+
+}
+
+namespace game
+{
+
+auto intersects_frustum(const AABB &aabb, const std::array<FrustumPlane, 6u> &planes) -> bool
+{
+    for (const auto &plane : planes)
+    {
+        auto positive_vertex = aabb.min;
+        if (plane.normal.x >= 0)
+        {
+            positive_vertex.x = aabb.max.x;
+        }
+        if (plane.normal.y >= 0)
+        {
+            positive_vertex.y = aabb.max.y;
+        }
+        if (plane.normal.z >= 0)
+        {
+            positive_vertex.z = aabb.max.z;
+        }
+
+        if (Vector3::dot(plane.normal, positive_vertex) + plane.distance < 0.0f)
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+AABBArray::AABBArray()
+    : size_{}
+    , min_{}
+    , max_{}
+{
+}
+
+auto AABBArray::push_back(const AABB &aabb) -> void
+{
+    // grow a whole batch at a time, so the last batch can always be loaded in full
+    if (size_ % cull_batch_size == 0u)
+    {
+        for (auto axis = 0u; axis < 3u; ++axis)
+        {
+            min_[axis].resize(size_ + cull_batch_size);
+            max_[axis].resize(size_ + cull_batch_size);
+        }
+    }
+
+    min_[0][size_] = aabb.min.x;
+    min_[1][size_] = aabb.min.y;
+    min_[2][size_] = aabb.min.z;
+    max_[0][size_] = aabb.max.x;
+    max_[1][size_] = aabb.max.y;
+    max_[2][size_] = aabb.max.z;
+
+    ++size_;
+}
+
+auto AABBArray::clear() -> void
+{
+    size_ = 0u;
+
+    for (auto axis = 0u; axis < 3u; ++axis)
+    {
+        min_[axis].clear();
+        max_[axis].clear();
+    }
+}
+
+auto AABBArray::size() const -> std::size_t
+{
+    return size_;
+}
+
+auto AABBArray::min(std::size_t axis) const -> std::span<const float>
+{
+    expect(axis < 3u, "invalid axis: {}", axis);
+    return min_[axis];
+}
+
+auto AABBArray::max(std::size_t axis) const -> std::span<const float>
+{
+    expect(axis < 3u, "invalid axis: {}", axis);
+    return max_[axis];
+}
+
+auto cull(const std::array<FrustumPlane, 6u> &planes, const AABBArray &boxes, std::vector<std::uint64_t> &visible)
+    -> void
+{
+    visible.assign((boxes.size() + 63u) / 64u, 0u);
+
+    // which corner to test only depends on the plane, so it is picked once rather than per box
+    auto batch_planes = std::array<BatchPlane, 6u>{};
+    for (auto i = 0u; i < planes.size(); ++i)
+    {
+        const auto &plane = planes[i];
+        const auto normal = std::array<float, 3u>{plane.normal.x, plane.normal.y, plane.normal.z};
+
+        batch_planes[i].distance = simd::splat(plane.distance);
+
+        for (auto axis = 0u; axis < 3u; ++axis)
+        {
+            batch_planes[i].normal[axis] = simd::splat(normal[axis]);
+            batch_planes[i].corner[axis] = normal[axis] >= 0.0f ? boxes.max(axis).data() : boxes.min(axis).data();
+        }
+    }
+
+    const auto zero = simd::splat(0.0f);
+
+    for (auto first = std::size_t{}; first < boxes.size(); first += cull_batch_size)
+    {
+        auto outside = 0u;
+
+        for (auto lane = 0u; lane < cull_batch_size; lane += lane_count)
+        {
+            const auto offset = first + lane;
+            auto lane_outside = zero;
+
+            for (const auto &plane : batch_planes)
+            {
+                // summed in the same order as Vector3::dot so the result matches intersects_frustum exactly
+                const auto x = simd::mul(plane.normal[0], simd::load(plane.corner[0] + offset));
+                const auto y = simd::mul(plane.normal[1], simd::load(plane.corner[1] + offset));
+                const auto z = simd::mul(plane.normal[2], simd::load(plane.corner[2] + offset));
+                const auto distance = simd::add(simd::add(simd::add(x, y), z), plane.distance);
+
+                lane_outside = simd::bit_or(lane_outside, simd::less(distance, zero));
+            }
+
+            outside |= simd::mask_bits(lane_outside) << lane;
+        }
+
+        auto batch_visible = std::uint64_t{~outside & ((1u << cull_batch_size) - 1u)};
+
+        // the padding after the last box is not visible
+        if (const auto remaining = boxes.size() - first; remaining < cull_batch_size)
+        {
+            batch_visible &= (std::uint64_t{1u} << remaining) - 1u;
+        }
+
+        visible[first / 64u] |= batch_visible << (first % 64u);
+    }
+}
+
+}
@@ -0,0 +1,129 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+#include "maths/aabb.h"
+#include "maths/frustum_plane.h"
+
+namespace game
+{
+
+/** Number of boxes cull tests at once, the arrays in an AABBArray are always padded to a multiple of this. */
+inline constexpr auto cull_batch_size = std::size_t{8u};
+
+/**
+ * Check if a box is at least partially inside a frustum. For each plane only the corner furthest along the normal has
+ * to be tested, if that is behind the plane then the whole box is.
+ *
+ * @param aabb
+ *   The box to test.
+ * @param planes
+ *   The frustum planes, with normals pointing into the frustum.
+ *
+ * @returns
+ *   True if the box intersects the frustum, false if it is entirely outside.
+ */
+auto intersects_frustum(const AABB &aabb, const std::array<FrustumPlane, 6u> &planes) -> bool;
+
+/**
+ * A structure of arrays of boxes, i.e. each component of the corners is stored contiguously so boxes can be loaded
+ * straight into SIMD registers by cull.
+ */
+class AABBArray
+{
+  public:
+    /**
+     * Construct a new empty array.
+     */
+    AABBArray();
+
+    /**
+     * Add a box to the end of the array.
+     *
+     * @param aabb
+     *   The box to add.
+     */
+    auto push_back(const AABB &aabb) -> void;
+
+    /**
+     * Remove all boxes, keeping the allocated memory for reuse.
+     */
+    auto clear() -> void;
+
+    /**
+     * Get the number of boxes.
+     *
+     * @returns
+     *   Number of boxes.
+     */
+    auto size() const -> std::size_t;
+
+    /**
+     * Get the minimum corner components on an axis. The span is padded to a multiple of cull_batch_size.
+     *
+     * @param axis
+     *   The axis, 0 for x, 1 for y and 2 for z.
+     *
+     * @returns
+     *   The components, in the order the boxes were added.
+     */
+    auto min(std::size_t axis) const -> std::span<const float>;
+
+    /**
+     * Get the maximum corner components on an axis. The span is padded to a multiple of cull_batch_size.
+     *
+     * @param axis
+     *   The axis, 0 for x, 1 for y and 2 for z.
+     *
+     * @returns
+     *   The components, in the order the boxes were added.
+     */
+    auto max(std::size_t axis) const -> std::span<const float>;
+
+  private:
+    /** Number of boxes. */
+    std::size_t size_;
+
+    /** Minimum corner components, one array per axis. */
+    std::array<std::vector<float>, 3u> min_;
+
+    /** Maximum corner components, one array per axis. */
+    std::array<std::vector<float>, 3u> max_;
+};
+
+/**
+ * Test every box in an array against a frustum, cull_batch_size boxes at a time with the SIMD backend. The result for
+ * each box is identical to intersects_frustum.
+ *
+ * @param planes
+ *   The frustum planes, with normals pointing into the frustum.
+ * @param boxes
+ *   The boxes to test.
+ * @param visible
+ *   Overwritten with the visibility bitmask, bit (i % 64) of element (i / 64) is set if box i intersects the frustum.
+ *   Passed in so the memory can be reused across frames.
+ */
+auto cull(const std::array<FrustumPlane, 6u> &planes, const AABBArray &boxes, std::vector<std::uint64_t> &visible)
+    -> void;
+
+/**
+ * Check a bit in a visibility bitmask written by cull.
+ *
+ * @param visible
+ *   The bitmask.
+ * @param index
+ *   Index of the box.
+ *
+ * @returns
+ *   True if the box is visible.
+ */
+inline auto is_visible(std::span<const std::uint64_t> visible, std::size_t index) -> bool
+{
+    return ((visible[index / 64u] >> (index % 64u)) & 1u) != 0u;
+}
+
+}
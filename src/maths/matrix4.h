@@ -6,6 +6,7 @@
 #include <span>
 
 #include "maths/quaternion.h"
+#include "maths/simd.h"
 #include "maths/vector3.h"
 #include "maths/vector4.h"
 #include "utils/error.h"
@@ -15,6 +16,9 @@ namespace game
 
 /**
  * A 4x4 matrix. Elements are stored in column-major order, i.e. the same as OpenGL expects.
+ *
+ * The products are constexpr and evaluated with scalar code at compile time, at runtime they use the SIMD backend (see
+ * simd.h) which gives the same results.
  */
 class Matrix4
 {
@@ -181,6 +185,32 @@ class Matrix4
         elements_[10] = 1.0f - 2.0f * rotation.x * rotation.x - 2.0f * rotation.y * rotation.y;
     }
 
+    /**
+     * Construct a translation, rotation and scale matrix. This is the same as multiplying the three matrices (in that
+     * order) but far cheaper, as only the rotation columns need scaling.
+     *
+     * @param translation
+     *   The translation vector.
+     * @param rotation
+     *   The rotation quaternion.
+     * @param scale
+     *   The scale vector.
+     */
+    constexpr Matrix4(const Vector3 &translation, const Quaternion &rotation, const Vector3 &scale)
+        : Matrix4{rotation}
+    {
+        for (auto i = 0u; i < 3u; ++i)
+        {
+            elements_[i] *= scale.x;
+            elements_[i + 4u] *= scale.y;
+            elements_[i + 8u] *= scale.z;
+        }
+
+        elements_[12] = translation.x;
+        elements_[13] = translation.y;
+        elements_[14] = translation.z;
+    }
+
     /**
      * Construct a look at (view) matrix.
      *
@@ -215,6 +245,19 @@ class Matrix4
      */
     static auto perspective(float fov, float width, float height, float near_plane, float far_plane) -> Matrix4;
 
+    /**
+     * Invert an affine matrix (i.e. one whose last row is (0, 0, 0, 1), such as any combination of translation,
+     * rotation and scale). This is much cheaper than a general inverse. It is undefined behaviour if the matrix is not
+     * affine or is singular.
+     *
+     * @param m
+     *   The matrix to invert.
+     *
+     * @returns
+     *   The inverted matrix.
+     */
+    static constexpr auto invert_affine(const Matrix4 &m) -> Matrix4;
+
     /**
      * Get the elements of the matrix.
      *
@@ -279,21 +322,29 @@ class Matrix4
 
 constexpr auto operator*=(Matrix4 &m1, const Matrix4 &m2) -> Matrix4 &
 {
-    auto result = Matrix4{};
-    for (auto i = 0u; i < 4u; ++i)
+    if consteval
     {
-        for (auto j = 0u; j < 4u; ++j)
+        auto result = Matrix4{};
+        for (auto i = 0u; i < 4u; ++i)
         {
-            auto sum = 0.0f;
-            for (auto k = 0u; k < 4u; ++k)
+            for (auto j = 0u; j < 4u; ++j)
             {
-                sum += m1.elements_[i + k * 4] * m2.elements_[k + j * 4];
+                auto sum = 0.0f;
+                for (auto k = 0u; k < 4u; ++k)
+                {
+                    sum += m1.elements_[i + k * 4] * m2.elements_[k + j * 4];
+                }
+                result.elements_[i + j * 4] = sum;
             }
-            result.elements_[i + j * 4] = sum;
         }
+
+        m1 = result;
+    }
+    else
+    {
+        simd::multiply(m1.elements_.data(), m2.elements_.data(), m1.elements_.data());
     }
 
-    m1 = result;
     return m1;
 }
 
@@ -303,6 +354,80 @@ constexpr auto operator*(const Matrix4 &m1, const Matrix4 &m2) -> Matrix4
     return tmp *= m2;
 }
 
+constexpr auto operator*(const Matrix4 &m, const Vector4 &v) -> Vector4
+{
+    const auto elements = m.data();
+    const auto components = std::array<float, 4u>{v.x, v.y, v.z, v.w};
+    auto result = std::array<float, 4u>{};
+
+    if consteval
+    {
+        for (auto i = 0u; i < 4u; ++i)
+        {
+            auto sum = 0.0f;
+            for (auto k = 0u; k < 4u; ++k)
+            {
+                sum += elements[i + k * 4] * components[k];
+            }
+            result[i] = sum;
+        }
+    }
+    else
+    {
+        result = simd::lanes(simd::transform(elements.data(), components.data()));
+    }
+
+    return {result[0], result[1], result[2], result[3]};
+}
+
+constexpr auto Matrix4::invert_affine(const Matrix4 &m) -> Matrix4
+{
+    auto inverse = Matrix4{};
+
+    if consteval
+    {
+        const auto &e = m.elements_;
+        const auto a = Vector3{e[0], e[1], e[2]};
+        const auto b = Vector3{e[4], e[5], e[6]};
+        const auto c = Vector3{e[8], e[9], e[10]};
+        const auto t = Vector3{e[12], e[13], e[14]};
+
+        // rows of the inverse of the upper 3x3
+        const auto bc = Vector3::cross(b, c);
+        const auto determinant = Vector3::dot(a, bc);
+        const auto divide = [determinant](const Vector3 &v)
+        { return Vector3{v.x / determinant, v.y / determinant, v.z / determinant}; };
+
+        const auto r0 = divide(bc);
+        const auto r1 = divide(Vector3::cross(c, a));
+        const auto r2 = divide(Vector3::cross(a, b));
+
+        inverse.elements_ = {
+            {r0.x,
+             r1.x,
+             r2.x,
+             0.0f,
+             r0.y,
+             r1.y,
+             r2.y,
+             0.0f,
+             r0.z,
+             r1.z,
+             r2.z,
+             0.0f,
+             -Vector3::dot(r0, t),
+             -Vector3::dot(r1, t),
+             -Vector3::dot(r2, t),
+             1.0f}};
+    }
+    else
+    {
+        simd::invert_affine(m.elements_.data(), inverse.elements_.data());
+    }
+
+    return inverse;
+}
+
 inline auto Matrix4::look_at(const Vector3 &eye, const Vector3 &look_at, const Vector3 &up) -> Matrix4
 {
     const auto f = Vector3::normalise(look_at - eye);
@@ -0,0 +1,415 @@
+#pragma once
+
+#include <array>
+#include <bit>
+#include <cstdint>
+#include <string_view>
+
+// the backend is picked at compile time, define GAME_SIMD_SCALAR to force the portable fallback (e.g. to compare)
+#if !defined(GAME_SIMD_SCALAR) && (defined(_M_X64) || defined(__SSE2__))
+#define GAME_SIMD_SSE
+#include <emmintrin.h>
+#elif !defined(GAME_SIMD_SCALAR) && (defined(_M_ARM64) || defined(__aarch64__))
+// 32 bit arm also defines __ARM_NEON but lacks vdivq_f32 and vaddvq_u32, so it gets the fallback
+#define GAME_SIMD_NEON
+#include <arm_neon.h>
+#endif
+
+/**
+ * Four wide float operations for the hot maths paths, used by the maths types for anything evaluated at runtime (the
+ * constexpr scalar versions are used for constant evaluation).
+ *
+ * Every operation does exactly the same float arithmetic, in the same order, as the scalar code it replaces (there is
+ * no fused multiply add and no reassociation) so the results are bit identical other than the sign of a zero sum.
+ */
+namespace game::simd
+{
+
+// each backend provides a Float4 and the same lane wise primitives: load and store (both unaligned), set, splat, add,
+// sub, mul, div and yzx (which rotates the first three lanes, i.e. (x y z w) -> (y z x w))
+//
+// comparisons produce a lane mask (every bit of a lane set if the comparison is true, clear otherwise) which can be
+// combined with bit_or and reduced with mask_bits (which returns the lanes that are set as the low four bits)
+
+#if defined(GAME_SIMD_SSE)
+
+/** Name of the backend in use. */
+inline constexpr auto backend = std::string_view{"sse"};
+
+/** Four floats in a register. */
+using Float4 = __m128;
+
+inline auto load(const float *data) -> Float4
+{
+    return _mm_loadu_ps(data);
+}
+
+inline auto set(float x, float y, float z, float w) -> Float4
+{
+    return _mm_setr_ps(x, y, z, w);
+}
+
+inline auto splat(float value) -> Float4
+{
+    return _mm_set1_ps(value);
+}
+
+inline auto store(Float4 v, float *data) -> void
+{
+    _mm_storeu_ps(data, v);
+}
+
+inline auto add(Float4 a, Float4 b) -> Float4
+{
+    return _mm_add_ps(a, b);
+}
+
+inline auto sub(Float4 a, Float4 b) -> Float4
+{
+    return _mm_sub_ps(a, b);
+}
+
+inline auto mul(Float4 a, Float4 b) -> Float4
+{
+    return _mm_mul_ps(a, b);
+}
+
+inline auto div(Float4 a, Float4 b) -> Float4
+{
+    return _mm_div_ps(a, b);
+}
+
+inline auto yzx(Float4 v) -> Float4
+{
+    return _mm_shuffle_ps(v, v, _MM_SHUFFLE(3, 0, 2, 1));
+}
+
+inline auto less(Float4 a, Float4 b) -> Float4
+{
+    return _mm_cmplt_ps(a, b);
+}
+
+inline auto bit_or(Float4 a, Float4 b) -> Float4
+{
+    return _mm_or_ps(a, b);
+}
+
+inline auto mask_bits(Float4 mask) -> std::uint32_t
+{
+    return static_cast<std::uint32_t>(_mm_movemask_ps(mask));
+}
+
+#elif defined(GAME_SIMD_NEON)
+
+/** Name of the backend in use. */
+inline constexpr auto backend = std::string_view{"neon"};
+
+/** Four floats in a register. */
+using Float4 = float32x4_t;
+
+inline auto load(const float *data) -> Float4
+{
+    return vld1q_f32(data);
+}
+
+inline auto set(float x, float y, float z, float w) -> Float4
+{
+    const auto data = std::array<float, 4u>{x, y, z, w};
+    return vld1q_f32(data.data());
+}
+
+inline auto splat(float value) -> Float4
+{
+    return vdupq_n_f32(value);
+}
+
+inline auto store(Float4 v, float *data) -> void
+{
+    vst1q_f32(data, v);
+}
+
+inline auto add(Float4 a, Float4 b) -> Float4
+{
+    return vaddq_f32(a, b);
+}
+
+inline auto sub(Float4 a, Float4 b) -> Float4
+{
+    return vsubq_f32(a, b);
+}
+
+inline auto mul(Float4 a, Float4 b) -> Float4
+{
+    return vmulq_f32(a, b);
+}
+
+inline auto div(Float4 a, Float4 b) -> Float4
+{
+    return vdivq_f32(a, b);
+}
+
+inline auto yzx(Float4 v) -> Float4
+{
+    // (y z w x) with w and x swapped back
+    const auto rotated = vextq_f32(v, v, 1);
+    return vsetq_lane_f32(vgetq_lane_f32(v, 3), vsetq_lane_f32(vgetq_lane_f32(v, 0), rotated, 2), 3);
+}
+
+inline auto less(Float4 a, Float4 b) -> Float4
+{
+    return vreinterpretq_f32_u32(vcltq_f32(a, b));
+}
+
+inline auto bit_or(Float4 a, Float4 b) -> Float4
+{
+    return vreinterpretq_f32_u32(vorrq_u32(vreinterpretq_u32_f32(a), vreinterpretq_u32_f32(b)));
+}
+
+inline auto mask_bits(Float4 mask) -> std::uint32_t
+{
+    // there is no movemask, so keep the top bit of each lane and weight it by the lane index
+    const auto weights = std::array<std::uint32_t, 4u>{1u, 2u, 4u, 8u};
+    const auto top = vshrq_n_u32(vreinterpretq_u32_f32(mask), 31);
+    return vaddvq_u32(vmulq_u32(top, vld1q_u32(weights.data())));
+}
+
+#else
+
+/** Name of the backend in use. */
+inline constexpr auto backend = std::string_view{"scalar"};
+
+/** Four floats, for targets without a supported instruction set. */
+struct Float4
+{
+    std::array<float, 4u> lanes;
+};
+
+inline auto load(const float *data) -> Float4
+{
+    return {{data[0], data[1], data[2], data[3]}};
+}
+
+inline auto set(float x, float y, float z, float w) -> Float4
+{
+    return {{x, y, z, w}};
+}
+
+inline auto splat(float value) -> Float4
+{
+    return {{value, value, value, value}};
+}
+
+inline auto store(Float4 v, float *data) -> void
+{
+    for (auto i = 0u; i < 4u; ++i)
+    {
+        data[i] = v.lanes[i];
+    }
+}
+
+inline auto add(Float4 a, Float4 b) -> Float4
+{
+    return {{a.lanes[0] + b.lanes[0], a.lanes[1] + b.lanes[1], a.lanes[2] + b.lanes[2], a.lanes[3] + b.lanes[3]}};
+}
+
+inline auto sub(Float4 a, Float4 b) -> Float4
+{
+    return {{a.lanes[0] - b.lanes[0], a.lanes[1] - b.lanes[1], a.lanes[2] - b.lanes[2], a.lanes[3] - b.lanes[3]}};
+}
+
+inline auto mul(Float4 a, Float4 b) -> Float4
+{
+    return {{a.lanes[0] * b.lanes[0], a.lanes[1] * b.lanes[1], a.lanes[2] * b.lanes[2], a.lanes[3] * b.lanes[3]}};
+}
+
+inline auto div(Float4 a, Float4 b) -> Float4
+{
+    return {{a.lanes[0] / b.lanes[0], a.lanes[1] / b.lanes[1], a.lanes[2] / b.lanes[2], a.lanes[3] / b.lanes[3]}};
+}
+
+inline auto yzx(Float4 v) -> Float4
+{
+    return {{v.lanes[1], v.lanes[2], v.lanes[0], v.lanes[3]}};
+}
+
+inline auto less(Float4 a, Float4 b) -> Float4
+{
+    auto result = Float4{};
+    for (auto i = 0u; i < 4u; ++i)
+    {
+        result.lanes[i] = std::bit_cast<float>(a.lanes[i] < b.lanes[i] ? 0xffffffffu : 0u);
+    }
+
+    return result;
+}
+
+inline auto bit_or(Float4 a, Float4 b) -> Float4
+{
+    auto result = Float4{};
+    for (auto i = 0u; i < 4u; ++i)
+    {
+        result.lanes[i] =
+            std::bit_cast<float>(std::bit_cast<std::uint32_t>(a.lanes[i]) | std::bit_cast<std::uint32_t>(b.lanes[i]));
+    }
+
+    return result;
+}
+
+inline auto mask_bits(Float4 mask) -> std::uint32_t
+{
+    auto bits = 0u;
+    for (auto i = 0u; i < 4u; ++i)
+    {
+        bits |= (std::bit_cast<std::uint32_t>(mask.lanes[i]) >> 31u) << i;
+    }
+
+    return bits;
+}
+
+#endif
+
+/**
+ * Get the lanes of a register.
+ *
+ * @param v
+ *   The register.
+ *
+ * @returns
+ *   The lanes, in order.
+ */
+inline auto lanes(Float4 v) -> std::array<float, 4u>
+{
+    auto result = std::array<float, 4u>{};
+    store(v, result.data());
+    return result;
+}
+
+/**
+ * Dot product of the first three lanes. The lanes are summed in order so the result matches the scalar dot product.
+ *
+ * @param a
+ *   The first vector.
+ * @param b
+ *   The second vector.
+ *
+ * @returns
+ *   The dot product.
+ */
+inline auto dot3(Float4 a, Float4 b) -> float
+{
+    const auto product = lanes(mul(a, b));
+    return product[0] + product[1] + product[2];
+}
+
+/**
+ * Cross product of the first three lanes.
+ *
+ * @param a
+ *   The first vector.
+ * @param b
+ *   The second vector.
+ *
+ * @returns
+ *   The cross product, the last lane is zero if it is in both inputs.
+ */
+inline auto cross(Float4 a, Float4 b) -> Float4
+{
+    return yzx(sub(mul(a, yzx(b)), mul(yzx(a), b)));
+}
+
+/**
+ * Transform a vector by a column major 4x4 matrix, i.e. sum the columns weighted by the components of the vector.
+ *
+ * @param m
+ *   The 16 elements of the matrix.
+ * @param v
+ *   The 4 components of the vector.
+ *
+ * @returns
+ *   The transformed vector.
+ */
+inline auto transform(const float *m, const float *v) -> Float4
+{
+    auto result = mul(load(m), splat(v[0]));
+    result = add(result, mul(load(m + 4), splat(v[1])));
+    result = add(result, mul(load(m + 8), splat(v[2])));
+    return add(result, mul(load(m + 12), splat(v[3])));
+}
+
+/**
+ * Multiply two column major 4x4 matrices, each column of the result is a column of the second matrix transformed by
+ * the first.
+ *
+ * @param m1
+ *   The 16 elements of the left matrix.
+ * @param m2
+ *   The 16 elements of the right matrix.
+ * @param result
+ *   Where to write the 16 elements of the product, may alias either input.
+ */
+inline auto multiply(const float *m1, const float *m2, float *result) -> void
+{
+    const auto c0 = transform(m1, m2);
+    const auto c1 = transform(m1, m2 + 4);
+    const auto c2 = transform(m1, m2 + 8);
+    const auto c3 = transform(m1, m2 + 12);
+
+    store(c0, result);
+    store(c1, result + 4);
+    store(c2, result + 8);
+    store(c3, result + 12);
+}
+
+/**
+ * Invert a column major 4x4 affine matrix, i.e. one whose last row is (0, 0, 0, 1). The rows of the inverse of the
+ * upper 3x3 are the cross products of its columns over the determinant, which is far cheaper than a general inverse.
+ *
+ * @param m
+ *   The 16 elements of the matrix.
+ * @param result
+ *   Where to write the 16 elements of the inverse, may alias the input.
+ */
+inline auto invert_affine(const float *m, float *result) -> void
+{
+    const auto a = set(m[0], m[1], m[2], 0.0f);
+    const auto b = set(m[4], m[5], m[6], 0.0f);
+    const auto c = set(m[8], m[9], m[10], 0.0f);
+    const auto t = set(m[12], m[13], m[14], 0.0f);
+
+    const auto bc = cross(b, c);
+    const auto determinant = splat(dot3(a, bc));
+
+    const auto r0 = div(bc, determinant);
+    const auto r1 = div(cross(c, a), determinant);
+    const auto r2 = div(cross(a, b), determinant);
+
+    // the inverse is column major so the rows have to be scattered
+    const auto row0 = lanes(r0);
+    const auto row1 = lanes(r1);
+    const auto row2 = lanes(r2);
+
+    const auto inverse = std::array<float, 16u>{
+        row0[0],
+        row1[0],
+        row2[0],
+        0.0f,
+        row0[1],
+        row1[1],
+        row2[1],
+        0.0f,
+        row0[2],
+        row1[2],
+        row2[2],
+        0.0f,
+        -dot3(r0, t),
+        -dot3(r1, t),
+        -dot3(r2, t),
+        1.0f};
+
+    for (auto i = 0u; i < inverse.size(); ++i)
+    {
+        result[i] = inverse[i];
+    }
+}
+
+}
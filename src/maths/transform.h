@@ -19,7 +19,7 @@ class Transform
 
     constexpr operator Matrix4() const
     {
-        return Matrix4{position} * Matrix4{rotation} * Matrix4{scale, Matrix4::Scale{}};
+        return Matrix4{position, rotation, scale};
     }
 
     Vector3 position;
@@ -3,6 +3,7 @@
 #include <cmath>
 #include <format>
 
+#include "maths/simd.h"
 #include "maths/vector4.h"
 #include "utils/error.h"
 
@@ -56,7 +57,8 @@ struct Vector3
     }
 
     /**
-     * Get the length of the vector.
+     * Get the length of the vector. This does not guard against overflow, like std::hypot does, as that is far
+     * slower and not needed for any value a game will see.
      *
      * @returns
      *   The length of the vector.
@@ -188,7 +190,7 @@ constexpr auto operator-(const Vector3 &v) -> Vector3
 
 inline auto Vector3::length() const -> float
 {
-    return std::hypot(x, y, z);
+    return std::sqrt(dot(*this, *this));
 }
 
 inline auto Vector3::normalise(const Vector3 &v) -> Vector3
@@ -196,21 +198,38 @@ inline auto Vector3::normalise(const Vector3 &v) -> Vector3
     const auto l = v.length();
     expect(l != 0.0f, "cannot normalise a zero vector");
 
-    return {v.x / l, v.y / l, v.z / l};
+    const auto normalised = simd::lanes(simd::div(simd::set(v.x, v.y, v.z, 0.0f), simd::splat(l)));
+    return {normalised[0], normalised[1], normalised[2]};
 }
 
 constexpr auto Vector3::cross(const Vector3 &v1, const Vector3 &v2) -> Vector3
 {
-    const auto i = (v1.y * v2.z) - (v1.z * v2.y);
-    const auto j = (v1.x * v2.z) - (v1.z * v2.x);
-    const auto k = (v1.x * v2.y) - (v1.y * v2.x);
+    if consteval
+    {
+        const auto i = (v1.y * v2.z) - (v1.z * v2.y);
+        const auto j = (v1.x * v2.z) - (v1.z * v2.x);
+        const auto k = (v1.x * v2.y) - (v1.y * v2.x);
 
-    return {i, -j, k};
+        return {i, -j, k};
+    }
+    else
+    {
+        const auto result =
+            simd::lanes(simd::cross(simd::set(v1.x, v1.y, v1.z, 0.0f), simd::set(v2.x, v2.y, v2.z, 0.0f)));
+        return {result[0], result[1], result[2]};
+    }
 }
 
 constexpr auto Vector3::dot(const Vector3 &v1, const Vector3 &v2) -> float
 {
-    return v1.x * v2.x + v1.y * v2.y + v1.z * v2.z;
+    if consteval
+    {
+        return v1.x * v2.x + v1.y * v2.y + v1.z * v2.z;
+    }
+    else
+    {
+        return simd::dot3(simd::set(v1.x, v1.y, v1.z, 0.0f), simd::set(v2.x, v2.y, v2.z, 0.0f));
+    }
 }
 
 inline auto Vector3::distance(const Vector3 &v1, const Vector3 &v2) -> float
@@ -0,0 +1,313 @@
+#include "resources/async_loader.h"
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <functional>
+#include <future>
+#include <mutex>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "graphics/cube_map.h"
+#include "graphics/mesh.h"
+#include "graphics/shader.h"
+#include "graphics/texture.h"
+#include "resources/file.h"
+#include "resources/resource_loader.h"
+#include "tlv/tlv_archive.h"
+#include "tlv/tlv_compression.h"
+#include "tlv/tlv_entry.h"
+#include "tlv/tlv_reader.h"
+#include "utils/error.h"
+
+namespace
+{
+
+/** Granularity to touch memory at when paging it in, the smallest page size we run on. */
+constexpr auto page_size = std::size_t{4096u};
+
+/**
+ * The result of preparing something which may have been decompressed, the value may view into the staging copies so
+ * they are kept together. Staging buffers own their copy on the heap, so moving them does not invalidate any views.
+ */
+template <class T>
+struct Staged
+{
+    /** Staging copies of any compressed entries. */
+    std::vector<game::TLVStagingBuffer> staging;
+
+    /** The prepared value. */
+    T value;
+};
+
+/**
+ * Fault in a range of a memory mapped file, so the main thread does not stall on io when it reads it.
+ *
+ * @param data
+ *   The data to page in.
+ */
+auto page_in(std::span<const std::byte> data) -> void
+{
+    auto checksum = std::byte{};
+
+    for (auto offset = std::size_t{}; offset < data.size(); offset += page_size)
+    {
+        checksum ^= data[offset];
+    }
+
+    // stop the reads being optimised away
+    [[maybe_unused]] volatile auto sink = checksum;
+}
+
+/**
+ * Fault in all the members of a composite entry. The members are paged in individually, rather than the value of the
+ * entry, as a deduplicated archive stores the payloads outside of the entry.
+ *
+ * @param entry
+ *   The entry to page in.
+ */
+auto page_in(const game::TLVEntry &entry) -> void
+{
+    for (const auto &member : entry.members())
+    {
+        page_in(member.value());
+    }
+}
+
+/**
+ * Find an entry in an archive and page it in.
+ *
+ * @param archive
+ *   The archive to search.
+ * @param name
+ *   Name of the entry.
+ * @param type
+ *   Type of the entry.
+ *
+ * @returns
+ *   The entry.
+ */
+auto find_and_page_in(const game::TLVArchive &archive, std::string_view name, game::TLVType type) -> game::TLVEntry
+{
+    const auto entry = archive.find(name, type);
+    game::ensure(entry.has_value(), "could not find {} {}", type, name);
+
+    page_in(*entry);
+
+    return *entry;
+}
+
+}
+
+namespace game
+{
+
+AsyncLoader::AsyncLoader(const ResourceLoader &resource_loader, std::size_t thread_count)
+    : resource_loader_(resource_loader)
+    , mutex_()
+    , main_thread_tasks_()
+    , callbacks_()
+    , pool_(thread_count, static_cast<std::size_t>(LoadPriority::BACKGROUND) + 1u)
+{
+}
+
+auto AsyncLoader::load_file(std::string_view name, LoadPriority priority, const MappingOptions &options)
+    -> std::future<File>
+{
+    return pool_.submit(
+        static_cast<std::size_t>(priority),
+        [this, name = std::string{name}, options]
+        {
+            auto file = resource_loader_.load(name, options);
+            file.prefetch(file.as_data());
+            return file;
+        });
+}
+
+auto AsyncLoader::load_shader(std::string_view name, ShaderType type, LoadPriority priority) -> std::future<Shader>
+{
+    return load(
+        priority,
+        [this, name = std::string{name}]
+        {
+            auto file = resource_loader_.load(name);
+            page_in(file.as_data());
+            return file;
+        },
+        [type](File file) { return Shader{file.as_string(), type}; });
+}
+
+auto AsyncLoader::load_texture(
+    const TLVArchive &archive,
+    std::string_view name,
+    const Sampler *sampler,
+    LoadPriority priority) -> std::future<Texture>
+{
+    return load(
+        priority,
+        [this, &archive, name = std::string{name}, priority]
+        {
+            // the view (and its validation) is all the parsing a texture needs, the data is already in its final format
+            // once decompressed
+            const auto entry = find_and_page_in(archive, name, TLVType::TEXTURE_DESCRIPTION);
+            auto prepared = Staged<TextureDescriptionView>{};
+
+            if (auto staging = decompress(entry, priority); staging)
+            {
+                prepared.value = staging->entry().texture_description_view();
+                prepared.staging.push_back(std::move(*staging));
+            }
+            else
+            {
+                prepared.value = entry.texture_description_view();
+            }
+
+            return prepared;
+        },
+        [sampler](const Staged<TextureDescriptionView> &prepared) { return Texture{prepared.value, sampler}; });
+}
+
+auto AsyncLoader::load_mesh(const TLVArchive &archive, std::string_view name, LoadPriority priority)
+    -> std::future<Mesh>
+{
+    return load(
+        priority,
+        [this, &archive, name = std::string{name}, priority]
+        {
+            // the mesh may be in either format, which Mesh will work out again (finding by index is cheap) so unless it
+            // needs decompressing all that is needed here is to get the data resident
+            const auto packed = archive.find(name, TLVType::PACKED_MESH_DATA);
+            const auto entry = packed ? *packed : find_and_page_in(archive, name, TLVType::MESH_DATA);
+            if (packed)
+            {
+                page_in(entry);
+            }
+
+            auto prepared = Staged<std::string>{.staging = {}, .value = name};
+            if (auto staging = decompress(entry, priority); staging)
+            {
+                prepared.staging.push_back(std::move(*staging));
+            }
+
+            return prepared;
+        },
+        [&archive](const Staged<std::string> &prepared)
+        {
+            if (prepared.staging.empty())
+            {
+                return Mesh{archive, prepared.value};
+            }
+
+            const auto entry = prepared.staging.front().entry();
+            return entry.type() == TLVType::PACKED_MESH_DATA ? Mesh{entry.packed_mesh_value()}
+                                                             : Mesh{entry.mesh_value()};
+        });
+}
+
+auto AsyncLoader::load_cube_map(
+    const TLVArchive &archive,
+    const std::array<std::string_view, 6u> &image_names,
+    LoadPriority priority) -> std::future<CubeMap>
+{
+    auto names = std::array<std::string, 6u>{};
+    std::ranges::copy(image_names, std::ranges::begin(names));
+
+    return load(
+        priority,
+        [this, &archive, names, priority]
+        {
+            auto prepared = Staged<std::array<TextureDescriptionView, 6u>>{};
+
+            for (auto index = 0u; index < names.size(); ++index)
+            {
+                const auto entry = find_and_page_in(archive, names[index], TLVType::TEXTURE_DESCRIPTION);
+
+                if (auto staging = decompress(entry, priority); staging)
+                {
+                    prepared.value[index] = staging->entry().texture_description_view();
+                    prepared.staging.push_back(std::move(*staging));
+                }
+                else
+                {
+                    prepared.value[index] = entry.texture_description_view();
+                }
+            }
+
+            return prepared;
+        },
+        [](const Staged<std::array<TextureDescriptionView, 6u>> &prepared) { return CubeMap{prepared.value}; });
+}
+
+auto AsyncLoader::decompress(const TLVEntry &entry, LoadPriority priority) -> std::optional<TLVStagingBuffer>
+{
+    if (!entry.is_compressed())
+    {
+        return std::nullopt;
+    }
+
+    auto staging = TLVStagingBuffer{entry};
+
+    // this runs on a worker, which takes chunks itself rather than blocking on the others
+    pool_.parallel_for(
+        static_cast<std::size_t>(priority),
+        staging.chunk_count(),
+        [&staging](auto index) { staging.decompress_chunk(index); });
+
+    return staging;
+}
+
+auto AsyncLoader::run_on_main_thread(std::move_only_function<void()> task) -> void
+{
+    const auto lock = std::scoped_lock{mutex_};
+    main_thread_tasks_.push(std::move(task));
+}
+
+auto AsyncLoader::pump(std::chrono::nanoseconds budget) -> std::size_t
+{
+    const auto start = std::chrono::steady_clock::now();
+    auto count = std::size_t{};
+
+    // always run at least one task, so progress is made even with a tiny budget
+    do
+    {
+        auto task = std::move_only_function<void()>{};
+
+        {
+            const auto lock = std::scoped_lock{mutex_};
+            if (main_thread_tasks_.empty())
+            {
+                break;
+            }
+
+            task = std::move(main_thread_tasks_.front());
+            main_thread_tasks_.pop();
+        }
+
+        task();
+        ++count;
+    } while (std::chrono::steady_clock::now() - start < budget);
+
+    // callbacks may register more callbacks, so run them from a copy and put back the ones still waiting
+    auto callbacks = std::exchange(callbacks_, {});
+    for (auto &callback : callbacks)
+    {
+        if (callback())
+        {
+            ++count;
+        }
+        else
+        {
+            callbacks_.push_back(std::move(callback));
+        }
+    }
+
+    return count;
+}
+
+}
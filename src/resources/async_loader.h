@@ -0,0 +1,311 @@
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <queue>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "graphics/cube_map.h"
+#include "graphics/mesh.h"
+#include "graphics/shader.h"
+#include "graphics/texture.h"
+#include "resources/file.h"
+#include "resources/resource_loader.h"
+#include "utils/thread_pool.h"
+
+namespace game
+{
+
+class Sampler;
+class TLVArchive;
+class TLVEntry;
+class TLVStagingBuffer;
+
+/**
+ * Enumeration of load priorities, workers always take the most urgent work first.
+ */
+enum class LoadPriority : std::uint32_t
+{
+    /** Something is (or is about to be) waiting on the load. */
+    BLOCKING,
+
+    /** Needed before the current level can start. */
+    LEVEL_CRITICAL,
+
+    /** Speculative loads, e.g. for the next level. */
+    BACKGROUND
+};
+
+/**
+ * Loads resources in the background.
+ *
+ * Loads are split into two stages:
+ *  - prepare: runs on a worker thread, does all the file io, parsing and validation
+ *  - create: runs on the main thread during pump(), does the minimal work that has to happen there (i.e. creating
+ *    OpenGL objects)
+ *
+ * Results are delivered through futures, which can be waited on with wait() or handed to then() for a completion
+ * callback. pump(), wait() and then() must only be called from the thread that owns the OpenGL context.
+ *
+ * Anything passed by reference (e.g. a TLVArchive) must outlive the loads using it.
+ *
+ * Compressed archive entries are decompressed during prepare, with the chunks spread over all the workers, into a
+ * staging copy which is handed to create. Uncompressed entries are still viewed in place.
+ */
+class AsyncLoader
+{
+  public:
+    /**
+     * Construct a new async loader.
+     *
+     * @param resource_loader
+     *   Loader to load files with, must outlive this object.
+     * @param thread_count
+     *   Number of worker threads.
+     */
+    AsyncLoader(const ResourceLoader &resource_loader, std::size_t thread_count);
+
+    /**
+     * Load a file on a worker thread. The whole file is prefetched.
+     *
+     * @param name
+     *   Name of the file to load.
+     * @param priority
+     *   Priority of the load.
+     * @param options
+     *   Hints for how to map the file.
+     *
+     * @returns
+     *   Future for the file.
+     */
+    auto load_file(std::string_view name, LoadPriority priority, const MappingOptions &options = {})
+        -> std::future<File>;
+
+    /**
+     * Load and compile a shader, only the compilation happens on the main thread.
+     *
+     * @param name
+     *   Name of the shader source file.
+     * @param type
+     *   The type of the shader.
+     * @param priority
+     *   Priority of the load.
+     *
+     * @returns
+     *   Future for the shader.
+     */
+    auto load_shader(std::string_view name, ShaderType type, LoadPriority priority) -> std::future<Shader>;
+
+    /**
+     * Load a texture from an archive, only the upload happens on the main thread.
+     *
+     * @param archive
+     *   Archive to load from.
+     * @param name
+     *   Name of the texture.
+     * @param sampler
+     *   Sampler for the texture.
+     * @param priority
+     *   Priority of the load.
+     *
+     * @returns
+     *   Future for the texture.
+     */
+    auto load_texture(const TLVArchive &archive, std::string_view name, const Sampler *sampler, LoadPriority priority)
+        -> std::future<Texture>;
+
+    /**
+     * Load a mesh from an archive, only the upload happens on the main thread.
+     *
+     * @param archive
+     *   Archive to load from.
+     * @param name
+     *   Name of the mesh.
+     * @param priority
+     *   Priority of the load.
+     *
+     * @returns
+     *   Future for the mesh.
+     */
+    auto load_mesh(const TLVArchive &archive, std::string_view name, LoadPriority priority) -> std::future<Mesh>;
+
+    /**
+     * Load a cube map from an archive, only the upload happens on the main thread.
+     *
+     * @param archive
+     *   Archive to load from.
+     * @param image_names
+     *   Names of the six faces, in the order expected by CubeMap.
+     * @param priority
+     *   Priority of the load.
+     *
+     * @returns
+     *   Future for the cube map.
+     */
+    auto load_cube_map(
+        const TLVArchive &archive,
+        const std::array<std::string_view, 6u> &image_names,
+        LoadPriority priority) -> std::future<CubeMap>;
+
+    /**
+     * Generic two stage load, see class description. Any exception thrown by either stage is stored in the returned
+     * future.
+     *
+     * @param priority
+     *   Priority of the load.
+     * @param prepare
+     *   Run on a worker thread, must return a value which is then passed to create.
+     * @param create
+     *   Run on the main thread with the result of prepare.
+     *
+     * @returns
+     *   Future for the result of create.
+     */
+    template <class Prepare, class Create>
+    auto load(LoadPriority priority, Prepare prepare, Create create)
+        -> std::future<std::invoke_result_t<Create, std::invoke_result_t<Prepare>>>
+    {
+        using Result = std::invoke_result_t<Create, std::invoke_result_t<Prepare>>;
+
+        // shared as packaged tasks may need to copy their callable
+        auto promise = std::make_shared<std::promise<Result>>();
+        auto future = promise->get_future();
+
+        pool_.submit(
+            static_cast<std::size_t>(priority),
+            [this, prepare = std::move(prepare), create = std::move(create), promise]() mutable
+            {
+                try
+                {
+                    run_on_main_thread(
+                        [create = std::move(create), prepared = prepare(), promise]() mutable
+                        {
+                            try
+                            {
+                                promise->set_value(create(std::move(prepared)));
+                            }
+                            catch (...)
+                            {
+                                promise->set_exception(std::current_exception());
+                            }
+                        });
+                }
+                catch (...)
+                {
+                    promise->set_exception(std::current_exception());
+                }
+            });
+
+        return future;
+    }
+
+    /**
+     * Queue a task to run on the main thread during the next pump(). Safe to call from any thread.
+     *
+     * @param task
+     *   The task to run.
+     */
+    auto run_on_main_thread(std::move_only_function<void()> task) -> void;
+
+    /**
+     * Register a callback to be called on the main thread, during pump(), once a future is ready.
+     *
+     * @param future
+     *   The future to wait for.
+     * @param callback
+     *   Called with the result of the future (or rather the future itself, so errors can be handled).
+     */
+    template <class T, class F>
+    auto then(std::future<T> future, F callback) -> void
+    {
+        callbacks_.push_back(
+            [future = std::move(future), callback = std::move(callback)]() mutable
+            {
+                if (future.wait_for(std::chrono::seconds{0}) != std::future_status::ready)
+                {
+                    return false;
+                }
+
+                callback(std::move(future));
+                return true;
+            });
+    }
+
+    /**
+     * Run queued main thread tasks and ready callbacks. At least one task is run (if there are any) regardless of the
+     * budget.
+     *
+     * @param budget
+     *   Time to spend running tasks, so a burst of completions cannot cause a long frame.
+     *
+     * @returns
+     *   Number of tasks and callbacks run.
+     */
+    auto pump(std::chrono::nanoseconds budget = std::chrono::nanoseconds::max()) -> std::size_t;
+
+    /**
+     * Wait for a future, pumping the main thread queue whilst waiting (as the future may depend on it).
+     *
+     * @param future
+     *   The future to wait for.
+     *
+     * @returns
+     *   The result of the future.
+     */
+    template <class T>
+    auto wait(std::future<T> &future) -> T
+    {
+        while (future.wait_for(std::chrono::seconds{0}) != std::future_status::ready)
+        {
+            if (pump() == 0u)
+            {
+                future.wait_for(std::chrono::milliseconds{1});
+            }
+        }
+
+        return future.get();
+    }
+
+  private:
+    /**
+     * Decompress an entry, if it is compressed, spreading the chunks over the workers.
+     *
+     * @param entry
+     *   The entry to decompress.
+     * @param priority
+     *   Priority of the load the entry is for.
+     *
+     * @returns
+     *   Staging copy of the entry, or an empty optional if it is not compressed (so can be viewed in place).
+     */
+    auto decompress(const TLVEntry &entry, LoadPriority priority) -> std::optional<TLVStagingBuffer>;
+
+    /** Loader to load files with. */
+    const ResourceLoader &resource_loader_;
+
+    /** Guards the main thread queue. */
+    std::mutex mutex_;
+
+    /** Tasks waiting to be run on the main thread. */
+    std::queue<std::move_only_function<void()>> main_thread_tasks_;
+
+    /** Completion callbacks, only touched by the main thread. Return true once they have run. */
+    std::vector<std::move_only_function<bool()>> callbacks_;
+
+    /** Worker threads, declared last so they are stopped before the queue they post to is destroyed. */
+    ThreadPool pool_;
+};
+
+}
@@ -0,0 +1,41 @@
+#pragma once
+
+#include <string_view>
+#include <utility>
+
+#include "resources/file.h"
+#include "tlv/tlv_archive.h"
+
+using namespace std::literals;
+
+namespace game
+{
+
+/** Name of the bundle holding everything not assigned to a level, it is always loaded. */
+inline constexpr auto shared_bundle = "shared"sv;
+
+/**
+ * A resource bundle: a mapped archive file.
+ */
+struct Bundle
+{
+    /**
+     * Construct a new bundle, validating the archive.
+     *
+     * @param file
+     *   The mapped archive file.
+     */
+    Bundle(File file)
+        : file(std::move(file))
+        , archive(this->file.as_data())
+    {
+    }
+
+    /** The mapped file, declared first so it outlives the archive which views it. */
+    File file;
+
+    /** The archive in the file. */
+    TLVArchive archive;
+};
+
+}
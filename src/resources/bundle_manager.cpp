@@ -0,0 +1,101 @@
+#include "resources/bundle_manager.h"
+
+#include <algorithm>
+#include <chrono>
+#include <format>
+#include <future>
+#include <memory>
+#include <span>
+#include <string>
+#include <string_view>
+
+#include "resources/async_loader.h"
+#include "resources/file.h"
+#include "resources/resource_loader.h"
+#include "tlv/tlv_archive.h"
+#include "utils/log.h"
+
+namespace game
+{
+
+BundleManager::BundleManager(
+    const ResourceLoader &resource_loader,
+    AsyncLoader &async_loader,
+    std::string_view base_name)
+    : resource_loader_(resource_loader)
+    , async_loader_(async_loader)
+    , base_name_(base_name)
+    , slots_()
+{
+}
+
+auto BundleManager::prefetch(std::string_view name, LoadPriority priority) -> void
+{
+    if (slots_.contains(name))
+    {
+        return;
+    }
+
+    log::info("loading bundle {}", name);
+
+    slots_.emplace(
+        name,
+        Slot{
+            .loading = async_loader_.load(
+                priority,
+                [&resource_loader = resource_loader_, file_name = std::format("{}.{}", base_name_, name)]
+                {
+                    // assets are looked up through the index so access is random, but the whole bundle is going to
+                    // be used so fault it all in whilst we are off the main thread
+                    auto file = resource_loader.load(
+                        file_name, {.access_pattern = AccessPattern::RANDOM, .populate = false, .huge_pages = true});
+                    file.prefetch(file.as_data());
+
+                    return std::make_unique<Bundle>(std::move(file));
+                },
+                [](std::unique_ptr<Bundle> bundle) { return bundle; }),
+            .bundle = {}});
+}
+
+auto BundleManager::get(std::string_view name) -> const TLVArchive &
+{
+    prefetch(name, LoadPriority::BLOCKING);
+
+    auto &slot = slots_.find(name)->second;
+    if (!slot.bundle)
+    {
+        slot.bundle = async_loader_.wait(slot.loading);
+    }
+
+    return slot.bundle->archive;
+}
+
+auto BundleManager::is_ready(std::string_view name) const -> bool
+{
+    const auto slot = slots_.find(name);
+    if (slot == std::ranges::end(slots_))
+    {
+        return false;
+    }
+
+    if (slot->second.bundle)
+    {
+        return true;
+    }
+
+    return slot->second.loading.wait_for(std::chrono::seconds{0}) == std::future_status::ready;
+}
+
+auto BundleManager::retain(std::span<const std::string_view> names) -> void
+{
+    // an in flight load holds its own reference to its result, so dropping its future is enough to release it
+    const auto erased = std::erase_if(
+        slots_, [names](const auto &slot) { return !std::ranges::contains(names, std::string_view{slot.first}); });
+
+    if (erased != 0u)
+    {
+        log::info("released {} bundles", erased);
+    }
+}
+
+}
@@ -0,0 +1,109 @@
+#pragma once
+
+#include <future>
+#include <memory>
+#include <span>
+#include <string>
+#include <string_view>
+
+#include "resources/async_loader.h"
+#include "resources/bundle.h"
+#include "resources/file.h"
+#include "resources/resource_loader.h"
+#include "tlv/tlv_archive.h"
+#include "utils/string_map.h"
+
+namespace game
+{
+
+/**
+ * Manages which resource bundles are mapped. The resource packer splits assets into bundles (see the packer manifest),
+ * each one written to "<base name>.<bundle name>", so only the bundles the current and next level need have to be
+ * resident.
+ *
+ * Bundles are mapped, prefetched and validated on a worker thread. Releasing a bundle unmaps it, so anything created
+ * from it must have copied what it needs (which is true of all the graphics resources) and no loads from it may still
+ * be in flight.
+ */
+class BundleManager
+{
+  public:
+    /**
+     * Construct a new bundle manager.
+     *
+     * @param resource_loader
+     *   Loader to map bundle files with, must outlive this object.
+     * @param async_loader
+     *   Loader to run bundle loads on, must outlive this object.
+     * @param base_name
+     *   Name of the bundle files, without the bundle name.
+     */
+    BundleManager(const ResourceLoader &resource_loader, AsyncLoader &async_loader, std::string_view base_name);
+
+    /**
+     * Start loading a bundle, if it is not already loaded (or loading).
+     *
+     * @param name
+     *   Name of the bundle.
+     * @param priority
+     *   Priority of the load.
+     */
+    auto prefetch(std::string_view name, LoadPriority priority) -> void;
+
+    /**
+     * Get a bundle, loading it (and waiting for it) if required.
+     *
+     * @param name
+     *   Name of the bundle.
+     *
+     * @returns
+     *   The archive in the bundle, valid until the bundle is released.
+     */
+    auto get(std::string_view name) -> const TLVArchive &;
+
+    /**
+     * Check if a bundle has finished loading, without waiting.
+     *
+     * @param name
+     *   Name of the bundle.
+     *
+     * @returns
+     *   True if the bundle can be got without waiting, false otherwise.
+     */
+    auto is_ready(std::string_view name) const -> bool;
+
+    /**
+     * Release every bundle not in a set, bundles which are still loading are released once they complete.
+     *
+     * @param names
+     *   Names of the bundles to keep.
+     */
+    auto retain(std::span<const std::string_view> names) -> void;
+
+  private:
+    /**
+     * State of a single bundle, which is either loading or loaded.
+     */
+    struct Slot
+    {
+        /** The load, invalid once it has completed. */
+        std::future<std::unique_ptr<Bundle>> loading;
+
+        /** The bundle, null until the load has completed. */
+        std::unique_ptr<Bundle> bundle;
+    };
+
+    /** Loader to map bundle files with. */
+    const ResourceLoader &resource_loader_;
+
+    /** Loader to run bundle loads on. */
+    AsyncLoader &async_loader_;
+
+    /** Name of the bundle files, without the bundle name. */
+    std::string base_name_;
+
+    /** All bundles which are loaded or loading. */
+    StringMap<Slot> slots_;
+};
+
+}
@@ -1,14 +1,12 @@
 #pragma once
 
 #include <cstddef>
+#include <cstring>
 #include <filesystem>
-#include <memory>
 #include <ranges>
 #include <span>
 #include <string_view>
 
-#include <Windows.h>
-
 #include "utils/auto_release.h"
 #include "utils/error.h"
 
@@ -27,9 +25,41 @@ enum class CreationMode
     CREATE
 };
 
+/**
+ * Enumeration of expected access patterns, used to tune how the OS reads ahead.
+ */
+enum class AccessPattern
+{
+    /** No particular pattern, use the OS defaults. */
+    NORMAL,
+
+    /** The file will be read front to back, read ahead aggressively. */
+    SEQUENTIAL,
+
+    /** The file will be read in no particular order (e.g. via an index), read ahead is wasted. */
+    RANDOM
+};
+
+/**
+ * Hints for how a file should be mapped. These are hints only, anything the platform does not support is ignored.
+ */
+struct MappingOptions
+{
+    /** Expected access pattern. */
+    AccessPattern access_pattern;
+
+    /** Whether to read the whole file in when it is opened, rather than faulting pages in on first use. */
+    bool populate;
+
+    /** Whether to back large files with huge pages, reducing TLB pressure for big archives. */
+    bool huge_pages;
+};
+
 /**
  * Abstraction over a file. Internally uses memory mapped files to access the file contents, so data can re returned as
  * a pointer rather than a copy. You need to keep the file open for the duration of the data usage.
+ *
+ * The implementation is platform specific, see file_win32.cpp and file_posix.cpp.
  */
 class File
 {
@@ -41,8 +71,10 @@ class File
      *   The path to the file.
      * @param mode
      *   The creation mode of the file.
+     * @param options
+     *   Hints for how to map the file.
      */
-    File(const std::filesystem::path &path, CreationMode mode = CreationMode::OPEN);
+    File(const std::filesystem::path &path, CreationMode mode = CreationMode::OPEN, const MappingOptions &options = {});
 
     /**
      * Get the size of the file.
@@ -68,6 +100,14 @@ class File
      */
     auto as_data() const -> std::span<const std::byte>;
 
+    /**
+     * Ask the OS to start reading part of the file in, so it is resident by the time it is used. This does not block.
+     *
+     * @param range
+     *   The range to prefetch, must be a subspan of as_data() (e.g. the value of a TLV entry).
+     */
+    auto prefetch(std::span<const std::byte> range) const -> void;
+
     /**
      * Write data to the file.
      *
@@ -78,19 +118,23 @@ class File
     auto write(const T &data) -> void
         requires(sizeof(std::ranges::range_value_t<T>) == 1)
     {
+        ensure(std::ranges::size(data) <= size_, "data larger than file");
+
         std::memcpy(map_view_.get(), std::ranges::data(data), std::ranges::size(data));
-        ensure(::FlushViewOfFile(map_view_.get(), data.size()) != 0, "failed to flush file");
+        flush(std::ranges::size(data));
     }
 
   private:
-    /** Handle to the file. */
-    AutoRelease<HANDLE, INVALID_HANDLE_VALUE> handle_;
-
-    /** Handle to the file mapping. */
-    AutoRelease<HANDLE, reinterpret_cast<HANDLE>(NULL)> mapping_;
+    /**
+     * Flush the start of the mapped view to disk.
+     *
+     * @param size
+     *   Number of bytes to flush.
+     */
+    auto flush(std::size_t size) -> void;
 
-    /** Pointer to the mapped view of the file. */
-    std::unique_ptr<void, decltype(&::UnmapViewOfFile)> map_view_;
+    /** Pointer to the mapped view of the file, the file itself does not need to stay open once mapped. */
+    AutoRelease<std::byte *, nullptr> map_view_;
 
     /** Size of the file. */
     std::size_t size_;
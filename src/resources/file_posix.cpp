@@ -0,0 +1,147 @@
+#include "file.h"
+
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <span>
+#include <string_view>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "utils/auto_release.h"
+#include "utils/error.h"
+
+namespace
+{
+
+/** Files smaller than this are not worth backing with huge pages. */
+constexpr auto huge_page_threshold = std::size_t{2u * 1024u * 1024u};
+
+/**
+ * Convert an access pattern to the madvise advice.
+ *
+ * @param access_pattern
+ *   The access pattern.
+ *
+ * @returns
+ *   The advice.
+ */
+auto to_advice(game::AccessPattern access_pattern) -> int
+{
+    switch (access_pattern)
+    {
+        using enum game::AccessPattern;
+        case NORMAL: return MADV_NORMAL;
+        case SEQUENTIAL: return MADV_SEQUENTIAL;
+        case RANDOM: return MADV_RANDOM;
+    }
+
+    return MADV_NORMAL;
+}
+
+}
+
+namespace game
+{
+File::File(const std::filesystem::path &path, CreationMode mode, const MappingOptions &options)
+    : map_view_{}
+    , size_{}
+{
+    const auto flags = mode == CreationMode::OPEN ? O_RDWR : O_RDWR | O_CREAT;
+    const auto handle = AutoRelease<int, -1>{::open(path.c_str(), flags | O_CLOEXEC, 0644), ::close};
+    ensure(handle.get() != -1, "failed to open file: {}", errno);
+
+    struct ::stat stat = {};
+    ensure(::fstat(handle, &stat) == 0, "failed to get file size: {}", errno);
+    size_ = static_cast<std::size_t>(stat.st_size);
+
+    // mmap rejects empty mappings, an empty file just has no view
+    if (size_ == 0u)
+    {
+        return;
+    }
+
+    auto map_flags = MAP_SHARED;
+#if defined(MAP_POPULATE)
+    if (options.populate)
+    {
+        map_flags |= MAP_POPULATE;
+    }
+#endif
+
+    auto *view = ::mmap(nullptr, size_, PROT_READ | PROT_WRITE, map_flags, handle, 0);
+    ensure(view != MAP_FAILED, "failed to map file: {}", errno);
+
+    // the mapping keeps the file alive, so the descriptor can be closed once it exists
+    map_view_ = {static_cast<std::byte *>(view), [size = size_](auto mapped) { ::munmap(mapped, size); }};
+
+    // advice is purely an optimisation, so failure is not an error
+    ::madvise(view, size_, to_advice(options.access_pattern));
+
+#if defined(MADV_HUGEPAGE)
+    // MAP_HUGETLB only works for anonymous and hugetlbfs mappings, for regular files transparent huge pages are the
+    // only option (and only where the kernel supports them for the page cache)
+    if (options.huge_pages && (size_ >= huge_page_threshold))
+    {
+        ::madvise(view, size_, MADV_HUGEPAGE);
+    }
+#endif
+
+#if !defined(MAP_POPULATE)
+    if (options.populate)
+    {
+        prefetch(as_data());
+    }
+#endif
+}
+
+auto File::size() const -> std::size_t
+{
+    return size_;
+}
+
+auto File::as_string() const -> std::string_view
+{
+    return {reinterpret_cast<const char *>(map_view_.get()), size_};
+}
+
+auto File::as_data() const -> std::span<const std::byte>
+{
+    return {map_view_.get(), size_};
+}
+
+auto File::prefetch(std::span<const std::byte> range) const -> void
+{
+    ensure(
+        (range.data() >= map_view_.get()) && (range.data() + range.size() <= map_view_.get() + size_),
+        "range not in file");
+
+    if (range.empty())
+    {
+        return;
+    }
+
+    // madvise needs a page aligned address, the view itself is page aligned so round down relative to it
+    const auto page_size = static_cast<std::size_t>(::sysconf(_SC_PAGESIZE));
+    const auto offset = static_cast<std::size_t>(range.data() - map_view_.get());
+    const auto aligned_offset = offset - (offset % page_size);
+
+    // advice is purely an optimisation, so failure is not an error
+    ::madvise(map_view_.get() + aligned_offset, offset - aligned_offset + range.size(), MADV_WILLNEED);
+}
+
+auto File::flush(std::size_t size) -> void
+{
+    if (size == 0u)
+    {
+        return;
+    }
+
+    ensure(::msync(map_view_.get(), size, MS_SYNC) == 0, "failed to flush file: {}", errno);
+}
+
+}
@@ -0,0 +1,100 @@
+#include "file.h"
+
+#include <cstddef>
+#include <filesystem>
+#include <span>
+#include <string_view>
+
+#include <Windows.h>
+
+#include "utils/auto_release.h"
+#include "utils/error.h"
+
+namespace game
+{
+File::File(const std::filesystem::path &path, CreationMode mode, const MappingOptions &options)
+    : map_view_{}
+    , size_{}
+{
+    // the access pattern is only a flag on the file handle, there is no per view equivalent of madvise
+    auto flags = DWORD{FILE_ATTRIBUTE_NORMAL};
+    switch (options.access_pattern)
+    {
+        using enum AccessPattern;
+        case NORMAL: break;
+        case SEQUENTIAL: flags |= FILE_FLAG_SEQUENTIAL_SCAN; break;
+        case RANDOM: flags |= FILE_FLAG_RANDOM_ACCESS; break;
+    }
+
+    const auto handle = AutoRelease<HANDLE, INVALID_HANDLE_VALUE>{
+        ::CreateFileA(
+            path.string().c_str(),
+            GENERIC_READ | GENERIC_WRITE,
+            0,
+            nullptr,
+            mode == CreationMode::OPEN ? OPEN_EXISTING : OPEN_ALWAYS,
+            flags,
+            nullptr),
+        ::CloseHandle};
+    ensure(handle, "failed to open file");
+
+    // large pages are only supported for pagefile backed sections, so options.huge_pages is ignored
+    const auto mapping = AutoRelease<HANDLE, reinterpret_cast<HANDLE>(NULL)>{
+        ::CreateFileMappingA(handle, nullptr, PAGE_READWRITE, 0, 0, nullptr), ::CloseHandle};
+    ensure(mapping, "failed to map file: {}", ::GetLastError());
+
+    // the view keeps the file and mapping alive, so both handles can be closed once it exists
+    map_view_ = {
+        static_cast<std::byte *>(::MapViewOfFile(mapping, FILE_MAP_ALL_ACCESS, 0, 0, 0)),
+        [](auto view) { ::UnmapViewOfFile(view); }};
+    ensure(map_view_, "failed to get map view");
+
+    auto size = LARGE_INTEGER{};
+    ensure(::GetFileSizeEx(handle, &size) != 0, "failed to get file size");
+    size_ = static_cast<std::size_t>(size.QuadPart);
+
+    if (options.populate)
+    {
+        prefetch(as_data());
+    }
+}
+
+auto File::size() const -> std::size_t
+{
+    return size_;
+}
+
+auto File::as_string() const -> std::string_view
+{
+    return {reinterpret_cast<const char *>(map_view_.get()), size_};
+}
+
+auto File::as_data() const -> std::span<const std::byte>
+{
+    return {map_view_.get(), size_};
+}
+
+auto File::prefetch(std::span<const std::byte> range) const -> void
+{
+    ensure(
+        (range.data() >= map_view_.get()) && (range.data() + range.size() <= map_view_.get() + size_),
+        "range not in file");
+
+    if (range.empty())
+    {
+        return;
+    }
+
+    auto entry = WIN32_MEMORY_RANGE_ENTRY{
+        .VirtualAddress = const_cast<std::byte *>(range.data()), .NumberOfBytes = range.size()};
+
+    // this is purely an optimisation, so failure is not an error
+    ::PrefetchVirtualMemory(::GetCurrentProcess(), 1u, &entry, 0u);
+}
+
+auto File::flush(std::size_t size) -> void
+{
+    ensure(::FlushViewOfFile(map_view_.get(), size) != 0, "failed to flush file");
+}
+
+}
@@ -0,0 +1,98 @@
+#pragma once
+
+#include <cstdint>
+#include <format>
+#include <string>
+
+namespace game
+{
+
+/**
+ * A typed handle to an object in a ResourceCache. Handles are an index into a slot array plus the generation of the
+ * slot when the handle was created, so resolving one is an array lookup and a handle to an object which has since been
+ * removed can be detected.
+ *
+ * A default constructed handle is never valid.
+ */
+template <class T>
+class Handle
+{
+  public:
+    /**
+     * Construct an invalid handle.
+     */
+    constexpr Handle()
+        : Handle(0u, 0u)
+    {
+    }
+
+    /**
+     * Construct a new handle.
+     *
+     * @param index
+     *   Index of the slot.
+     * @param generation
+     *   Generation of the slot, 0 is reserved for invalid handles.
+     */
+    constexpr Handle(std::uint32_t index, std::uint32_t generation)
+        : index_(index)
+        , generation_(generation)
+    {
+    }
+
+    /**
+     * Get the slot index.
+     *
+     * @returns
+     *   Index of the slot.
+     */
+    constexpr auto index() const -> std::uint32_t
+    {
+        return index_;
+    }
+
+    /**
+     * Get the generation.
+     *
+     * @returns
+     *   Generation of the slot when the handle was created.
+     */
+    constexpr auto generation() const -> std::uint32_t
+    {
+        return generation_;
+    }
+
+    /**
+     * Check if the handle was ever valid, this does not check if the object still exists (see ResourceCache::contains).
+     */
+    constexpr explicit operator bool() const
+    {
+        return generation_ != 0u;
+    }
+
+    constexpr auto operator==(const Handle &) const -> bool = default;
+
+  private:
+    /** Index of the slot. */
+    std::uint32_t index_;
+
+    /** Generation of the slot. */
+    std::uint32_t generation_;
+};
+
+/**
+ * Converts a handle to a string.
+ *
+ * @param obj
+ *   The handle to convert.
+ *
+ * @returns
+ *   The string representation of the handle.
+ */
+template <class T>
+auto to_string(const Handle<T> &obj) -> std::string
+{
+    return std::format("{}:{}", obj.index(), obj.generation());
+}
+
+}
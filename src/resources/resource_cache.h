@@ -1,9 +1,21 @@
 #pragma once
 
+#include <algorithm>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <limits>
+#include <optional>
 #include <ranges>
+#include <string>
 #include <string_view>
 #include <tuple>
+#include <vector>
 
+#include "resources/handle.h"
+#include "resources/resource_footprint.h"
 #include "utils/error.h"
 #include "utils/string_map.h"
 
@@ -15,8 +27,53 @@ class Texture;
 class Material;
 class Sampler;
 
+/**
+ * Concept for types which can report their memory usage, other types are treated as using no memory.
+ */
+template <class T>
+concept HasFootprint = requires(const T &obj) {
+    { obj.footprint() } -> std::same_as<ResourceFootprint>;
+};
+
+/**
+ * Live statistics for a single type in a ResourceCache.
+ */
+struct ResourceStats
+{
+    /** Bytes of CPU memory used by resident objects. */
+    std::size_t cpu_bytes;
+
+    /** Bytes of GPU memory used by resident objects. */
+    std::size_t gpu_bytes;
+
+    /** Budget for the combined CPU and GPU bytes. */
+    std::size_t budget;
+
+    /** Number of objects currently resident. */
+    std::size_t resident;
+
+    /** Number of gets which found the object resident. */
+    std::size_t hits;
+
+    /** Number of gets which had to reload the object. */
+    std::size_t misses;
+
+    /** Number of objects evicted to stay in budget. */
+    std::size_t evictions;
+};
+
 /**
  * A generic resource cache. Allows you to store string keys against the templated types. Keys must be unique per type.
+ *
+ * Objects are stored in per type slot arrays and referred to by Handle, resolving a handle is an index and a
+ * generation check. Names are only intended to be used at load time to find the handle of an object.
+ *
+ * Each type can be given a memory budget. When a type goes over budget the least recently used objects are evicted,
+ * and reloaded the next time they are requested. Only objects inserted with a loader can be evicted, and pinned objects
+ * are never evicted.
+ *
+ * Objects never move once inserted, so pointers returned by get remain valid until the object is erased or evicted.
+ * Anything holding on to a pointer to a reloadable object should pin it, e.g. by getting it through ResourcePins.
  */
 template <class... T>
 class ResourceCache
@@ -30,23 +87,139 @@ class ResourceCache
      *
      * @param args
      *   Arguments to pass to the constructor of the object.
+     *
+     * @returns
+     *   Handle to the inserted object.
      */
     template <class U, class... Args>
-    auto insert(std::string_view name, Args &&...args) -> U *
+    auto insert(std::string_view name, Args &&...args) -> Handle<U>
     {
-        auto &map = std::get<StringMap<U>>(maps_);
+        auto &store = std::get<Store<U>>(stores_);
+
+        expect(!store.names.contains(name), "{} already exists", name);
+
+        // reuse a free slot if there is one, the generation was bumped when it was freed
+        const auto reuse = !store.free.empty();
+        const auto index = reuse ? store.free.back() : static_cast<std::uint32_t>(store.slots.size());
+        if (!reuse)
+        {
+            store.slots.emplace_back();
+        }
+
+        auto &slot = store.slots[index];
+        try
+        {
+            slot.object.emplace(std::forward<Args>(args)...);
+        }
+        catch (...)
+        {
+            // the slot is only taken once the object exists, so a throwing constructor leaves it free
+            if (!reuse)
+            {
+                store.slots.pop_back();
+            }
+            throw;
+        }
+
+        if (reuse)
+        {
+            store.free.pop_back();
+        }
+
+        slot.name = name;
+        slot.last_used = ++tick_;
 
-        expect(!map.contains(name), "{} already exists", name);
-        const auto [iter, inserted] = map.emplace(std::make_pair(name, U{std::forward<Args>(args)...}));
+        const auto handle = Handle<U>{index, slot.generation};
+        store.names.emplace(slot.name, handle);
 
-        expect(inserted, "insertion failed as key exists");
+        make_resident(store, slot);
+        enforce_budget(store, index);
 
-        return std::addressof(iter->second);
+        return handle;
+    }
+
+    /**
+     * Insert an object into the cache which can be evicted and reloaded on demand. The object is loaded immediately.
+     * Undefined behaviour if the object already exists.
+     *
+     * @param name
+     *   Name of object to insert.
+     * @param loader
+     *   Function to (re)load the object.
+     *
+     * @returns
+     *   Handle to the inserted object.
+     */
+    template <class U>
+    auto insert_reloadable(std::string_view name, std::move_only_function<U()> loader) -> Handle<U>
+    {
+        auto object = loader();
+        const auto handle = insert<U>(name, std::move(object));
+
+        auto &store = std::get<Store<U>>(stores_);
+        store.slots[handle.index()].loader = std::move(loader);
+
+        return handle;
+    }
+
+    /**
+     * Find the handle of an object by name. This is for load time, hot code should hold on to the handle.
+     *
+     * @param name
+     *   Name of object to find, undefined behaviour if it doesn't exist.
+     *
+     * @returns
+     *   Handle to the object.
+     */
+    template <class U>
+    auto find(std::string_view name) const -> Handle<U>
+    {
+        const auto &store = std::get<Store<U>>(stores_);
+
+        const auto handle = store.names.find(name);
+        expect(handle != std::ranges::end(store.names), "{} does not exist", name);
+
+        return handle->second;
     }
 
     /**
      * Get an object.
      *
+     * @param handle
+     *   Handle of object to get, undefined behaviour if the object no longer exists.
+     *
+     * @returns
+     *   Pointer to requested object.
+     */
+    template <class U>
+    auto get(Handle<U> handle) -> U *
+    {
+        auto &store = std::get<Store<U>>(stores_);
+
+        expect(contains(handle), "stale handle {}", handle);
+
+        auto &slot = store.slots[handle.index()];
+        if (slot.object)
+        {
+            ++store.stats.hits;
+        }
+        else
+        {
+            ++store.stats.misses;
+
+            slot.object.emplace(slot.loader());
+            make_resident(store, slot);
+            enforce_budget(store, handle.index());
+        }
+
+        slot.last_used = ++tick_;
+
+        return std::addressof(*slot.object);
+    }
+
+    /**
+     * Get an object by name. This is for load time, hot code should use a handle.
+     *
      * @param name
      *   Name of object to get, undefined behaviour if it doesn't exist.
      *
@@ -54,19 +227,269 @@ class ResourceCache
      *   Pointer to requested object.
      */
     template <class U>
-    auto get(std::string_view name)
+    auto get(std::string_view name) -> U *
+    {
+        return get(find<U>(name));
+    }
+
+    /**
+     * Check if the object a handle refers to still exists.
+     *
+     * @param handle
+     *   Handle to check.
+     *
+     * @returns
+     *   True if the object exists, false if the handle is stale (or was never valid).
+     */
+    template <class U>
+    auto contains(Handle<U> handle) const -> bool
+    {
+        const auto &store = std::get<Store<U>>(stores_);
+
+        return handle && (handle.index() < store.slots.size()) &&
+               (store.slots[handle.index()].generation == handle.generation());
+    }
+
+    /**
+     * Check if an object is currently loaded, i.e. get will not have to reload it.
+     *
+     * @param handle
+     *   Handle of object to check, undefined behaviour if the object no longer exists.
+     *
+     * @returns
+     *   True if the object is loaded.
+     */
+    template <class U>
+    auto is_resident(Handle<U> handle) const -> bool
+    {
+        const auto &store = std::get<Store<U>>(stores_);
+
+        expect(contains(handle), "stale handle {}", handle);
+
+        return store.slots[handle.index()].object.has_value();
+    }
+
+    /**
+     * Pin an object, so it cannot be evicted. Pins are counted, so each pin needs a matching unpin.
+     *
+     * @param handle
+     *   Handle of object to pin, undefined behaviour if the object no longer exists.
+     */
+    template <class U>
+    auto pin(Handle<U> handle) -> void
+    {
+        auto &store = std::get<Store<U>>(stores_);
+
+        expect(contains(handle), "stale handle {}", handle);
+
+        ++store.slots[handle.index()].pin_count;
+    }
+
+    /**
+     * Unpin an object, which may cause it to be evicted if the type is over budget.
+     *
+     * @param handle
+     *   Handle of object to unpin, undefined behaviour if the object no longer exists or is not pinned.
+     */
+    template <class U>
+    auto unpin(Handle<U> handle) -> void
+    {
+        auto &store = std::get<Store<U>>(stores_);
+
+        expect(contains(handle), "stale handle {}", handle);
+
+        auto &slot = store.slots[handle.index()];
+        expect(slot.pin_count > 0u, "{} is not pinned", slot.name);
+
+        --slot.pin_count;
+        enforce_budget(store, store.slots.size());
+    }
+
+    /**
+     * Set the memory budget for a type, objects are evicted immediately if it is over budget.
+     *
+     * @param budget
+     *   Budget for the combined CPU and GPU bytes of all resident objects of the type.
+     */
+    template <class U>
+    auto set_budget(std::size_t budget) -> void
     {
-        auto &map = std::get<StringMap<U>>(maps_);
+        auto &store = std::get<Store<U>>(stores_);
 
-        const auto object = map.find(name);
-        expect(object != std::ranges::end(map), "{} does not exist", name);
+        store.stats.budget = budget;
+        enforce_budget(store, store.slots.size());
+    }
+
+    /**
+     * Get the live statistics for a type.
+     *
+     * @returns
+     *   Statistics for the type.
+     */
+    template <class U>
+    auto stats() const -> ResourceStats
+    {
+        return std::get<Store<U>>(stores_).stats;
+    }
+
+    /**
+     * Remove an object, all handles to it become stale.
+     *
+     * @param handle
+     *   Handle of object to remove, undefined behaviour if the object no longer exists.
+     */
+    template <class U>
+    auto erase(Handle<U> handle) -> void
+    {
+        auto &store = std::get<Store<U>>(stores_);
+
+        expect(contains(handle), "stale handle {}", handle);
+
+        auto &slot = store.slots[handle.index()];
+        if (slot.object)
+        {
+            evict(store, slot);
+        }
 
-        return std::addressof(object->second);
+        store.names.erase(slot.name);
+        slot.name.clear();
+        slot.loader = nullptr;
+        slot.pin_count = 0u;
+
+        // 0 is reserved for invalid handles
+        slot.generation = slot.generation == std::numeric_limits<std::uint32_t>::max() ? 1u : slot.generation + 1u;
+        store.free.push_back(handle.index());
     }
 
   private:
+    /**
+     * A slot for a single object.
+     */
+    template <class U>
+    struct Slot
+    {
+        /** The object, empty if the slot is free or the object has been evicted. */
+        std::optional<U> object;
+
+        /** Name of the object. */
+        std::string name;
+
+        /** Generation of the slot, bumped every time it is freed. */
+        std::uint32_t generation = 1u;
+
+        /** Function to reload the object, empty if the object cannot be evicted. */
+        std::move_only_function<U()> loader;
+
+        /** Memory used by the object when it was loaded. */
+        ResourceFootprint footprint = {};
+
+        /** Tick of the last get, for finding the least recently used object. */
+        std::uint64_t last_used = 0u;
+
+        /** Number of outstanding pins. */
+        std::uint32_t pin_count = 0u;
+    };
+
+    /**
+     * Storage for a single type.
+     */
+    template <class U>
+    struct Store
+    {
+        /** Slots, a deque so objects never move as it grows. */
+        std::deque<Slot<U>> slots;
+
+        /** Indices of free slots. */
+        std::vector<std::uint32_t> free;
+
+        /** Lookup of name to handle. */
+        StringMap<Handle<U>> names;
+
+        /** Live statistics, which also hold the budget. */
+        ResourceStats stats = {.budget = std::numeric_limits<std::size_t>::max()};
+    };
+
+    /**
+     * Account for an object that has just been loaded into a slot.
+     *
+     * @param store
+     *   Store the slot is in.
+     * @param slot
+     *   The slot.
+     */
+    template <class U>
+    static auto make_resident(Store<U> &store, Slot<U> &slot) -> void
+    {
+        if constexpr (HasFootprint<U>)
+        {
+            slot.footprint = slot.object->footprint();
+        }
+
+        store.stats.cpu_bytes += slot.footprint.cpu_bytes;
+        store.stats.gpu_bytes += slot.footprint.gpu_bytes;
+        ++store.stats.resident;
+    }
+
+    /**
+     * Unload the object in a slot.
+     *
+     * @param store
+     *   Store the slot is in.
+     * @param slot
+     *   The slot, must have an object.
+     */
+    template <class U>
+    static auto evict(Store<U> &store, Slot<U> &slot) -> void
+    {
+        slot.object.reset();
+
+        store.stats.cpu_bytes -= slot.footprint.cpu_bytes;
+        store.stats.gpu_bytes -= slot.footprint.gpu_bytes;
+        --store.stats.resident;
+        slot.footprint = {};
+    }
+
+    /**
+     * Evict least recently used objects until a store is within budget (or there is nothing left that can be evicted).
+     *
+     * @param store
+     *   Store to enforce the budget on.
+     * @param keep
+     *   Index of a slot which must not be evicted (i.e. the one just loaded), out of range to allow any.
+     */
+    template <class U>
+    static auto enforce_budget(Store<U> &store, std::size_t keep) -> void
+    {
+        while (store.stats.cpu_bytes + store.stats.gpu_bytes > store.stats.budget)
+        {
+            auto victim = std::ranges::end(store.slots);
+
+            for (auto iter = std::ranges::begin(store.slots); iter != std::ranges::end(store.slots); ++iter)
+            {
+                const auto evictable = iter->object && iter->loader && (iter->pin_count == 0u) &&
+                                       (static_cast<std::size_t>(iter - std::ranges::begin(store.slots)) != keep);
+
+                if (evictable && ((victim == std::ranges::end(store.slots)) || (iter->last_used < victim->last_used)))
+                {
+                    victim = iter;
+                }
+            }
+
+            if (victim == std::ranges::end(store.slots))
+            {
+                return;
+            }
+
+            evict(store, *victim);
+            ++store.stats.evictions;
+        }
+    }
+
     /** Object store for given types. */
-    std::tuple<StringMap<T>...> maps_;
+    std::tuple<Store<T>...> stores_;
+
+    /** Incremented on every insert and get, used to order objects by last use. */
+    std::uint64_t tick_ = 0u;
 };
 
 // default cache for the game
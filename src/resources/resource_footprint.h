@@ -0,0 +1,31 @@
+#pragma once
+
+#include <cstddef>
+
+namespace game
+{
+
+/**
+ * Memory used by a resource.
+ */
+struct ResourceFootprint
+{
+    /** Bytes of CPU memory used. */
+    std::size_t cpu_bytes;
+
+    /** Bytes of GPU memory used. */
+    std::size_t gpu_bytes;
+
+    /**
+     * Get the total memory used.
+     *
+     * @returns
+     *   Sum of CPU and GPU bytes.
+     */
+    constexpr auto total() const -> std::size_t
+    {
+        return cpu_bytes + gpu_bytes;
+    }
+};
+
+}
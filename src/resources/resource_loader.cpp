@@ -13,9 +13,9 @@ ResourceLoader::ResourceLoader(const std::filesystem::path &root)
 {
 }
 
-auto ResourceLoader::load(std::string_view name) const -> File
+auto ResourceLoader::load(std::string_view name, const MappingOptions &options) const -> File
 {
-    return {root_ / name};
+    return {root_ / name, CreationMode::OPEN, options};
 }
 
 }
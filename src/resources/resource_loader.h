@@ -28,11 +28,14 @@ class ResourceLoader
      * Load a file from the resource directory. It is undefined behaviour if the file does not exist.
      *
      * @param name
+     *   The name of the file, relative to the root.
+     * @param options
+     *   Hints for how to map the file.
      *
      * @returns
      *   The file object.
      */
-    auto load(std::string_view name) const -> File;
+    auto load(std::string_view name, const MappingOptions &options = {}) const -> File;
 
   private:
     /** The root directory to load resources from. */
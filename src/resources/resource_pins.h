@@ -0,0 +1,99 @@
+#pragma once
+
+#include <string_view>
+#include <tuple>
+#include <vector>
+
+#include "resources/handle.h"
+#include "resources/resource_cache.h"
+
+namespace game
+{
+
+/**
+ * A set of objects pinned in a ResourceCache, which are all unpinned when the set is destroyed.
+ *
+ * Entities hold raw pointers to their meshes, materials and textures, so whatever creates them should get those
+ * pointers through a set which lives at least as long as the entities. Everything else stays free to be evicted.
+ */
+template <class... T>
+class ResourcePins
+{
+  public:
+    /**
+     * Construct a new empty set.
+     *
+     * @param cache
+     *   The cache the objects are in, must outlive this object.
+     */
+    explicit ResourcePins(ResourceCache<T...> &cache)
+        : cache_(cache)
+        , handles_{}
+    {
+    }
+
+    ~ResourcePins()
+    {
+        // objects erased while pinned have already lost their pins
+        const auto unpin_all = [this]<class U>(const std::vector<Handle<U>> &handles)
+        {
+            for (const auto handle : handles)
+            {
+                if (cache_.contains(handle))
+                {
+                    cache_.unpin(handle);
+                }
+            }
+        };
+
+        std::apply([&](const auto &...handles) { (unpin_all(handles), ...); }, handles_);
+    }
+
+    ResourcePins(const ResourcePins &) = delete;
+    auto operator=(const ResourcePins &) -> ResourcePins & = delete;
+
+    /**
+     * Pin an object and get it, reloading it if it has been evicted.
+     *
+     * @param handle
+     *   Handle of the object, undefined behaviour if the object no longer exists.
+     *
+     * @returns
+     *   Pointer to the object, valid for the lifetime of this set.
+     */
+    template <class U>
+    auto get(Handle<U> handle) -> U *
+    {
+        cache_.pin(handle);
+        std::get<std::vector<Handle<U>>>(handles_).push_back(handle);
+
+        return cache_.get(handle);
+    }
+
+    /**
+     * Pin an object by name and get it. This is for load time, as with ResourceCache::get.
+     *
+     * @param name
+     *   Name of the object, undefined behaviour if it doesn't exist.
+     *
+     * @returns
+     *   Pointer to the object, valid for the lifetime of this set.
+     */
+    template <class U>
+    auto get(std::string_view name) -> U *
+    {
+        return get(cache_.template find<U>(name));
+    }
+
+  private:
+    /** The cache the objects are in. */
+    ResourceCache<T...> &cache_;
+
+    /** Every pin taken, per type. */
+    std::tuple<std::vector<Handle<T>>...> handles_;
+};
+
+/** Pins for the default cache. */
+using DefaultPins = ResourcePins<Mesh, Material, Texture, Sampler>;
+
+}
@@ -0,0 +1,230 @@
+#include "tlv/tlv_archive.h"
+
+#include <algorithm>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <optional>
+#include <ranges>
+#include <span>
+#include <string_view>
+#include <vector>
+
+#include "tlv/tlv_entry.h"
+#include "tlv/tlv_index.h"
+#include "tlv/tlv_reader.h"
+#include "utils/error.h"
+#include "utils/hash.h"
+
+namespace
+{
+
+/** Size of the type and length fields of an entry. */
+constexpr auto header_size = sizeof(game::TLVType) + sizeof(std::uint32_t);
+
+/** Size of the trailing entry which stores the location of the index. */
+constexpr auto index_location_size = header_size + sizeof(std::uint64_t);
+
+/**
+ * Helper function to read a trivially copyable value from a buffer, makes no assumption about alignment.
+ *
+ * @param buffer
+ *   The buffer to read from, must be at least sizeof(T) bytes.
+ *
+ * @returns
+ *   The read value.
+ */
+template <class T>
+auto read(std::span<const std::byte> buffer) -> T
+{
+    auto value = T{};
+    std::memcpy(&value, buffer.data(), sizeof(value));
+    return value;
+}
+
+}
+
+namespace game
+{
+
+TLVArchive::TLVArchive(std::span<const std::byte> buffer)
+    : buffer_(buffer)
+    , index_slots_()
+    , built_slots_()
+    , offsets_()
+    , slot_count_()
+    , version_(1u)
+    , alignment_(1u)
+{
+    if ((buffer_.size() >= header_size) && (read<TLVType>(buffer_) == TLVType::HEADER))
+    {
+        const auto header = *TLVReader(buffer_).begin();
+        ensure(header.size() == header_size + sizeof(std::uint32_t) * 3u, "invalid header");
+
+        const auto header_value = buffer_.subspan(header_size);
+        ensure(read<std::uint32_t>(header_value) == tlv_magic, "invalid magic");
+
+        version_ = read<std::uint32_t>(header_value.subspan(sizeof(std::uint32_t)));
+        alignment_ = read<std::uint32_t>(header_value.subspan(sizeof(std::uint32_t) * 2u));
+
+        ensure(version_ <= tlv_version, "unsupported archive version {}", version_);
+        ensure(std::has_single_bit(alignment_), "alignment must be a power of two");
+
+        // offsets are aligned relative to the start of the archive, so the archive itself must be aligned
+        ensure(reinterpret_cast<std::uintptr_t>(buffer_.data()) % alignment_ == 0u, "archive buffer misaligned");
+    }
+
+    // validate every entry once up front, so nothing read from the archive needs to be checked again, this only touches
+    // the entry headers (and the small fixed size members of composites) so large values are not paged in, validating
+    // a composite also checks every blob reference it holds
+    auto slots = std::vector<TLVIndexSlot>{};
+
+    for (auto remaining = buffer_; !remaining.empty();)
+    {
+        ensure(remaining.size() >= header_size, "invalid entry size");
+
+        const auto type = read<TLVType>(remaining);
+        const auto length = read<std::uint32_t>(remaining.subspan(sizeof(TLVType)));
+        ensure(remaining.size() - header_size >= length, "invalid length");
+
+        const auto entry = TLVEntry{type, remaining.subspan(header_size, length), TLVValidation::CHECKED, buffer_};
+        const auto offset = static_cast<std::uint64_t>(remaining.data() - buffer_.data());
+
+        if (type != TLVType::PADDING)
+        {
+            entry.validate();
+            offsets_.push_back(offset);
+        }
+
+        if ((type == TLVType::TEXTURE_DESCRIPTION) || (type == TLVType::MESH_DATA) ||
+            (type == TLVType::PACKED_MESH_DATA))
+        {
+            slots.push_back({.hash = fnv1a(entry.name()), .offset = offset, .type = type, .length = entry.size()});
+        }
+
+        remaining = remaining.subspan(entry.size());
+    }
+
+    // only the type of the last entry says whether there is an index, the trailing bytes could equally be the end of a
+    // payload which happens to look like an index location
+    if (!offsets_.empty() && (read<TLVType>(buffer_.subspan(offsets_.back())) == TLVType::INDEX_LOCATION))
+    {
+        const auto location_offset = offsets_.back();
+        const auto location = *TLVReader(buffer_.subspan(location_offset)).begin();
+        ensure(location.size() == index_location_size, "invalid index location");
+
+        const auto index_offset = read<std::uint64_t>(buffer_.subspan(location_offset + header_size));
+        ensure(index_offset < location_offset, "index offset out of range");
+
+        const auto index = *TLVReader(buffer_.subspan(index_offset)).begin();
+        ensure(index.type() == TLVType::INDEX, "index location does not point to an index");
+
+        const auto index_value = buffer_.subspan(index_offset + header_size, index.size() - header_size);
+        ensure(index_value.size() >= sizeof(std::uint32_t) * 2u, "index too small");
+
+        slot_count_ = read<std::uint32_t>(index_value);
+        index_slots_ = index_value.subspan(sizeof(std::uint32_t) * 2u);
+
+        ensure(std::has_single_bit(slot_count_), "index size must be a power of two");
+        ensure(index_slots_.size() == slot_count_ * sizeof(TLVIndexSlot), "index size mismatch");
+
+        // every slot must describe one of the named entries found above (which are in offset order), so lookups can
+        // trust it
+
+        for (auto i = 0u; i < slot_count_; ++i)
+        {
+            const auto candidate = slot(i);
+            if (candidate.length == 0u)
+            {
+                continue;
+            }
+
+            const auto named = std::ranges::lower_bound(slots, candidate.offset, {}, &TLVIndexSlot::offset);
+            ensure(
+                (named != std::ranges::end(slots)) && (named->offset == candidate.offset) &&
+                    (named->type == candidate.type) && (named->length == candidate.length) &&
+                    (named->hash == candidate.hash),
+                "index slot {} does not match an entry",
+                i);
+        }
+    }
+    else
+    {
+        // no index on disk so build one from the entries found above
+        built_slots_ = build_tlv_index(slots);
+        slot_count_ = built_slots_.size();
+    }
+}
+
+auto TLVArchive::find(std::string_view name, TLVType type) const -> std::optional<TLVEntry>
+{
+    const auto hash = fnv1a(name);
+    const auto mask = slot_count_ - 1u;
+
+    // bound the probe in case we have been given a corrupt index with no empty slots
+    for (auto probe = 0u; probe < slot_count_; ++probe)
+    {
+        const auto candidate = slot((hash + probe) & mask);
+        if (candidate.length == 0u)
+        {
+            return std::nullopt;
+        }
+
+        if ((candidate.hash != hash) || (candidate.type != type))
+        {
+            continue;
+        }
+
+        // only now do we touch the entry itself, to rule out hash collisions
+        const auto entry =
+            *TLVReader(buffer_.subspan(candidate.offset, candidate.length), TLVValidation::VALIDATED, buffer_).begin();
+
+        if (entry.name() == name)
+        {
+            return entry;
+        }
+    }
+
+    return std::nullopt;
+}
+
+auto TLVArchive::reader() const -> TLVReader
+{
+    return {buffer_, TLVValidation::VALIDATED};
+}
+
+auto TLVArchive::entry_count() const -> std::size_t
+{
+    return offsets_.size();
+}
+
+auto TLVArchive::entry(std::size_t index) const -> TLVEntry
+{
+    expect(index < offsets_.size(), "entry {} out of range", index);
+
+    return *TLVReader(buffer_.subspan(offsets_[index]), TLVValidation::VALIDATED, buffer_).begin();
+}
+
+auto TLVArchive::has_index() const -> bool
+{
+    return !index_slots_.empty();
+}
+
+auto TLVArchive::version() const -> std::uint32_t
+{
+    return version_;
+}
+
+auto TLVArchive::alignment() const -> std::uint32_t
+{
+    return alignment_;
+}
+
+auto TLVArchive::slot(std::size_t index) const -> TLVIndexSlot
+{
+    return built_slots_.empty() ? read<TLVIndexSlot>(index_slots_.subspan(index * sizeof(TLVIndexSlot)))
+                                : built_slots_[index];
+}
+
+}
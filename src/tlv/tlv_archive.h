@@ -0,0 +1,146 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <span>
+#include <string_view>
+#include <vector>
+
+#include "tlv/tlv_entry.h"
+#include "tlv/tlv_index.h"
+#include "tlv/tlv_reader.h"
+
+namespace game
+{
+
+/**
+ * A Type-Length-Value archive. This is a non-owning view over a buffer of TLV entries which allows named entries to be
+ * looked up in constant time.
+ *
+ * The archive is validated once on construction: every entry is checked and the offset of each one is recorded. All
+ * entries read from the archive are then trusted, so neither iterating nor the entry accessors repeat any checks.
+ *
+ * If the archive was written with an index (see TLVWriter::write_index) then the index is used in place (after checking
+ * it against the entries). Otherwise an index is built in memory from the validation pass, so lookups are still
+ * constant time.
+ *
+ * Payloads written once and shared by several entries (see TLVBlobReference) are resolved transparently, so entries
+ * read from a deduplicated archive look exactly as they would have without deduplication.
+ *
+ * Archives which start with a header (see TLVWriter::write_header) guarantee that array values are aligned, the
+ * guarantee can be queried with alignment(). Archives without a header are treated as version 1 and are still readable,
+ * but make no alignment guarantee.
+ */
+class TLVArchive
+{
+  public:
+    /**
+     * Construct a new TLV archive.
+     *
+     * @param buffer
+     *   The buffer to read from. This is a non-owning view into the buffer.
+     */
+    TLVArchive(std::span<const std::byte> buffer);
+
+    /**
+     * Find a named entry in the archive. Only the matching entry is parsed.
+     *
+     * @param name
+     *   The name of the entry.
+     * @param type
+     *   The type of the entry.
+     *
+     * @returns
+     *   The entry if it exists, otherwise an empty optional.
+     */
+    auto find(std::string_view name, TLVType type) const -> std::optional<TLVEntry>;
+
+    /**
+     * Get a reader for iterating over all entries in the archive. As the archive has been validated the reader does no
+     * checking.
+     *
+     * @returns
+     *   Reader over the whole archive.
+     */
+    auto reader() const -> TLVReader;
+
+    /**
+     * Get the number of entries in the archive, not including padding.
+     *
+     * @returns
+     *   Number of entries.
+     */
+    auto entry_count() const -> std::size_t;
+
+    /**
+     * Get an entry by its position in the archive, in constant time.
+     *
+     * @param index
+     *   Position of the entry, must be less than entry_count().
+     *
+     * @returns
+     *   The entry.
+     */
+    auto entry(std::size_t index) const -> TLVEntry;
+
+    /**
+     * Check if the archive contains an on disk index.
+     *
+     * @returns
+     *   True if the archive was written with an index, false otherwise.
+     */
+    auto has_index() const -> bool;
+
+    /**
+     * Get the format version of the archive.
+     *
+     * @returns
+     *   The version from the archive header, or 1 if the archive has no header.
+     */
+    auto version() const -> std::uint32_t;
+
+    /**
+     * Get the alignment guarantee of the archive. The values of all array and composite entries start on a multiple
+     * of this many bytes, so can be viewed in place as any type with an alignment requirement no greater than this.
+     *
+     * @returns
+     *   The alignment of array values in bytes, 1 if the archive makes no guarantee.
+     */
+    auto alignment() const -> std::uint32_t;
+
+  private:
+    /**
+     * Get a slot from the index.
+     *
+     * @param index
+     *   Index of the slot, it is undefined behaviour if this is out of range.
+     *
+     * @returns
+     *   The slot at the given index.
+     */
+    auto slot(std::size_t index) const -> TLVIndexSlot;
+
+    /** The buffer to read from. This is a non-owning view into the buffer. */
+    std::span<const std::byte> buffer_;
+
+    /** View of the index slots in the buffer, empty if the archive has no index. */
+    std::span<const std::byte> index_slots_;
+
+    /** Index slots built on construction, only used if the archive has no index. */
+    std::vector<TLVIndexSlot> built_slots_;
+
+    /** Offset of every entry (other than padding), recorded when the archive is validated. */
+    std::vector<std::uint64_t> offsets_;
+
+    /** Number of slots in the index. */
+    std::size_t slot_count_;
+
+    /** Format version of the archive. */
+    std::uint32_t version_;
+
+    /** Alignment guarantee of the archive. */
+    std::uint32_t alignment_;
+};
+
+}
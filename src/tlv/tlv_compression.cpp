@@ -0,0 +1,319 @@
+#include "tlv/tlv_compression.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <memory>
+#include <optional>
+#include <span>
+#include <vector>
+
+#include "tlv/tlv_entry.h"
+#include "tlv/tlv_reader.h"
+#include "utils/error.h"
+#include "utils/lz4.h"
+
+namespace
+{
+
+/** Size of the type and length fields of an entry. */
+constexpr auto header_size = sizeof(game::TLVType) + sizeof(std::uint32_t);
+
+// staging buffers are allocated with new, so can only be aligned like an archive if new aligns to at least as much
+static_assert(__STDCPP_DEFAULT_NEW_ALIGNMENT__ >= game::tlv_alignment);
+
+/**
+ * Get the number of chunks an array is split into.
+ *
+ * @param size
+ *   Size of the array.
+ * @param chunk_size
+ *   Size of each chunk.
+ *
+ * @returns
+ *   Number of chunks.
+ */
+auto count_chunks(std::uint64_t size, std::uint32_t chunk_size) -> std::uint64_t
+{
+    return (size / chunk_size) + ((size % chunk_size) != 0u ? 1u : 0u);
+}
+
+/**
+ * Read an entry from a table of (unaligned) uint32_t.
+ *
+ * @param table
+ *   The table.
+ * @param index
+ *   Index of the entry.
+ *
+ * @returns
+ *   The entry.
+ */
+auto read_u32(std::span<const std::byte> table, std::size_t index) -> std::uint32_t
+{
+    auto value = std::uint32_t{};
+    std::memcpy(&value, table.data() + index * sizeof(value), sizeof(value));
+    return value;
+}
+
+/**
+ * Get the size of the padding needed so the value of an entry starting at an offset is aligned, as TLVWriter pads.
+ *
+ * @param offset
+ *   Offset the entry would start at.
+ *
+ * @returns
+ *   Size of the padding entry, including its header, or zero if no padding is needed.
+ */
+auto padding_size(std::size_t offset) -> std::size_t
+{
+    auto remainder = (game::tlv_alignment - (offset + header_size) % game::tlv_alignment) % game::tlv_alignment;
+
+    // not enough space to fit the padding entry header, so pad out to the next boundary instead
+    if ((remainder != 0u) && (remainder < header_size))
+    {
+        remainder += game::tlv_alignment;
+    }
+
+    return remainder;
+}
+
+/**
+ * Write the type and length of an entry.
+ *
+ * @param destination
+ *   Where to write the header.
+ * @param type
+ *   Type of the entry.
+ * @param length
+ *   Length of the value of the entry.
+ */
+auto write_header(std::byte *destination, game::TLVType type, std::size_t length) -> void
+{
+    const auto length32 = static_cast<std::uint32_t>(length);
+    std::memcpy(destination, &type, sizeof(type));
+    std::memcpy(destination + sizeof(type), &length32, sizeof(length32));
+}
+
+}
+
+namespace game
+{
+
+auto tlv_compress(TLVType type, std::span<const std::byte> data, float min_saving)
+    -> std::optional<std::vector<std::byte>>
+{
+    ensure(data.size() <= std::numeric_limits<std::uint32_t>::max(), "array of {} bytes too large", data.size());
+
+    const auto header =
+        TLVCompressedHeader{.type = type, .chunk_size = tlv_compression_chunk_size, .size = data.size()};
+
+    auto chunk_ends = std::vector<std::uint32_t>{};
+    auto chunks = std::vector<std::byte>{};
+
+    for (auto offset = std::size_t{}; offset < data.size(); offset += header.chunk_size)
+    {
+        const auto chunk = data.subspan(offset, std::min<std::size_t>(header.chunk_size, data.size() - offset));
+        const auto compressed = lz4_compress(chunk);
+
+        // a chunk which does not get smaller is stored as is, the reader can tell from its size
+        const auto stored = compressed.size() < chunk.size() ? std::span<const std::byte>{compressed} : chunk;
+        chunks.insert(std::ranges::end(chunks), std::ranges::cbegin(stored), std::ranges::cend(stored));
+        chunk_ends.push_back(static_cast<std::uint32_t>(chunks.size()));
+    }
+
+    const auto size = sizeof(header) + chunk_ends.size() * sizeof(std::uint32_t) + chunks.size();
+    if (static_cast<float>(size) > static_cast<float>(data.size()) * (1.0f - min_saving))
+    {
+        return std::nullopt;
+    }
+
+    const auto header_bytes = std::as_bytes(std::span{&header, 1u});
+    const auto table_bytes = std::as_bytes(std::span{chunk_ends});
+
+    auto value = std::vector<std::byte>{};
+    value.reserve(size);
+    value.insert(std::ranges::end(value), std::ranges::cbegin(header_bytes), std::ranges::cend(header_bytes));
+    value.insert(std::ranges::end(value), std::ranges::cbegin(table_bytes), std::ranges::cend(table_bytes));
+    value.insert(std::ranges::end(value), std::ranges::cbegin(chunks), std::ranges::cend(chunks));
+
+    return value;
+}
+
+TLVCompressedValue::TLVCompressedValue(std::span<const std::byte> value)
+    : header_()
+    , chunk_ends_()
+    , chunks_()
+{
+    ensure(value.size() >= sizeof(header_), "compressed value too small");
+    std::memcpy(&header_, value.data(), sizeof(header_));
+    ensure(header_.chunk_size != 0u, "invalid chunk size");
+
+    const auto count = count_chunks(header_.size, header_.chunk_size);
+    const auto table = value.subspan(sizeof(header_));
+    ensure(count <= table.size() / sizeof(std::uint32_t), "compressed value too small for {} chunks", count);
+
+    chunk_ends_ = table.first(count * sizeof(std::uint32_t));
+    chunks_ = table.subspan(chunk_ends_.size());
+
+    auto start = std::size_t{};
+    for (auto index = std::size_t{}; index < count; ++index)
+    {
+        const auto end = std::size_t{read_u32(chunk_ends_, index)};
+        const auto uncompressed =
+            std::min<std::uint64_t>(header_.chunk_size, header_.size - index * header_.chunk_size);
+        ensure((end >= start) && (end - start <= uncompressed) && (end <= chunks_.size()), "invalid chunk {}", index);
+
+        start = end;
+    }
+
+    ensure(start == chunks_.size(), "compressed value has trailing data");
+}
+
+auto TLVCompressedValue::type() const -> TLVType
+{
+    return header_.type;
+}
+
+auto TLVCompressedValue::size() const -> std::size_t
+{
+    return static_cast<std::size_t>(header_.size);
+}
+
+auto TLVCompressedValue::chunk_count() const -> std::size_t
+{
+    return chunk_ends_.size() / sizeof(std::uint32_t);
+}
+
+auto TLVCompressedValue::decompress_chunk(std::size_t index, std::span<std::byte> destination) const -> void
+{
+    expect(index < chunk_count(), "invalid chunk index: {}", index);
+    expect(destination.size() == size(), "destination is {} bytes, expected {}", destination.size(), size());
+
+    const auto start = index == 0u ? std::size_t{} : std::size_t{read_u32(chunk_ends_, index - 1u)};
+    const auto end = std::size_t{read_u32(chunk_ends_, index)};
+    const auto offset = index * header_.chunk_size;
+
+    const auto source = chunks_.subspan(start, end - start);
+    const auto target = destination.subspan(offset, std::min<std::size_t>(header_.chunk_size, size() - offset));
+
+    if (source.size() == target.size())
+    {
+        std::ranges::copy(source, std::ranges::begin(target));
+    }
+    else
+    {
+        lz4_decompress(source, target);
+    }
+}
+
+auto TLVCompressedValue::decompress(std::span<std::byte> destination) const -> void
+{
+    for (auto index = std::size_t{}; index < chunk_count(); ++index)
+    {
+        decompress_chunk(index, destination);
+    }
+}
+
+TLVStagingBuffer::TLVStagingBuffer(const TLVEntry &entry)
+    : type_(entry.type())
+    , buffer_()
+    , size_()
+    , members_()
+    , chunks_()
+{
+    /**
+     * Where a member goes in the copy.
+     */
+    struct Layout
+    {
+        TLVEntry member;
+        std::optional<TLVCompressedValue> compressed;
+        std::size_t offset;
+        std::size_t length;
+    };
+
+    // lay the copy out first so it can be allocated in one go, every member is aligned (which is more than the
+    // scalars need) so the layout does not depend on the member types
+    auto layout = std::vector<Layout>{};
+    for (const auto &member : entry.members())
+    {
+        const auto compressed = member.type() == TLVType::COMPRESSED
+                                    ? std::optional<TLVCompressedValue>{member.value()}
+                                    : std::nullopt;
+        const auto length = compressed ? compressed->size() : member.value().size();
+        ensure(length <= std::numeric_limits<std::uint32_t>::max(), "member of {} bytes too large", length);
+
+        size_ += padding_size(size_);
+        layout.push_back({.member = member, .compressed = compressed, .offset = size_, .length = length});
+        size_ += header_size + length;
+    }
+
+    // no point zeroing memory that is about to be overwritten
+    buffer_ = std::make_unique_for_overwrite<std::byte[]>(size_);
+
+    auto offset = std::size_t{};
+    for (const auto &[member, compressed, member_offset, length] : layout)
+    {
+        if (member_offset != offset)
+        {
+            const auto padding = member_offset - offset - header_size;
+            write_header(buffer_.get() + offset, TLVType::PADDING, padding);
+            std::memset(buffer_.get() + offset + header_size, 0, padding);
+        }
+
+        auto *destination = buffer_.get() + member_offset;
+
+        if (compressed)
+        {
+            write_header(destination, compressed->type(), length);
+            members_.push_back({.value = *compressed, .destination = {destination + header_size, length}});
+
+            for (auto index = std::size_t{}; index < compressed->chunk_count(); ++index)
+            {
+                chunks_.push_back({.member = members_.size() - 1u, .index = index});
+            }
+        }
+        else
+        {
+            write_header(destination, member.type(), length);
+            std::ranges::copy(member.value(), destination + header_size);
+        }
+
+        offset = member_offset + header_size + length;
+    }
+}
+
+auto TLVStagingBuffer::chunk_count() const -> std::size_t
+{
+    return chunks_.size();
+}
+
+auto TLVStagingBuffer::decompress_chunk(std::size_t index) -> void
+{
+    expect(index < chunks_.size(), "invalid chunk index: {}", index);
+
+    const auto &chunk = chunks_[index];
+    const auto &member = members_[chunk.member];
+
+    member.value.decompress_chunk(chunk.index, member.destination);
+}
+
+auto TLVStagingBuffer::decompress() -> void
+{
+    for (auto index = std::size_t{}; index < chunks_.size(); ++index)
+    {
+        decompress_chunk(index);
+    }
+}
+
+auto TLVStagingBuffer::entry() const -> TLVEntry
+{
+    // the decompressed data has never been checked, so the copy is checked as it is read
+    const auto value = std::span<const std::byte>{buffer_.get(), size_};
+    return {type_, value, TLVValidation::CHECKED, value};
+}
+
+}
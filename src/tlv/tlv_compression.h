@@ -0,0 +1,199 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <span>
+#include <vector>
+
+#include "tlv/tlv_entry.h"
+
+namespace game
+{
+
+/**
+ * Uncompressed size of each chunk of a compressed array. Small enough that a large texture is spread over every loader
+ * thread, large enough that the per chunk overhead (in both size and time) is negligible.
+ */
+inline constexpr auto tlv_compression_chunk_size = std::uint32_t{64u * 1024u};
+
+/**
+ * Compress an array payload into the value of a COMPRESSED entry, see TLVCompressedHeader.
+ *
+ * @param type
+ *   The type of the array.
+ * @param data
+ *   The payload.
+ * @param min_saving
+ *   Fraction of the size of the payload compression has to save for it to be worth decompressing on load.
+ *
+ * @returns
+ *   The value of the COMPRESSED entry, or an empty optional if compression did not save enough.
+ */
+auto tlv_compress(TLVType type, std::span<const std::byte> data, float min_saving)
+    -> std::optional<std::vector<std::byte>>;
+
+/**
+ * A non-owning view of the value of a COMPRESSED entry.
+ *
+ * The structure of the value is always checked on construction, regardless of whether the archive it came from was
+ * validated, as that is cheap. The chunks themselves are checked as they are decompressed.
+ */
+class TLVCompressedValue
+{
+  public:
+    /**
+     * Construct a new compressed value, will throw if it is malformed.
+     *
+     * @param value
+     *   The value of a COMPRESSED entry.
+     */
+    explicit TLVCompressedValue(std::span<const std::byte> value);
+
+    /**
+     * Get the type of the array that was compressed.
+     *
+     * @returns
+     *   The array type.
+     */
+    auto type() const -> TLVType;
+
+    /**
+     * Get the uncompressed size of the array.
+     *
+     * @returns
+     *   Size in bytes.
+     */
+    auto size() const -> std::size_t;
+
+    /**
+     * Get the number of independently compressed chunks.
+     *
+     * @returns
+     *   Number of chunks.
+     */
+    auto chunk_count() const -> std::size_t;
+
+    /**
+     * Decompress a single chunk. Chunks are independent, so different chunks can be decompressed concurrently.
+     *
+     * @param index
+     *   Index of the chunk.
+     * @param destination
+     *   Buffer for the whole array, must be size() bytes. Only the part of it for this chunk is written.
+     */
+    auto decompress_chunk(std::size_t index, std::span<std::byte> destination) const -> void;
+
+    /**
+     * Decompress every chunk on the calling thread.
+     *
+     * @param destination
+     *   Buffer for the whole array, must be size() bytes.
+     */
+    auto decompress(std::span<std::byte> destination) const -> void;
+
+  private:
+    /** The header, copied out as the value may not be aligned. */
+    TLVCompressedHeader header_;
+
+    /** Table of chunk end offsets, kept as bytes for the same reason. */
+    std::span<const std::byte> chunk_ends_;
+
+    /** The compressed chunks. */
+    std::span<const std::byte> chunks_;
+};
+
+/**
+ * A copy of a composite entry with all of its compressed members decompressed, so it can be viewed like any other
+ * entry. Members which are not compressed are copied as they are.
+ *
+ * Construction lays out and allocates the copy and fills in everything except the compressed members. Their chunks
+ * are then decompressed straight into the copy, either all at once with decompress() or individually (and possibly
+ * concurrently, e.g. with ThreadPool::parallel_for) with decompress_chunk(). The entry is only valid once every chunk
+ * has been decompressed.
+ *
+ * The copy is heap allocated so moving a staging buffer does not invalidate the entry or any views into it.
+ */
+class TLVStagingBuffer
+{
+  public:
+    /**
+     * Construct a new staging buffer.
+     *
+     * @param entry
+     *   The entry to copy, must be a composite.
+     */
+    explicit TLVStagingBuffer(const TLVEntry &entry);
+
+    /**
+     * Get the number of chunks to decompress, over all members.
+     *
+     * @returns
+     *   Number of chunks.
+     */
+    auto chunk_count() const -> std::size_t;
+
+    /**
+     * Decompress a single chunk, different chunks can be decompressed concurrently.
+     *
+     * @param index
+     *   Index of the chunk, less than chunk_count().
+     */
+    auto decompress_chunk(std::size_t index) -> void;
+
+    /**
+     * Decompress every chunk on the calling thread.
+     */
+    auto decompress() -> void;
+
+    /**
+     * Get the decompressed entry. The entry (and any view from it) is only valid as long as this object.
+     *
+     * @returns
+     *   The entry.
+     */
+    auto entry() const -> TLVEntry;
+
+  private:
+    /**
+     * A compressed member and where it decompresses to.
+     */
+    struct Member
+    {
+        /** The compressed value. */
+        TLVCompressedValue value;
+
+        /** Where in the copy it decompresses to. */
+        std::span<std::byte> destination;
+    };
+
+    /**
+     * A single chunk of a compressed member.
+     */
+    struct Chunk
+    {
+        /** Index into members_. */
+        std::size_t member;
+
+        /** Index of the chunk in the member. */
+        std::size_t index;
+    };
+
+    /** Type of the entry. */
+    TLVType type_;
+
+    /** The copy of the value of the entry. */
+    std::unique_ptr<std::byte[]> buffer_;
+
+    /** Size of the copy. */
+    std::size_t size_;
+
+    /** All compressed members. */
+    std::vector<Member> members_;
+
+    /** All chunks of all compressed members. */
+    std::vector<Chunk> chunks_;
+};
+
+}
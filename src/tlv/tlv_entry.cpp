@@ -1,24 +1,210 @@
 #include "tlv/tlv_entry.h"
 
+#include <algorithm>
 #include <cstddef>
 #include <cstdint>
 #include <cstring>
+#include <format>
 #include <span>
 #include <string>
+#include <string_view>
+#include <tuple>
+#include <utility>
 #include <vector>
 
 #include "graphics/mesh_data.h"
 #include "graphics/texture.h"
 #include "graphics/vertex_data.h"
+#include "graphics/vertex_layout.h"
+#include "tlv/tlv_compression.h"
 #include "tlv/tlv_reader.h"
 #include "utils/error.h"
 
+namespace
+{
+
+/**
+ * Fixed size part of a serialised vertex layout, the attributes follow.
+ */
+struct VertexLayoutHeader
+{
+    std::uint32_t stride;
+    game::IndexType index_type;
+    game::Vector3 position_offset;
+    game::Vector3 position_scale;
+};
+
+/**
+ * Check if a type is a named composite.
+ *
+ * @param type
+ *   The type to check.
+ *
+ * @returns
+ *   True if the type is a named composite, false otherwise.
+ */
+auto is_composite(game::TLVType type) -> bool
+{
+    return (type == game::TLVType::TEXTURE_DESCRIPTION) || (type == game::TLVType::MESH_DATA) ||
+           (type == game::TLVType::PACKED_MESH_DATA);
+}
+
+/**
+ * Check if a type is an array, i.e. something a blob can stand in for.
+ *
+ * @param type
+ *   The type to check.
+ *
+ * @returns
+ *   True if the type is an array, false otherwise.
+ */
+auto is_array(game::TLVType type) -> bool
+{
+    return (type == game::TLVType::UINT32_ARRAY) || (type == game::TLVType::BYTE_ARRAY) ||
+           (type == game::TLVType::VERTEX_DATA_ARRAY);
+}
+
+/**
+ * Verify something is true and throw an exception if not, unless the data has already been validated in which case the
+ * check has already been made.
+ *
+ * @param validation
+ *   Whether the data has been validated.
+ * @param predicate
+ *   The thing to test.
+ * @param msg
+ *   The message to print if the predicate is false.
+ * @param args
+ *   The arguments to format the message with.
+ */
+template <class... Args>
+auto check(game::TLVValidation validation, bool predicate, std::format_string<Args...> msg, Args &&...args) -> void
+{
+    if (validation == game::TLVValidation::CHECKED)
+    {
+        game::ensure(predicate, msg, std::forward<Args>(args)...);
+    }
+}
+
+/**
+ * Get the type of an array member, looking through compression.
+ *
+ * @param member
+ *   The member.
+ *
+ * @returns
+ *   The type of the member, or of the array it holds if it is compressed.
+ */
+auto array_type(const game::TLVEntry &member) -> game::TLVType
+{
+    return member.type() == game::TLVType::COMPRESSED ? game::TLVCompressedValue{member.value()}.type()
+                                                      : member.type();
+}
+
+/**
+ * Get the size of an array member, looking through compression.
+ *
+ * @param member
+ *   The member.
+ *
+ * @returns
+ *   The size of the member, or of the array it holds if it is compressed.
+ */
+auto array_size(const game::TLVEntry &member) -> std::size_t
+{
+    return member.type() == game::TLVType::COMPRESSED ? game::TLVCompressedValue{member.value()}.size()
+                                                      : member.value().size();
+}
+
+/**
+ * Check a member which is about to be viewed in place is not compressed. Compressed members are allowed in a validated
+ * archive, so this is always checked.
+ *
+ * @param member
+ *   The member.
+ */
+auto ensure_uncompressed(const game::TLVEntry &member) -> void
+{
+    game::ensure(
+        member.type() != game::TLVType::COMPRESSED,
+        "{} is compressed so cannot be viewed in place",
+        array_type(member));
+}
+
+/**
+ * Helper function to copy an array value, decompressing it if needed.
+ *
+ * @param entry
+ *   The entry to copy.
+ * @param type
+ *   The expected array type.
+ * @param validation
+ *   Whether the entry has been validated.
+ *
+ * @returns
+ *   Copy of the value as an array of T.
+ */
+template <class T>
+auto copy_array(const game::TLVEntry &entry, game::TLVType type, game::TLVValidation validation) -> std::vector<T>
+{
+    if (entry.type() == game::TLVType::COMPRESSED)
+    {
+        // the contents of a compressed value are never validated up front, so are always checked
+        const auto compressed = game::TLVCompressedValue{entry.value()};
+        game::ensure(compressed.type() == type, "incorrect type");
+        game::ensure(compressed.size() % sizeof(T) == 0u, "incorrect size");
+
+        auto value = std::vector<T>(compressed.size() / sizeof(T));
+        compressed.decompress(std::as_writable_bytes(std::span{value}));
+
+        return value;
+    }
+
+    check(validation, entry.type() == type, "incorrect type");
+    check(validation, entry.value().size() % sizeof(T) == 0u, "incorrect size");
+
+    auto value = std::vector<T>(entry.value().size() / sizeof(T));
+    std::memcpy(value.data(), entry.value().data(), value.size() * sizeof(T));
+
+    return value;
+}
+
+/**
+ * Helper function to view a value as an array of T.
+ *
+ * @param value
+ *   The value to view, must be a multiple of sizeof(T) bytes.
+ * @param validation
+ *   Whether the value has been validated.
+ *
+ * @returns
+ *   View of the value as an array of T.
+ */
+template <class T>
+auto as_span(std::span<const std::byte> value, game::TLVValidation validation) -> std::span<const T>
+{
+    check(validation, value.size() % sizeof(T) == 0u, "incorrect size");
+
+    // alignment depends on where the buffer was loaded rather than its contents, so is always checked
+    game::ensure(reinterpret_cast<std::uintptr_t>(value.data()) % alignof(T) == 0u, "misaligned value");
+
+    return {reinterpret_cast<const T *>(value.data()), value.size() / sizeof(T)};
+}
+
+}
+
 namespace game
 {
 
-TLVEntry::TLVEntry(TLVType type, std::span<const std::byte> value)
+TLVEntry::TLVEntry(
+    TLVType type,
+    std::span<const std::byte> value,
+    TLVValidation validation,
+    std::span<const std::byte> archive)
     : type_(type)
     , value_(value)
+    , validation_(validation)
+    , archive_(archive)
 {
 }
 
@@ -27,10 +213,26 @@ auto TLVEntry::type() const -> TLVType
     return type_;
 }
 
+auto TLVEntry::value() const -> std::span<const std::byte>
+{
+    return value_;
+}
+
+auto TLVEntry::name() const -> std::string_view
+{
+    check(validation_, is_composite(type_), "entry is not named");
+
+    const auto reader = TLVReader(value_, validation_, archive_);
+    const auto name_entry = *std::ranges::begin(reader);
+    check(validation_, name_entry.type() == TLVType::STRING, "first member not string");
+
+    return {reinterpret_cast<const char *>(name_entry.value_.data()), name_entry.value_.size()};
+}
+
 auto TLVEntry::uint32_value() const -> std::uint32_t
 {
-    ensure(type_ == TLVType::UINT32, "incorrect type");
-    ensure(value_.size() == sizeof(std::uint32_t), "incorrect size");
+    check(validation_, type_ == TLVType::UINT32, "incorrect type");
+    check(validation_, value_.size() == sizeof(std::uint32_t), "incorrect size");
 
     auto value = std::uint32_t{};
     std::memcpy(&value, value_.data(), sizeof(value));
@@ -39,17 +241,19 @@ auto TLVEntry::uint32_value() const -> std::uint32_t
 
 auto TLVEntry::uint32_array_value() const -> std::vector<std::uint32_t>
 {
-    ensure(type_ == TLVType::UINT32_ARRAY, "incorrect type");
+    return copy_array<std::uint32_t>(*this, TLVType::UINT32_ARRAY, validation_);
+}
 
-    auto value = std::vector<std::uint32_t>(value_.size() / sizeof(std::uint32_t));
-    std::memcpy(value.data(), value_.data(), value_.size());
+auto TLVEntry::uint32_array_view() const -> std::span<const std::uint32_t>
+{
+    check(validation_, type_ == TLVType::UINT32_ARRAY, "incorrect type");
 
-    return value;
+    return as_span<std::uint32_t>(value_, validation_);
 }
 
 auto TLVEntry::string_value() const -> std::string
 {
-    ensure(type_ == TLVType::STRING, "incorrect type");
+    check(validation_, type_ == TLVType::STRING, "incorrect type");
 
     const auto *ptr = reinterpret_cast<const char *>(value_.data());
     return std::string(ptr, ptr + value_.size());
@@ -57,10 +261,54 @@ auto TLVEntry::string_value() const -> std::string
 
 auto TLVEntry::byte_array_value() const -> std::vector<std::byte>
 {
-    ensure(type_ == TLVType::BYTE_ARRAY, "incorrect type");
+    return copy_array<std::byte>(*this, TLVType::BYTE_ARRAY, validation_);
+}
+
+auto TLVEntry::byte_array_view() const -> std::span<const std::byte>
+{
+    check(validation_, type_ == TLVType::BYTE_ARRAY, "incorrect type");
+
+    return value_;
+}
+
+auto TLVEntry::is_compressed() const -> bool
+{
+    if (type_ == TLVType::COMPRESSED)
+    {
+        return true;
+    }
+
+    if (!is_composite(type_))
+    {
+        return false;
+    }
+
+    return std::ranges::any_of(members(), [](const auto &member) { return member.type() == TLVType::COMPRESSED; });
+}
+
+auto TLVEntry::resolve() const -> TLVEntry
+{
+    if ((type_ != TLVType::BLOB_REFERENCE) || archive_.empty())
+    {
+        return *this;
+    }
+
+    check(validation_, value_.size() == sizeof(TLVBlobReference), "incorrect size");
 
-    const auto *ptr = reinterpret_cast<const std::byte *>(value_.data());
-    return std::vector<std::byte>(ptr, ptr + value_.size());
+    auto reference = TLVBlobReference{};
+    std::memcpy(&reference, value_.data(), sizeof(reference));
+
+    check(
+        validation_,
+        is_array(reference.type) || (reference.type == TLVType::COMPRESSED),
+        "cannot reference a {}",
+        reference.type);
+    check(validation_, reference.offset < archive_.size(), "blob offset out of range");
+
+    const auto blob = *TLVReader(archive_.subspan(reference.offset), validation_, archive_).begin();
+    check(validation_, blob.type_ == TLVType::BLOB, "reference does not point to a blob");
+
+    return {reference.type, blob.value_, validation_, archive_};
 }
 
 auto TLVEntry::size() const -> std::uint32_t
@@ -68,10 +316,66 @@ auto TLVEntry::size() const -> std::uint32_t
     return static_cast<std::uint32_t>(sizeof(type_) + sizeof(std::uint32_t) + value_.size());
 }
 
+auto TLVEntry::validate() const -> void
+{
+    // always check, even if this entry claims to be validated
+    const auto entry = TLVEntry{type_, value_, TLVValidation::CHECKED, archive_};
+
+    switch (type_)
+    {
+        using enum TLVType;
+
+        case UINT32: entry.uint32_value(); break;
+        case UINT32_ARRAY: ensure(value_.size() % sizeof(std::uint32_t) == 0u, "incorrect size"); break;
+        case TEXTURE_FORMAT: entry.texture_format_value(); break;
+        case TEXTURE_USAGE: entry.texture_usage_value(); break;
+        case VERTEX_DATA: entry.vertex_data_value(); break;
+        case VERTEX_DATA_ARRAY: ensure(value_.size() % sizeof(VertexData) == 0u, "incorrect size"); break;
+        case VERTEX_LAYOUT: entry.vertex_layout_value(); break;
+        case BLOB_REFERENCE: entry.resolve(); break;
+        case COMPRESSED:
+        {
+            // only the structure, the chunks are checked as they are decompressed
+            const auto compressed = TLVCompressedValue{value_};
+            ensure(is_array(compressed.type()), "cannot compress a {}", compressed.type());
+            break;
+        }
+
+        // the composite parts check the structure, then each array member checks itself (the parts look through
+        // compression so this works for compressed members too)
+        case TEXTURE_DESCRIPTION:
+        {
+            entry.name();
+            const auto [description, data] = entry.texture_description_parts();
+            data.validate();
+            break;
+        }
+        case MESH_DATA:
+        {
+            entry.name();
+            const auto [vertices, indices] = entry.mesh_parts();
+            vertices.validate();
+            indices.validate();
+            break;
+        }
+        case PACKED_MESH_DATA:
+        {
+            entry.name();
+            const auto [layout, vertices, indices] = entry.packed_mesh_parts();
+            vertices.validate();
+            indices.validate();
+            break;
+        }
+
+        // strings, byte arrays and blobs can hold anything and the archive metadata is checked by the archive
+        default: break;
+    }
+}
+
 auto TLVEntry::texture_format_value() const -> TextureFormat
 {
-    ensure(type_ == TLVType::TEXTURE_FORMAT, "incorrect type");
-    ensure(value_.size() == sizeof(TextureFormat), "incorrect size");
+    check(validation_, type_ == TLVType::TEXTURE_FORMAT, "incorrect type");
+    check(validation_, value_.size() == sizeof(TextureFormat), "incorrect size");
 
     auto value = TextureFormat{};
     std::memcpy(&value, value_.data(), sizeof(value));
@@ -80,8 +384,8 @@ auto TLVEntry::texture_format_value() const -> TextureFormat
 
 auto TLVEntry::texture_usage_value() const -> TextureUsage
 {
-    ensure(type_ == TLVType::TEXTURE_USAGE, "incorrect type");
-    ensure(value_.size() == sizeof(TextureUsage), "incorrect size");
+    check(validation_, type_ == TLVType::TEXTURE_USAGE, "incorrect type");
+    check(validation_, value_.size() == sizeof(TextureUsage), "incorrect size");
 
     auto value = TextureUsage{};
     std::memcpy(&value, value_.data(), sizeof(value));
@@ -90,35 +394,68 @@ auto TLVEntry::texture_usage_value() const -> TextureUsage
 
 auto TLVEntry::texture_description_value() const -> TextureDescription
 {
-    ensure(type_ == TLVType::TEXTURE_DESCRIPTION, "incorrect type");
+    const auto [description, data] = texture_description_parts();
+
+    return {
+        description.width,
+        description.height,
+        description.format,
+        description.usage,
+        description.mip_levels,
+        copy_array<std::byte>(data, TLVType::BYTE_ARRAY, validation_)};
+}
+
+auto TLVEntry::texture_description_view() const -> TextureDescriptionView
+{
+    auto [description, data] = texture_description_parts();
+    ensure_uncompressed(data);
 
-    const auto reader = TLVReader(value_);
+    description.data = data.byte_array_view();
+
+    return description;
+}
+
+auto TLVEntry::texture_description_parts() const -> std::pair<TextureDescriptionView, TLVEntry>
+{
+    check(validation_, type_ == TLVType::TEXTURE_DESCRIPTION, "incorrect type");
+
+    const auto reader = TLVReader(value_, validation_, archive_);
     auto reader_cursor = std::ranges::begin(reader);
 
-    ensure((*reader_cursor).type() == TLVType::STRING, "first member not string");
+    check(validation_, (*reader_cursor).type() == TLVType::STRING, "first member not string");
     ++reader_cursor;
 
     const auto width = (*reader_cursor).uint32_value();
     ++reader_cursor;
-    ensure(reader_cursor != std::ranges::end(reader), "texture TLV too small");
+    check(validation_, reader_cursor != std::ranges::end(reader), "texture TLV too small");
 
     const auto height = (*reader_cursor).uint32_value();
     ++reader_cursor;
-    ensure(reader_cursor != std::ranges::end(reader), "texture TLV too small");
+    check(validation_, reader_cursor != std::ranges::end(reader), "texture TLV too small");
 
-    [[maybe_unused]] const auto format = (*reader_cursor).texture_format_value();
+    const auto format = (*reader_cursor).texture_format_value();
     ++reader_cursor;
-    ensure(reader_cursor != std::ranges::end(reader), "texture TLV too small");
+    check(validation_, reader_cursor != std::ranges::end(reader), "texture TLV too small");
 
     const auto usage = (*reader_cursor).texture_usage_value();
     ++reader_cursor;
-    ensure(reader_cursor != std::ranges::end(reader), "texture TLV too small");
+    check(validation_, reader_cursor != std::ranges::end(reader), "texture TLV too small");
 
-    auto data = (*reader_cursor).byte_array_value();
+    // older archives have no mip level count and only ever store level 0
+    auto mip_levels = std::uint32_t{1u};
+    if ((*reader_cursor).type() == TLVType::UINT32)
+    {
+        mip_levels = (*reader_cursor).uint32_value();
+        ++reader_cursor;
+        check(validation_, reader_cursor != std::ranges::end(reader), "texture TLV too small");
+    }
+
+    const auto data = *reader_cursor;
+    check(validation_, array_type(data) == TLVType::BYTE_ARRAY, "texture data not byte array");
     ++reader_cursor;
-    ensure(reader_cursor == std::ranges::end(reader), "texture TLV too large");
+    check(validation_, reader_cursor == std::ranges::end(reader), "texture TLV too large");
 
-    return {width, height, format, usage, std::move(data)};
+    return {{width, height, format, usage, mip_levels, {}}, data};
 }
 
 auto TLVEntry::is_texture(std::string_view name) const -> bool
@@ -128,17 +465,13 @@ auto TLVEntry::is_texture(std::string_view name) const -> bool
         return false;
     }
 
-    const auto reader = TLVReader(value_);
-    auto reader_cursor = std::ranges::begin(reader);
-
-    const auto texture_name = (*reader_cursor).string_value();
-    return texture_name == name;
+    return this->name() == name;
 }
 
 auto TLVEntry::vertex_data_value() const -> VertexData
 {
-    ensure(type_ == TLVType::VERTEX_DATA, "incorrect type");
-    ensure(value_.size() == sizeof(VertexData), "incorrect size");
+    check(validation_, type_ == TLVType::VERTEX_DATA, "incorrect type");
+    check(validation_, value_.size() == sizeof(VertexData), "incorrect size");
 
     auto value = VertexData{};
     std::memcpy(&value, value_.data(), sizeof(value));
@@ -147,53 +480,135 @@ auto TLVEntry::vertex_data_value() const -> VertexData
 
 auto TLVEntry::vertex_data_array_value() const -> std::vector<VertexData>
 {
-    ensure(type_ == TLVType::VERTEX_DATA_ARRAY, "incorrect type");
+    return copy_array<VertexData>(*this, TLVType::VERTEX_DATA_ARRAY, validation_);
+}
+
+auto TLVEntry::vertex_data_array_view() const -> std::span<const VertexData>
+{
+    check(validation_, type_ == TLVType::VERTEX_DATA_ARRAY, "incorrect type");
 
-    auto value = std::vector<VertexData>(value_.size() / sizeof(VertexData));
-    std::memcpy(value.data(), value_.data(), value_.size());
+    return as_span<VertexData>(value_, validation_);
+}
+
+auto TLVEntry::vertex_layout_value() const -> VertexLayout
+{
+    check(validation_, type_ == TLVType::VERTEX_LAYOUT, "incorrect type");
+    check(validation_, value_.size() >= sizeof(VertexLayoutHeader), "incorrect size");
+    check(
+        validation_, (value_.size() - sizeof(VertexLayoutHeader)) % sizeof(VertexAttribute) == 0u, "incorrect size");
+
+    auto header = VertexLayoutHeader{};
+    std::memcpy(&header, value_.data(), sizeof(header));
+
+    auto value = VertexLayout{
+        .stride = header.stride,
+        .index_type = header.index_type,
+        .position_offset = header.position_offset,
+        .position_scale = header.position_scale,
+        .attributes = std::vector<VertexAttribute>((value_.size() - sizeof(header)) / sizeof(VertexAttribute))};
+    std::memcpy(value.attributes.data(), value_.data() + sizeof(header), value_.size() - sizeof(header));
+
+    for (const auto &attribute : value.attributes)
+    {
+        check(
+            validation_,
+            attribute.offset + attribute.components * component_size(attribute.type) <= value.stride,
+            "attribute {} outside of vertex",
+            attribute.location);
+    }
 
     return value;
 }
 
+auto TLVEntry::members() const -> TLVReader
+{
+    check(validation_, is_composite(type_), "entry is not a composite");
+
+    return {value_, validation_, archive_};
+}
+
 auto TLVEntry::mesh_value() const -> MeshData
 {
-    ensure(type_ == TLVType::MESH_DATA, "incorrect type");
+    const auto [vertices, indices] = mesh_parts();
+    ensure_uncompressed(vertices);
+    ensure_uncompressed(indices);
+
+    return {vertices.vertex_data_array_view(), indices.uint32_array_view()};
+}
+
+auto TLVEntry::mesh_parts() const -> std::pair<TLVEntry, TLVEntry>
+{
+    check(validation_, type_ == TLVType::MESH_DATA, "incorrect type");
 
-    const auto reader = TLVReader(value_);
+    const auto reader = TLVReader(value_, validation_, archive_);
     auto reader_cursor = std::ranges::begin(reader);
 
-    ensure((*reader_cursor).type() == TLVType::STRING, "first member not string");
+    check(validation_, (*reader_cursor).type() == TLVType::STRING, "first member not string");
     ++reader_cursor;
 
-    ensure((*reader_cursor).type() == TLVType::VERTEX_DATA_ARRAY, "second member not vertex data array");
-    const auto vertex_data = std::span<const VertexData>{
-        reinterpret_cast<const VertexData *>((*reader_cursor).value_.data()),
-        (*reader_cursor).value_.size() / sizeof(VertexData)};
+    const auto vertices = *reader_cursor;
+    check(validation_, array_type(vertices) == TLVType::VERTEX_DATA_ARRAY, "second member not vertex data array");
     ++reader_cursor;
 
-    ensure((*reader_cursor).type() == TLVType::UINT32_ARRAY, "third member not uint32 array");
-    const auto index_data = std::span<const std::uint32_t>{
-        reinterpret_cast<const std::uint32_t *>((*reader_cursor).value_.data()),
-        (*reader_cursor).value_.size() / sizeof(std::uint32_t)};
+    const auto indices = *reader_cursor;
+    check(validation_, array_type(indices) == TLVType::UINT32_ARRAY, "third member not uint32 array");
 
     ++reader_cursor;
-    ensure(reader_cursor == std::ranges::end(reader), "texture TLV too large");
+    check(validation_, reader_cursor == std::ranges::end(reader), "texture TLV too large");
 
-    return {vertex_data, index_data};
+    return {vertices, indices};
+}
+
+auto TLVEntry::packed_mesh_value() const -> PackedMeshData
+{
+    auto [layout, vertices, indices] = packed_mesh_parts();
+    ensure_uncompressed(vertices);
+    ensure_uncompressed(indices);
+
+    return {.layout = std::move(layout), .vertices = vertices.byte_array_view(), .indices = indices.byte_array_view()};
+}
+
+auto TLVEntry::packed_mesh_parts() const -> std::tuple<VertexLayout, TLVEntry, TLVEntry>
+{
+    check(validation_, type_ == TLVType::PACKED_MESH_DATA, "incorrect type");
+
+    const auto reader = TLVReader(value_, validation_, archive_);
+    auto reader_cursor = std::ranges::begin(reader);
+
+    check(validation_, (*reader_cursor).type() == TLVType::STRING, "first member not string");
+    ++reader_cursor;
+
+    check(validation_, (*reader_cursor).type() == TLVType::VERTEX_LAYOUT, "second member not vertex layout");
+    auto layout = (*reader_cursor).vertex_layout_value();
+    ++reader_cursor;
+
+    const auto vertices = *reader_cursor;
+    check(validation_, array_type(vertices) == TLVType::BYTE_ARRAY, "third member not byte array");
+    ++reader_cursor;
+
+    const auto indices = *reader_cursor;
+    check(validation_, array_type(indices) == TLVType::BYTE_ARRAY, "fourth member not byte array");
+
+    ++reader_cursor;
+    check(validation_, reader_cursor == std::ranges::end(reader), "packed mesh TLV too large");
+
+    check(
+        validation_,
+        layout.stride != 0u && array_size(vertices) % layout.stride == 0u,
+        "vertex data size mismatch");
+    check(validation_, array_size(indices) % index_size(layout.index_type) == 0u, "index data size mismatch");
+
+    return {std::move(layout), vertices, indices};
 }
 
 auto TLVEntry::is_mesh(std::string_view name) const -> bool
 {
-    if (type_ != TLVType::MESH_DATA)
+    if ((type_ != TLVType::MESH_DATA) && (type_ != TLVType::PACKED_MESH_DATA))
     {
         return false;
     }
 
-    const auto reader = TLVReader(value_);
-    auto reader_cursor = std::ranges::begin(reader);
-
-    const auto mesh_name = (*reader_cursor).string_value();
-    return mesh_name == name;
+    return this->name() == name;
 }
 
 auto to_string(const game::TLVType &obj) -> std::string
@@ -214,6 +629,17 @@ auto to_string(const game::TLVType &obj) -> std::string
 
         case TEXTURE_DESCRIPTION: str = "TEXTURE_DESCRIPTION"sv; break;
         case MESH_DATA: str = "MESH_DATA"sv; break;
+
+        case INDEX: str = "INDEX"sv; break;
+        case INDEX_LOCATION: str = "INDEX_LOCATION"sv; break;
+        case HEADER: str = "HEADER"sv; break;
+        case PADDING: str = "PADDING"sv; break;
+
+        case VERTEX_LAYOUT: str = "VERTEX_LAYOUT"sv; break;
+        case PACKED_MESH_DATA: str = "PACKED_MESH_DATA"sv; break;
+        case BLOB: str = "BLOB"sv; break;
+        case BLOB_REFERENCE: str = "BLOB_REFERENCE"sv; break;
+        case COMPRESSED: str = "COMPRESSED"sv; break;
     }
 
     return std::format("{}", str);
@@ -4,17 +4,23 @@
 #include <cstdint>
 #include <span>
 #include <string>
+#include <string_view>
+#include <tuple>
+#include <utility>
 #include <vector>
 
 #include "graphics/mesh_data.h"
 #include "graphics/texture.h"
 #include "graphics/vertex_data.h"
+#include "graphics/vertex_layout.h"
 
 using namespace std::literals;
 
 namespace game
 {
 
+class TLVReader;
+
 /**
  * Enumeration of TLV types.
  */
@@ -31,8 +37,96 @@ enum class TLVType : std::uint32_t
 
     // composite types
     TEXTURE_DESCRIPTION,
-    MESH_DATA
+    MESH_DATA,
+
+    // archive metadata
+    INDEX,
+    INDEX_LOCATION,
+    HEADER,
+    PADDING,
+
+    // types are stored in archives so new types are appended to keep existing values stable
+
+    VERTEX_LAYOUT,
+    PACKED_MESH_DATA,
+    BLOB,
+    BLOB_REFERENCE,
+    COMPRESSED
+};
+
+/** Magic value stored in the archive header, "UGTL" when read as bytes. */
+inline constexpr auto tlv_magic = std::uint32_t{0x4c544755};
+
+/**
+ * Current version of the archive format.
+ *
+ * Version 1 archives have no header and entries are packed with no regard to alignment. Version 2 archives start with
+ * a HEADER entry and the values of all array and composite entries start on a tlv_alignment boundary.
+ */
+inline constexpr auto tlv_version = std::uint32_t{2u};
+
+/** Alignment (in bytes) of array and composite values in a version 2 archive. */
+inline constexpr auto tlv_alignment = std::uint32_t{16u};
+
+/**
+ * Enumeration of how much checking is needed when reading TLV data.
+ */
+enum class TLVValidation
+{
+    /** Nothing is known about the data, everything is checked as it is read. */
+    CHECKED,
+
+    /** The data has already been validated (see TLVArchive), so reads skip the checks. */
+    VALIDATED
+};
+
+/**
+ * The value of a BLOB_REFERENCE entry.
+ *
+ * Archives written with deduplication (see TLVWriter::set_deduplication) store the payload of each array member of a
+ * composite once, in a top level BLOB entry, and the composite holds a reference in place of the array. The blob is
+ * identified by its offset, so resolving a reference is constant time. Readers resolve references transparently, the
+ * entry returned has the type of the original array and the value of the blob.
+ */
+struct TLVBlobReference
+{
+    /** Type of the array the blob stands in for, or COMPRESSED if the blob holds a compressed array. */
+    TLVType type;
+
+    /** Unused, keeps offset aligned. */
+    std::uint32_t reserved;
+
+    /** Offset of the start of the BLOB entry (the type field) from the start of the archive. */
+    std::uint64_t offset;
+};
+static_assert(sizeof(TLVBlobReference) == 16u);
+
+/**
+ * The start of the value of a COMPRESSED entry.
+ *
+ * Archives written with compression (see TLVWriter::set_compression) may store the array members of a composite
+ * compressed, when doing so saves enough space. The payload is split into fixed size chunks which are compressed
+ * independently (see lz4_compress), so they can be decompressed in parallel. The value is laid out as:
+ *
+ *   - this header
+ *   - for each chunk, the offset (from the end of this table) of the end of its compressed data as a uint32_t
+ *   - the compressed chunks, back to back
+ *
+ * A chunk which would not get any smaller is stored as is, which is the case when its stored size is the same as its
+ * uncompressed size. Compressed members cannot be viewed in place, see TLVStagingBuffer.
+ */
+struct TLVCompressedHeader
+{
+    /** Type of the array that was compressed. */
+    TLVType type;
+
+    /** Uncompressed size of each chunk, except the last which may be smaller. */
+    std::uint32_t chunk_size;
+
+    /** Uncompressed size of the whole array. */
+    std::uint64_t size;
 };
+static_assert(sizeof(TLVCompressedHeader) == 16u);
 
 /**
  * A Type-Length-Value entry. This is a non-owning view into a TLV entry.
@@ -49,7 +143,17 @@ enum class TLVType : std::uint32_t
  * |  ...   |  |
  * +--------+ -'
  *
- * It is assumed TLVs will contain user controlled data so they have wide contracts.
+ * It is assumed TLVs will contain user controlled data so they have wide contracts. The exception is entries read from
+ * a validated archive, these have already had every check made so accessors skip them.
+ *
+ * Views into array values require the value to be suitably aligned for the element type (and will throw otherwise),
+ * this is always the case for archives written with a header (see TLVWriter::write_header).
+ *
+ * Blob references (see TLVBlobReference) are resolved against the buffer the entry was read from, so an entry must not
+ * outlive that buffer (which is already true of any view it returns).
+ *
+ * Compressed members (see TLVCompressedHeader) are decompressed by the accessors which return a copy, the accessors
+ * which return a view throw if they would have to decompress.
  */
 class TLVEntry
 {
@@ -61,8 +165,16 @@ class TLVEntry
      *   The type of the entry.
      * @param value
      *   The data for the entry.
+     * @param validation
+     *   Whether the entry has already been validated, only pass VALIDATED if validate() has been called on the entry.
+     * @param archive
+     *   The whole buffer the entry was read from, used to resolve blob references. If empty references are left as is.
      */
-    TLVEntry(TLVType type, std::span<const std::byte> value);
+    TLVEntry(
+        TLVType type,
+        std::span<const std::byte> value,
+        TLVValidation validation = TLVValidation::CHECKED,
+        std::span<const std::byte> archive = {});
 
     /**
      * Get the type of the entry.
@@ -72,6 +184,23 @@ class TLVEntry
      */
     auto type() const -> TLVType;
 
+    /**
+     * Get a view of the raw bytes of the value.
+     *
+     * @returns
+     *   View of the value.
+     */
+    auto value() const -> std::span<const std::byte>;
+
+    /**
+     * Get the name of a composite entry. This is a view into the entry so no copy is made. Will throw if the entry is
+     * not a named composite type.
+     *
+     * @returns
+     *   The name of the entry.
+     */
+    auto name() const -> std::string_view;
+
     /**
      * Get a copy of the value as a uint32_t. Will throw if the type does not match.
      *
@@ -88,6 +217,15 @@ class TLVEntry
      */
     auto uint32_array_value() const -> std::vector<std::uint32_t>;
 
+    /**
+     * Get a view of the value as a uint32_t array. No copy is made, the view is only valid as long as the underlying
+     * buffer. Will throw if the type does not match.
+     *
+     * @returns
+     *  View of the entry as a uint32_t array.
+     */
+    auto uint32_array_view() const -> std::span<const std::uint32_t>;
+
     /**
      * Get a copy of the value as a string. Will throw if the type does not match.
      *
@@ -104,6 +242,15 @@ class TLVEntry
      */
     auto byte_array_value() const -> std::vector<std::byte>;
 
+    /**
+     * Get a view of the value as a byte array. No copy is made, the view is only valid as long as the underlying
+     * buffer. Will throw if the type does not match.
+     *
+     * @returns
+     *  View of the entry as a byte array.
+     */
+    auto byte_array_view() const -> std::span<const std::byte>;
+
     /**
      * Get a copy of the value as a texture format. Will throw if the type does not match.
      *
@@ -128,6 +275,15 @@ class TLVEntry
      */
     auto texture_description_value() const -> TextureDescription;
 
+    /**
+     * Get a view of the value as a texture description. The pixel data is not copied, the view is only valid as long
+     * as the underlying buffer. Will throw if the type does not match.
+     *
+     * @returns
+     *  View of the entry as a texture description.
+     */
+    auto texture_description_view() const -> TextureDescriptionView;
+
     /**
      * Check if the entry is a texture with the given name.
      *
@@ -156,7 +312,33 @@ class TLVEntry
     auto vertex_data_array_value() const -> std::vector<VertexData>;
 
     /**
-     * Get a copy of the value as a mesh. Will throw if the type does not match.
+     * Get a view of the value as a vertex data array. No copy is made, the view is only valid as long as the underlying
+     * buffer. Will throw if the type does not match.
+     *
+     * @returns
+     *  View of the entry as a vertex data array.
+     */
+    auto vertex_data_array_view() const -> std::span<const VertexData>;
+
+    /**
+     * Get a copy of the value as a vertex layout. Will throw if the type does not match.
+     *
+     * @returns
+     *  The value of the entry as a vertex layout.
+     */
+    auto vertex_layout_value() const -> VertexLayout;
+
+    /**
+     * Get a reader over the members of a composite entry. Will throw if the entry is not a composite type.
+     *
+     * @returns
+     *   Reader over the members of the entry.
+     */
+    auto members() const -> TLVReader;
+
+    /**
+     * Get a view of the value as a mesh. No copy is made, the view is only valid as long as the underlying buffer. Will
+     * throw if the type does not match.
      *
      * @returns
      *  The value of the entry as a mesh.
@@ -164,7 +346,16 @@ class TLVEntry
     auto mesh_value() const -> MeshData;
 
     /**
-     * Check if the entry is a mesh with the given name.
+     * Get a view of the value as a packed mesh. The vertex and index data is not copied, the view is only valid as long
+     * as the underlying buffer. Will throw if the type does not match.
+     *
+     * @returns
+     *  The value of the entry as a packed mesh.
+     */
+    auto packed_mesh_value() const -> PackedMeshData;
+
+    /**
+     * Check if the entry is a mesh (packed or not) with the given name.
      *
      * @param name
      *   The name of the mesh.
@@ -175,19 +366,74 @@ class TLVEntry
     auto is_mesh(std::string_view name) const -> bool;
 
     /**
-     * Get the size of the whole entry, type + length + value.
+     * Check if the entry, or any member of a composite entry, is compressed.
+     *
+     * @returns
+     *   True if the entry has to be decompressed before it can be viewed, false otherwise.
+     */
+    auto is_compressed() const -> bool;
+
+    /**
+     * Resolve a blob reference. Will throw if the reference does not point to a blob.
+     *
+     * @returns
+     *   The array entry the reference stands in for, or a copy of this entry if it is not a reference (or there is no
+     *   buffer to resolve it against).
+     */
+    auto resolve() const -> TLVEntry;
+
+    /**
+     * Get the size of the whole entry, type + length + value. For a resolved blob reference this is the size the
+     * array would have had, not the size of the reference.
      *
      * @returns
      *   The size of the entry in bytes.
      */
     auto size() const -> std::uint32_t;
 
+    /**
+     * Make every check the accessors for this type of entry would make, including on all members of a composite entry.
+     * Will throw if any check fails.
+     */
+    auto validate() const -> void;
+
   private:
+    /**
+     * Read the members of a texture description, checking its structure. The pixel data is returned as its member
+     * entry, which may be compressed.
+     *
+     * @returns
+     *   The texture description (with no data) and the pixel data member.
+     */
+    auto texture_description_parts() const -> std::pair<TextureDescriptionView, TLVEntry>;
+
+    /**
+     * Read the members of a mesh, checking its structure.
+     *
+     * @returns
+     *   The vertex and index members, which may be compressed.
+     */
+    auto mesh_parts() const -> std::pair<TLVEntry, TLVEntry>;
+
+    /**
+     * Read the members of a packed mesh, checking its structure.
+     *
+     * @returns
+     *   The vertex layout followed by the vertex and index members, which may be compressed.
+     */
+    auto packed_mesh_parts() const -> std::tuple<VertexLayout, TLVEntry, TLVEntry>;
+
     /** The type of the entry. */
     TLVType type_;
 
     /** View into the value of the entry. */
     std::span<const std::byte> value_;
+
+    /** Whether the entry has already been validated. */
+    TLVValidation validation_;
+
+    /** The whole buffer the entry was read from, for resolving blob references. */
+    std::span<const std::byte> archive_;
 };
 
 /**
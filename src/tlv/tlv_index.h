@@ -0,0 +1,77 @@
+#pragma once
+
+#include <algorithm>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+#include "tlv/tlv_entry.h"
+
+namespace game
+{
+
+/**
+ * A single slot in the archive index. The index is an open addressing hash table (linear probing) keyed on the hash of
+ * an entry name, so it can be queried in place without parsing any other entries.
+ *
+ * The value of an INDEX entry has the following layout:
+ *
+ * +------------+ -.
+ * | Slot count |  | 4 bytes (always a power of two)
+ * +------------+ -+
+ * |  Reserved  |  | 4 bytes
+ * +------------+ -+
+ * |   Slots    |  |
+ * |    ...     |  | Slot count * sizeof(TLVIndexSlot) bytes
+ * +------------+ -'
+ *
+ * The final entry of an indexed archive is an INDEX_LOCATION entry which stores the offset of the INDEX entry, this
+ * means a reader can find the index by only looking at the last few bytes of the archive.
+ */
+struct TLVIndexSlot
+{
+    /** Hash of the entry name, see fnv1a. */
+    std::uint64_t hash;
+
+    /** Offset of the start of the entry (the type field) from the start of the archive. */
+    std::uint64_t offset;
+
+    /** Type of the entry. */
+    TLVType type;
+
+    /** Size of the whole entry (type + length + value), zero marks an empty slot. */
+    std::uint32_t length;
+};
+static_assert(sizeof(TLVIndexSlot) == 24u);
+
+/**
+ * Build an index hash table from a collection of slots.
+ *
+ * @param slots
+ *   The slots to insert, all must have a non-zero length.
+ *
+ * @returns
+ *   The hash table, has a power of two size and a load factor of at most 0.5.
+ */
+inline auto build_tlv_index(std::span<const TLVIndexSlot> slots) -> std::vector<TLVIndexSlot>
+{
+    auto table = std::vector<TLVIndexSlot>(std::bit_ceil(std::max<std::size_t>(slots.size() * 2u, 1u)));
+    const auto mask = table.size() - 1u;
+
+    for (const auto &slot : slots)
+    {
+        auto index = slot.hash & mask;
+        while (table[index].length != 0u)
+        {
+            index = (index + 1u) & mask;
+        }
+
+        table[index] = slot;
+    }
+
+    return table;
+}
+
+}
@@ -1,43 +1,73 @@
 #include "tlv/tlv_reader.h"
 
 #include <cstdint>
+#include <cstring>
 #include <span>
 
 #include "tlv/tlv_entry.h"
 #include "utils/error.h"
 
+namespace
+{
+
+/** Size of the type and length fields of an entry. */
+constexpr auto header_size = sizeof(game::TLVType) + sizeof(std::uint32_t);
+
+}
+
 namespace game
 {
 
-TLVReader::TLVReader(std::span<const std::byte> buffer)
-    : buffer_(buffer)
+TLVReader::TLVReader(std::span<const std::byte> buffer, TLVValidation validation)
+    : TLVReader(buffer, validation, buffer)
 {
 }
 
-TLVReader::Iterator::Iterator(std::span<const std::byte> buffer)
+TLVReader::TLVReader(std::span<const std::byte> buffer, TLVValidation validation, std::span<const std::byte> archive)
     : buffer_(buffer)
+    , validation_(validation)
+    , archive_(archive)
 {
 }
 
-auto TLVReader::Iterator::operator*() const -> TLVReader::Iterator::value_type
+TLVReader::Iterator::Iterator()
+    : buffer_()
+    , validation_(TLVValidation::CHECKED)
+    , archive_()
+    , type_()
+    , length_()
 {
-    ensure(buffer_.size() >= sizeof(TLVType) + sizeof(std::uint32_t), "invalid entry size");
-
-    auto type = TLVType{};
-    std::memcpy(&type, buffer_.data(), sizeof(type));
+}
 
-    auto length = std::uint32_t{};
-    std::memcpy(&length, buffer_.data() + sizeof(type), sizeof(length));
+TLVReader::Iterator::Iterator(
+    std::span<const std::byte> buffer,
+    TLVValidation validation,
+    std::span<const std::byte> archive)
+    : buffer_(buffer)
+    , validation_(validation)
+    , archive_(archive)
+    , type_()
+    , length_()
+{
+    load();
+}
 
-    ensure(buffer_.size() >= sizeof(TLVType) + sizeof(std::uint32_t) + length, "invalid length");
+auto TLVReader::Iterator::operator*() const -> TLVReader::Iterator::value_type
+{
+    // load will have thrown for a bad entry, so the only thing left to check is dereferencing the end
+    if (validation_ == TLVValidation::CHECKED)
+    {
+        ensure(!buffer_.empty(), "invalid entry size");
+    }
 
-    return {type, buffer_.subspan(sizeof(type) + sizeof(length), length)};
+    return TLVEntry{type_, buffer_.subspan(header_size, length_), validation_, archive_}.resolve();
 }
 
 auto TLVReader::Iterator::operator++() -> TLVReader::Iterator &
 {
-    const auto entry = operator*();
-    buffer_ = buffer_.last(buffer_.size() - entry.size());
+    buffer_ = buffer_.subspan(header_size + length_);
+    load();
+
     return *this;
 }
 
@@ -52,4 +82,31 @@ auto TLVReader::Iterator::operator==(const Iterator &other) const -> bool
 {
     return (other.buffer_.data() == buffer_.data()) && (other.buffer_.size() == buffer_.size());
 }
+
+auto TLVReader::Iterator::load() -> void
+{
+    while (!buffer_.empty())
+    {
+        if (validation_ == TLVValidation::CHECKED)
+        {
+            ensure(buffer_.size() >= header_size, "invalid entry size");
+        }
+
+        std::memcpy(&type_, buffer_.data(), sizeof(type_));
+        std::memcpy(&length_, buffer_.data() + sizeof(type_), sizeof(length_));
+
+        if (validation_ == TLVValidation::CHECKED)
+        {
+            ensure(buffer_.size() - header_size >= length_, "invalid length");
+        }
+
+        if (type_ != TLVType::PADDING)
+        {
+            return;
+        }
+
+        buffer_ = buffer_.subspan(header_size + length_);
+    }
+}
+
 }
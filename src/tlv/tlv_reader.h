@@ -1,6 +1,7 @@
 #pragma once
 
 #include <cstddef>
+#include <cstdint>
 #include <iterator>
 #include <span>
 
@@ -12,6 +13,15 @@ namespace game
 /**
  * A Type-Length-Value reader. This is a non-owning view over a buffer of data that contains TLV entries. It provides a
  * forward iterator for iterating over the entries.
+ *
+ * PADDING entries are an artefact of how an archive is laid out rather than part of its content, so they are skipped
+ * by the iterator and never returned.
+ *
+ * Each entry header is parsed once, as the iterator reaches it. A reader over validated data (see TLVArchive) skips
+ * all bounds checks and the entries it returns skip their checks too.
+ *
+ * Blob references (see TLVBlobReference) are resolved as they are read, so the iterator returns the array entry the
+ * reference stands in for.
  */
 class TLVReader
 {
@@ -26,8 +36,8 @@ class TLVReader
         using difference_type = std::ptrdiff_t;
         using value_type = TLVEntry;
 
-        Iterator() = default;
-        Iterator(std::span<const std::byte> buffer);
+        Iterator();
+        Iterator(std::span<const std::byte> buffer, TLVValidation validation, std::span<const std::byte> archive);
 
         auto operator*() const -> value_type;
 
@@ -38,7 +48,25 @@ class TLVReader
         auto operator==(const Iterator &) const -> bool;
 
       private:
+        /**
+         * Advance the buffer past any padding entries and parse the header of the entry at the front of it.
+         */
+        auto load() -> void;
+
+        /** Remaining data, starting with the current entry. */
         std::span<const std::byte> buffer_;
+
+        /** Whether the data has been validated. */
+        TLVValidation validation_;
+
+        /** The whole buffer, for resolving blob references. */
+        std::span<const std::byte> archive_;
+
+        /** Type of the current entry. */
+        TLVType type_;
+
+        /** Length of the value of the current entry. */
+        std::uint32_t length_;
     };
     static_assert(std::forward_iterator<Iterator>);
 
@@ -47,8 +75,22 @@ class TLVReader
      *
      * @param buffer
      *   The buffer to read from. This is a non-owning view into the buffer.
+     * @param validation
+     *   Whether the buffer has already been validated, only pass VALIDATED for data from a TLVArchive.
      */
-    TLVReader(std::span<const std::byte> buffer);
+    TLVReader(std::span<const std::byte> buffer, TLVValidation validation = TLVValidation::CHECKED);
+
+    /**
+     * Construct a new TLV reader over part of a larger buffer, e.g. the members of a composite entry.
+     *
+     * @param buffer
+     *   The buffer to read from. This is a non-owning view into the buffer.
+     * @param validation
+     *   Whether the buffer has already been validated, only pass VALIDATED for data from a TLVArchive.
+     * @param archive
+     *   The whole buffer, which blob reference offsets are relative to.
+     */
+    TLVReader(std::span<const std::byte> buffer, TLVValidation validation, std::span<const std::byte> archive);
 
     /**
      * Get the begin iterator for the TLV reader.
@@ -58,7 +100,7 @@ class TLVReader
      */
     auto begin(this auto &&self) -> Iterator
     {
-        return {self.buffer_};
+        return {self.buffer_, self.validation_, self.archive_};
     }
 
     /**
@@ -69,12 +111,19 @@ class TLVReader
      */
     auto end(this auto &&self) -> Iterator
     {
-        return {{self.buffer_.data() + self.buffer_.size(), self.buffer_.data() + self.buffer_.size()}};
+        const auto *end = self.buffer_.data() + self.buffer_.size();
+        return {{end, end}, self.validation_, self.archive_};
     }
 
   private:
     /** The buffer to read from. This is a non-owning view into the buffer. */
     std::span<const std::byte> buffer_;
+
+    /** Whether the buffer has been validated. */
+    TLVValidation validation_;
+
+    /** The whole buffer, for resolving blob references. */
+    std::span<const std::byte> archive_;
 };
 
 }
@@ -0,0 +1,90 @@
+#include "tlv/tlv_sink.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <ranges>
+#include <span>
+#include <vector>
+
+#include "utils/error.h"
+
+namespace game
+{
+
+auto MemoryTLVSink::write(std::span<const std::byte> data) -> void
+{
+    buffer_.insert(std::ranges::end(buffer_), std::ranges::cbegin(data), std::ranges::cend(data));
+}
+
+auto MemoryTLVSink::patch(std::uint64_t offset, std::span<const std::byte> data) -> void
+{
+    expect(offset + data.size() <= buffer_.size(), "patch out of range");
+
+    std::memcpy(buffer_.data() + offset, data.data(), data.size());
+}
+
+auto MemoryTLVSink::read(std::uint64_t offset, std::span<std::byte> data) -> void
+{
+    expect(offset + data.size() <= buffer_.size(), "read out of range");
+
+    std::memcpy(data.data(), buffer_.data() + offset, data.size());
+}
+
+auto MemoryTLVSink::size() const -> std::uint64_t
+{
+    return buffer_.size();
+}
+
+auto MemoryTLVSink::yield() -> std::vector<std::byte>
+{
+    auto tmp = std::vector<std::byte>{};
+    std::ranges::swap(tmp, buffer_);
+
+    return tmp;
+}
+
+FileTLVSink::FileTLVSink(const std::filesystem::path &path)
+    : file_{path, std::ios::binary | std::ios::in | std::ios::out | std::ios::trunc}
+    , size_{}
+{
+    ensure(!!file_, "failed to open {}", path.string());
+}
+
+auto FileTLVSink::write(std::span<const std::byte> data) -> void
+{
+    file_.write(reinterpret_cast<const char *>(data.data()), static_cast<std::streamsize>(data.size()));
+    ensure(!!file_, "failed to write {} bytes", data.size());
+
+    size_ += data.size();
+}
+
+auto FileTLVSink::patch(std::uint64_t offset, std::span<const std::byte> data) -> void
+{
+    expect(offset + data.size() <= size_, "patch out of range");
+
+    file_.seekp(static_cast<std::streamoff>(offset));
+    file_.write(reinterpret_cast<const char *>(data.data()), static_cast<std::streamsize>(data.size()));
+    file_.seekp(static_cast<std::streamoff>(size_));
+    ensure(!!file_, "failed to patch {} bytes at {}", data.size(), offset);
+}
+
+auto FileTLVSink::read(std::uint64_t offset, std::span<std::byte> data) -> void
+{
+    expect(offset + data.size() <= size_, "read out of range");
+
+    // reads and writes share a position, so put it back at the end for the next write
+    file_.seekg(static_cast<std::streamoff>(offset));
+    file_.read(reinterpret_cast<char *>(data.data()), static_cast<std::streamsize>(data.size()));
+    file_.seekp(static_cast<std::streamoff>(size_));
+    ensure(!!file_, "failed to read {} bytes at {}", data.size(), offset);
+}
+
+auto FileTLVSink::size() const -> std::uint64_t
+{
+    return size_;
+}
+
+}
@@ -0,0 +1,116 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <span>
+#include <vector>
+
+namespace game
+{
+
+/**
+ * Interface for a destination TLVWriter writes to. Data is only ever appended, apart from patch which allows the
+ * writer to fill in the length of a composite entry once all of its members have been written.
+ */
+class TLVSink
+{
+  public:
+    virtual ~TLVSink() = default;
+
+    /**
+     * Append data to the sink.
+     *
+     * @param data
+     *   The data to append.
+     */
+    virtual auto write(std::span<const std::byte> data) -> void = 0;
+
+    /**
+     * Overwrite data that has already been written.
+     *
+     * @param offset
+     *   Offset from the start of the sink to write at.
+     * @param data
+     *   The data to write, offset + data.size() must not be larger than size().
+     */
+    virtual auto patch(std::uint64_t offset, std::span<const std::byte> data) -> void = 0;
+
+    /**
+     * Read back data that has already been written.
+     *
+     * @param offset
+     *   Offset from the start of the sink to read from.
+     * @param data
+     *   Where to read to, offset + data.size() must not be larger than size().
+     */
+    virtual auto read(std::uint64_t offset, std::span<std::byte> data) -> void = 0;
+
+    /**
+     * Get the number of bytes written so far.
+     *
+     * @returns
+     *   Number of bytes written.
+     */
+    virtual auto size() const -> std::uint64_t = 0;
+};
+
+/**
+ * Sink that writes to an in memory buffer.
+ */
+class MemoryTLVSink final : public TLVSink
+{
+  public:
+    auto write(std::span<const std::byte> data) -> void override;
+
+    auto patch(std::uint64_t offset, std::span<const std::byte> data) -> void override;
+
+    auto read(std::uint64_t offset, std::span<std::byte> data) -> void override;
+
+    auto size() const -> std::uint64_t override;
+
+    /**
+     * Yield the buffer. This will return the buffer and clear the internal buffer.
+     *
+     * @returns
+     *   The buffer.
+     */
+    auto yield() -> std::vector<std::byte>;
+
+  private:
+    /** The buffer to write to. */
+    std::vector<std::byte> buffer_;
+};
+
+/**
+ * Sink that streams straight to a file, so only the data currently being written needs to be held in memory.
+ */
+class FileTLVSink final : public TLVSink
+{
+  public:
+    /**
+     * Construct a new file sink, the file is created (or truncated).
+     *
+     * @param path
+     *   Path of the file to write.
+     */
+    FileTLVSink(const std::filesystem::path &path);
+
+    auto write(std::span<const std::byte> data) -> void override;
+
+    auto patch(std::uint64_t offset, std::span<const std::byte> data) -> void override;
+
+    auto read(std::uint64_t offset, std::span<std::byte> data) -> void override;
+
+    auto size() const -> std::uint64_t override;
+
+  private:
+    /** The file to write to, also opened for reading so written data can be read back. */
+    std::fstream file_;
+
+    /** Number of bytes written. */
+    std::uint64_t size_;
+};
+
+}
@@ -1,32 +1,95 @@
 #include "tlv/tlv_writer.h"
 
+#include <algorithm>
+#include <array>
 #include <cstddef>
+#include <cstring>
 #include <cstdint>
+#include <limits>
+#include <memory>
+#include <optional>
 #include <ranges>
 #include <span>
 #include <string_view>
+#include <utility>
 #include <vector>
 
 #include "graphics/vertex_data.h"
+#include "tlv/tlv_compression.h"
 #include "tlv/tlv_entry.h"
+#include "tlv/tlv_index.h"
+#include "tlv/tlv_reader.h"
+#include "tlv/tlv_sink.h"
+#include "utils/error.h"
+#include "utils/exception.h"
+#include "utils/hash.h"
 
 namespace
 {
 
+/** Size of the type and length fields of an entry. */
+constexpr auto header_size = sizeof(game::TLVType) + sizeof(std::uint32_t);
+
+/** Payloads smaller than this are always written in place, as a reference would save little (if anything). */
+constexpr auto min_blob_size = std::size_t{64u};
+
+/**
+ * Check if a type is an array, i.e. something that can be compressed and deduplicated.
+ *
+ * @param type
+ *   The type to check.
+ *
+ * @returns
+ *   True if the type is an array, false otherwise.
+ */
+auto is_array(game::TLVType type) -> bool
+{
+    return (type == game::TLVType::UINT32_ARRAY) || (type == game::TLVType::BYTE_ARRAY) ||
+           (type == game::TLVType::VERTEX_DATA_ARRAY);
+}
+
 auto write_bytes(std::vector<std::byte> &buffer, std::span<const std::byte> data) -> void
 {
     buffer.insert(std::ranges::end(buffer), std::ranges::cbegin(data), std::ranges::cend(data));
 }
 
-auto write_entry(
-    std::vector<std::byte> &buffer,
-    game::TLVType type,
-    std::uint32_t length,
-    std::span<const std::byte> value) -> void
+auto write_entry(game::TLVSink &sink, game::TLVType type, std::uint32_t length, std::span<const std::byte> value)
+    -> void
+{
+    // assemble the header so small entries are a single write
+    auto header = std::array<std::byte, header_size>{};
+    std::memcpy(header.data(), &type, sizeof(type));
+    std::memcpy(header.data() + sizeof(type), &length, sizeof(length));
+
+    sink.write(header);
+    sink.write(value);
+}
+
+/**
+ * Write a padding entry (if needed) so the value of the next entry written starts on a tlv_alignment boundary. As the
+ * padding is itself an entry it is always at least the size of an entry header.
+ *
+ * @param sink
+ *   The sink to pad.
+ */
+auto write_padding(game::TLVSink &sink) -> void
 {
-    write_bytes(buffer, {reinterpret_cast<const std::byte *>(&type), sizeof(type)});
-    write_bytes(buffer, {reinterpret_cast<const std::byte *>(&length), sizeof(length)});
-    write_bytes(buffer, value);
+    constexpr auto zeros = std::array<std::byte, game::tlv_alignment + header_size>{};
+
+    auto remainder = (game::tlv_alignment - (sink.size() + header_size) % game::tlv_alignment) % game::tlv_alignment;
+    if (remainder == 0u)
+    {
+        return;
+    }
+
+    // not enough space to fit the padding entry header, so pad out to the next boundary instead
+    if (remainder < header_size)
+    {
+        remainder += game::tlv_alignment;
+    }
+
+    const auto length = static_cast<std::uint32_t>(remainder - header_size);
+    write_entry(sink, game::TLVType::PADDING, length, std::span{zeros}.first(length));
 }
 
 }
@@ -34,12 +97,67 @@ auto write_entry(
 namespace game
 {
 
+TLVWriter::TLVWriter()
+    : buffer_(std::make_unique<MemoryTLVSink>())
+    , sink_(buffer_.get())
+    , index_()
+    , deduplicate_(false)
+    , blobs_()
+    , deduplicated_bytes_()
+    , min_compression_saving_()
+    , compressed_bytes_()
+{
+}
+
+TLVWriter::TLVWriter(TLVSink &sink)
+    : buffer_()
+    , sink_(std::addressof(sink))
+    , index_()
+    , deduplicate_(false)
+    , blobs_()
+    , deduplicated_bytes_()
+    , min_compression_saving_()
+    , compressed_bytes_()
+{
+}
+
 auto TLVWriter::yield() -> std::vector<std::byte>
 {
-    auto tmp = std::vector<std::byte>{};
-    std::ranges::swap(tmp, buffer_);
+    expect(!!buffer_, "cannot yield a writer with an external sink");
+
+    index_.clear();
+    blobs_.clear();
+
+    return buffer_->yield();
+}
+
+auto TLVWriter::set_deduplication(bool enabled) -> void
+{
+    deduplicate_ = enabled;
+}
 
-    return tmp;
+auto TLVWriter::deduplicated_bytes() const -> std::uint64_t
+{
+    return deduplicated_bytes_;
+}
+
+auto TLVWriter::set_compression(std::optional<float> min_saving) -> void
+{
+    min_compression_saving_ = min_saving;
+}
+
+auto TLVWriter::compressed_bytes() const -> std::uint64_t
+{
+    return compressed_bytes_;
+}
+
+auto TLVWriter::write_header() -> void
+{
+    expect(sink_->size() == 0u, "header must be the first entry");
+
+    const auto header = std::array<std::uint32_t, 3u>{tlv_magic, tlv_version, tlv_alignment};
+    const auto value_bytes = std::as_bytes(std::span{header});
+    write_entry(*sink_, TLVType::HEADER, static_cast<std::uint32_t>(value_bytes.size()), value_bytes);
 }
 
 auto TLVWriter::write(std::uint32_t value) -> void
@@ -47,7 +165,7 @@ auto TLVWriter::write(std::uint32_t value) -> void
     const auto type = TLVType::UINT32;
     const auto length = sizeof(value);
     const auto value_bytes = std::span<const std::byte>{reinterpret_cast<const std::byte *>(&value), length};
-    write_entry(buffer_, type, length, value_bytes);
+    write_entry(*sink_, type, length, value_bytes);
 }
 
 auto TLVWriter::write(std::span<const std::uint32_t> value) -> void
@@ -55,7 +173,8 @@ auto TLVWriter::write(std::span<const std::uint32_t> value) -> void
     const auto type = TLVType::UINT32_ARRAY;
     const auto length = static_cast<std::uint32_t>(value.size() * sizeof(std::uint32_t));
     const auto value_bytes = std::span<const std::byte>{reinterpret_cast<const std::byte *>(value.data()), length};
-    write_entry(buffer_, type, length, value_bytes);
+    write_padding(*sink_);
+    write_entry(*sink_, type, length, value_bytes);
 }
 
 auto TLVWriter::write(std::string_view value) -> void
@@ -63,7 +182,7 @@ auto TLVWriter::write(std::string_view value) -> void
     const auto type = TLVType::STRING;
     const auto length = static_cast<std::uint32_t>(value.length());
     const auto value_bytes = std::span<const std::byte>{reinterpret_cast<const std::byte *>(value.data()), length};
-    write_entry(buffer_, type, length, value_bytes);
+    write_entry(*sink_, type, length, value_bytes);
 }
 
 auto TLVWriter::write(std::span<const std::byte> value) -> void
@@ -71,7 +190,8 @@ auto TLVWriter::write(std::span<const std::byte> value) -> void
     const auto type = TLVType::BYTE_ARRAY;
     const auto length = static_cast<std::uint32_t>(value.size());
     const auto value_bytes = std::span<const std::byte>{reinterpret_cast<const std::byte *>(value.data()), length};
-    write_entry(buffer_, type, length, value_bytes);
+    write_padding(*sink_);
+    write_entry(*sink_, type, length, value_bytes);
 }
 
 auto TLVWriter::write(TextureFormat value) -> void
@@ -79,7 +199,7 @@ auto TLVWriter::write(TextureFormat value) -> void
     const auto type = TLVType::TEXTURE_FORMAT;
     const auto length = sizeof(value);
     const auto value_bytes = std::span<const std::byte>{reinterpret_cast<const std::byte *>(&value), length};
-    write_entry(buffer_, type, length, value_bytes);
+    write_entry(*sink_, type, length, value_bytes);
 }
 
 auto TLVWriter::write(TextureUsage value) -> void
@@ -87,7 +207,7 @@ auto TLVWriter::write(TextureUsage value) -> void
     const auto type = TLVType::TEXTURE_USAGE;
     const auto length = sizeof(value);
     const auto value_bytes = std::span<const std::byte>{reinterpret_cast<const std::byte *>(&value), length};
-    write_entry(buffer_, type, length, value_bytes);
+    write_entry(*sink_, type, length, value_bytes);
 }
 
 auto TLVWriter::write(const VertexData &value) -> void
@@ -95,7 +215,7 @@ auto TLVWriter::write(const VertexData &value) -> void
     const auto type = TLVType::VERTEX_DATA;
     const auto length = sizeof(value);
     const auto value_bytes = std::span<const std::byte>{reinterpret_cast<const std::byte *>(&value), length};
-    write_entry(buffer_, type, length, value_bytes);
+    write_entry(*sink_, type, length, value_bytes);
 }
 
 auto TLVWriter::write(std::span<const VertexData> value) -> void
@@ -103,7 +223,8 @@ auto TLVWriter::write(std::span<const VertexData> value) -> void
     const auto type = TLVType::VERTEX_DATA_ARRAY;
     const auto length = static_cast<std::uint32_t>(value.size() * sizeof(VertexData));
     const auto value_bytes = std::span<const std::byte>{reinterpret_cast<const std::byte *>(value.data()), length};
-    write_entry(buffer_, type, length, value_bytes);
+    write_padding(*sink_);
+    write_entry(*sink_, type, length, value_bytes);
 }
 
 auto TLVWriter::write(
@@ -114,19 +235,26 @@ auto TLVWriter::write(
     TextureUsage usage,
     std::span<const std::byte> data) -> void
 {
-    auto writer = TLVWriter{};
+    write(
+        name,
+        TextureDescriptionView{
+            .width = width, .height = height, .format = format, .usage = usage, .mip_levels = 1u, .data = data});
+}
+
+auto TLVWriter::write(std::string_view name, const TextureDescriptionView &description) -> void
+{
+    const auto data = prepare_array(TLVType::BYTE_ARRAY, description.data);
+    const auto offset = begin_composite(TLVType::TEXTURE_DESCRIPTION);
 
-    writer.write(name);
-    writer.write(width);
-    writer.write(height);
-    writer.write(format);
-    writer.write(usage);
-    writer.write(data);
+    write(name);
+    write(description.width);
+    write(description.height);
+    write(description.format);
+    write(description.usage);
+    write(description.mip_levels);
+    write_array(data);
 
-    const auto value = writer.yield();
-    const auto type = TLVType::TEXTURE_DESCRIPTION;
-    const auto length = static_cast<std::uint32_t>(value.size());
-    write_entry(buffer_, type, length, value);
+    end_composite(name, TLVType::TEXTURE_DESCRIPTION, offset);
 }
 
 auto TLVWriter::write(
@@ -134,16 +262,292 @@ auto TLVWriter::write(
     std::span<const VertexData> vertices,
     std::span<const std::uint32_t> indices) -> void
 {
-    auto writer = TLVWriter{};
+    const auto vertex_data = prepare_array(TLVType::VERTEX_DATA_ARRAY, std::as_bytes(vertices));
+    const auto index_data = prepare_array(TLVType::UINT32_ARRAY, std::as_bytes(indices));
+    const auto offset = begin_composite(TLVType::MESH_DATA);
 
-    writer.write(name);
-    writer.write(vertices);
-    writer.write(indices);
+    write(name);
+    write_array(vertex_data);
+    write_array(index_data);
 
-    const auto value = writer.yield();
-    const auto type = TLVType::MESH_DATA;
-    const auto length = static_cast<std::uint32_t>(value.size());
-    write_entry(buffer_, type, length, value);
+    end_composite(name, TLVType::MESH_DATA, offset);
+}
+
+auto TLVWriter::write(const VertexLayout &value) -> void
+{
+    // fixed size fields followed by the attributes, see TLVEntry::vertex_layout_value
+    auto value_bytes = std::vector<std::byte>{};
+    write_bytes(value_bytes, {reinterpret_cast<const std::byte *>(&value.stride), sizeof(value.stride)});
+    write_bytes(value_bytes, {reinterpret_cast<const std::byte *>(&value.index_type), sizeof(value.index_type)});
+    write_bytes(
+        value_bytes, {reinterpret_cast<const std::byte *>(&value.position_offset), sizeof(value.position_offset)});
+    write_bytes(
+        value_bytes, {reinterpret_cast<const std::byte *>(&value.position_scale), sizeof(value.position_scale)});
+    write_bytes(value_bytes, std::as_bytes(std::span{value.attributes}));
+
+    write_entry(*sink_, TLVType::VERTEX_LAYOUT, static_cast<std::uint32_t>(value_bytes.size()), value_bytes);
+}
+
+auto TLVWriter::write(std::string_view name, const PackedMeshData &mesh) -> void
+{
+    const auto vertex_data = prepare_array(TLVType::BYTE_ARRAY, mesh.vertices);
+    const auto index_data = prepare_array(TLVType::BYTE_ARRAY, mesh.indices);
+    const auto offset = begin_composite(TLVType::PACKED_MESH_DATA);
+
+    write(name);
+    write(mesh.layout);
+    write_array(vertex_data);
+    write_array(index_data);
+
+    end_composite(name, TLVType::PACKED_MESH_DATA, offset);
+}
+
+auto TLVWriter::append(std::span<const std::byte> buffer) -> void
+{
+    for (const auto &entry : TLVReader{buffer})
+    {
+        switch (entry.type())
+        {
+            using enum TLVType;
+
+            case UINT32_ARRAY:
+            case BYTE_ARRAY:
+            case VERTEX_DATA_ARRAY:
+                write_padding(*sink_);
+                write_entry(*sink_, entry.type(), static_cast<std::uint32_t>(entry.value().size()), entry.value());
+                break;
+            case TEXTURE_DESCRIPTION:
+            case MESH_DATA:
+            case PACKED_MESH_DATA: write_composite(entry); break;
+            // the payloads are copied as the references to them are resolved
+            case BLOB: break;
+            case HEADER:
+            case INDEX:
+            case INDEX_LOCATION: throw Exception("cannot append archive metadata: {}", entry.type());
+            default:
+                write_entry(*sink_, entry.type(), static_cast<std::uint32_t>(entry.value().size()), entry.value());
+                break;
+        }
+    }
+}
+
+auto TLVWriter::write_index() -> void
+{
+    const auto table = build_tlv_index(index_);
+    const auto slot_count = static_cast<std::uint32_t>(table.size());
+    const auto reserved = std::uint32_t{};
+
+    auto value = std::vector<std::byte>{};
+    write_bytes(value, {reinterpret_cast<const std::byte *>(&slot_count), sizeof(slot_count)});
+    write_bytes(value, {reinterpret_cast<const std::byte *>(&reserved), sizeof(reserved)});
+    write_bytes(value, std::as_bytes(std::span{table}));
+
+    write_padding(*sink_);
+    const auto index_offset = sink_->size();
+    write_entry(*sink_, TLVType::INDEX, static_cast<std::uint32_t>(value.size()), value);
+    write_entry(
+        *sink_,
+        TLVType::INDEX_LOCATION,
+        sizeof(index_offset),
+        {reinterpret_cast<const std::byte *>(&index_offset), sizeof(index_offset)});
+
+    index_.clear();
+}
+
+auto TLVWriter::begin_composite(TLVType type) -> std::uint64_t
+{
+    // members are aligned relative to the start of the sink, so aligning the value keeps them aligned relative to it
+    write_padding(*sink_);
+
+    const auto offset = sink_->size();
+
+    // the length is not known until the members have been written, so write a placeholder and patch it later
+    write_entry(*sink_, type, 0u, {});
+
+    return offset;
+}
+
+auto TLVWriter::end_composite(std::string_view name, TLVType type, std::uint64_t offset) -> void
+{
+    const auto size = sink_->size() - offset;
+    // the index stores the size of the whole entry so that is the limit, rather than the length field
+    ensure(size <= std::numeric_limits<std::uint32_t>::max(), "{} {} is too large", type, name);
+
+    const auto length = static_cast<std::uint32_t>(size - header_size);
+    sink_->patch(offset + sizeof(type), {reinterpret_cast<const std::byte *>(&length), sizeof(length)});
+
+    index_.push_back({.hash = fnv1a(name), .offset = offset, .type = type, .length = static_cast<std::uint32_t>(size)});
+}
+
+auto TLVWriter::prepare_array(TLVType type, std::span<const std::byte> data) -> Payload
+{
+    auto payload = Payload{.type = type, .data = data, .compressed = {}, .blob = {}};
+    auto compression_tried = false;
+
+    // the type is part of the key as a compressed blob can only stand in for one type of array
+    const auto key = deduplicate_ && (data.size() >= min_blob_size)
+                         ? std::optional<std::pair<TLVType, Hash128>>{{type, fnv1a_128(data)}}
+                         : std::nullopt;
+
+    if (key)
+    {
+        // fnv is not collision resistant, so a matching hash is only a candidate until the blob has been compared
+        const auto [first, last] = blobs_.equal_range(*key);
+        for (const auto &[_, blob] : std::ranges::subrange(first, last))
+        {
+            // a blob holds either the payload as passed in or compressed, which can only be compared with the payload
+            // compressed the same way
+            auto stored = data;
+            if (blob.type != type)
+            {
+                if (!compression_tried)
+                {
+                    compress(payload);
+                    compression_tried = true;
+                }
+
+                if (payload.compressed.empty())
+                {
+                    continue;
+                }
+
+                stored = payload.compressed;
+            }
+
+            if (matches(blob, stored))
+            {
+                deduplicated_bytes_ += blob.size;
+                payload.type = blob.type;
+                payload.compressed.clear();
+                payload.blob = blob.offset;
+
+                return payload;
+            }
+        }
+    }
+
+    if (!compression_tried)
+    {
+        compress(payload);
+    }
+
+    if (!payload.compressed.empty())
+    {
+        compressed_bytes_ += data.size() - payload.compressed.size();
+    }
+
+    if (key)
+    {
+        const auto stored = payload.compressed.empty() ? payload.data : std::span<const std::byte>{payload.compressed};
+        ensure(
+            stored.size() <= std::numeric_limits<std::uint32_t>::max(), "blob of {} bytes is too large", stored.size());
+
+        write_padding(*sink_);
+
+        const auto offset = sink_->size();
+        write_entry(*sink_, TLVType::BLOB, static_cast<std::uint32_t>(stored.size()), stored);
+        blobs_.emplace(*key, Blob{.type = payload.type, .offset = offset, .size = stored.size()});
+
+        payload.blob = offset;
+    }
+
+    return payload;
+}
+
+auto TLVWriter::compress(Payload &payload) const -> void
+{
+    if (!min_compression_saving_ || !is_array(payload.type))
+    {
+        return;
+    }
+
+    if (auto compressed = tlv_compress(payload.type, payload.data, *min_compression_saving_); compressed)
+    {
+        payload.type = TLVType::COMPRESSED;
+        payload.compressed = std::move(*compressed);
+    }
+}
+
+auto TLVWriter::matches(const Blob &blob, std::span<const std::byte> stored) -> bool
+{
+    if (blob.size != stored.size())
+    {
+        return false;
+    }
+
+    auto chunk = std::array<std::byte, 4096u>{};
+
+    for (auto offset = std::size_t{}; offset < stored.size(); offset += chunk.size())
+    {
+        const auto read = std::span{chunk}.first(std::min(chunk.size(), stored.size() - offset));
+        sink_->read(blob.offset + header_size + offset, read);
+
+        if (!std::ranges::equal(read, stored.subspan(offset, read.size())))
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+auto TLVWriter::write_array(const Payload &payload) -> void
+{
+    if (payload.blob)
+    {
+        const auto reference = TLVBlobReference{.type = payload.type, .reserved = 0u, .offset = *payload.blob};
+        write_entry(
+            *sink_,
+            TLVType::BLOB_REFERENCE,
+            sizeof(reference),
+            {reinterpret_cast<const std::byte *>(&reference), sizeof(reference)});
+    }
+    else
+    {
+        const auto stored = payload.compressed.empty() ? payload.data : std::span<const std::byte>{payload.compressed};
+
+        // compressed payloads are only ever read a byte at a time, so do not need aligning
+        if (payload.type != TLVType::COMPRESSED)
+        {
+            write_padding(*sink_);
+        }
+
+        write_entry(*sink_, payload.type, static_cast<std::uint32_t>(stored.size()), stored);
+    }
+}
+
+auto TLVWriter::write_composite(const TLVEntry &entry) -> void
+{
+    // as with the typed writes all the blobs have to be written before the composite is started, members which are
+    // already compressed are still deduplicated
+    const auto is_payload = [](const TLVEntry &member)
+    { return is_array(member.type()) || (member.type() == TLVType::COMPRESSED); };
+
+    auto payloads = std::vector<Payload>{};
+    for (const auto &member : entry.members())
+    {
+        if (is_payload(member))
+        {
+            payloads.push_back(prepare_array(member.type(), member.value()));
+        }
+    }
+
+    const auto offset = begin_composite(entry.type());
+
+    auto payload = std::ranges::cbegin(payloads);
+    for (const auto &member : entry.members())
+    {
+        if (is_payload(member))
+        {
+            write_array(*payload++);
+        }
+        else
+        {
+            write_entry(*sink_, member.type(), static_cast<std::uint32_t>(member.value().size()), member.value());
+        }
+    }
+
+    end_composite(entry.name(), entry.type(), offset);
 }
 
 }
@@ -2,31 +2,112 @@
 
 #include <cstddef>
 #include <cstdint>
+#include <map>
+#include <memory>
+#include <optional>
 #include <span>
 #include <string_view>
+#include <utility>
 #include <vector>
 
+#include "graphics/mesh_data.h"
 #include "graphics/texture.h"
 #include "graphics/vertex_data.h"
+#include "graphics/vertex_layout.h"
+#include "tlv/tlv_index.h"
+#include "tlv/tlv_entry.h"
+#include "tlv/tlv_sink.h"
+#include "utils/hash.h"
 
 namespace game
 {
 /**
  * Class for writing primitives to a buffer in TLV format.
  *
- * Once data has been written to the buffer, it can be yielded to get a copy of the data. The buffer is cleared after.
+ * By default data is written to an internal buffer, which can be yielded to get the data. The buffer is cleared after.
+ * Alternatively a writer can be given a sink (e.g. a FileTLVSink) to stream to, so large archives never have to be held
+ * in memory. Composite entries are written in place with their length back-patched once all their members have been
+ * written, so each byte is only written once regardless of the sink.
+ *
+ * Named composite entries (textures and meshes) are remembered as they are written, calling write_index will append a
+ * table of contents so readers can find them by name without walking the whole buffer.
+ *
+ * The values of array and composite entries are always padded to start on a tlv_alignment boundary (relative to the
+ * start of the buffer), so they can be viewed in place once loaded. Calling write_header first marks the buffer as an
+ * archive which makes that guarantee.
+ *
+ * With deduplication enabled the array members of composite entries are hashed and each unique payload is written
+ * once, as a top level BLOB entry, with the composites holding references to it (see TLVBlobReference). Readers resolve
+ * the references, so this only changes the size of the output. Payloads are not kept, when a hash matches the blob is
+ * read back from the sink to compare.
+ *
+ * With compression enabled the array members of composite entries are compressed (see TLVCompressedHeader) when it
+ * saves enough space to be worth decompressing them on load. Compression happens before deduplication, so a blob holds
+ * the compressed payload. A duplicate is still compressed, to compare it with the blob, but is only written once.
  */
 class TLVWriter
 {
   public:
     /**
-     * Yield the buffer. This will return a copy of the buffer and clear the internal buffer.
+     * Construct a new writer which writes to an internal buffer.
+     */
+    TLVWriter();
+
+    /**
+     * Construct a new writer which writes to a sink, yield cannot be called on such a writer.
+     *
+     * @param sink
+     *   The sink to write to, must outlive this object.
+     */
+    explicit TLVWriter(TLVSink &sink);
+
+    /**
+     * Yield the buffer. This will return the buffer and clear the internal buffer.
      *
      * @returns
      *   The buffer containing the TLV data.
      */
     auto yield() -> std::vector<std::byte>;
 
+    /**
+     * Enable or disable deduplication of composite payloads, see class description. Payloads are only shared with
+     * others written whilst deduplication is enabled.
+     *
+     * @param enabled
+     *   Whether to deduplicate.
+     */
+    auto set_deduplication(bool enabled) -> void;
+
+    /**
+     * Get the number of payload bytes which were not written as they were duplicates.
+     *
+     * @returns
+     *   Number of bytes saved by deduplication.
+     */
+    auto deduplicated_bytes() const -> std::uint64_t;
+
+    /**
+     * Enable or disable compression of composite payloads, see class description.
+     *
+     * @param min_saving
+     *   Fraction of its size compression has to save for a payload to be stored compressed, or an empty optional to
+     *   disable compression.
+     */
+    auto set_compression(std::optional<float> min_saving) -> void;
+
+    /**
+     * Get the number of payload bytes saved by compression.
+     *
+     * @returns
+     *   Number of bytes saved by compression.
+     */
+    auto compressed_bytes() const -> std::uint64_t;
+
+    /**
+     * Write the archive header, this must be the first thing written to an archive.
+     */
+    auto write_header() -> void;
+
     /**
      * Write a uint32_t to the buffer.
      *
@@ -92,7 +173,7 @@ class TLVWriter
     auto write(std::span<const VertexData> value) -> void;
 
     /**
-     * Write a texture description to the buffer.
+     * Write a texture description with a single mip level to the buffer.
      *
      * @param name
      *   The name of the texture.
@@ -115,6 +196,16 @@ class TLVWriter
         TextureUsage usage,
         std::span<const std::byte> data) -> void;
 
+    /**
+     * Write a texture description, including all of its mip levels, to the buffer.
+     *
+     * @param name
+     *   The name of the texture.
+     * @param description
+     *   The description of the texture.
+     */
+    auto write(std::string_view name, const TextureDescriptionView &description) -> void;
+
     /**
      * Write a mesh data to the buffer.
      *
@@ -128,8 +219,174 @@ class TLVWriter
     auto write(std::string_view name, std::span<const VertexData> vertices, std::span<const std::uint32_t> indices)
         -> void;
 
+    /**
+     * Write a vertex layout to the buffer.
+     *
+     * @param value
+     *   The layout to write.
+     */
+    auto write(const VertexLayout &value) -> void;
+
+    /**
+     * Write a packed mesh to the buffer.
+     *
+     * @param name
+     *   The name of the mesh.
+     * @param mesh
+     *   The packed mesh.
+     */
+    auto write(std::string_view name, const PackedMeshData &mesh) -> void;
+
+    /**
+     * Append all the entries from another TLV buffer, such as one yielded from another writer. Entries are re-emitted
+     * so alignment is maintained, named entries are included in the index and payloads are deduplicated (if enabled).
+     * Any blob references in the buffer are resolved, so their payloads are copied.
+     *
+     * @param buffer
+     *   The buffer to append, must not contain archive metadata (header or index).
+     */
+    auto append(std::span<const std::byte> buffer) -> void;
+
+    /**
+     * Write an index of all the named entries written so far, followed by the location of the index. This should be
+     * the last thing written to an archive.
+     */
+    auto write_index() -> void;
+
   private:
-    /** The buffer to write to. */
-    std::vector<std::byte> buffer_;
+    /**
+     * Start a composite entry, members should then be written as normal followed by a call to end_composite.
+     *
+     * @param type
+     *   The type of the entry.
+     *
+     * @returns
+     *   Offset of the entry, to pass to end_composite.
+     */
+    auto begin_composite(TLVType type) -> std::uint64_t;
+
+    /**
+     * Finish a composite entry, patching its length and recording it in the index.
+     *
+     * @param name
+     *   The name of the entry.
+     * @param type
+     *   The type of the entry.
+     * @param offset
+     *   Offset returned from begin_composite.
+     */
+    auto end_composite(std::string_view name, TLVType type, std::uint64_t offset) -> void;
+
+    /**
+     * An array member of a composite, ready to be written.
+     */
+    struct Payload
+    {
+        /** Type to write the member as, COMPRESSED if it is compressed. */
+        TLVType type;
+
+        /** The payload as it was passed in. */
+        std::span<const std::byte> data;
+
+        /** The payload compressed, empty if it was not compressed here. */
+        std::vector<std::byte> compressed;
+
+        /** Offset of the blob holding the payload, empty if it is to be written in place. */
+        std::optional<std::uint64_t> blob;
+    };
+
+    /**
+     * A blob which has been written.
+     */
+    struct Blob
+    {
+        /** Type of the payload in the blob, COMPRESSED if it is compressed. */
+        TLVType type;
+
+        /** Offset of the blob. */
+        std::uint64_t offset;
+
+        /** Size of the payload in the blob. */
+        std::uint64_t size;
+    };
+
+    /**
+     * Prepare an array member of a composite, compressing it and writing it as a blob if enabled. Blobs are top level
+     * entries so this must be called before the composite which holds the member is started.
+     *
+     * @param type
+     *   The type of the array, or COMPRESSED for an already compressed array.
+     * @param data
+     *   The payload.
+     *
+     * @returns
+     *   The payload to pass to write_array.
+     */
+    auto prepare_array(TLVType type, std::span<const std::byte> data) -> Payload;
+
+    /**
+     * Compress a payload, if enabled and it saves enough.
+     *
+     * @param payload
+     *   The payload, updated with the compressed data and type if it was compressed.
+     */
+    auto compress(Payload &payload) const -> void;
+
+    /**
+     * Check if a blob holds a payload, by reading it back from the sink. Only a small buffer is read back at a time so
+     * nothing of the size of the payload is ever held.
+     *
+     * @param blob
+     *   The blob to check.
+     * @param stored
+     *   The payload in the same form as the blob, i.e. compressed if the blob is.
+     *
+     * @returns
+     *   True if the blob holds exactly the payload, false otherwise.
+     */
+    auto matches(const Blob &blob, std::span<const std::byte> stored) -> bool;
+
+    /**
+     * Write an array member of a composite, either in place or as a reference to a blob.
+     *
+     * @param payload
+     *   Payload returned from prepare_array.
+     */
+    auto write_array(const Payload &payload) -> void;
+
+    /**
+     * Re-emit a composite entry member by member, recording it in the index.
+     *
+     * @param entry
+     *   The entry to write.
+     */
+    auto write_composite(const TLVEntry &entry) -> void;
+
+    /** Internal buffer, null if writing to an external sink. */
+    std::unique_ptr<MemoryTLVSink> buffer_;
+
+    /** The sink to write to, either buffer_ or an external sink. */
+    TLVSink *sink_;
+
+    /** Index slots for all named entries written to the buffer. */
+    std::vector<TLVIndexSlot> index_;
+
+    /** Whether to deduplicate payloads. */
+    bool deduplicate_;
+
+    /**
+     * Every blob written, keyed on the type and hash of the uncompressed payload (which may collide). Blobs only record
+     * where they were written, their payloads are read back from the sink when a hash matches.
+     */
+    std::multimap<std::pair<TLVType, Hash128>, Blob> blobs_;
+
+    /** Number of payload bytes not written as they were duplicates. */
+    std::uint64_t deduplicated_bytes_;
+
+    /** Fraction of its size compression has to save for a payload to be compressed, empty if disabled. */
+    std::optional<float> min_compression_saving_;
+
+    /** Number of payload bytes saved by compression. */
+    std::uint64_t compressed_bytes_;
 };
 }
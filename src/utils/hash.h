@@ -0,0 +1,101 @@
+#pragma once
+
+#include <compare>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string_view>
+
+namespace game
+{
+
+/**
+ * Hash a string with 64 bit FNV-1a. This is constexpr so can be used to hash names at compile time, the same value is
+ * also written to disk so it must not change.
+ *
+ * @param str
+ *   The string to hash.
+ *
+ * @returns
+ *   The hash of the string.
+ */
+constexpr auto fnv1a(std::string_view str) -> std::uint64_t
+{
+    auto hash = std::uint64_t{0xcbf29ce484222325};
+
+    for (const auto c : str)
+    {
+        hash ^= static_cast<std::uint8_t>(c);
+        hash *= std::uint64_t{0x100000001b3};
+    }
+
+    return hash;
+}
+
+/**
+ * Hash a byte buffer with 64 bit FNV-1a.
+ *
+ * @param data
+ *   The data to hash.
+ * @param hash
+ *   The initial hash value, can be used to chain multiple buffers together.
+ *
+ * @returns
+ *   The hash of the data.
+ */
+constexpr auto fnv1a(std::span<const std::byte> data, std::uint64_t hash = 0xcbf29ce484222325) -> std::uint64_t
+{
+    for (const auto b : data)
+    {
+        hash ^= static_cast<std::uint8_t>(b);
+        hash *= std::uint64_t{0x100000001b3};
+    }
+
+    return hash;
+}
+
+/**
+ * A 128 bit hash value.
+ */
+struct Hash128
+{
+    std::uint64_t high;
+    std::uint64_t low;
+
+    constexpr auto operator<=>(const Hash128 &) const = default;
+};
+
+/**
+ * Hash a byte buffer with 128 bit FNV-1a. This is wide enough that content can be identified by its hash alone, i.e.
+ * two buffers with the same hash can be treated as identical without comparing them.
+ *
+ * @param data
+ *   The data to hash.
+ *
+ * @returns
+ *   The hash of the data.
+ */
+constexpr auto fnv1a_128(std::span<const std::byte> data) -> Hash128
+{
+    // the prime is 2^88 + 0x13b, so the multiply can be done with 64 bit arithmetic as (hash * 0x13b) + (hash << 88)
+    constexpr auto prime_low = std::uint64_t{0x13b};
+
+    auto hash = Hash128{.high = 0x6c62272e07bb0142, .low = 0x62b821756295c58d};
+
+    for (const auto b : data)
+    {
+        hash.low ^= static_cast<std::uint8_t>(b);
+
+        // carry out of the low word of hash.low * prime_low, split into 32 bit halves so nothing overflows
+        const auto low_product = (hash.low & 0xffffffff) * prime_low;
+        const auto high_product = (hash.low >> 32u) * prime_low;
+        const auto carry = (high_product + (low_product >> 32u)) >> 32u;
+
+        hash.high = (hash.high * prime_low) + carry + (hash.low << 24u);
+        hash.low *= prime_low;
+    }
+
+    return hash;
+}
+
+}
@@ -0,0 +1,300 @@
+#include "utils/lz4.h"
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <span>
+#include <vector>
+
+#include "utils/error.h"
+
+namespace
+{
+
+/** Shortest match that can be encoded, shorter runs are cheaper as literals. */
+constexpr auto min_match = std::size_t{4u};
+
+/** The last bytes of a block are always literals. */
+constexpr auto last_literals = std::size_t{5u};
+
+/** A match cannot start within this many bytes of the end of a block. */
+constexpr auto match_start_limit = std::size_t{12u};
+
+/** Furthest back a match can be, offsets are stored in 16 bits. */
+constexpr auto max_offset = std::size_t{0xffffu};
+
+/** Number of bits in a match table index. */
+constexpr auto hash_bits = 12u;
+
+/** Misses before the search starts skipping ahead, shifted by this to get the extra step. */
+constexpr auto skip_strength = 6u;
+
+/** Value of a length nibble which means more length bytes follow. */
+constexpr auto extended_length = std::size_t{15u};
+
+/**
+ * Read four (unaligned) bytes.
+ *
+ * @param data
+ *   Buffer to read from.
+ * @param offset
+ *   Offset of the bytes, must be at least four bytes from the end.
+ *
+ * @returns
+ *   The bytes as an integer.
+ */
+auto read_u32(std::span<const std::byte> data, std::size_t offset) -> std::uint32_t
+{
+    auto value = std::uint32_t{};
+    std::memcpy(&value, data.data() + offset, sizeof(value));
+    return value;
+}
+
+/**
+ * Hash four bytes to an index into the match table.
+ *
+ * @param sequence
+ *   The bytes to hash.
+ *
+ * @returns
+ *   Index into the match table.
+ */
+auto hash(std::uint32_t sequence) -> std::size_t
+{
+    return (sequence * 2654435761u) >> (32u - hash_bits);
+}
+
+/**
+ * Write the extra bytes of a length which did not fit in its nibble.
+ *
+ * @param block
+ *   Block to write to.
+ * @param length
+ *   The remaining length, after subtracting the nibble.
+ */
+auto write_length(std::vector<std::byte> &block, std::size_t length) -> void
+{
+    for (; length >= 255u; length -= 255u)
+    {
+        block.push_back(std::byte{255u});
+    }
+
+    block.push_back(static_cast<std::byte>(length));
+}
+
+/**
+ * Write a sequence, which is a run of literals followed by a match.
+ *
+ * @param block
+ *   Block to write to.
+ * @param literals
+ *   The literals.
+ * @param offset
+ *   How far back the match is.
+ * @param length
+ *   Length of the match.
+ */
+auto write_sequence(
+    std::vector<std::byte> &block,
+    std::span<const std::byte> literals,
+    std::size_t offset,
+    std::size_t length) -> void
+{
+    const auto match = length - min_match;
+    const auto token = (std::min(literals.size(), extended_length) << 4u) | std::min(match, extended_length);
+    block.push_back(static_cast<std::byte>(token));
+
+    if (literals.size() >= extended_length)
+    {
+        write_length(block, literals.size() - extended_length);
+    }
+
+    block.insert(std::ranges::end(block), std::ranges::cbegin(literals), std::ranges::cend(literals));
+    block.push_back(static_cast<std::byte>(offset & 0xffu));
+    block.push_back(static_cast<std::byte>(offset >> 8u));
+
+    if (match >= extended_length)
+    {
+        write_length(block, match - extended_length);
+    }
+}
+
+/**
+ * Write the final sequence of a block, which is only literals.
+ *
+ * @param block
+ *   Block to write to.
+ * @param literals
+ *   The literals.
+ */
+auto write_last_literals(std::vector<std::byte> &block, std::span<const std::byte> literals) -> void
+{
+    block.push_back(static_cast<std::byte>(std::min(literals.size(), extended_length) << 4u));
+
+    if (literals.size() >= extended_length)
+    {
+        write_length(block, literals.size() - extended_length);
+    }
+
+    block.insert(std::ranges::end(block), std::ranges::cbegin(literals), std::ranges::cend(literals));
+}
+
+/**
+ * Read the extra bytes of a length which did not fit in its nibble.
+ *
+ * @param block
+ *   Block to read from.
+ * @param offset
+ *   Offset of the first length byte, advanced past the last.
+ *
+ * @returns
+ *   The extra length.
+ */
+auto read_length(std::span<const std::byte> block, std::size_t &offset) -> std::size_t
+{
+    auto length = std::size_t{};
+
+    for (;;)
+    {
+        game::ensure(offset < block.size(), "truncated lz4 block");
+
+        const auto value = std::to_integer<std::size_t>(block[offset++]);
+        length += value;
+
+        if (value != 255u)
+        {
+            return length;
+        }
+    }
+}
+
+}
+
+namespace game
+{
+
+auto lz4_compress(std::span<const std::byte> data) -> std::vector<std::byte>
+{
+    // positions are stored in 32 bits, callers compress in chunks far smaller than this
+    ensure(data.size() <= std::numeric_limits<std::uint32_t>::max(), "lz4 input of {} bytes too large", data.size());
+
+    auto block = std::vector<std::byte>{};
+    block.reserve(data.size() + data.size() / 255u + 16u);
+
+    auto anchor = std::size_t{};
+
+    if (data.size() > match_start_limit)
+    {
+        // most recent position of each (hashed) four byte sequence, a hash collision just means a failed match
+        auto table = std::array<std::uint32_t, 1u << hash_bits>{};
+
+        const auto match_limit = data.size() - match_start_limit;
+        const auto match_end_limit = data.size() - last_literals;
+
+        auto position = std::size_t{};
+        auto misses = 0u;
+
+        while (position < match_limit)
+        {
+            const auto sequence = read_u32(data, position);
+            const auto slot = hash(sequence);
+            const auto candidate = std::size_t{table[slot]};
+            table[slot] = static_cast<std::uint32_t>(position);
+
+            if ((candidate >= position) || (position - candidate > max_offset) ||
+                (read_u32(data, candidate) != sequence))
+            {
+                // step further the longer it has been since a match, so incompressible data is quick to get through
+                position += 1u + (misses++ >> skip_strength);
+                continue;
+            }
+
+            misses = 0u;
+
+            auto length = min_match;
+            while ((position + length < match_end_limit) && (data[candidate + length] == data[position + length]))
+            {
+                ++length;
+            }
+
+            write_sequence(block, data.subspan(anchor, position - anchor), position - candidate, length);
+
+            position += length;
+            anchor = position;
+        }
+    }
+
+    write_last_literals(block, data.subspan(anchor));
+
+    return block;
+}
+
+auto lz4_decompress(std::span<const std::byte> block, std::span<std::byte> destination) -> void
+{
+    auto in = std::size_t{};
+    auto out = std::size_t{};
+
+    for (;;)
+    {
+        ensure(in < block.size(), "truncated lz4 block");
+
+        const auto token = std::to_integer<std::size_t>(block[in++]);
+
+        auto literals = token >> 4u;
+        if (literals == extended_length)
+        {
+            literals += read_length(block, in);
+        }
+
+        ensure(literals <= block.size() - in, "lz4 literals out of range");
+        ensure(literals <= destination.size() - out, "lz4 literals overflow destination");
+
+        std::ranges::copy_n(block.data() + in, literals, destination.data() + out);
+        in += literals;
+        out += literals;
+
+        // the last sequence is only literals
+        if (in == block.size())
+        {
+            break;
+        }
+
+        ensure(block.size() - in >= 2u, "truncated lz4 block");
+
+        const auto offset =
+            std::to_integer<std::size_t>(block[in]) | (std::to_integer<std::size_t>(block[in + 1u]) << 8u);
+        in += 2u;
+        ensure((offset != 0u) && (offset <= out), "lz4 match offset {} out of range", offset);
+
+        auto length = token & 0xfu;
+        if (length == extended_length)
+        {
+            length += read_length(block, in);
+        }
+        length += min_match;
+
+        ensure(length <= destination.size() - out, "lz4 match overflows destination");
+
+        if (offset >= length)
+        {
+            std::memcpy(destination.data() + out, destination.data() + out - offset, length);
+        }
+        else
+        {
+            // the match overlaps the bytes it is producing (i.e. a repeating pattern) so has to be copied in order
+            for (auto i = std::size_t{}; i < length; ++i)
+            {
+                destination[out + i] = destination[out - offset + i];
+            }
+        }
+
+        out += length;
+    }
+
+    ensure(out == destination.size(), "lz4 block decompressed to {} bytes, expected {}", out, destination.size());
+}
+
+}
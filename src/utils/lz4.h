@@ -0,0 +1,36 @@
+#pragma once
+
+#include <cstddef>
+#include <span>
+#include <vector>
+
+namespace game
+{
+
+/**
+ * Compress a buffer in the LZ4 block format. This favours speed (of both compression and decompression) over ratio,
+ * so it is a good fit for data which is loaded often and compressed once.
+ *
+ * The output is a single block with no framing, so the caller has to store the uncompressed size alongside it. It
+ * can be larger than the input for incompressible data.
+ *
+ * @param data
+ *   The data to compress.
+ *
+ * @returns
+ *   The compressed block.
+ */
+auto lz4_compress(std::span<const std::byte> data) -> std::vector<std::byte>;
+
+/**
+ * Decompress an LZ4 block. Every read and write is bounds checked, so it is safe to call on untrusted data, and will
+ * throw if the block is malformed or does not decompress to exactly the size of the destination.
+ *
+ * @param block
+ *   The compressed block.
+ * @param destination
+ *   Buffer to decompress into, must be the uncompressed size of the block.
+ */
+auto lz4_decompress(std::span<const std::byte> block, std::span<std::byte> destination) -> void;
+
+}
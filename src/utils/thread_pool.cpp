@@ -0,0 +1,177 @@
+#include "utils/thread_pool.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <stop_token>
+#include <thread>
+
+#include "utils/error.h"
+
+namespace
+{
+
+/**
+ * State shared between the threads taking part in a parallel_for.
+ */
+struct ParallelForState
+{
+    /** The function to call, owned by the caller of parallel_for. */
+    const std::function<void(std::size_t)> *body;
+
+    /** Number of indices. */
+    std::size_t count;
+
+    /** Next index to claim, once this passes count there is nothing left to do. */
+    std::atomic<std::size_t> next;
+
+    /** Number of calls which have finished. */
+    std::atomic<std::size_t> done;
+
+    /** Guards error. */
+    std::mutex mutex;
+
+    /** The first exception thrown by a call. */
+    std::exception_ptr error;
+};
+
+/**
+ * Claim and run indices until there are none left.
+ *
+ * @param state
+ *   The shared state, body is only touched after an index is claimed so a thread which starts after every index has
+ *   been claimed (when the caller may have returned) does nothing.
+ */
+auto drain(ParallelForState &state) -> void
+{
+    for (auto index = state.next++; index < state.count; index = state.next++)
+    {
+        try
+        {
+            (*state.body)(index);
+        }
+        catch (...)
+        {
+            const auto lock = std::scoped_lock{state.mutex};
+            if (!state.error)
+            {
+                state.error = std::current_exception();
+            }
+        }
+
+        if (++state.done == state.count)
+        {
+            state.done.notify_all();
+        }
+    }
+}
+
+}
+
+namespace game
+{
+
+ThreadPool::ThreadPool(std::size_t thread_count, std::size_t priority_count)
+    : mutex_()
+    , cv_()
+    , tasks_(priority_count)
+    , threads_()
+{
+    expect(thread_count > 0u, "thread pool must have at least one thread");
+    expect(priority_count > 0u, "thread pool must have at least one priority");
+
+    for (auto i = 0u; i < thread_count; ++i)
+    {
+        threads_.emplace_back([this](std::stop_token token) { run(token); });
+    }
+}
+
+ThreadPool::~ThreadPool()
+{
+    for (auto &thread : threads_)
+    {
+        thread.request_stop();
+    }
+
+    cv_.notify_all();
+}
+
+auto ThreadPool::thread_count() const -> std::size_t
+{
+    return threads_.size();
+}
+
+auto ThreadPool::parallel_for(std::size_t priority, std::size_t count, const std::function<void(std::size_t)> &body)
+    -> void
+{
+    expect(priority < tasks_.size(), "invalid priority: {}", priority);
+
+    if (count == 0u)
+    {
+        return;
+    }
+
+    // helpers may not start until after this returns, so they share ownership of the state
+    const auto state = std::make_shared<ParallelForState>(&body, count);
+    const auto helpers = std::min(count - 1u, threads_.size());
+
+    {
+        const auto lock = std::scoped_lock{mutex_};
+        for (auto i = 0u; i < helpers; ++i)
+        {
+            tasks_[priority].emplace([state] { drain(*state); });
+        }
+    }
+
+    cv_.notify_all();
+
+    // every index is claimed by the time this returns, so waiting for the claimed ones to finish cannot deadlock on a
+    // helper which is stuck in the queue
+    drain(*state);
+
+    for (auto done = state->done.load(); done != count; done = state->done.load())
+    {
+        state->done.wait(done);
+    }
+
+    if (state->error)
+    {
+        std::rethrow_exception(state->error);
+    }
+}
+
+auto ThreadPool::has_tasks() const -> bool
+{
+    return std::ranges::any_of(tasks_, [](const auto &queue) { return !queue.empty(); });
+}
+
+auto ThreadPool::run(std::stop_token token) -> void
+{
+    for (;;)
+    {
+        auto task = std::move_only_function<void()>{};
+
+        {
+            auto lock = std::unique_lock{mutex_};
+            cv_.wait(lock, token, [this] { return has_tasks(); });
+
+            // drain the queues before stopping so no submitted future is left without a value
+            if (!has_tasks())
+            {
+                return;
+            }
+
+            auto &queue = *std::ranges::find_if(tasks_, [](const auto &q) { return !q.empty(); });
+            task = std::move(queue.front());
+            queue.pop();
+        }
+
+        task();
+    }
+}
+
+}
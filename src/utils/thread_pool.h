@@ -0,0 +1,148 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <functional>
+#include <future>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "utils/error.h"
+
+namespace game
+{
+
+/**
+ * A fixed size pool of worker threads which execute submitted tasks in the order they were submitted.
+ *
+ * Tasks can optionally be given a priority, where 0 is the most urgent. Workers always take the oldest task of the most
+ * urgent priority that has work, so a steady stream of urgent work will starve less urgent work.
+ *
+ * Destroying the pool waits for all submitted tasks to complete.
+ */
+class ThreadPool
+{
+  public:
+    /**
+     * Construct a new thread pool.
+     *
+     * @param thread_count
+     *   Number of worker threads, must be greater than zero.
+     * @param priority_count
+     *   Number of task priorities, must be greater than zero.
+     */
+    ThreadPool(std::size_t thread_count, std::size_t priority_count = 1u);
+
+    /**
+     * Wait for all outstanding tasks and join the worker threads.
+     */
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool &) = delete;
+    auto operator=(const ThreadPool &) -> ThreadPool & = delete;
+    ThreadPool(ThreadPool &&) = delete;
+    auto operator=(ThreadPool &&) -> ThreadPool & = delete;
+
+    /**
+     * Submit a task to be executed on a worker thread. Any exception thrown by the task is stored in the returned
+     * future.
+     *
+     * @param task
+     *   The task to execute.
+     *
+     * @returns
+     *   Future for the result of the task.
+     */
+    template <class F>
+    auto submit(F &&task) -> std::future<std::invoke_result_t<std::decay_t<F>>>
+    {
+        return submit(0u, std::forward<F>(task));
+    }
+
+    /**
+     * Submit a task with a priority to be executed on a worker thread. Any exception thrown by the task is stored in
+     * the returned future.
+     *
+     * @param priority
+     *   Priority of the task, 0 is the most urgent. Must be less than the priority count.
+     * @param task
+     *   The task to execute.
+     *
+     * @returns
+     *   Future for the result of the task.
+     */
+    template <class F>
+    auto submit(std::size_t priority, F &&task) -> std::future<std::invoke_result_t<std::decay_t<F>>>
+    {
+        expect(priority < tasks_.size(), "invalid priority: {}", priority);
+
+        auto packaged_task = std::packaged_task<std::invoke_result_t<std::decay_t<F>>()>{std::forward<F>(task)};
+        auto future = packaged_task.get_future();
+
+        {
+            const auto lock = std::scoped_lock{mutex_};
+            tasks_[priority].emplace(std::move(packaged_task));
+        }
+
+        cv_.notify_one();
+
+        return future;
+    }
+
+    /**
+     * Call a function for every index in a range, spread across the worker threads. The calling thread takes part and
+     * only ever waits for calls which have already started, so this is safe to call from a task running on the pool
+     * (even when every worker is busy). If any call throws the first exception is rethrown once all calls are done.
+     *
+     * @param priority
+     *   Priority of the helper tasks, 0 is the most urgent. Must be less than the priority count.
+     * @param count
+     *   Number of indices, body is called with each of [0, count) exactly once.
+     * @param body
+     *   The function to call, must be safe to call concurrently with different indices.
+     */
+    auto parallel_for(std::size_t priority, std::size_t count, const std::function<void(std::size_t)> &body) -> void;
+
+    /**
+     * Get the number of worker threads.
+     *
+     * @returns
+     *   Number of worker threads.
+     */
+    auto thread_count() const -> std::size_t;
+
+  private:
+    /**
+     * Worker thread loop, executes tasks until the pool is stopped and there is no work left.
+     *
+     * @param token
+     *   Stop token for the thread.
+     */
+    auto run(std::stop_token token) -> void;
+
+    /**
+     * Check if there are any queued tasks, must be called with the mutex held.
+     *
+     * @returns
+     *   True if any priority has a queued task.
+     */
+    auto has_tasks() const -> bool;
+
+    /** Guards the task queue. */
+    std::mutex mutex_;
+
+    /** Signalled when a task is submitted or the pool is stopping. */
+    std::condition_variable_any cv_;
+
+    /** Tasks waiting to be executed, one queue per priority. */
+    std::vector<std::queue<std::move_only_function<void()>>> tasks_;
+
+    /** Worker threads, declared last so they are stopped before the queue is destroyed. */
+    std::vector<std::jthread> threads_;
+};
+
+}
@@ -0,0 +1,358 @@
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <numbers>
+#include <ranges>
+#include <span>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "graphics/aabb_tree.h"
+#include "graphics/camera.h"
+#include "graphics/entity.h"
+#include "maths/aabb.h"
+#include "maths/frustum_cull.h"
+#include "maths/vector3.h"
+#include "utils/thread_pool.h"
+
+namespace
+{
+
+/**
+ * Entities (which the tree only uses as keys) scattered over a large area, with bounds of varying size.
+ */
+struct World
+{
+    explicit World(std::size_t count)
+        : entities{}
+        , items{}
+    {
+        entities.reserve(count);
+
+        auto state = 0x12345678u;
+        const auto random = [&state](float range)
+        {
+            state = state * 1664525u + 1013904223u;
+            return (static_cast<float>(state >> 8u) / static_cast<float>(1u << 24u) - 0.5f) * range;
+        };
+
+        for (auto i = std::size_t{}; i < count; ++i)
+        {
+            const auto &entity = entities.emplace_back(
+                nullptr, nullptr, game::Vector3{}, game::Vector3{1.0f}, std::span<const game::Texture *const>{});
+
+            const auto centre = game::Vector3{random(200.0f), random(20.0f), random(200.0f)};
+            const auto half_size = game::Vector3{0.5f + std::abs(random(4.0f))};
+            items.push_back({.entity = &entity, .bounds = {.min = centre - half_size, .max = centre + half_size}});
+        }
+    }
+
+    auto brute_force(auto &&predicate) const -> std::vector<const game::Entity *>
+    {
+        auto result = std::vector<const game::Entity *>{};
+        for (const auto &[entity, bounds] : items)
+        {
+            if (predicate(bounds))
+            {
+                result.push_back(entity);
+            }
+        }
+
+        std::ranges::sort(result);
+        return result;
+    }
+
+    std::vector<game::Entity> entities;
+    std::vector<game::AABBTree::Item> items;
+};
+
+auto sorted(std::vector<const game::Entity *> entities) -> std::vector<const game::Entity *>
+{
+    std::ranges::sort(entities);
+    return entities;
+}
+
+auto overlaps(const game::AABB &a, const game::AABB &b) -> bool
+{
+    return (a.min.x <= b.max.x) && (a.max.x >= b.min.x) && (a.min.y <= b.max.y) && (a.max.y >= b.min.y) &&
+           (a.min.z <= b.max.z) && (a.max.z >= b.min.z);
+}
+
+auto create_camera() -> game::Camera
+{
+    auto camera = game::Camera{
+        {0.0f, 5.0f, 0.0f},
+        {0.0f, 0.0f, -1.0f},
+        {0.0f, 1.0f, 0.0f},
+        std::numbers::pi_v<float> / 4.0f,
+        1920.0f,
+        1080.0f,
+        0.1f,
+        60.0f};
+    camera.adjust_yaw(0.7f);
+
+    return camera;
+}
+
+/**
+ * Check every query against a brute force search.
+ */
+auto check_queries(const game::AABBTree &tree, const World &world) -> void
+{
+    const auto camera = create_camera();
+    const auto &planes = camera.frustum_planes();
+
+    auto result = std::vector<const game::Entity *>{};
+    tree.query_frustum(planes, result);
+    const auto expected_frustum =
+        world.brute_force([&](const auto &bounds) { return game::intersects_frustum(bounds, planes); });
+    ASSERT_FALSE(expected_frustum.empty());
+    ASSERT_EQ(sorted(result), expected_frustum);
+
+    const auto box = game::AABB{.min = {-20.0f, -5.0f, -30.0f}, .max = {10.0f, 5.0f, 0.0f}};
+    result.clear();
+    tree.query_aabb(box, result);
+    const auto expected_aabb = world.brute_force([&](const auto &bounds) { return overlaps(bounds, box); });
+    ASSERT_FALSE(expected_aabb.empty());
+    ASSERT_EQ(sorted(result), expected_aabb);
+
+    const auto centre = game::Vector3{30.0f, 0.0f, 30.0f};
+    result.clear();
+    tree.query_sphere(centre, 15.0f, result);
+    const auto expected_sphere = world.brute_force(
+        [&](const auto &bounds)
+        {
+            const auto closest = game::Vector3{
+                std::clamp(centre.x, bounds.min.x, bounds.max.x),
+                std::clamp(centre.y, bounds.min.y, bounds.max.y),
+                std::clamp(centre.z, bounds.min.z, bounds.max.z)};
+            return game::Vector3::distance(closest, centre) <= 15.0f;
+        });
+    ASSERT_FALSE(expected_sphere.empty());
+    ASSERT_EQ(sorted(result), expected_sphere);
+}
+
+}
+
+TEST(aabb_tree, empty)
+{
+    const auto tree = game::AABBTree{};
+    const auto camera = create_camera();
+
+    auto result = std::vector<const game::Entity *>{};
+    tree.query_frustum(camera.frustum_planes(), result);
+    tree.query_aabb({.min = {-100.0f}, .max = {100.0f}}, result);
+    tree.query_sphere({}, 100.0f, result);
+    tree.query_ray({}, {0.0f, 0.0f, -1.0f}, 100.0f, result);
+
+    ASSERT_TRUE(result.empty());
+    ASSERT_EQ(tree.size(), 0u);
+    ASSERT_EQ(tree.height(), 0u);
+}
+
+TEST(aabb_tree, insert)
+{
+    const auto world = World{500u};
+
+    auto tree = game::AABBTree{};
+    for (const auto &[entity, bounds] : world.items)
+    {
+        tree.insert(entity, bounds);
+    }
+
+    ASSERT_EQ(tree.size(), world.items.size());
+    ASSERT_TRUE(tree.contains(world.items.front().entity));
+
+    // rotations keep the tree balanced, a perfectly balanced tree of 500 leaves has a height of 9
+    ASSERT_LE(tree.height(), 14u);
+
+    check_queries(tree, world);
+}
+
+TEST(aabb_tree, insert_sorted)
+{
+    // inserting along a line is the worst case for an unbalanced tree
+    auto entities = std::vector<game::Entity>{};
+    entities.reserve(256u);
+
+    auto tree = game::AABBTree{};
+    for (auto i = 0u; i < 256u; ++i)
+    {
+        const auto &entity = entities.emplace_back(
+            nullptr, nullptr, game::Vector3{}, game::Vector3{1.0f}, std::span<const game::Texture *const>{});
+        const auto x = static_cast<float>(i) * 2.0f;
+        tree.insert(&entity, {.min = {x, 0.0f, 0.0f}, .max = {x + 1.0f, 1.0f, 1.0f}});
+    }
+
+    ASSERT_LE(tree.height(), 12u);
+}
+
+TEST(aabb_tree, build)
+{
+    const auto world = World{1000u};
+
+    auto tree = game::AABBTree{};
+    tree.build(world.items);
+
+    ASSERT_EQ(tree.size(), world.items.size());
+    ASSERT_LE(tree.height(), 16u);
+
+    check_queries(tree, world);
+}
+
+TEST(aabb_tree, parallel_build)
+{
+    const auto world = World{1000u};
+    auto pool = game::ThreadPool{4u};
+
+    auto tree = game::AABBTree{};
+    tree.build(world.items, pool, 0u);
+
+    auto serial_tree = game::AABBTree{};
+    serial_tree.build(world.items);
+
+    // the split does not depend on how many threads build the subtrees
+    ASSERT_EQ(tree.size(), world.items.size());
+    ASSERT_EQ(tree.height(), serial_tree.height());
+
+    check_queries(tree, world);
+}
+
+TEST(aabb_tree, build_single)
+{
+    const auto world = World{1u};
+
+    auto tree = game::AABBTree{};
+    tree.build(world.items);
+
+    ASSERT_EQ(tree.size(), 1u);
+    ASSERT_EQ(tree.height(), 0u);
+
+    auto result = std::vector<const game::Entity *>{};
+    tree.query_aabb(world.items.front().bounds, result);
+    ASSERT_EQ(result, std::vector<const game::Entity *>{world.items.front().entity});
+}
+
+TEST(aabb_tree, remove)
+{
+    auto world = World{300u};
+
+    auto tree = game::AABBTree{};
+    tree.build(world.items);
+
+    // remove every third entity, from both the tree and the world
+    auto kept = std::vector<game::AABBTree::Item>{};
+    for (const auto &[index, item] : std::views::enumerate(world.items))
+    {
+        if (index % 3 == 0)
+        {
+            tree.remove(item.entity);
+        }
+        else
+        {
+            kept.push_back(item);
+        }
+    }
+    world.items = kept;
+
+    ASSERT_EQ(tree.size(), world.items.size());
+    ASSERT_FALSE(tree.contains(world.entities.data()));
+
+    check_queries(tree, world);
+
+    // reuses the freed nodes
+    tree.insert(world.entities.data(), {.min = {0.0f}, .max = {1.0f}});
+    ASSERT_TRUE(tree.contains(world.entities.data()));
+}
+
+TEST(aabb_tree, update)
+{
+    auto world = World{300u};
+
+    auto tree = game::AABBTree{0.5f};
+    tree.build(world.items);
+
+    // small moves stay inside the fattened boxes
+    for (auto &[entity, bounds] : world.items)
+    {
+        bounds.min += game::Vector3{0.25f, 0.0f, 0.0f};
+        bounds.max += game::Vector3{0.25f, 0.0f, 0.0f};
+        tree.update(entity, bounds);
+    }
+
+    ASSERT_EQ(tree.reinsert_count(), 0u);
+    check_queries(tree, world);
+
+    // large moves do not
+    for (auto &[entity, bounds] : world.items)
+    {
+        bounds.min += game::Vector3{3.0f, 1.0f, -2.0f};
+        bounds.max += game::Vector3{3.0f, 1.0f, -2.0f};
+        tree.update(entity, bounds);
+    }
+
+    ASSERT_EQ(tree.reinsert_count(), world.items.size());
+    check_queries(tree, world);
+
+    tree.rebuild();
+
+    ASSERT_EQ(tree.reinsert_count(), 0u);
+    ASSERT_EQ(tree.size(), world.items.size());
+    check_queries(tree, world);
+}
+
+TEST(aabb_tree, update_rebuilds)
+{
+    auto world = World{300u};
+
+    auto tree = game::AABBTree{0.5f};
+    tree.build(world.items);
+
+    // scatter every entity twice, the second pass goes over the limit and rebuilds part way through
+    for (auto pass = 0u; pass < 2u; ++pass)
+    {
+        for (auto &&[index, item] : std::views::enumerate(world.items))
+        {
+            auto &[entity, bounds] = item;
+            const auto offset = game::Vector3{static_cast<float>(index % 7) * 10.0f - 30.0f, 0.0f, 40.0f};
+            bounds.min += offset;
+            bounds.max += offset;
+            tree.update(entity, bounds);
+        }
+    }
+
+    ASSERT_LT(tree.reinsert_count(), world.items.size());
+    ASSERT_EQ(tree.size(), world.items.size());
+    ASSERT_LE(tree.height(), 14u);
+    check_queries(tree, world);
+}
+
+TEST(aabb_tree, query_ray)
+{
+    auto entities = std::vector<game::Entity>{};
+    entities.reserve(3u);
+
+    auto tree = game::AABBTree{};
+    for (const auto z : {-30.0f, -10.0f, -20.0f})
+    {
+        const auto &entity = entities.emplace_back(
+            nullptr, nullptr, game::Vector3{}, game::Vector3{1.0f}, std::span<const game::Texture *const>{});
+        tree.insert(&entity, {.min = {-1.0f, -1.0f, z - 1.0f}, .max = {1.0f, 1.0f, z + 1.0f}});
+    }
+
+    // nearest first
+    auto result = std::vector<const game::Entity *>{};
+    tree.query_ray({0.0f, 0.0f, 0.0f}, {0.0f, 0.0f, -1.0f}, 100.0f, result);
+    ASSERT_EQ(result, (std::vector<const game::Entity *>{&entities[1], &entities[2], &entities[0]}));
+
+    // too short to reach the furthest
+    result.clear();
+    tree.query_ray({0.0f, 0.0f, 0.0f}, {0.0f, 0.0f, -1.0f}, 25.0f, result);
+    ASSERT_EQ(result, (std::vector<const game::Entity *>{&entities[1], &entities[2]}));
+
+    // misses to the side
+    result.clear();
+    tree.query_ray({5.0f, 0.0f, 0.0f}, {0.0f, 0.0f, -1.0f}, 100.0f, result);
+    ASSERT_TRUE(result.empty());
+}
@@ -0,0 +1,121 @@
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <future>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "resources/async_loader.h"
+#include "resources/resource_loader.h"
+
+TEST(async_loader, load_runs_create_on_pumping_thread)
+{
+    const auto resource_loader = game::ResourceLoader{std::filesystem::temp_directory_path()};
+    auto loader = game::AsyncLoader{resource_loader, 2u};
+
+    const auto main_thread = std::this_thread::get_id();
+
+    auto future = loader.load(
+        game::LoadPriority::BLOCKING,
+        [main_thread]
+        {
+            EXPECT_NE(std::this_thread::get_id(), main_thread);
+            return 21;
+        },
+        [main_thread](int value)
+        {
+            EXPECT_EQ(std::this_thread::get_id(), main_thread);
+            return value * 2;
+        });
+
+    ASSERT_EQ(loader.wait(future), 42);
+}
+
+TEST(async_loader, create_waits_for_pump)
+{
+    const auto resource_loader = game::ResourceLoader{std::filesystem::temp_directory_path()};
+    auto loader = game::AsyncLoader{resource_loader, 1u};
+
+    auto future = loader.load(game::LoadPriority::BACKGROUND, [] { return 1; }, [](int value) { return value; });
+
+    ASSERT_EQ(future.wait_for(std::chrono::milliseconds{50}), std::future_status::timeout);
+
+    while (loader.pump() == 0u)
+    {
+        std::this_thread::yield();
+    }
+
+    ASSERT_EQ(future.get(), 1);
+}
+
+TEST(async_loader, prepare_exception)
+{
+    const auto resource_loader = game::ResourceLoader{std::filesystem::temp_directory_path()};
+    auto loader = game::AsyncLoader{resource_loader, 1u};
+
+    auto future = loader.load(
+        game::LoadPriority::BLOCKING,
+        []() -> int { throw std::runtime_error("error"); },
+        [](int value) { return value; });
+
+    ASSERT_THROW(loader.wait(future), std::runtime_error);
+}
+
+TEST(async_loader, create_exception)
+{
+    const auto resource_loader = game::ResourceLoader{std::filesystem::temp_directory_path()};
+    auto loader = game::AsyncLoader{resource_loader, 1u};
+
+    auto future = loader.load(
+        game::LoadPriority::BLOCKING, [] { return 1; }, [](int) -> int { throw std::runtime_error("error"); });
+
+    ASSERT_THROW(loader.wait(future), std::runtime_error);
+}
+
+TEST(async_loader, then)
+{
+    const auto resource_loader = game::ResourceLoader{std::filesystem::temp_directory_path()};
+    auto loader = game::AsyncLoader{resource_loader, 2u};
+
+    auto results = std::vector<int>{};
+    for (auto i = 0; i < 10; ++i)
+    {
+        loader.then(
+            loader.load(game::LoadPriority::LEVEL_CRITICAL, [i] { return i; }, [](int value) { return value; }),
+            [&results](std::future<int> future) { results.push_back(future.get()); });
+    }
+
+    while (results.size() < 10u)
+    {
+        loader.pump();
+    }
+
+    std::ranges::sort(results);
+    ASSERT_EQ(results, (std::vector<int>{0, 1, 2, 3, 4, 5, 6, 7, 8, 9}));
+}
+
+TEST(async_loader, load_file)
+{
+    const auto path = std::filesystem::temp_directory_path() / "async_loader_tests_load_file";
+    {
+        auto file = std::ofstream{path, std::ios::binary};
+        file << "hello";
+    }
+
+    {
+        const auto resource_loader = game::ResourceLoader{std::filesystem::temp_directory_path()};
+        auto loader = game::AsyncLoader{resource_loader, 1u};
+
+        auto future = loader.load_file("async_loader_tests_load_file", game::LoadPriority::BLOCKING);
+        const auto file = loader.wait(future);
+
+        ASSERT_EQ(file.as_string(), "hello");
+    }
+
+    std::filesystem::remove(path);
+}
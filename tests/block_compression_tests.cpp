@@ -0,0 +1,153 @@
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "block_compression.h"
+#include "graphics/texture.h"
+#include "utils/exception.h"
+
+namespace
+{
+
+constexpr auto width = 67u;
+constexpr auto height = 45u;
+
+/**
+ * Create a smoothly varying RGBA test image, deliberately not a multiple of the block size.
+ */
+auto create_image() -> std::vector<std::byte>
+{
+    auto pixels = std::vector<std::byte>{};
+
+    for (auto y = 0u; y < height; ++y)
+    {
+        for (auto x = 0u; x < width; ++x)
+        {
+            pixels.push_back(static_cast<std::byte>(static_cast<int>(128.0 + 127.0 * std::sin(x * 0.2))));
+            pixels.push_back(static_cast<std::byte>(static_cast<int>(128.0 + 127.0 * std::cos(y * 0.15))));
+            pixels.push_back(static_cast<std::byte>(static_cast<int>(128.0 + 100.0 * std::sin((x + y) * 0.1))));
+            pixels.push_back(static_cast<std::byte>(static_cast<int>(200.0 + 50.0 * std::sin(x * 0.3))));
+        }
+    }
+
+    return pixels;
+}
+
+/**
+ * Compress and decompress the test image and measure the PSNR over the first channels.
+ */
+auto round_trip_psnr(game::TextureFormat format, game::CompressionQuality quality, std::uint32_t channels) -> double
+{
+    const auto pixels = create_image();
+    const auto blocks = game::compress_image(pixels, width, height, 4u, format, quality);
+    const auto decompressed = game::decompress_image(blocks, width, height, format);
+
+    auto squared_error = 0.0;
+    for (auto i = 0u; i < pixels.size(); ++i)
+    {
+        if (i % 4u < channels)
+        {
+            const auto difference = std::to_integer<int>(pixels[i]) - std::to_integer<int>(decompressed[i]);
+            squared_error += difference * difference;
+        }
+    }
+
+    const auto mse = squared_error / (width * height * channels);
+    return 10.0 * std::log10((255.0 * 255.0) / mse);
+}
+
+}
+
+TEST(block_compression, bc1_round_trip)
+{
+    ASSERT_GT(round_trip_psnr(game::TextureFormat::BC1, game::CompressionQuality::HIGH, 3u), 28.0);
+}
+
+TEST(block_compression, bc3_round_trip)
+{
+    ASSERT_GT(round_trip_psnr(game::TextureFormat::BC3, game::CompressionQuality::HIGH, 4u), 29.0);
+}
+
+TEST(block_compression, bc4_round_trip)
+{
+    ASSERT_GT(round_trip_psnr(game::TextureFormat::BC4, game::CompressionQuality::HIGH, 1u), 40.0);
+}
+
+TEST(block_compression, bc5_round_trip)
+{
+    ASSERT_GT(round_trip_psnr(game::TextureFormat::BC5, game::CompressionQuality::HIGH, 2u), 42.0);
+}
+
+TEST(block_compression, bc7_round_trip)
+{
+    ASSERT_GT(round_trip_psnr(game::TextureFormat::BC7, game::CompressionQuality::HIGH, 4u), 29.0);
+}
+
+TEST(block_compression, high_not_worse_than_fast)
+{
+    for (const auto format :
+         {game::TextureFormat::BC1, game::TextureFormat::BC4, game::TextureFormat::BC5, game::TextureFormat::BC7})
+    {
+        ASSERT_GE(
+            round_trip_psnr(format, game::CompressionQuality::HIGH, 4u),
+            round_trip_psnr(format, game::CompressionQuality::FAST, 4u));
+    }
+}
+
+TEST(block_compression, bc7_solid_colour_is_exact)
+{
+    const auto pixels = std::vector<std::byte>(5u * 3u * 3u, std::byte{77});
+    const auto blocks =
+        game::compress_image(pixels, 5u, 3u, 3u, game::TextureFormat::BC7, game::CompressionQuality::FAST);
+    const auto decompressed = game::decompress_image(blocks, 5u, 3u, game::TextureFormat::BC7);
+
+    for (auto i = 0u; i < decompressed.size(); ++i)
+    {
+        // three channel images have an implicit opaque alpha
+        ASSERT_EQ(decompressed[i], i % 4u == 3u ? std::byte{0xff} : std::byte{77});
+    }
+}
+
+TEST(block_compression, size_matches_mip_level_size)
+{
+    const auto pixels = create_image();
+
+    for (const auto format :
+         {game::TextureFormat::BC1,
+          game::TextureFormat::BC3,
+          game::TextureFormat::BC4,
+          game::TextureFormat::BC5,
+          game::TextureFormat::BC7})
+    {
+        const auto blocks = game::compress_image(pixels, width, height, 4u, format, game::CompressionQuality::FAST);
+        ASSERT_EQ(blocks.size(), game::mip_level_size(format, width, height, 0u));
+    }
+}
+
+TEST(block_compression, mip_level_size_rounds_up_to_blocks)
+{
+    ASSERT_EQ(game::mip_level_size(game::TextureFormat::BC1, 5u, 3u, 0u), 2u * 8u);
+    ASSERT_EQ(game::mip_level_size(game::TextureFormat::BC7, 5u, 3u, 0u), 2u * 16u);
+    ASSERT_EQ(game::mip_level_size(game::TextureFormat::BC7, 5u, 3u, 2u), 16u);
+}
+
+TEST(block_compression, uncompressed_format_throws)
+{
+    const auto pixels = create_image();
+
+    ASSERT_THROW(
+        game::compress_image(pixels, width, height, 4u, game::TextureFormat::RGBA, game::CompressionQuality::FAST),
+        game::Exception);
+}
+
+TEST(block_compression, invalid_channels_throws)
+{
+    const auto pixels = std::vector<std::byte>(16u * 2u);
+
+    ASSERT_THROW(
+        game::compress_image(pixels, 4u, 4u, 2u, game::TextureFormat::BC5, game::CompressionQuality::FAST),
+        game::Exception);
+}
@@ -0,0 +1,98 @@
+#include <array>
+#include <cstddef>
+#include <filesystem>
+#include <format>
+#include <string_view>
+
+#include <gtest/gtest.h>
+
+#include "resources/async_loader.h"
+#include "resources/bundle_manager.h"
+#include "resources/resource_loader.h"
+#include "tlv/tlv_entry.h"
+#include "tlv/tlv_sink.h"
+#include "tlv/tlv_writer.h"
+#include "utils/exception.h"
+
+namespace
+{
+
+/**
+ * Write a bundle holding a single texture, named after the bundle, to the temp directory.
+ */
+auto write_bundle(std::string_view name) -> std::filesystem::path
+{
+    const auto path = std::filesystem::temp_directory_path() / std::format("bundle_manager_tests.{}", name);
+    const auto data = std::array<std::byte, 3u>{};
+
+    auto sink = game::FileTLVSink{path};
+    auto writer = game::TLVWriter{sink};
+    writer.write_header();
+    writer.write(name, 1u, 1u, game::TextureFormat::RGB, game::TextureUsage::SRGB, data);
+    writer.write_index();
+
+    return path;
+}
+
+}
+
+TEST(bundle_manager, get)
+{
+    const auto paths = std::array{write_bundle("shared"), write_bundle("apple")};
+
+    {
+        const auto resource_loader = game::ResourceLoader{std::filesystem::temp_directory_path()};
+        auto loader = game::AsyncLoader{resource_loader, 2u};
+        auto bundles = game::BundleManager{resource_loader, loader, "bundle_manager_tests"};
+
+        ASSERT_FALSE(bundles.is_ready("apple"));
+
+        bundles.prefetch("apple", game::LoadPriority::BACKGROUND);
+        const auto &shared = bundles.get(game::shared_bundle);
+        const auto &apple = bundles.get("apple");
+
+        ASSERT_TRUE(bundles.is_ready("apple"));
+        ASSERT_TRUE(shared.find("shared", game::TLVType::TEXTURE_DESCRIPTION).has_value());
+        ASSERT_TRUE(apple.find("apple", game::TLVType::TEXTURE_DESCRIPTION).has_value());
+        ASSERT_FALSE(apple.find("shared", game::TLVType::TEXTURE_DESCRIPTION).has_value());
+    }
+
+    for (const auto &path : paths)
+    {
+        std::filesystem::remove(path);
+    }
+}
+
+TEST(bundle_manager, retain)
+{
+    const auto paths = std::array{write_bundle("shared"), write_bundle("apple")};
+
+    {
+        const auto resource_loader = game::ResourceLoader{std::filesystem::temp_directory_path()};
+        auto loader = game::AsyncLoader{resource_loader, 1u};
+        auto bundles = game::BundleManager{resource_loader, loader, "bundle_manager_tests"};
+
+        bundles.get(game::shared_bundle);
+        bundles.get("apple");
+
+        const auto retained = std::array{game::shared_bundle};
+        bundles.retain(retained);
+
+        ASSERT_TRUE(bundles.is_ready(game::shared_bundle));
+        ASSERT_FALSE(bundles.is_ready("apple"));
+    }
+
+    for (const auto &path : paths)
+    {
+        std::filesystem::remove(path);
+    }
+}
+
+TEST(bundle_manager, missing_bundle)
+{
+    const auto resource_loader = game::ResourceLoader{std::filesystem::temp_directory_path()};
+    auto loader = game::AsyncLoader{resource_loader, 1u};
+    auto bundles = game::BundleManager{resource_loader, loader, "bundle_manager_tests_missing"};
+
+    ASSERT_THROW(bundles.get("apple"), game::Exception);
+}
@@ -103,3 +103,49 @@ TEST(camera, adjust_pitch)
     utils::assert_matrix4_equal(camera.view(), expected_view);
     utils::assert_matrix4_equal(camera.projection(), expected_projection);
 }
+
+TEST(camera, view_projection)
+{
+    auto camera = game::Camera{
+        {0.0f, 10.0f, 0.0f},
+        {0.0f, 0.0f, -1.0f},
+        {0.0f, 1.0f, 0.0f},
+        std::numbers::pi_v<float> / 4.0f,
+        1920.0f,
+        1080.0f,
+        0.1f,
+        100.0f};
+
+    utils::assert_matrix4_equal(camera.view_projection(), camera.projection() * camera.view());
+
+    // the cached matrix has to be recalculated after moving
+    camera.translate({1.0f, 2.0f, 3.0f});
+    camera.adjust_yaw(0.3f);
+
+    utils::assert_matrix4_equal(camera.view_projection(), camera.projection() * camera.view());
+}
+
+TEST(camera, frustum_planes_follow_camera)
+{
+    auto camera = game::Camera{
+        {0.0f, 0.0f, 0.0f},
+        {0.0f, 0.0f, -1.0f},
+        {0.0f, 1.0f, 0.0f},
+        std::numbers::pi_v<float> / 4.0f,
+        1920.0f,
+        1080.0f,
+        0.1f,
+        100.0f};
+
+    // the near plane faces along the view direction
+    utils::assert_vector3_equal(camera.frustum_planes()[1].normal, camera.direction());
+
+    camera.adjust_yaw(std::numbers::pi_v<float> / 2.0f);
+
+    utils::assert_vector3_equal(camera.frustum_planes()[1].normal, camera.direction());
+
+    camera.set_position({0.0f, 0.0f, 50.0f});
+
+    const auto &near = camera.frustum_planes()[1];
+    ASSERT_NEAR(game::Vector3::dot(near.normal, camera.position() + camera.direction()) + near.distance, 0.9f, 0.001f);
+}
@@ -0,0 +1,192 @@
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <format>
+#include <fstream>
+#include <ranges>
+#include <span>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "cook_cache.h"
+#include "utils/hash.h"
+
+namespace
+{
+
+/**
+ * Get an empty directory for a test to use as a cache, named after the test.
+ */
+auto cache_directory(std::string_view name) -> std::filesystem::path
+{
+    const auto directory = std::filesystem::temp_directory_path() / std::format("cook_cache_tests.{}", name);
+    std::filesystem::remove_all(directory);
+
+    return directory;
+}
+
+/**
+ * Write a file to use as a source asset.
+ */
+auto write_source(const std::filesystem::path &path, std::string_view contents) -> void
+{
+    auto file = std::ofstream{path, std::ios::binary};
+    file.write(contents.data(), static_cast<std::streamsize>(contents.size()));
+}
+
+/**
+ * Create a small blob to cache.
+ */
+auto create_blob() -> std::vector<std::byte>
+{
+    return {std::byte{0x01}, std::byte{0x02}, std::byte{0x03}, std::byte{0x04}, std::byte{0x05}};
+}
+
+}
+
+TEST(cook_cache, hit)
+{
+    const auto directory = cache_directory("hit");
+    const auto blob = create_blob();
+
+    const auto cache = game::CookCache{directory};
+    cache.store(1u, blob);
+
+    ASSERT_EQ(cache.load(1u), blob);
+
+    std::filesystem::remove_all(directory);
+}
+
+TEST(cook_cache, miss)
+{
+    const auto directory = cache_directory("miss");
+
+    const auto cache = game::CookCache{directory};
+    cache.store(1u, create_blob());
+
+    ASSERT_FALSE(cache.load(2u).has_value());
+
+    std::filesystem::remove_all(directory);
+}
+
+TEST(cook_cache, truncated)
+{
+    const auto directory = cache_directory("truncated");
+    const auto blob = create_blob();
+
+    const auto cache = game::CookCache{directory};
+    cache.store(1u, blob);
+    cache.store(2u, blob);
+
+    // cut off part way through the blob, and part way through the hash
+    std::filesystem::resize_file(directory / std::format("{:016x}.tlv", 1u), sizeof(std::uint64_t) + 2u);
+    std::filesystem::resize_file(directory / std::format("{:016x}.tlv", 2u), 2u);
+
+    ASSERT_FALSE(cache.load(1u).has_value());
+    ASSERT_FALSE(cache.load(2u).has_value());
+
+    std::filesystem::remove_all(directory);
+}
+
+TEST(cook_cache, corrupt)
+{
+    const auto directory = cache_directory("corrupt");
+
+    const auto cache = game::CookCache{directory};
+    cache.store(1u, create_blob());
+
+    {
+        const auto path = directory / std::format("{:016x}.tlv", 1u);
+        auto file = std::fstream{path, std::ios::binary | std::ios::in | std::ios::out};
+        file.seekp(sizeof(std::uint64_t) + 1u);
+        file.put('\xff');
+    }
+
+    ASSERT_FALSE(cache.load(1u).has_value());
+
+    std::filesystem::remove_all(directory);
+}
+
+TEST(cook_cache, concurrent_store)
+{
+    const auto directory = cache_directory("concurrent_store");
+    const auto blob = create_blob();
+
+    const auto cache = game::CookCache{directory};
+
+    // identical cooks share a key, so store it from several threads at once
+    {
+        auto threads = std::vector<std::jthread>{};
+        for (auto i = 0u; i < 8u; ++i)
+        {
+            threads.emplace_back(
+                [&]
+                {
+                    for (auto j = 0u; j < 16u; ++j)
+                    {
+                        cache.store(1u, blob);
+                    }
+                });
+        }
+    }
+
+    ASSERT_EQ(cache.load(1u), blob);
+
+    // no temporary files are left behind
+    ASSERT_EQ(std::ranges::distance(std::filesystem::directory_iterator{directory}), 1);
+
+    std::filesystem::remove_all(directory);
+}
+
+TEST(cook_key, changes)
+{
+    const auto directory = cache_directory("cook_key");
+    std::filesystem::create_directories(directory);
+
+    const auto path = directory / "asset.png";
+    const auto other_path = directory / "other.png";
+    write_source(path, "contents");
+    write_source(other_path, "contents");
+
+    const auto settings = std::array<std::uint32_t, 2u>{1u, 2u};
+    const auto changed_settings = std::array<std::uint32_t, 2u>{1u, 3u};
+
+    const auto key = game::cook_key(path, settings);
+    ASSERT_EQ(game::cook_key(path, settings), key);
+    ASSERT_NE(game::cook_key(path, changed_settings), key);
+    ASSERT_NE(game::cook_key(other_path, settings), key);
+
+    write_source(path, "changed contents");
+    ASSERT_NE(game::cook_key(path, settings), key);
+
+    std::filesystem::remove_all(directory);
+}
+
+TEST(cook_key, large_file)
+{
+    const auto directory = cache_directory("large_file");
+    std::filesystem::create_directories(directory);
+
+    // several times the size of the chunks the file is hashed in, and not a multiple of it
+    const auto contents = std::views::iota(0u, 300'001u) |
+                          std::views::transform([](auto i) { return static_cast<char>(i * 7u); }) |
+                          std::ranges::to<std::string>();
+    const auto path = directory / "large.png";
+    write_source(path, contents);
+
+    const auto settings = std::array<std::uint32_t, 2u>{1u, 2u};
+    const auto filename = std::string_view{"large.png"};
+
+    auto expected = game::fnv1a(std::as_bytes(std::span{settings}));
+    expected = game::fnv1a(std::as_bytes(std::span{filename}), expected);
+    expected = game::fnv1a(std::as_bytes(std::span{contents}), expected);
+
+    ASSERT_EQ(game::cook_key(path, settings), expected);
+
+    std::filesystem::remove_all(directory);
+}
@@ -0,0 +1,109 @@
+#include <cstddef>
+#include <filesystem>
+#include <fstream>
+#include <span>
+#include <string>
+#include <string_view>
+
+#include <gtest/gtest.h>
+
+#include "resources/file.h"
+#include "utils/exception.h"
+
+namespace
+{
+
+/**
+ * Write a temporary file and remove it when done.
+ */
+class TempFile
+{
+  public:
+    TempFile(std::string_view name, std::string_view contents)
+        : path_(std::filesystem::temp_directory_path() / name)
+    {
+        auto file = std::ofstream{path_, std::ios::binary};
+        file.write(contents.data(), static_cast<std::streamsize>(contents.size()));
+    }
+
+    ~TempFile()
+    {
+        std::filesystem::remove(path_);
+    }
+
+    auto path() const -> const std::filesystem::path &
+    {
+        return path_;
+    }
+
+  private:
+    std::filesystem::path path_;
+};
+
+}
+
+TEST(file, read)
+{
+    const auto temp = TempFile{"file_tests_read", "hello world"};
+    const auto file = game::File{temp.path()};
+
+    ASSERT_EQ(file.size(), 11u);
+    ASSERT_EQ(file.as_string(), "hello world");
+    ASSERT_EQ(file.as_data().size(), 11u);
+    ASSERT_EQ(file.as_data()[4], static_cast<std::byte>('o'));
+}
+
+TEST(file, missing)
+{
+    ASSERT_THROW(game::File{std::filesystem::temp_directory_path() / "file_tests_missing"}, game::Exception);
+}
+
+TEST(file, write)
+{
+    const auto temp = TempFile{"file_tests_write", "xxxxx"};
+
+    {
+        auto file = game::File{temp.path()};
+        file.write(std::string_view{"abc"});
+    }
+
+    const auto file = game::File{temp.path()};
+    ASSERT_EQ(file.as_string(), "abcxx");
+}
+
+TEST(file, mapping_options)
+{
+    const auto contents = std::string(3u * 1024u * 1024u, 'a');
+    const auto temp = TempFile{"file_tests_mapping_options", contents};
+
+    for (const auto access_pattern :
+         {game::AccessPattern::NORMAL, game::AccessPattern::SEQUENTIAL, game::AccessPattern::RANDOM})
+    {
+        const auto file = game::File{
+            temp.path(),
+            game::CreationMode::OPEN,
+            {.access_pattern = access_pattern, .populate = true, .huge_pages = true}};
+
+        ASSERT_EQ(file.as_string(), contents);
+    }
+}
+
+TEST(file, prefetch)
+{
+    const auto contents = std::string(100000u, 'a');
+    const auto temp = TempFile{"file_tests_prefetch", contents};
+    const auto file = game::File{temp.path()};
+
+    ASSERT_NO_THROW(file.prefetch(file.as_data()));
+    ASSERT_NO_THROW(file.prefetch(file.as_data().subspan(5000u, 10u)));
+    ASSERT_NO_THROW(file.prefetch(file.as_data().subspan(99999u)));
+}
+
+TEST(file, prefetch_outside_file)
+{
+    const auto temp = TempFile{"file_tests_prefetch_outside_file", "hello world"};
+    const auto file = game::File{temp.path()};
+    const auto other = std::string(20u, 'a');
+
+    ASSERT_THROW(file.prefetch(std::as_bytes(std::span{other})), game::Exception);
+}
@@ -0,0 +1,144 @@
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <numbers>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "graphics/camera.h"
+#include "maths/aabb.h"
+#include "maths/frustum_cull.h"
+#include "maths/frustum_plane.h"
+#include "maths/matrix4.h"
+#include "maths/quaternion.h"
+#include "maths/vector3.h"
+#include "utils.h"
+
+namespace
+{
+
+auto create_camera() -> game::Camera
+{
+    return {
+        {0.0f, 0.0f, 0.0f},
+        {0.0f, 0.0f, -1.0f},
+        {0.0f, 1.0f, 0.0f},
+        std::numbers::pi_v<float> / 4.0f,
+        1920.0f,
+        1080.0f,
+        0.1f,
+        100.0f};
+}
+
+auto create_box(const game::Vector3 &centre, float half_size) -> game::AABB
+{
+    return {.min = centre - game::Vector3{half_size}, .max = centre + game::Vector3{half_size}};
+}
+
+}
+
+TEST(frustum_cull, intersects_frustum)
+{
+    const auto camera = create_camera();
+    const auto &planes = camera.frustum_planes();
+
+    ASSERT_TRUE(game::intersects_frustum(create_box({0.0f, 0.0f, -10.0f}, 1.0f), planes));
+    ASSERT_TRUE(game::intersects_frustum(create_box({0.0f, 0.0f, -100.0f}, 1.0f), planes));
+    ASSERT_FALSE(game::intersects_frustum(create_box({0.0f, 0.0f, 10.0f}, 1.0f), planes));
+    ASSERT_FALSE(game::intersects_frustum(create_box({0.0f, 0.0f, -110.0f}, 1.0f), planes));
+    ASSERT_FALSE(game::intersects_frustum(create_box({100.0f, 0.0f, -10.0f}, 1.0f), planes));
+}
+
+TEST(frustum_cull, empty)
+{
+    const auto camera = create_camera();
+    const auto boxes = game::AABBArray{};
+    auto visible = std::vector<std::uint64_t>{1u, 2u, 3u};
+
+    game::cull(camera.frustum_planes(), boxes, visible);
+
+    ASSERT_TRUE(visible.empty());
+}
+
+TEST(frustum_cull, matches_intersects_frustum)
+{
+    auto camera = create_camera();
+    camera.adjust_yaw(0.4f);
+    camera.adjust_pitch(-0.2f);
+    const auto &planes = camera.frustum_planes();
+
+    // a grid of boxes around the camera, with a count that is not a multiple of the batch size or of 64
+    auto aabbs = std::vector<game::AABB>{};
+    for (auto x = -10; x <= 10; ++x)
+    {
+        for (auto z = -10; z <= 10; ++z)
+        {
+            const auto centre = game::Vector3{
+                static_cast<float>(x) * 8.0f, static_cast<float>((x * z) % 7), static_cast<float>(z) * 8.0f};
+            aabbs.push_back(create_box(centre, 0.5f + static_cast<float>((x + z + 20) % 3)));
+        }
+    }
+
+    auto boxes = game::AABBArray{};
+    for (const auto &aabb : aabbs)
+    {
+        boxes.push_back(aabb);
+    }
+
+    auto visible = std::vector<std::uint64_t>{};
+    game::cull(planes, boxes, visible);
+
+    ASSERT_EQ(boxes.size(), aabbs.size());
+    ASSERT_EQ(visible.size(), (aabbs.size() + 63u) / 64u);
+
+    auto visible_count = 0u;
+    for (auto i = std::size_t{}; i < aabbs.size(); ++i)
+    {
+        ASSERT_EQ(game::is_visible(visible, i), game::intersects_frustum(aabbs[i], planes)) << i;
+        visible_count += game::is_visible(visible, i) ? 1u : 0u;
+    }
+
+    // make sure the test actually covers both cases
+    ASSERT_GT(visible_count, 0u);
+    ASSERT_LT(visible_count, aabbs.size());
+
+    // nothing past the last box is set
+    ASSERT_EQ(visible.back() >> (aabbs.size() % 64u), 0u);
+}
+
+TEST(frustum_cull, clear)
+{
+    const auto camera = create_camera();
+
+    auto boxes = game::AABBArray{};
+    for (auto i = 0u; i < 10u; ++i)
+    {
+        boxes.push_back(create_box({0.0f, 0.0f, 200.0f}, 1.0f));
+    }
+
+    boxes.clear();
+    boxes.push_back(create_box({0.0f, 0.0f, -10.0f}, 1.0f));
+
+    auto visible = std::vector<std::uint64_t>{};
+    game::cull(camera.frustum_planes(), boxes, visible);
+
+    ASSERT_EQ(boxes.size(), 1u);
+    ASSERT_EQ(visible, std::vector<std::uint64_t>{1u});
+}
+
+TEST(frustum_cull, transform)
+{
+    const auto box = game::AABB{.min = {-1.0f, -2.0f, -3.0f}, .max = {1.0f, 2.0f, 3.0f}};
+
+    // a quarter turn about y swaps the x and z extents
+    const auto half_angle = std::numbers::pi_v<float> / 4.0f;
+    const auto rotation = game::Quaternion{0.0f, std::sin(half_angle), 0.0f, std::cos(half_angle)};
+    const auto matrix = game::Matrix4{game::Vector3{10.0f, 0.0f, 0.0f}, rotation, game::Vector3{2.0f}};
+
+    const auto transformed = game::transform(box, matrix);
+
+    utils::assert_vector3_equal(transformed.min, {4.0f, -4.0f, -2.0f});
+    utils::assert_vector3_equal(transformed.max, {16.0f, 4.0f, 2.0f});
+}
@@ -0,0 +1,101 @@
+#include <cstddef>
+#include <cstdint>
+#include <ranges>
+#include <span>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "utils/exception.h"
+#include "utils/lz4.h"
+
+namespace
+{
+
+auto round_trip(std::span<const std::byte> data) -> std::vector<std::byte>
+{
+    const auto block = game::lz4_compress(data);
+
+    auto decompressed = std::vector<std::byte>(data.size());
+    game::lz4_decompress(block, decompressed);
+
+    return decompressed;
+}
+
+}
+
+TEST(lz4, empty)
+{
+    const auto data = std::vector<std::byte>{};
+
+    ASSERT_EQ(round_trip(data), data);
+}
+
+TEST(lz4, short_input)
+{
+    // too short for any matches
+    const auto data = std::vector<std::byte>(10u, std::byte{0x42});
+
+    ASSERT_EQ(round_trip(data), data);
+}
+
+TEST(lz4, repeated_byte)
+{
+    // a single long overlapping match, with lengths that need extra length bytes
+    const auto data = std::vector<std::byte>(100000u, std::byte{0x42});
+    const auto block = game::lz4_compress(data);
+
+    ASSERT_LT(block.size(), data.size() / 100u);
+    ASSERT_EQ(round_trip(data), data);
+}
+
+TEST(lz4, pattern)
+{
+    const auto data = std::views::iota(0u, 70000u) |
+                      std::views::transform([](auto i) { return static_cast<std::byte>((i * i) % 251u); }) |
+                      std::ranges::to<std::vector>();
+
+    ASSERT_EQ(round_trip(data), data);
+}
+
+TEST(lz4, incompressible)
+{
+    auto state = 0x12345678u;
+    const auto data = std::views::iota(0u, 10000u) | std::views::transform(
+                                                         [&state](auto)
+                                                         {
+                                                             state = state * 1664525u + 1013904223u;
+                                                             return static_cast<std::byte>(state >> 24u);
+                                                         }) |
+                      std::ranges::to<std::vector>();
+
+    ASSERT_EQ(round_trip(data), data);
+}
+
+TEST(lz4, wrong_destination_size)
+{
+    const auto data = std::vector<std::byte>(1000u, std::byte{0x42});
+    const auto block = game::lz4_compress(data);
+
+    auto too_small = std::vector<std::byte>(data.size() - 1u);
+    ASSERT_THROW(game::lz4_decompress(block, too_small), game::Exception);
+
+    auto too_large = std::vector<std::byte>(data.size() + 1u);
+    ASSERT_THROW(game::lz4_decompress(block, too_large), game::Exception);
+}
+
+TEST(lz4, malformed)
+{
+    auto destination = std::vector<std::byte>(100u);
+
+    // no block at all
+    ASSERT_THROW(game::lz4_decompress({}, destination), game::Exception);
+
+    // more literals than there are bytes
+    const auto truncated = std::vector<std::byte>{std::byte{0xf0}, std::byte{0x10}, std::byte{0x01}};
+    ASSERT_THROW(game::lz4_decompress(truncated, destination), game::Exception);
+
+    // match before the start of the output
+    const auto bad_offset = std::vector<std::byte>{std::byte{0x10}, std::byte{0x01}, std::byte{0x02}, std::byte{0x00}};
+    ASSERT_THROW(game::lz4_decompress(bad_offset, destination), game::Exception);
+}
@@ -0,0 +1,61 @@
+#include <algorithm>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "manifest.h"
+#include "utils/exception.h"
+
+TEST(manifest, empty)
+{
+    const auto manifest = game::Manifest{};
+
+    ASSERT_EQ(manifest.bundles(), (std::vector<std::string>{"shared"}));
+    ASSERT_EQ(manifest.bundle("anything.png"), "shared");
+}
+
+TEST(manifest, parse)
+{
+    const auto manifest = game::Manifest{
+        "# comment\n"
+        "[apple]\r\n"
+        "  barrel.obj  \n"
+        "\n"
+        "[shared]\n"
+        "sky.png\n"
+        "[kiwi]\n"
+        "kiwi.obj\n"};
+
+    ASSERT_EQ(manifest.bundles(), (std::vector<std::string>{"shared", "apple", "kiwi"}));
+    ASSERT_EQ(manifest.bundle("barrel.obj"), "apple");
+    ASSERT_EQ(manifest.bundle("kiwi.obj"), "kiwi");
+    ASSERT_EQ(manifest.bundle("sky.png"), "shared");
+    ASSERT_EQ(manifest.bundle("unlisted.png"), "shared");
+
+    auto assets = manifest.assets();
+    std::ranges::sort(assets);
+    ASSERT_EQ(assets, (std::vector<std::string_view>{"barrel.obj", "kiwi.obj", "sky.png"}));
+}
+
+TEST(manifest, asset_outside_bundle)
+{
+    ASSERT_THROW(game::Manifest{"barrel.obj\n[apple]\n"}, game::Exception);
+}
+
+TEST(manifest, duplicate_asset)
+{
+    ASSERT_THROW(game::Manifest{"[apple]\nbarrel.obj\n[kiwi]\nbarrel.obj\n"}, game::Exception);
+}
+
+TEST(manifest, duplicate_bundle)
+{
+    ASSERT_THROW(game::Manifest{"[apple]\n[apple]\n"}, game::Exception);
+}
+
+TEST(manifest, invalid_bundle_name)
+{
+    ASSERT_THROW(game::Manifest{"[../apple]\n"}, game::Exception);
+    ASSERT_THROW(game::Manifest{"[apple\n"}, game::Exception);
+}
@@ -4,7 +4,10 @@
 #include <gtest/gtest.h>
 
 #include "maths/matrix4.h"
+#include "maths/quaternion.h"
+#include "maths/transform.h"
 #include "maths/vector3.h"
+#include "maths/vector4.h"
 #include "utils.h"
 
 TEST(matrix4, identity_ctor)
@@ -106,6 +109,23 @@ TEST(matrix4, quaternion_ctor)
     ASSERT_EQ(m, expected);
 }
 
+TEST(matrix4, translation_rotation_scale_ctor)
+{
+    const auto translation = game::Vector3{1.1f, -2.3f, 3.7f};
+    const auto rotation = game::Quaternion{0.18f, 0.52f, -0.09f, 0.83f};
+    const auto scale = game::Vector3{1.5f, 0.7f, 2.3f};
+
+    const auto m = game::Matrix4{translation, rotation, scale};
+
+    // the shortcut has to give exactly the same result as the full product
+    const auto product =
+        game::Matrix4{translation} * game::Matrix4{rotation} * game::Matrix4{scale, game::Matrix4::Scale{}};
+    const auto transform = game::Transform{translation, scale, rotation};
+
+    ASSERT_EQ(m, product);
+    ASSERT_EQ(m, game::Matrix4{transform});
+}
+
 TEST(matrix4, multiply)
 {
     const auto m1 = game::Matrix4{
@@ -239,3 +259,59 @@ TEST(matrix4, row)
     ASSERT_EQ(m.row(2), game::Vector4(3.0f, 7.0f, 11.0f, 15.0f));
     ASSERT_EQ(m.row(3), game::Vector4(4.0f, 8.0f, 12.0f, 16.0f));
 }
+
+TEST(matrix4, multiply_matches_constant_evaluation)
+{
+    constexpr auto m1 =
+        game::Matrix4{{1.1f, -2.3f, 3.7f}, game::Quaternion{0.18f, 0.52f, -0.09f, 0.83f}, {1.5f, 0.7f, 2.3f}};
+    constexpr auto m2 =
+        game::Matrix4{{-0.3f, 9.1f, 0.2f}, game::Quaternion{-0.61f, 0.1f, 0.33f, 0.71f}, {0.9f, 1.3f, 0.1f}};
+
+    // evaluated with the scalar code at compile time and the simd code at runtime, which must agree exactly
+    constexpr auto expected = m1 * m2;
+    const auto result = m1 * m2;
+
+    ASSERT_EQ(result, expected);
+}
+
+TEST(matrix4, multiply_vector4)
+{
+    const auto m = game::Matrix4{
+        {1.0f, 2.0f, 3.0f, 4.0f, 5.0f, 6.0f, 7.0f, 8.0f, 9.0f, 10.0f, 11.0f, 12.0f, 13.0f, 14.0f, 15.0f, 16.0f}};
+
+    ASSERT_EQ(m * game::Vector4(1.0f, 0.5f, -1.0f, 2.0f), game::Vector4(20.5f, 23.0f, 25.5f, 28.0f));
+}
+
+TEST(matrix4, multiply_vector4_matches_constant_evaluation)
+{
+    constexpr auto m =
+        game::Matrix4{{1.1f, -2.3f, 3.7f}, game::Quaternion{0.18f, 0.52f, -0.09f, 0.83f}, {1.5f, 0.7f, 2.3f}};
+    constexpr auto v = game::Vector4{0.3f, -1.7f, 2.9f, 1.0f};
+
+    constexpr auto expected = m * v;
+    const auto result = m * v;
+
+    ASSERT_EQ(result, expected);
+}
+
+TEST(matrix4, invert_affine)
+{
+    const auto m =
+        game::Matrix4{{1.1f, -2.3f, 3.7f}, game::Quaternion{0.18f, 0.52f, -0.09f, 0.83f}, {1.5f, 0.7f, 2.3f}};
+
+    const auto inverse = game::Matrix4::invert_affine(m);
+
+    utils::assert_matrix4_equal(inverse * m, game::Matrix4{}, 0.00001f);
+    utils::assert_matrix4_equal(m * inverse, game::Matrix4{}, 0.00001f);
+}
+
+TEST(matrix4, invert_affine_matches_constant_evaluation)
+{
+    constexpr auto m =
+        game::Matrix4{{1.1f, -2.3f, 3.7f}, game::Quaternion{0.18f, 0.52f, -0.09f, 0.83f}, {1.5f, 0.7f, 2.3f}};
+
+    constexpr auto expected = game::Matrix4::invert_affine(m);
+    const auto result = game::Matrix4::invert_affine(m);
+
+    ASSERT_EQ(result, expected);
+}
@@ -0,0 +1,132 @@
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "graphics/vertex_data.h"
+#include "mesh_optimiser.h"
+#include "utils/exception.h"
+
+namespace
+{
+
+auto vertex(float x, float y) -> game::VertexData
+{
+    return {.position = {x, y, 0.0f}, .normal = {0.0f, 0.0f, 1.0f}, .tangent = {1.0f, 0.0f, 0.0f}, .uv = {x, y}};
+}
+
+/**
+ * Build a size x size grid of quads with every triangle having its own unwelded vertices.
+ */
+auto unwelded_grid(std::uint32_t size) -> game::MeshBuffers
+{
+    auto mesh = game::MeshBuffers{};
+
+    for (auto y = 0u; y < size; ++y)
+    {
+        for (auto x = 0u; x < size; ++x)
+        {
+            const auto fx = static_cast<float>(x);
+            const auto fy = static_cast<float>(y);
+
+            for (const auto &v : {vertex(fx, fy),
+                                  vertex(fx + 1.0f, fy),
+                                  vertex(fx, fy + 1.0f),
+                                  vertex(fx + 1.0f, fy),
+                                  vertex(fx + 1.0f, fy + 1.0f),
+                                  vertex(fx, fy + 1.0f)})
+            {
+                mesh.indices.push_back(static_cast<std::uint32_t>(mesh.vertices.size()));
+                mesh.vertices.push_back(v);
+            }
+        }
+    }
+
+    return mesh;
+}
+
+/**
+ * Get the positions of every triangle, normalised and sorted so two meshes can be compared regardless of order.
+ */
+auto sorted_triangles(const game::MeshBuffers &mesh) -> std::vector<std::array<std::pair<float, float>, 3u>>
+{
+    auto triangles = std::vector<std::array<std::pair<float, float>, 3u>>{};
+
+    for (auto i = 0u; i < mesh.indices.size(); i += 3u)
+    {
+        auto triangle = std::array<std::pair<float, float>, 3u>{};
+        for (auto j = 0u; j < 3u; ++j)
+        {
+            const auto &position = mesh.vertices[mesh.indices[i + j]].position;
+            triangle[j] = {position.x, position.y};
+        }
+
+        // rotate so the winding is preserved but the start vertex is consistent
+        std::ranges::rotate(triangle, std::ranges::min_element(triangle));
+        triangles.push_back(triangle);
+    }
+
+    std::ranges::sort(triangles);
+    return triangles;
+}
+
+}
+
+TEST(mesh_optimiser, weld_vertices)
+{
+    const auto mesh = unwelded_grid(4u);
+    const auto welded = game::weld_vertices(mesh.vertices, mesh.indices);
+
+    ASSERT_EQ(welded.vertices.size(), 25u);
+    ASSERT_EQ(welded.indices.size(), mesh.indices.size());
+    ASSERT_EQ(sorted_triangles(welded), sorted_triangles(mesh));
+}
+
+TEST(mesh_optimiser, optimise_vertex_fetch)
+{
+    const auto vertices = std::vector<game::VertexData>{vertex(0.0f, 0.0f), vertex(1.0f, 0.0f), vertex(2.0f, 0.0f)};
+    const auto indices = std::vector<std::uint32_t>{2u, 0u, 2u};
+
+    const auto optimised = game::optimise_vertex_fetch(vertices, indices);
+
+    // unreferenced vertex removed and the rest in first use order
+    ASSERT_EQ(optimised.vertices.size(), 2u);
+    ASSERT_EQ(optimised.vertices[0].position.x, 2.0f);
+    ASSERT_EQ(optimised.vertices[1].position.x, 0.0f);
+    ASSERT_EQ(optimised.indices, (std::vector<std::uint32_t>{0u, 1u, 0u}));
+}
+
+TEST(mesh_optimiser, optimise_mesh)
+{
+    const auto mesh = unwelded_grid(32u);
+    const auto welded = game::weld_vertices(mesh.vertices, mesh.indices);
+    const auto optimised = game::optimise_mesh(mesh.vertices, mesh.indices);
+
+    const auto before = game::analyse_vertex_cache(welded.indices, welded.vertices.size());
+    const auto after = game::analyse_vertex_cache(optimised.indices, optimised.vertices.size());
+
+    ASSERT_EQ(sorted_triangles(optimised), sorted_triangles(mesh));
+    ASSERT_EQ(optimised.vertices.size(), welded.vertices.size());
+    ASSERT_LE(after.acmr, before.acmr);
+    ASSERT_LT(after.acmr, 1.0f);
+}
+
+TEST(mesh_optimiser, analyse_vertex_cache)
+{
+    // two triangles sharing an edge, 4 unique vertices transformed once each
+    const auto indices = std::vector<std::uint32_t>{0u, 1u, 2u, 1u, 3u, 2u};
+    const auto stats = game::analyse_vertex_cache(indices, 4u);
+
+    ASSERT_EQ(stats.acmr, 2.0f);
+    ASSERT_EQ(stats.atvr, 1.0f);
+}
+
+TEST(mesh_optimiser, invalid_index)
+{
+    const auto indices = std::vector<std::uint32_t>{0u, 1u, 5u};
+
+    ASSERT_THROW(game::optimise_vertex_cache(indices, 3u), game::Exception);
+}
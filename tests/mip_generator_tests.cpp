@@ -0,0 +1,67 @@
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "graphics/texture.h"
+#include "mip_generator.h"
+#include "utils/exception.h"
+
+namespace
+{
+template <class... Args>
+auto create_binary_vec(Args... args) -> std::vector<std::byte>
+{
+    return {std::byte(args)...};
+}
+}
+
+TEST(mip_generator, data)
+{
+    const auto pixels = create_binary_vec(0x00, 0xff, 0x00, 0xff);
+    const auto chain = game::generate_mip_chain(pixels, 2u, 2u, 1u, false);
+
+    ASSERT_EQ(chain, create_binary_vec(0x00, 0xff, 0x00, 0xff, 0x80));
+}
+
+TEST(mip_generator, srgb)
+{
+    // averaging black and white in linear space gives 0.5 which is ~188 in sRGB, not 128
+    const auto pixels = create_binary_vec(0x00, 0xff, 0x00, 0xff);
+    const auto chain = game::generate_mip_chain(pixels, 2u, 2u, 1u, true);
+
+    ASSERT_EQ(chain.back(), std::byte{188});
+}
+
+TEST(mip_generator, srgb_alpha_is_linear)
+{
+    const auto pixels = create_binary_vec(0x00, 0x00, 0x00, 0x00, 0xff, 0xff, 0xff, 0xff);
+    const auto chain = game::generate_mip_chain(pixels, 2u, 1u, 4u, true);
+
+    ASSERT_EQ(chain, create_binary_vec(0x00, 0x00, 0x00, 0x00, 0xff, 0xff, 0xff, 0xff, 188, 188, 188, 0x80));
+}
+
+TEST(mip_generator, odd_size)
+{
+    const auto pixels = std::vector<std::byte>(5u * 3u * 3u, std::byte{100});
+    const auto chain = game::generate_mip_chain(pixels, 5u, 3u, 3u, true);
+
+    auto expected_size = std::size_t{};
+    for (auto level = 0u; level < game::mip_level_count(5u, 3u); ++level)
+    {
+        expected_size += game::mip_level_size(game::TextureFormat::RGB, 5u, 3u, level);
+    }
+
+    // 5x3 -> 2x1 -> 1x1, a constant image should stay constant
+    ASSERT_EQ(game::mip_level_count(5u, 3u), 3u);
+    ASSERT_EQ(chain.size(), expected_size);
+    ASSERT_EQ(chain, std::vector<std::byte>(expected_size, std::byte{100}));
+}
+
+TEST(mip_generator, size_mismatch)
+{
+    const auto pixels = create_binary_vec(0x00, 0xff, 0x00);
+
+    ASSERT_THROW(game::generate_mip_chain(pixels, 2u, 2u, 1u, false), game::Exception);
+}
@@ -0,0 +1,368 @@
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <ranges>
+#include <span>
+#include <tuple>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "graphics/instance_data.h"
+#include "graphics/opengl.h"
+#include "graphics/render_backend.h"
+#include "graphics/render_queue.h"
+#include "graphics/state_cache.h"
+#include "graphics/uniform.h"
+
+using enum game::RenderCommandType;
+
+namespace
+{
+
+/**
+ * Create a draw, the index offset is used to identify it.
+ */
+auto create_draw(
+    std::uintptr_t id,
+    ::GLuint program,
+    ::GLuint vertex_array,
+    float depth,
+    game::RenderPass pass = game::RenderPass::SOLID) -> game::DrawCall
+{
+    return {
+        .pass = pass,
+        .program = program,
+        .vertex_array = vertex_array,
+        .index_count = 3u,
+        .index_type = GL_UNSIGNED_INT,
+        .index_offset = id,
+        .depth = depth,
+        .instanced = false,
+        .entity = nullptr};
+}
+
+/**
+ * Get the ids of the draws in the order they were drawn.
+ */
+auto drawn_ids(const game::RecordingRenderBackend &backend) -> std::vector<std::uintptr_t>
+{
+    return backend.commands() | std::views::filter([](const auto &command) { return command.type == DRAW_ELEMENTS; }) |
+           std::views::transform([](const auto &command) { return command.index_offset; }) |
+           std::ranges::to<std::vector>();
+}
+
+/**
+ * Create an instance, the first parameter is used to identify it.
+ */
+auto create_instance(float id) -> game::InstanceData
+{
+    return {.model = {}, .parameters = {id, 0.0f, 0.0f, 0.0f}};
+}
+
+/**
+ * Get the instanced draws in the order they were drawn.
+ */
+auto instanced_draws(const game::RecordingRenderBackend &backend) -> std::vector<game::RenderCommand>
+{
+    return backend.commands() |
+           std::views::filter([](const auto &command) { return command.type == DRAW_ELEMENTS_INSTANCED; }) |
+           std::ranges::to<std::vector>();
+}
+
+}
+
+TEST(render_queue, sort_key_order)
+{
+    const auto textures = std::array<game::TextureBinding, 1u>{{{.texture = 1u, .sampler = 1u}}};
+
+    // solid draws before blended ones
+    ASSERT_LT(
+        game::make_sort_key(game::RenderPass::SOLID, 9u, textures, 9u, 1.0f),
+        game::make_sort_key(game::RenderPass::BLENDED, 1u, textures, 1u, 0.0f));
+
+    // solid draws are grouped by program before depth
+    ASSERT_LT(
+        game::make_sort_key(game::RenderPass::SOLID, 1u, textures, 2u, 1.0f),
+        game::make_sort_key(game::RenderPass::SOLID, 2u, textures, 1u, 0.0f));
+
+    // and drawn front to back with the same state
+    ASSERT_LT(
+        game::make_sort_key(game::RenderPass::SOLID, 1u, textures, 1u, 0.2f),
+        game::make_sort_key(game::RenderPass::SOLID, 1u, textures, 1u, 0.4f));
+
+    // blended draws are drawn back to front regardless of state
+    ASSERT_LT(
+        game::make_sort_key(game::RenderPass::BLENDED, 2u, textures, 2u, 0.8f),
+        game::make_sort_key(game::RenderPass::BLENDED, 1u, textures, 1u, 0.4f));
+
+    // identical texture sets get identical keys
+    const auto same_textures = std::vector<game::TextureBinding>{{.texture = 1u, .sampler = 1u}};
+    ASSERT_EQ(
+        game::make_sort_key(game::RenderPass::SOLID, 1u, textures, 1u, 0.5f),
+        game::make_sort_key(game::RenderPass::SOLID, 1u, same_textures, 1u, 0.5f));
+}
+
+TEST(render_queue, empty)
+{
+    auto backend = game::RecordingRenderBackend{};
+    auto cache = game::StateCache{backend};
+    auto queue = game::RenderQueue{};
+
+    queue.sort();
+    queue.submit(cache, {});
+
+    ASSERT_EQ(queue.size(), 0u);
+    ASSERT_TRUE(backend.commands().empty());
+}
+
+TEST(render_queue, unsorted_keeps_push_order)
+{
+    auto backend = game::RecordingRenderBackend{};
+    auto cache = game::StateCache{backend};
+    auto queue = game::RenderQueue{};
+
+    queue.push(create_draw(0u, 2u, 1u, 0.5f), {}, {});
+    queue.push(create_draw(1u, 1u, 1u, 0.5f), {}, {});
+    queue.push(create_draw(2u, 2u, 1u, 0.5f), {}, {});
+    queue.submit(cache, {});
+
+    ASSERT_EQ(drawn_ids(backend), (std::vector<std::uintptr_t>{0u, 1u, 2u}));
+    ASSERT_EQ(cache.stats().program_changes, 3u);
+}
+
+TEST(render_queue, sort_groups_state)
+{
+    auto backend = game::RecordingRenderBackend{};
+    auto cache = game::StateCache{backend};
+    auto queue = game::RenderQueue{};
+
+    const auto brick =
+        std::array<game::TextureBinding, 2u>{{{.texture = 1u, .sampler = 1u}, {.texture = 2u, .sampler = 1u}}};
+    const auto wood =
+        std::array<game::TextureBinding, 2u>{{{.texture = 3u, .sampler = 1u}, {.texture = 4u, .sampler = 1u}}};
+
+    // two programs, two texture sets and two meshes, interleaved as badly as possible
+    for (auto i = 0u; i < 16u; ++i)
+    {
+        const auto program = 1u + (i % 2u);
+        const auto vertex_array = 1u + ((i / 2u) % 2u);
+        const auto &textures = (i / 4u) % 2u == 0u ? brick : wood;
+        queue.push(create_draw(i, program, vertex_array, static_cast<float>(i) / 16.0f), textures, {});
+    }
+
+    queue.sort();
+    queue.submit(cache, {});
+
+    const auto &stats = cache.stats();
+    ASSERT_EQ(stats.draw_count, 16u);
+    ASSERT_EQ(stats.program_changes, 2u);
+
+    // each program draws both texture sets with both meshes
+    ASSERT_LE(stats.vertex_array_changes, 8u);
+    ASSERT_LE(stats.texture_changes, 2u + 2u * 3u);
+    ASSERT_EQ(stats.sampler_changes, 2u);
+
+    // draws with the same state are front to back
+    const auto ids = drawn_ids(backend);
+    ASSERT_EQ(ids.size(), 16u);
+    for (auto i = 1u; i < ids.size(); ++i)
+    {
+        const auto same_state = (ids[i] % 2u == ids[i - 1u] % 2u) && ((ids[i] / 2u) % 2u == (ids[i - 1u] / 2u) % 2u) &&
+                                ((ids[i] / 4u) % 2u == (ids[i - 1u] / 4u) % 2u);
+        if (same_state)
+        {
+            ASSERT_LT(ids[i - 1u], ids[i]);
+        }
+    }
+}
+
+TEST(render_queue, sort_matches_stable_sort)
+{
+    auto backend = game::RecordingRenderBackend{};
+    auto cache = game::StateCache{backend};
+    auto queue = game::RenderQueue{};
+
+    auto state = 0x2545f491u;
+    const auto random = [&state](std::uint32_t range)
+    {
+        state = state * 1664525u + 1013904223u;
+        return (state >> 8u) % range;
+    };
+
+    // keys and ids of the draws, with plenty of duplicate keys to check the sort is stable
+    auto expected = std::vector<std::tuple<std::uint64_t, std::uintptr_t>>{};
+    for (auto i = 0u; i < 2000u; ++i)
+    {
+        const auto pass = random(4u) == 0u ? game::RenderPass::BLENDED : game::RenderPass::SOLID;
+        const auto textures =
+            std::array<game::TextureBinding, 1u>{{{.texture = 1u + random(4u), .sampler = 1u + random(2u)}}};
+        const auto depth = static_cast<float>(random(50u)) / 50.0f;
+        const auto draw = create_draw(i, 1u + random(5u), 1u + random(300u), depth, pass);
+
+        queue.push(draw, textures, {});
+        expected.emplace_back(game::make_sort_key(pass, draw.program, textures, draw.vertex_array, draw.depth), i);
+    }
+
+    std::ranges::stable_sort(expected, {}, [](const auto &entry) { return std::get<0>(entry); });
+
+    queue.sort();
+    queue.submit(cache, {});
+
+    ASSERT_EQ(drawn_ids(backend), expected | std::views::elements<1> | std::ranges::to<std::vector>());
+}
+
+TEST(render_queue, prepare_before_draw)
+{
+    auto backend = game::RecordingRenderBackend{};
+    auto cache = game::StateCache{backend};
+    auto queue = game::RenderQueue{};
+
+    const auto textures = std::array<game::TextureBinding, 1u>{{{.texture = 7u, .sampler = 8u}}};
+    queue.push(create_draw(5u, 1u, 2u, 0.5f), textures, {});
+
+    auto prepared = std::vector<std::size_t>{};
+    queue.submit(
+        cache,
+        [&](const game::DrawCall &draw_call, const game::InstanceData &)
+        {
+            ASSERT_EQ(draw_call.index_offset, 5u);
+            prepared.push_back(backend.commands().size());
+        });
+
+    // state is bound before preparing, the draw comes after
+    ASSERT_EQ(prepared, std::vector<std::size_t>{4u});
+    ASSERT_EQ(backend.commands().size(), 5u);
+    ASSERT_EQ(backend.commands()[2], (game::RenderCommand{.type = BIND_TEXTURE, .unit = 0u, .handle = 7u}));
+    ASSERT_EQ(backend.commands()[4].type, DRAW_ELEMENTS);
+}
+
+TEST(render_queue, binds_parameter_buffers)
+{
+    auto backend = game::RecordingRenderBackend{};
+    auto cache = game::StateCache{backend};
+    auto queue = game::RenderQueue{};
+
+    auto with_parameters = create_draw(0u, 1u, 1u, 0.1f);
+    with_parameters.parameter_buffer = 9u;
+
+    queue.push(with_parameters, {}, {});
+    queue.push(with_parameters, {}, {});
+    queue.push(create_draw(1u, 2u, 1u, 0.1f), {}, {});
+    queue.sort();
+    queue.submit(cache, {});
+
+    // bound once for both draws which share it, left alone by the draw without one
+    const auto binds = backend.commands() |
+                       std::views::filter([](const auto &command) { return command.type == BIND_UNIFORM_BUFFER; }) |
+                       std::ranges::to<std::vector>();
+    ASSERT_EQ(
+        binds,
+        (std::vector<game::RenderCommand>{
+            {.type = BIND_UNIFORM_BUFFER, .unit = game::material_block_binding, .handle = 9u}}));
+}
+
+TEST(render_queue, instances_shared_state)
+{
+    auto backend = game::RecordingRenderBackend{};
+    auto cache = game::StateCache{backend};
+    auto queue = game::RenderQueue{};
+
+    const auto brick = std::array<game::TextureBinding, 1u>{{{.texture = 1u, .sampler = 1u}}};
+    const auto wood = std::array<game::TextureBinding, 1u>{{{.texture = 2u, .sampler = 1u}}};
+
+    // eight draws of two meshes, the last two of each with different textures
+    for (auto i = 0u; i < 8u; ++i)
+    {
+        auto draw = create_draw(i % 2u, 1u, 1u + (i % 2u), static_cast<float>(i) / 8.0f);
+        draw.instanced = true;
+
+        queue.push(draw, i < 4u ? brick : wood, create_instance(static_cast<float>(i)));
+    }
+
+    queue.sort();
+    queue.submit(cache, {});
+
+    const auto &stats = cache.stats();
+    ASSERT_EQ(stats.draw_count, 4u);
+    ASSERT_EQ(stats.instance_count, 8u);
+
+    const auto draws = instanced_draws(backend);
+    ASSERT_EQ(draws.size(), 4u);
+
+    // every draw has two instances, which are consecutive in the instance data and share the mesh and textures
+    const auto instances = queue.instances();
+    ASSERT_EQ(instances.size(), 8u);
+
+    auto next_instance = 0u;
+    for (const auto &draw : draws)
+    {
+        ASSERT_EQ(draw.instance_count, 2u);
+        ASSERT_EQ(draw.base_instance, next_instance);
+
+        const auto first = static_cast<std::uint32_t>(instances[draw.base_instance].parameters[0]);
+        const auto second = static_cast<std::uint32_t>(instances[draw.base_instance + 1u].parameters[0]);
+        ASSERT_EQ(first % 2u, draw.index_offset);
+        ASSERT_EQ(second % 2u, draw.index_offset);
+        ASSERT_EQ(first < 4u, second < 4u);
+
+        // front to back within the draw
+        ASSERT_LT(first, second);
+
+        next_instance += draw.instance_count;
+    }
+}
+
+TEST(render_queue, prepare_only_non_instanced)
+{
+    auto backend = game::RecordingRenderBackend{};
+    auto cache = game::StateCache{backend};
+    auto queue = game::RenderQueue{};
+
+    auto instanced = create_draw(0u, 1u, 1u, 0.1f);
+    instanced.instanced = true;
+
+    queue.push(instanced, {}, create_instance(0.0f));
+    queue.push(create_draw(1u, 1u, 1u, 0.2f), {}, create_instance(1.0f));
+    queue.push(instanced, {}, create_instance(2.0f));
+    queue.push(create_draw(1u, 1u, 1u, 0.3f), {}, create_instance(3.0f));
+
+    auto prepared = std::vector<float>{};
+    queue.submit(
+        cache,
+        [&](const game::DrawCall &draw_call, const game::InstanceData &instance)
+        {
+            ASSERT_FALSE(draw_call.instanced);
+            prepared.push_back(instance.parameters[0]);
+        });
+
+    // each draw is prepared with its own instance, and draws which are not next to each other, or not instanced, are
+    // never merged
+    ASSERT_EQ(prepared, (std::vector<float>{1.0f, 3.0f}));
+    ASSERT_EQ(drawn_ids(backend), (std::vector<std::uintptr_t>{1u, 1u}));
+    ASSERT_EQ(
+        instanced_draws(backend) | std::views::transform([](const auto &command) { return command.base_instance; }) |
+            std::ranges::to<std::vector>(),
+        (std::vector<std::uint32_t>{0u, 2u}));
+    ASSERT_EQ(cache.stats().draw_count, 4u);
+    ASSERT_EQ(cache.stats().instance_count, 4u);
+}
+
+TEST(render_queue, clear)
+{
+    auto backend = game::RecordingRenderBackend{};
+    auto cache = game::StateCache{backend};
+    auto queue = game::RenderQueue{};
+
+    queue.push(create_draw(0u, 1u, 1u, 0.5f), {}, {});
+    queue.sort();
+    queue.clear();
+
+    queue.push(create_draw(1u, 1u, 1u, 0.5f), {}, {});
+    queue.sort();
+    queue.submit(cache, {});
+
+    ASSERT_EQ(queue.size(), 1u);
+    ASSERT_EQ(drawn_ids(backend), std::vector<std::uintptr_t>{1u});
+}
@@ -1,14 +1,48 @@
+#include <cstddef>
+#include <stdexcept>
+#include <string>
+
 #include <gtest/gtest.h>
 
+#include "resources/handle.h"
 #include "resources/resource_cache.h"
+#include "resources/resource_footprint.h"
+#include "resources/resource_pins.h"
+
+namespace
+{
+
+struct Sized
+{
+    auto footprint() const -> game::ResourceFootprint
+    {
+        return {.cpu_bytes = 10u, .gpu_bytes = bytes};
+    }
+
+    std::size_t bytes;
+};
+
+struct Throwing
+{
+    explicit Throwing(bool fail)
+    {
+        if (fail)
+        {
+            throw std::runtime_error{"failed to construct"};
+        }
+    }
+};
+
+}
 
 TEST(resource_cache, insert)
 {
     auto cache = game::ResourceCache<int>{};
 
-    const auto *v = cache.insert<int>("num", 3);
+    const auto handle = cache.insert<int>("num", 3);
 
-    ASSERT_EQ(*v, 3);
+    ASSERT_TRUE(handle);
+    ASSERT_EQ(*cache.get(handle), 3);
 }
 
 TEST(resource_cache, get)
@@ -20,3 +54,210 @@ TEST(resource_cache, get)
 
     ASSERT_EQ(*v, 3);
 }
+
+TEST(resource_cache, find)
+{
+    auto cache = game::ResourceCache<int, std::string>{};
+
+    const auto num = cache.insert<int>("a", 3);
+    const auto str = cache.insert<std::string>("a", "hello");
+
+    ASSERT_EQ(cache.find<int>("a"), num);
+    ASSERT_EQ(cache.find<std::string>("a"), str);
+    ASSERT_EQ(*cache.get(str), "hello");
+}
+
+TEST(resource_cache, default_handle_invalid)
+{
+    auto cache = game::ResourceCache<int>{};
+    cache.insert<int>("num", 3);
+
+    ASSERT_FALSE(game::Handle<int>{});
+    ASSERT_FALSE(cache.contains(game::Handle<int>{}));
+}
+
+TEST(resource_cache, erase_makes_handle_stale)
+{
+    auto cache = game::ResourceCache<int>{};
+
+    const auto handle = cache.insert<int>("num", 3);
+    ASSERT_TRUE(cache.contains(handle));
+
+    cache.erase(handle);
+    ASSERT_FALSE(cache.contains(handle));
+
+    // the slot (and name) is reused but the old handle stays stale
+    const auto new_handle = cache.insert<int>("num", 4);
+    ASSERT_EQ(new_handle.index(), handle.index());
+    ASSERT_NE(new_handle.generation(), handle.generation());
+    ASSERT_FALSE(cache.contains(handle));
+    ASSERT_EQ(*cache.get(new_handle), 4);
+}
+
+TEST(resource_cache, throwing_insert_frees_slot)
+{
+    auto cache = game::ResourceCache<Throwing>{};
+
+    // a new slot is not kept
+    ASSERT_THROW(cache.insert<Throwing>("a", true), std::runtime_error);
+    const auto handle = cache.insert<Throwing>("a", false);
+    ASSERT_EQ(handle.index(), 0u);
+    ASSERT_TRUE(cache.contains(handle));
+
+    // a reused slot stays free
+    cache.erase(handle);
+    ASSERT_THROW(cache.insert<Throwing>("b", true), std::runtime_error);
+    ASSERT_EQ(cache.insert<Throwing>("b", false).index(), handle.index());
+}
+
+TEST(resource_cache, objects_do_not_move)
+{
+    auto cache = game::ResourceCache<int>{};
+
+    const auto *first = cache.get(cache.insert<int>("0", 0));
+    for (auto i = 1; i < 1000; ++i)
+    {
+        cache.insert<int>(std::to_string(i), i);
+    }
+
+    ASSERT_EQ(first, cache.get<int>("0"));
+}
+
+TEST(resource_cache, stats)
+{
+    auto cache = game::ResourceCache<Sized>{};
+
+    const auto handle = cache.insert<Sized>("a", 90u);
+    cache.insert<Sized>("b", 190u);
+    cache.get(handle);
+
+    const auto stats = cache.stats<Sized>();
+    ASSERT_EQ(stats.cpu_bytes, 20u);
+    ASSERT_EQ(stats.gpu_bytes, 280u);
+    ASSERT_EQ(stats.resident, 2u);
+    ASSERT_EQ(stats.hits, 1u);
+    ASSERT_EQ(stats.misses, 0u);
+
+    cache.erase(handle);
+    ASSERT_EQ(cache.stats<Sized>().gpu_bytes, 190u);
+}
+
+TEST(resource_cache, evicts_least_recently_used)
+{
+    auto cache = game::ResourceCache<Sized>{};
+    cache.set_budget<Sized>(300u);
+
+    const auto a = cache.insert_reloadable<Sized>("a", [] { return Sized{90u}; });
+    const auto b = cache.insert_reloadable<Sized>("b", [] { return Sized{90u}; });
+    const auto c = cache.insert_reloadable<Sized>("c", [] { return Sized{90u}; });
+
+    cache.get(b);
+    cache.get(a);
+
+    cache.insert_reloadable<Sized>("d", [] { return Sized{90u}; });
+
+    ASSERT_TRUE(cache.is_resident(a));
+    ASSERT_TRUE(cache.is_resident(b));
+    ASSERT_FALSE(cache.is_resident(c));
+    ASSERT_TRUE(cache.contains(c));
+    ASSERT_EQ(cache.stats<Sized>().evictions, 1u);
+    ASSERT_EQ(cache.stats<Sized>().resident, 3u);
+}
+
+TEST(resource_cache, reloads_on_demand)
+{
+    auto cache = game::ResourceCache<Sized>{};
+
+    auto loads = 0;
+    const auto handle = cache.insert_reloadable<Sized>(
+        "a",
+        [&loads]
+        {
+            ++loads;
+            return Sized{90u};
+        });
+
+    cache.set_budget<Sized>(0u);
+    ASSERT_FALSE(cache.is_resident(handle));
+
+    cache.set_budget<Sized>(1000u);
+    ASSERT_EQ(cache.get(handle)->bytes, 90u);
+    ASSERT_TRUE(cache.is_resident(handle));
+    ASSERT_EQ(loads, 2);
+    ASSERT_EQ(cache.stats<Sized>().misses, 1u);
+}
+
+TEST(resource_cache, pinned_not_evicted)
+{
+    auto cache = game::ResourceCache<Sized>{};
+
+    const auto handle = cache.insert_reloadable<Sized>("a", [] { return Sized{90u}; });
+    cache.pin(handle);
+
+    cache.set_budget<Sized>(0u);
+    ASSERT_TRUE(cache.is_resident(handle));
+
+    cache.unpin(handle);
+    ASSERT_FALSE(cache.is_resident(handle));
+}
+
+TEST(resource_cache, non_reloadable_not_evicted)
+{
+    auto cache = game::ResourceCache<Sized>{};
+
+    const auto handle = cache.insert<Sized>("a", 90u);
+    cache.set_budget<Sized>(0u);
+
+    ASSERT_TRUE(cache.is_resident(handle));
+    ASSERT_EQ(cache.stats<Sized>().evictions, 0u);
+}
+
+TEST(resource_pins, pinned_until_destroyed)
+{
+    auto cache = game::ResourceCache<Sized>{};
+    cache.set_budget<Sized>(150u);
+
+    const auto a = cache.insert_reloadable<Sized>("a", [] { return Sized{90u}; });
+    auto b = game::Handle<Sized>{};
+
+    {
+        auto pins = game::ResourcePins<Sized>{cache};
+        const auto *pinned = pins.get<Sized>("a");
+
+        // over budget, but the least recently used object is pinned
+        b = cache.insert_reloadable<Sized>("b", [] { return Sized{90u}; });
+        ASSERT_TRUE(cache.is_resident(a));
+        ASSERT_EQ(pinned->bytes, 90u);
+    }
+
+    // unpinning brings the cache back within budget
+    ASSERT_FALSE(cache.is_resident(a));
+    ASSERT_TRUE(cache.is_resident(b));
+    ASSERT_EQ(cache.stats<Sized>().evictions, 1u);
+}
+
+TEST(resource_pins, reloads_evicted)
+{
+    auto cache = game::ResourceCache<Sized>{};
+
+    const auto handle = cache.insert_reloadable<Sized>("a", [] { return Sized{90u}; });
+    cache.set_budget<Sized>(0u);
+    ASSERT_FALSE(cache.is_resident(handle));
+
+    auto pins = game::ResourcePins<Sized>{cache};
+    ASSERT_EQ(pins.get(handle)->bytes, 90u);
+    ASSERT_TRUE(cache.is_resident(handle));
+}
+
+TEST(resource_pins, erased_while_pinned)
+{
+    auto cache = game::ResourceCache<Sized>{};
+
+    const auto handle = cache.insert_reloadable<Sized>("a", [] { return Sized{90u}; });
+
+    auto pins = game::ResourcePins<Sized>{cache};
+    pins.get(handle);
+    cache.erase(handle);
+
+    ASSERT_FALSE(cache.contains(handle));
+}
@@ -0,0 +1,135 @@
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "graphics/opengl.h"
+#include "graphics/render_backend.h"
+#include "graphics/state_cache.h"
+
+using enum game::RenderCommandType;
+
+TEST(state_cache, forwards_changes)
+{
+    auto backend = game::RecordingRenderBackend{};
+    auto cache = game::StateCache{backend};
+
+    cache.use_program(1u);
+    cache.bind_vertex_array(2u);
+    cache.bind_texture(0u, 3u, 4u);
+    cache.draw_elements(6u, GL_UNSIGNED_INT, 12u);
+
+    const auto expected = std::vector<game::RenderCommand>{
+        {.type = USE_PROGRAM, .handle = 1u},
+        {.type = BIND_VERTEX_ARRAY, .handle = 2u},
+        {.type = BIND_TEXTURE, .unit = 0u, .handle = 3u},
+        {.type = BIND_SAMPLER, .unit = 0u, .handle = 4u},
+        {.type = DRAW_ELEMENTS, .index_count = 6u, .index_type = GL_UNSIGNED_INT, .index_offset = 12u},
+    };
+
+    ASSERT_EQ(std::vector(backend.commands().begin(), backend.commands().end()), expected);
+
+    const auto &stats = cache.stats();
+    ASSERT_EQ(stats.draw_count, 1u);
+    ASSERT_EQ(stats.program_changes, 1u);
+    ASSERT_EQ(stats.vertex_array_changes, 1u);
+    ASSERT_EQ(stats.texture_changes, 1u);
+    ASSERT_EQ(stats.sampler_changes, 1u);
+    ASSERT_EQ(stats.redundant_changes, 0u);
+}
+
+TEST(state_cache, skips_redundant_changes)
+{
+    auto backend = game::RecordingRenderBackend{};
+    auto cache = game::StateCache{backend};
+
+    cache.use_program(1u);
+    cache.bind_vertex_array(2u);
+    cache.bind_texture(0u, 3u, 4u);
+    backend.clear();
+
+    cache.use_program(1u);
+    cache.bind_vertex_array(2u);
+    cache.bind_texture(0u, 3u, 4u);
+
+    ASSERT_TRUE(backend.commands().empty());
+    ASSERT_EQ(cache.stats().redundant_changes, 4u);
+
+    // only the part which changed is forwarded
+    cache.bind_texture(0u, 5u, 4u);
+    cache.bind_texture(1u, 5u, 4u);
+
+    const auto expected = std::vector<game::RenderCommand>{
+        {.type = BIND_TEXTURE, .unit = 0u, .handle = 5u},
+        {.type = BIND_TEXTURE, .unit = 1u, .handle = 5u},
+        {.type = BIND_SAMPLER, .unit = 1u, .handle = 4u},
+    };
+
+    ASSERT_EQ(std::vector(backend.commands().begin(), backend.commands().end()), expected);
+    ASSERT_EQ(cache.stats().texture_changes, 3u);
+    ASSERT_EQ(cache.stats().sampler_changes, 2u);
+    ASSERT_EQ(cache.stats().redundant_changes, 5u);
+}
+
+TEST(state_cache, invalidate)
+{
+    auto backend = game::RecordingRenderBackend{};
+    auto cache = game::StateCache{backend};
+
+    cache.use_program(1u);
+    cache.bind_vertex_array(2u);
+    cache.invalidate();
+    backend.clear();
+
+    cache.use_program(1u);
+    cache.bind_vertex_array(2u);
+
+    const auto expected = std::vector<game::RenderCommand>{
+        {.type = USE_PROGRAM, .handle = 1u},
+        {.type = BIND_VERTEX_ARRAY, .handle = 2u},
+    };
+
+    ASSERT_EQ(std::vector(backend.commands().begin(), backend.commands().end()), expected);
+    ASSERT_EQ(cache.stats().program_changes, 2u);
+}
+
+TEST(state_cache, uniform_buffers)
+{
+    auto backend = game::RecordingRenderBackend{};
+    auto cache = game::StateCache{backend};
+
+    cache.bind_uniform_buffer(2u, 5u);
+    cache.bind_uniform_buffer(2u, 5u);
+    cache.bind_uniform_buffer(3u, 5u);
+    cache.bind_uniform_buffer(2u, 6u);
+
+    const auto expected = std::vector<game::RenderCommand>{
+        {.type = BIND_UNIFORM_BUFFER, .unit = 2u, .handle = 5u},
+        {.type = BIND_UNIFORM_BUFFER, .unit = 3u, .handle = 5u},
+        {.type = BIND_UNIFORM_BUFFER, .unit = 2u, .handle = 6u},
+    };
+
+    ASSERT_EQ(std::vector(backend.commands().begin(), backend.commands().end()), expected);
+    ASSERT_EQ(cache.stats().uniform_buffer_changes, 3u);
+    ASSERT_EQ(cache.stats().redundant_changes, 1u);
+}
+
+TEST(state_cache, instanced_draws)
+{
+    auto backend = game::RecordingRenderBackend{};
+    auto cache = game::StateCache{backend};
+
+    cache.draw_elements(6u, GL_UNSIGNED_INT, 0u);
+    cache.draw_elements_instanced(6u, GL_UNSIGNED_INT, 0u, 10u, 1u);
+
+    ASSERT_EQ(
+        backend.commands().back(),
+        (game::RenderCommand{
+            .type = DRAW_ELEMENTS_INSTANCED,
+            .index_count = 6u,
+            .index_type = GL_UNSIGNED_INT,
+            .index_offset = 0u,
+            .instance_count = 10u,
+            .base_instance = 1u}));
+    ASSERT_EQ(cache.stats().draw_count, 2u);
+    ASSERT_EQ(cache.stats().instance_count, 11u);
+}
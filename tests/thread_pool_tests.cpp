@@ -0,0 +1,119 @@
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <future>
+#include <stdexcept>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "utils/thread_pool.h"
+
+TEST(thread_pool, submit)
+{
+    auto pool = game::ThreadPool{4u};
+
+    auto futures = std::vector<std::future<int>>{};
+    for (auto i = 0; i < 100; ++i)
+    {
+        futures.push_back(pool.submit([i] { return i * 2; }));
+    }
+
+    for (auto i = 0; i < 100; ++i)
+    {
+        ASSERT_EQ(futures[i].get(), i * 2);
+    }
+}
+
+TEST(thread_pool, exception)
+{
+    auto pool = game::ThreadPool{1u};
+
+    auto future = pool.submit([]() -> int { throw std::runtime_error("error"); });
+
+    ASSERT_THROW(future.get(), std::runtime_error);
+}
+
+TEST(thread_pool, destructor_drains_queue)
+{
+    auto count = std::atomic<int>{};
+
+    {
+        auto pool = game::ThreadPool{2u};
+        for (auto i = 0; i < 50; ++i)
+        {
+            pool.submit([&count] { ++count; });
+        }
+    }
+
+    ASSERT_EQ(count, 50);
+}
+
+TEST(thread_pool, priority)
+{
+    auto order = std::vector<int>{};
+    auto pool = game::ThreadPool{1u, 3u};
+
+    // block the only worker so everything else queues up behind it
+    auto release = std::promise<void>{};
+    auto blocker = pool.submit([future = release.get_future()] { future.wait(); });
+
+    auto futures = std::vector<std::future<void>>{};
+    futures.push_back(pool.submit(2u, [&order] { order.push_back(2); }));
+    futures.push_back(pool.submit(1u, [&order] { order.push_back(1); }));
+    futures.push_back(pool.submit(0u, [&order] { order.push_back(0); }));
+    futures.push_back(pool.submit(1u, [&order] { order.push_back(3); }));
+
+    release.set_value();
+    for (auto &future : futures)
+    {
+        future.get();
+    }
+
+    ASSERT_EQ(order, (std::vector<int>{0, 1, 3, 2}));
+}
+
+TEST(thread_pool, parallel_for)
+{
+    auto pool = game::ThreadPool{4u};
+
+    auto counts = std::vector<std::atomic<int>>(1000u);
+    pool.parallel_for(0u, counts.size(), [&counts](auto index) { ++counts[index]; });
+
+    ASSERT_TRUE(std::ranges::all_of(counts, [](const auto &count) { return count == 1; }));
+}
+
+TEST(thread_pool, parallel_for_from_task)
+{
+    // the only worker is running the task, so the calling thread has to do all the work itself
+    auto pool = game::ThreadPool{1u};
+
+    auto future = pool.submit(
+        [&pool]
+        {
+            auto sum = std::atomic<std::size_t>{};
+            pool.parallel_for(0u, 100u, [&sum](auto index) { sum += index; });
+            return sum.load();
+        });
+
+    ASSERT_EQ(future.get(), 4950u);
+}
+
+TEST(thread_pool, parallel_for_exception)
+{
+    auto pool = game::ThreadPool{2u};
+
+    auto count = std::atomic<int>{};
+    const auto body = [&count](auto index)
+    {
+        ++count;
+        if (index == 5u)
+        {
+            throw std::runtime_error("error");
+        }
+    };
+
+    // every index is still visited
+    ASSERT_THROW(pool.parallel_for(0u, 10u, body), std::runtime_error);
+    ASSERT_EQ(count, 10);
+}
@@ -1,6 +1,12 @@
+#include <algorithm>
 #include <cstddef>
 #include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
 #include <fstream>
+#include <iterator>
+#include <new>
 #include <ranges>
 #include <span>
 #include <sstream>
@@ -10,15 +16,57 @@
 
 #include <gtest/gtest.h>
 
+#include "graphics/mesh_data.h"
 #include "graphics/texture.h"
+#include "graphics/vertex_data.h"
+#include "graphics/vertex_layout.h"
+#include "tlv/tlv_archive.h"
+#include "tlv/tlv_compression.h"
 #include "tlv/tlv_entry.h"
+#include "tlv/tlv_index.h"
 #include "tlv/tlv_reader.h"
+#include "tlv/tlv_sink.h"
 #include "tlv/tlv_writer.h"
 #include "utils/error.h"
 #include "utils/exception.h"
 
 #pragma comment(lib, "opengl32.lib")
 
+namespace
+{
+/** Whether allocations on this thread are being counted. */
+thread_local auto counting_allocations = false;
+
+/** Number of bytes allocated on this thread whilst counting. */
+thread_local auto allocated_bytes = std::size_t{};
+}
+
+// count allocations so tests can check what is kept in memory, everything else is as the default
+auto operator new(std::size_t size) -> void *
+{
+    if (counting_allocations)
+    {
+        allocated_bytes += size;
+    }
+
+    if (auto *ptr = std::malloc(size == 0u ? 1u : size); ptr != nullptr)
+    {
+        return ptr;
+    }
+
+    throw std::bad_alloc{};
+}
+
+auto operator delete(void *ptr) noexcept -> void
+{
+    std::free(ptr);
+}
+
+auto operator delete(void *ptr, std::size_t) noexcept -> void
+{
+    std::free(ptr);
+}
+
 namespace
 {
 template <class... Args>
@@ -26,6 +74,24 @@ auto create_binary_vec(Args... args) -> std::vector<std::byte>
 {
     return {std::byte(args)...};
 }
+
+auto create_patterned_vec(std::size_t size) -> std::vector<std::byte>
+{
+    return std::views::iota(0u, size) | std::views::transform([](auto i) { return std::byte((i / 7u) % 13u); }) |
+           std::ranges::to<std::vector>();
+}
+
+auto create_noise_vec(std::size_t size) -> std::vector<std::byte>
+{
+    auto state = 0x12345678u;
+    return std::views::iota(0u, size) | std::views::transform(
+                                            [&state](auto)
+                                            {
+                                                state = state * 1664525u + 1013904223u;
+                                                return std::byte(state >> 24u);
+                                            }) |
+           std::ranges::to<std::vector>();
+}
 }
 
 TEST(tlv_entry, ctor)
@@ -82,6 +148,25 @@ TEST(tlv_entry, byte_array_value_invalid_type)
     ASSERT_THROW(entry.byte_array_value(), game::Exception);
 }
 
+TEST(tlv_entry, byte_array_view_valid)
+{
+    const auto bytes = create_binary_vec(0xaa, 0xbb, 0xcc);
+    const auto entry = game::TLVEntry{game::TLVType::BYTE_ARRAY, bytes};
+
+    const auto view = entry.byte_array_view();
+
+    ASSERT_EQ(view.data(), bytes.data());
+    ASSERT_EQ(view.size(), bytes.size());
+}
+
+TEST(tlv_entry, uint32_array_view_invalid_size)
+{
+    const auto bytes = create_binary_vec(0xaa, 0xbb, 0xcc);
+    const auto entry = game::TLVEntry{game::TLVType::UINT32_ARRAY, bytes};
+
+    ASSERT_THROW(entry.uint32_array_view(), game::Exception);
+}
+
 TEST(tlv_reader, begin)
 {
     const auto bytes = create_binary_vec(
@@ -216,3 +301,809 @@ TEST(tlv_writer, write_texture_description)
     ASSERT_EQ(usage, texture_desc.usage);
     ASSERT_EQ(data, texture_desc.data);
 }
+
+TEST(tlv_archive, find_with_index)
+{
+    const auto data = create_binary_vec(0xaa, 0xbb, 0xcc);
+    const auto vertices = std::vector<game::VertexData>(3u);
+    const auto indices = std::vector<std::uint32_t>{0u, 1u, 2u};
+    auto writer = game::TLVWriter{};
+
+    writer.write("tex1", 1u, 1u, game::TextureFormat::RGB, game::TextureUsage::SRGB, data);
+    writer.write("mesh", vertices, indices);
+    writer.write("tex2", 2u, 3u, game::TextureFormat::RGB, game::TextureUsage::DATA, data);
+    writer.write_index();
+
+    const auto buffer = writer.yield();
+    const auto archive = game::TLVArchive{buffer};
+
+    ASSERT_TRUE(archive.has_index());
+
+    const auto tex = archive.find("tex2", game::TLVType::TEXTURE_DESCRIPTION);
+    ASSERT_TRUE(tex.has_value());
+    ASSERT_EQ(tex->name(), "tex2");
+    ASSERT_EQ(tex->texture_description_value().height, 3u);
+
+    const auto mesh = archive.find("mesh", game::TLVType::MESH_DATA);
+    ASSERT_TRUE(mesh.has_value());
+    ASSERT_EQ(mesh->mesh_value().indices.size(), indices.size());
+}
+
+TEST(tlv_archive, find_without_index)
+{
+    const auto data = create_binary_vec(0xaa, 0xbb, 0xcc);
+    auto writer = game::TLVWriter{};
+
+    writer.write("tex1", 1u, 1u, game::TextureFormat::RGB, game::TextureUsage::SRGB, data);
+    writer.write("tex2", 2u, 3u, game::TextureFormat::RGB, game::TextureUsage::DATA, data);
+
+    const auto buffer = writer.yield();
+    const auto archive = game::TLVArchive{buffer};
+
+    ASSERT_FALSE(archive.has_index());
+
+    const auto tex = archive.find("tex1", game::TLVType::TEXTURE_DESCRIPTION);
+    ASSERT_TRUE(tex.has_value());
+    ASSERT_EQ(tex->name(), "tex1");
+}
+
+TEST(tlv_archive, find_missing)
+{
+    const auto data = create_binary_vec(0xaa, 0xbb, 0xcc);
+    auto writer = game::TLVWriter{};
+
+    writer.write("tex1", 1u, 1u, game::TextureFormat::RGB, game::TextureUsage::SRGB, data);
+    writer.write_index();
+
+    const auto buffer = writer.yield();
+    const auto archive = game::TLVArchive{buffer};
+
+    ASSERT_FALSE(archive.find("tex2", game::TLVType::TEXTURE_DESCRIPTION).has_value());
+    ASSERT_FALSE(archive.find("tex1", game::TLVType::MESH_DATA).has_value());
+}
+
+TEST(tlv_writer, write_texture_description_view)
+{
+    const auto data = create_binary_vec(0xaa, 0xbb, 0xcc);
+    auto writer = game::TLVWriter{};
+
+    writer.write("tex", 1u, 1u, game::TextureFormat::RGB, game::TextureUsage::SRGB, data);
+
+    const auto buffer = writer.yield();
+    auto reader = game::TLVReader{buffer};
+    const auto entry = std::ranges::begin(reader);
+    const auto texture_desc = (*entry).texture_description_view();
+
+    // the view should point straight into the written buffer
+    ASSERT_GE(texture_desc.data.data(), buffer.data());
+    ASSERT_LE(texture_desc.data.data() + texture_desc.data.size(), buffer.data() + buffer.size());
+    ASSERT_TRUE(std::ranges::equal(data, texture_desc.data));
+}
+
+TEST(tlv_entry, uint32_array_view_misaligned)
+{
+    const auto bytes = create_binary_vec(0x00, 0xaa, 0xbb, 0xcc, 0xdd);
+    const auto entry = game::TLVEntry{game::TLVType::UINT32_ARRAY, std::span{bytes}.subspan(1u)};
+
+    ASSERT_THROW(entry.uint32_array_view(), game::Exception);
+    ASSERT_EQ(entry.uint32_array_value().size(), 1u);
+}
+
+TEST(tlv_reader, skip_padding)
+{
+    const auto bytes = create_binary_vec(
+        0x0d,
+        0x00,
+        0x00,
+        0x00, // type
+        0x02,
+        0x00,
+        0x00,
+        0x00, // length
+        0x00,
+        0x00, // value
+        0x00,
+        0x00,
+        0x00,
+        0x00, // type
+        0x04,
+        0x00,
+        0x00,
+        0x00, // length
+        0xdd,
+        0xcc,
+        0xbb,
+        0xaa, // value
+        0x0d,
+        0x00,
+        0x00,
+        0x00, // type
+        0x00,
+        0x00,
+        0x00,
+        0x00 // length
+    );
+
+    const auto reader = game::TLVReader(bytes);
+
+    ASSERT_EQ(std::ranges::distance(reader), 1);
+    ASSERT_EQ((*reader.begin()).uint32_value(), 0xaabbccdd);
+}
+
+TEST(tlv_writer, array_values_aligned)
+{
+    const auto data = create_binary_vec(0xaa, 0xbb, 0xcc);
+    const auto vertices = std::vector<game::VertexData>(3u);
+    const auto indices = std::vector<std::uint32_t>{0u, 1u, 2u};
+    auto writer = game::TLVWriter{};
+
+    writer.write_header();
+    writer.write("a");
+    writer.write(data);
+    writer.write(std::uint32_t{1u});
+    writer.write(indices);
+    writer.write("mesh", vertices, indices);
+    writer.write("tex", 1u, 1u, game::TextureFormat::RGB, game::TextureUsage::SRGB, data);
+    writer.write_index();
+
+    const auto buffer = writer.yield();
+    const auto archive = game::TLVArchive{buffer};
+
+    ASSERT_EQ(archive.version(), game::tlv_version);
+    ASSERT_EQ(archive.alignment(), game::tlv_alignment);
+
+    const auto offset = [&](const void *ptr)
+    { return static_cast<const std::byte *>(ptr) - buffer.data(); };
+
+    const auto reader = archive.reader();
+    auto cursor = std::ranges::begin(reader);
+    ASSERT_EQ((*cursor).type(), game::TLVType::HEADER);
+    ASSERT_EQ((*++cursor).string_value(), "a");
+    ASSERT_EQ(offset((*++cursor).byte_array_view().data()) % game::tlv_alignment, 0);
+    ASSERT_EQ((*++cursor).uint32_value(), 1u);
+    ASSERT_EQ(offset((*++cursor).uint32_array_view().data()) % game::tlv_alignment, 0);
+
+    const auto mesh = archive.find("mesh", game::TLVType::MESH_DATA)->mesh_value();
+    ASSERT_EQ(offset(mesh.vertices.data()) % game::tlv_alignment, 0);
+    ASSERT_EQ(offset(mesh.indices.data()) % game::tlv_alignment, 0);
+    ASSERT_TRUE(std::ranges::equal(mesh.indices, indices));
+
+    const auto tex = archive.find("tex", game::TLVType::TEXTURE_DESCRIPTION)->texture_description_view();
+    ASSERT_EQ(offset(tex.data.data()) % game::tlv_alignment, 0);
+    ASSERT_TRUE(std::ranges::equal(tex.data, data));
+}
+
+TEST(tlv_archive, entries)
+{
+    const auto data = create_binary_vec(0xaa, 0xbb, 0xcc);
+    auto writer = game::TLVWriter{};
+
+    writer.write_header();
+    writer.write(std::uint32_t{1u});
+    writer.write("tex", 1u, 1u, game::TextureFormat::RGB, game::TextureUsage::SRGB, data);
+    writer.write_index();
+
+    const auto buffer = writer.yield();
+    const auto archive = game::TLVArchive{buffer};
+
+    // padding is not counted
+    ASSERT_EQ(archive.entry_count(), 5u);
+    ASSERT_EQ(archive.entry(0u).type(), game::TLVType::HEADER);
+    ASSERT_EQ(archive.entry(1u).uint32_value(), 1u);
+    ASSERT_EQ(archive.entry(2u).texture_description_view().data.size(), data.size());
+    ASSERT_EQ(archive.entry(3u).type(), game::TLVType::INDEX);
+    ASSERT_EQ(archive.entry(4u).type(), game::TLVType::INDEX_LOCATION);
+
+    auto count = 0u;
+    for (const auto &entry : archive.reader())
+    {
+        ASSERT_EQ(entry.type(), archive.entry(count++).type());
+    }
+
+    ASSERT_EQ(count, archive.entry_count());
+}
+
+TEST(tlv_archive, invalid_member)
+{
+    const auto data = create_binary_vec(0xaa, 0xbb, 0xcc);
+    auto writer = game::TLVWriter{};
+
+    writer.write("tex", 1u, 1u, game::TextureFormat::RGB, game::TextureUsage::SRGB, data);
+
+    auto buffer = writer.yield();
+    const auto name_offset = (*game::TLVReader{buffer}.begin()).value().data() - buffer.data();
+
+    // the name must be a string
+    const auto type = game::TLVType::UINT32;
+    std::memcpy(buffer.data() + name_offset, &type, sizeof(type));
+
+    ASSERT_THROW(game::TLVArchive{buffer}, game::Exception);
+}
+
+TEST(tlv_archive, invalid_index)
+{
+    const auto data = create_binary_vec(0xaa, 0xbb, 0xcc);
+    auto writer = game::TLVWriter{};
+
+    writer.write("tex", 1u, 1u, game::TextureFormat::RGB, game::TextureUsage::SRGB, data);
+    writer.write_index();
+
+    auto buffer = writer.yield();
+
+    // point every slot at the start of the buffer, which is padding rather than the texture
+    auto index = game::TLVEntry{game::TLVType::INDEX, {}};
+    for (const auto &entry : game::TLVReader{buffer})
+    {
+        if (entry.type() == game::TLVType::INDEX)
+        {
+            index = entry;
+        }
+    }
+
+    const auto slots_offset = index.value().data() - buffer.data() + sizeof(std::uint32_t) * 2u;
+    const auto slot_count = (index.value().size() - sizeof(std::uint32_t) * 2u) / sizeof(game::TLVIndexSlot);
+    for (auto i = 0u; i < slot_count; ++i)
+    {
+        const auto offset = std::uint64_t{};
+        std::memcpy(
+            buffer.data() + slots_offset + i * sizeof(game::TLVIndexSlot) + offsetof(game::TLVIndexSlot, offset),
+            &offset,
+            sizeof(offset));
+    }
+
+    ASSERT_THROW(game::TLVArchive{buffer}, game::Exception);
+}
+
+TEST(tlv_archive, payload_ending_like_index_location)
+{
+    const auto data = create_binary_vec(0xaa, 0xbb, 0xcc);
+
+    // the tail of the array is a well formed index location, pointing at the start of the archive
+    const auto type = game::TLVType::INDEX_LOCATION;
+    const auto length = std::uint32_t{sizeof(std::uint64_t)};
+    const auto offset = std::uint64_t{};
+    auto trailer = std::vector<std::byte>(sizeof(type) + sizeof(length) + sizeof(offset));
+    std::memcpy(trailer.data(), &type, sizeof(type));
+    std::memcpy(trailer.data() + sizeof(type), &length, sizeof(length));
+    std::memcpy(trailer.data() + sizeof(type) + sizeof(length), &offset, sizeof(offset));
+
+    auto writer = game::TLVWriter{};
+    writer.write_header();
+    writer.write("tex", 1u, 1u, game::TextureFormat::RGB, game::TextureUsage::SRGB, data);
+    writer.write(trailer);
+
+    const auto buffer = writer.yield();
+    ASSERT_TRUE(std::ranges::equal(std::span{buffer}.last(trailer.size()), trailer));
+
+    const auto archive = game::TLVArchive{buffer};
+    ASSERT_FALSE(archive.has_index());
+    ASSERT_EQ(archive.entry(archive.entry_count() - 1u).byte_array_value(), trailer);
+    ASSERT_TRUE(archive.find("tex", game::TLVType::TEXTURE_DESCRIPTION).has_value());
+}
+
+TEST(tlv_archive, no_header)
+{
+    auto writer = game::TLVWriter{};
+    writer.write(std::uint32_t{1u});
+
+    const auto buffer = writer.yield();
+    const auto archive = game::TLVArchive{buffer};
+
+    ASSERT_EQ(archive.version(), 1u);
+    ASSERT_EQ(archive.alignment(), 1u);
+}
+
+TEST(tlv_writer, append)
+{
+    const auto data = create_binary_vec(0xaa, 0xbb, 0xcc);
+    const auto vertices = std::vector<game::VertexData>(3u);
+    const auto indices = std::vector<std::uint32_t>{0u, 1u, 2u};
+
+    auto direct = game::TLVWriter{};
+    direct.write_header();
+    direct.write("tex", 1u, 1u, game::TextureFormat::RGB, game::TextureUsage::SRGB, data);
+    direct.write("mesh", vertices, indices);
+    direct.write_index();
+
+    auto blob_writer = game::TLVWriter{};
+    blob_writer.write("a");
+    blob_writer.write("tex", 1u, 1u, game::TextureFormat::RGB, game::TextureUsage::SRGB, data);
+    const auto tex_blob = blob_writer.yield();
+    blob_writer.write("mesh", vertices, indices);
+    const auto mesh_blob = blob_writer.yield();
+
+    auto appended = game::TLVWriter{};
+    appended.write_header();
+    appended.append(std::span{tex_blob}.subspan(9u));
+    appended.append(mesh_blob);
+    appended.write_index();
+
+    // appending re-emits entries so the result does not depend on where the blobs were originally written
+    ASSERT_EQ(direct.yield(), appended.yield());
+}
+
+TEST(tlv_writer, append_metadata)
+{
+    auto writer = game::TLVWriter{};
+    writer.write_header();
+    const auto buffer = writer.yield();
+
+    ASSERT_THROW(writer.append(buffer), game::Exception);
+}
+
+TEST(tlv_writer, file_sink)
+{
+    const auto data = create_binary_vec(0xaa, 0xbb, 0xcc);
+    const auto vertices = std::vector<game::VertexData>(3u);
+    const auto indices = std::vector<std::uint32_t>{0u, 1u, 2u};
+    const auto path = std::filesystem::temp_directory_path() / "tlv_writer_file_sink.tlv";
+
+    const auto write = [&](game::TLVWriter &writer)
+    {
+        writer.write_header();
+        writer.write("a");
+        writer.write("tex", 1u, 1u, game::TextureFormat::RGB, game::TextureUsage::SRGB, data);
+        writer.write("mesh", vertices, indices);
+        writer.write_index();
+    };
+
+    auto memory = game::TLVWriter{};
+    write(memory);
+
+    {
+        auto sink = game::FileTLVSink{path};
+        auto writer = game::TLVWriter{sink};
+        write(writer);
+    }
+
+    auto file = std::ifstream{path, std::ios::binary};
+    const auto contents = std::vector<char>{std::istreambuf_iterator<char>{file}, std::istreambuf_iterator<char>{}};
+    file.close();
+    std::filesystem::remove(path);
+
+    ASSERT_TRUE(std::ranges::equal(std::as_bytes(std::span{contents}), memory.yield()));
+}
+
+TEST(tlv_writer, composite_length_patched)
+{
+    const auto vertices = std::vector<game::VertexData>(3u);
+    const auto indices = std::vector<std::uint32_t>{0u, 1u, 2u};
+
+    auto sink = game::MemoryTLVSink{};
+    auto writer = game::TLVWriter{sink};
+    writer.write_header();
+    writer.write("mesh", vertices, indices);
+    writer.write_index();
+
+    const auto buffer = sink.yield();
+    const auto archive = game::TLVArchive{buffer};
+    const auto mesh = archive.find("mesh", game::TLVType::MESH_DATA);
+
+    ASSERT_TRUE(mesh.has_value());
+    ASSERT_EQ(mesh->name(), "mesh");
+    ASSERT_TRUE(std::ranges::equal(mesh->mesh_value().indices, indices));
+
+    // walking the top level entries only reaches the end if the patched length is correct
+    auto last = game::TLVType{};
+    for (const auto &entry : game::TLVReader{buffer})
+    {
+        last = entry.type();
+    }
+
+    ASSERT_EQ(last, game::TLVType::INDEX_LOCATION);
+}
+
+TEST(tlv_writer, yield_external_sink)
+{
+    auto sink = game::MemoryTLVSink{};
+    auto writer = game::TLVWriter{sink};
+
+    ASSERT_DEATH(writer.yield(), "");
+}
+
+TEST(tlv_writer, write_texture_description_mip_levels)
+{
+    const auto data = create_binary_vec(0x01, 0x02, 0x03, 0x04, 0x05);
+    auto writer = game::TLVWriter{};
+
+    writer.write(
+        "tex",
+        game::TextureDescriptionView{
+            .width = 2u,
+            .height = 2u,
+            .format = game::TextureFormat::RGB,
+            .usage = game::TextureUsage::DATA,
+            .mip_levels = 2u,
+            .data = data});
+
+    const auto buffer = writer.yield();
+    auto reader = game::TLVReader{buffer};
+    const auto texture_desc = (*std::ranges::begin(reader)).texture_description_value();
+
+    ASSERT_EQ(texture_desc.mip_levels, 2u);
+    ASSERT_EQ(texture_desc.data, data);
+}
+
+TEST(tlv_entry, texture_description_without_mip_levels)
+{
+    // textures written before mip levels were added have no mip level member
+    const auto data = create_binary_vec(0xaa, 0xbb, 0xcc);
+    auto writer = game::TLVWriter{};
+
+    writer.write("tex");
+    writer.write(1u);
+    writer.write(1u);
+    writer.write(game::TextureFormat::RGB);
+    writer.write(game::TextureUsage::SRGB);
+    writer.write(data);
+
+    const auto members = writer.yield();
+    const auto entry = game::TLVEntry{game::TLVType::TEXTURE_DESCRIPTION, members};
+    const auto texture_desc = entry.texture_description_view();
+
+    ASSERT_EQ(texture_desc.mip_levels, 1u);
+    ASSERT_TRUE(std::ranges::equal(texture_desc.data, data));
+}
+
+TEST(tlv_archive, find_packed_mesh)
+{
+    const auto vertices = create_binary_vec(0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08);
+    const auto indices = create_binary_vec(0x00, 0x00, 0x01, 0x00, 0x00, 0x00);
+    const auto layout = game::VertexLayout{
+        .stride = 4u,
+        .index_type = game::IndexType::UINT16,
+        .position_offset = {1.0f, 2.0f, 3.0f},
+        .position_scale = {4.0f, 5.0f, 6.0f},
+        .attributes = {{.location = 0u, .components = 2u, .type = game::VertexAttributeType::UNORM16, .offset = 0u}}};
+
+    auto writer = game::TLVWriter{};
+    writer.write_header();
+    writer.write("mesh", game::PackedMeshData{.layout = layout, .vertices = vertices, .indices = indices});
+    writer.write_index();
+
+    const auto buffer = writer.yield();
+    const auto archive = game::TLVArchive{buffer};
+
+    const auto entry = archive.find("mesh", game::TLVType::PACKED_MESH_DATA);
+    ASSERT_TRUE(entry.has_value());
+    ASSERT_TRUE(entry->is_mesh("mesh"));
+
+    const auto mesh = entry->packed_mesh_value();
+    ASSERT_EQ(mesh.layout.stride, layout.stride);
+    ASSERT_EQ(mesh.layout.index_type, layout.index_type);
+    ASSERT_EQ(mesh.layout.position_offset, layout.position_offset);
+    ASSERT_EQ(mesh.layout.position_scale, layout.position_scale);
+    ASSERT_EQ(mesh.layout.attributes.size(), 1u);
+    ASSERT_EQ(mesh.layout.attributes[0].type, game::VertexAttributeType::UNORM16);
+    ASSERT_TRUE(std::ranges::equal(mesh.vertices, vertices));
+    ASSERT_TRUE(std::ranges::equal(mesh.indices, indices));
+}
+
+TEST(tlv_entry, vertex_layout_attribute_outside_stride)
+{
+    auto writer = game::TLVWriter{};
+    writer.write(game::VertexLayout{
+        .stride = 4u,
+        .index_type = game::IndexType::UINT32,
+        .position_offset = {0.0f},
+        .position_scale = {1.0f},
+        .attributes = {{.location = 0u, .components = 3u, .type = game::VertexAttributeType::FLOAT, .offset = 0u}}});
+
+    const auto buffer = writer.yield();
+    auto reader = game::TLVReader{buffer};
+
+    ASSERT_THROW((*std::ranges::begin(reader)).vertex_layout_value(), game::Exception);
+}
+
+TEST(tlv_archive, deduplicated_payloads)
+{
+    const auto data = std::vector<std::byte>(256u, std::byte{0xaa});
+    const auto vertices = std::vector<game::VertexData>(8u);
+    const auto indices = std::vector<std::uint32_t>{0u, 1u, 2u};
+
+    auto writer = game::TLVWriter{};
+    writer.set_deduplication(true);
+    writer.write_header();
+    writer.write("a", 8u, 8u, game::TextureFormat::RGBA, game::TextureUsage::DATA, data);
+    writer.write("b", 8u, 8u, game::TextureFormat::RGBA, game::TextureUsage::DATA, data);
+    writer.write("mesh", vertices, indices);
+    writer.write_index();
+
+    ASSERT_EQ(writer.deduplicated_bytes(), data.size());
+
+    const auto buffer = writer.yield();
+    const auto archive = game::TLVArchive{buffer};
+
+    const auto a = archive.find("a", game::TLVType::TEXTURE_DESCRIPTION)->texture_description_view();
+    const auto b = archive.find("b", game::TLVType::TEXTURE_DESCRIPTION)->texture_description_view();
+    ASSERT_TRUE(std::ranges::equal(a.data, data));
+    ASSERT_EQ(a.data.data(), b.data.data());
+
+    // the indices are too small to be worth sharing so are written in place
+    const auto mesh = archive.find("mesh", game::TLVType::MESH_DATA)->mesh_value();
+    ASSERT_EQ(mesh.vertices.size(), vertices.size());
+    ASSERT_TRUE(std::ranges::equal(mesh.indices, indices));
+
+    const auto blob_count = std::ranges::count_if(
+        std::views::iota(0u, archive.entry_count()),
+        [&](auto index) { return archive.entry(index).type() == game::TLVType::BLOB; });
+    ASSERT_EQ(blob_count, 2);
+}
+
+TEST(tlv_writer, file_sink_keeps_no_payloads)
+{
+    // distinct payloads, each large enough to be a blob, and a duplicate of the first
+    auto payloads = std::vector<std::vector<std::byte>>{};
+    for (auto i = 0u; i < 8u; ++i)
+    {
+        auto &payload = payloads.emplace_back(create_noise_vec(64u * 64u * 4u));
+        payload.front() = std::byte(i);
+    }
+    payloads.push_back(payloads.front());
+
+    const auto names = std::views::iota(0u, payloads.size()) |
+                       std::views::transform([](auto i) { return std::string(1u, static_cast<char>('a' + i)); }) |
+                       std::ranges::to<std::vector>();
+    const auto path = std::filesystem::temp_directory_path() / "tlv_writer_file_sink_keeps_no_payloads.tlv";
+
+    {
+        auto sink = game::FileTLVSink{path};
+        auto writer = game::TLVWriter{sink};
+        writer.set_deduplication(true);
+        writer.write_header();
+
+        allocated_bytes = 0u;
+        counting_allocations = true;
+        for (const auto &[name, payload] : std::views::zip(names, payloads))
+        {
+            writer.write(name, 64u, 64u, game::TextureFormat::RGBA, game::TextureUsage::DATA, payload);
+        }
+        counting_allocations = false;
+
+        writer.write_index();
+
+        // the duplicate is found by reading the blob back rather than from a copy of it
+        ASSERT_EQ(writer.deduplicated_bytes(), payloads.front().size());
+        ASSERT_LT(allocated_bytes, payloads.front().size());
+    }
+
+    auto file = std::ifstream{path, std::ios::binary};
+    const auto contents = std::vector<char>{std::istreambuf_iterator<char>{file}, std::istreambuf_iterator<char>{}};
+    file.close();
+    std::filesystem::remove(path);
+
+    const auto buffer = std::as_bytes(std::span{contents}) | std::ranges::to<std::vector>();
+    const auto archive = game::TLVArchive{buffer};
+
+    for (const auto &[name, payload] : std::views::zip(names, payloads))
+    {
+        const auto texture = archive.find(name, game::TLVType::TEXTURE_DESCRIPTION)->texture_description_view();
+        ASSERT_TRUE(std::ranges::equal(texture.data, payload));
+    }
+}
+
+TEST(tlv_writer, append_deduplicated)
+{
+    const auto data = std::vector<std::byte>(256u, std::byte{0xaa});
+
+    auto direct = game::TLVWriter{};
+    direct.set_deduplication(true);
+    direct.write_header();
+    direct.write("a", 8u, 8u, game::TextureFormat::RGBA, game::TextureUsage::DATA, data);
+    direct.write("b", 8u, 8u, game::TextureFormat::RGBA, game::TextureUsage::DATA, data);
+    direct.write_index();
+
+    // blobs are cooked independently, so are only deduplicated when merged
+    auto blob_writer = game::TLVWriter{};
+    blob_writer.write("a", 8u, 8u, game::TextureFormat::RGBA, game::TextureUsage::DATA, data);
+    const auto a_blob = blob_writer.yield();
+    blob_writer.write("b", 8u, 8u, game::TextureFormat::RGBA, game::TextureUsage::DATA, data);
+    const auto b_blob = blob_writer.yield();
+
+    auto appended = game::TLVWriter{};
+    appended.set_deduplication(true);
+    appended.write_header();
+    appended.append(a_blob);
+    appended.append(b_blob);
+    appended.write_index();
+
+    ASSERT_EQ(direct.yield(), appended.yield());
+}
+
+TEST(tlv_archive, invalid_blob_reference)
+{
+    const auto data = std::vector<std::byte>(256u, std::byte{0xaa});
+
+    auto writer = game::TLVWriter{};
+    writer.set_deduplication(true);
+    writer.write_header();
+    writer.write("tex", 8u, 8u, game::TextureFormat::RGBA, game::TextureUsage::DATA, data);
+    writer.write_index();
+
+    auto buffer = writer.yield();
+
+    // point the reference at the header rather than the blob
+    const auto type = game::TLVType::BLOB_REFERENCE;
+    const auto reference = std::ranges::search(buffer, std::as_bytes(std::span{&type, 1u}));
+    ASSERT_FALSE(reference.empty());
+
+    const auto offset = std::uint64_t{};
+    std::memcpy(
+        std::ranges::data(reference) + sizeof(std::uint32_t) * 2u + offsetof(game::TLVBlobReference, offset),
+        &offset,
+        sizeof(offset));
+
+    ASSERT_THROW(game::TLVArchive{buffer}, game::Exception);
+}
+
+TEST(tlv_archive, compressed_payloads)
+{
+    const auto pattern = create_patterned_vec(64u * 64u * 4u);
+    const auto noise = create_noise_vec(64u * 64u * 4u);
+
+    auto writer = game::TLVWriter{};
+    writer.set_compression(0.1f);
+    writer.write_header();
+    writer.write("pattern", 64u, 64u, game::TextureFormat::RGBA, game::TextureUsage::DATA, pattern);
+    writer.write("noise", 64u, 64u, game::TextureFormat::RGBA, game::TextureUsage::DATA, noise);
+    writer.write_index();
+
+    ASSERT_GT(writer.compressed_bytes(), 0u);
+
+    const auto buffer = writer.yield();
+    const auto archive = game::TLVArchive{buffer};
+
+    const auto compressed = archive.find("pattern", game::TLVType::TEXTURE_DESCRIPTION);
+    ASSERT_TRUE(compressed->is_compressed());
+    ASSERT_THROW(compressed->texture_description_view(), game::Exception);
+    ASSERT_EQ(compressed->texture_description_value().data, pattern);
+
+    auto staging = game::TLVStagingBuffer{*compressed};
+    staging.decompress();
+    const auto staged = staging.entry().texture_description_view();
+    ASSERT_EQ(staged.width, 64u);
+    ASSERT_TRUE(std::ranges::equal(staged.data, pattern));
+
+    // incompressible data is left as it is, and can still be viewed in place
+    const auto uncompressed = archive.find("noise", game::TLVType::TEXTURE_DESCRIPTION);
+    ASSERT_FALSE(uncompressed->is_compressed());
+
+    const auto view = uncompressed->texture_description_view();
+    ASSERT_TRUE(std::ranges::equal(view.data, noise));
+    ASSERT_GE(view.data.data(), buffer.data());
+    ASSERT_LT(view.data.data(), buffer.data() + buffer.size());
+}
+
+TEST(tlv_archive, compressed_mesh)
+{
+    const auto vertices = std::vector<game::VertexData>(1000u);
+    const auto indices = std::views::iota(0u, 3000u) | std::ranges::to<std::vector>();
+
+    auto writer = game::TLVWriter{};
+    writer.set_compression(0.1f);
+    writer.write_header();
+    writer.write("mesh", vertices, indices);
+    writer.write_index();
+
+    const auto buffer = writer.yield();
+    const auto archive = game::TLVArchive{buffer};
+
+    const auto entry = archive.find("mesh", game::TLVType::MESH_DATA);
+    ASSERT_TRUE(entry->is_compressed());
+    ASSERT_THROW(entry->mesh_value(), game::Exception);
+
+    auto staging = game::TLVStagingBuffer{*entry};
+    staging.decompress();
+
+    const auto mesh = staging.entry().mesh_value();
+    ASSERT_EQ(mesh.vertices.size(), vertices.size());
+    ASSERT_TRUE(std::ranges::equal(mesh.indices, indices));
+}
+
+TEST(tlv_archive, compressed_and_deduplicated)
+{
+    const auto data = create_patterned_vec(64u * 64u * 4u);
+
+    auto writer = game::TLVWriter{};
+    writer.set_compression(0.1f);
+    writer.set_deduplication(true);
+    writer.write_header();
+    writer.write("a", 64u, 64u, game::TextureFormat::RGBA, game::TextureUsage::DATA, data);
+    writer.write("b", 64u, 64u, game::TextureFormat::RGBA, game::TextureUsage::DATA, data);
+    writer.write_index();
+
+    const auto buffer = writer.yield();
+    const auto archive = game::TLVArchive{buffer};
+
+    // the blob holds the compressed payload, so the duplicate only saves the compressed size
+    ASSERT_EQ(writer.deduplicated_bytes() + writer.compressed_bytes(), data.size());
+
+    for (const auto *name : {"a", "b"})
+    {
+        const auto entry = archive.find(name, game::TLVType::TEXTURE_DESCRIPTION);
+        ASSERT_TRUE(entry->is_compressed());
+        ASSERT_EQ(entry->texture_description_value().data, data);
+    }
+}
+
+TEST(tlv_writer, append_compressed)
+{
+    const auto data = create_patterned_vec(64u * 64u * 4u);
+
+    auto blob_writer = game::TLVWriter{};
+    blob_writer.set_compression(0.1f);
+    blob_writer.write("a", 64u, 64u, game::TextureFormat::RGBA, game::TextureUsage::DATA, data);
+    const auto a_blob = blob_writer.yield();
+    blob_writer.write("b", 64u, 64u, game::TextureFormat::RGBA, game::TextureUsage::DATA, data);
+    const auto b_blob = blob_writer.yield();
+
+    // compressed payloads are appended as they are, and still shared
+    auto appended = game::TLVWriter{};
+    appended.set_deduplication(true);
+    appended.write_header();
+    appended.append(a_blob);
+    appended.append(b_blob);
+    appended.write_index();
+
+    ASSERT_GT(appended.deduplicated_bytes(), 0u);
+
+    const auto buffer = appended.yield();
+    const auto archive = game::TLVArchive{buffer};
+
+    ASSERT_EQ(archive.find("b", game::TLVType::TEXTURE_DESCRIPTION)->texture_description_value().data, data);
+}
+
+TEST(tlv_staging_buffer, chunks)
+{
+    // not a multiple of the chunk size, so the last chunk is partial
+    const auto data = create_patterned_vec(game::tlv_compression_chunk_size * 3u + 100u);
+
+    auto writer = game::TLVWriter{};
+    writer.set_compression(0.1f);
+    writer.write("tex", 100u, 100u, game::TextureFormat::RGBA, game::TextureUsage::DATA, data);
+    const auto buffer = writer.yield();
+
+    const auto reader = game::TLVReader{buffer};
+    auto staging = game::TLVStagingBuffer{*std::ranges::begin(reader)};
+    ASSERT_EQ(staging.chunk_count(), 4u);
+
+    // chunks are independent so can be decompressed in any order
+    for (auto index = staging.chunk_count(); index > 0u; --index)
+    {
+        staging.decompress_chunk(index - 1u);
+    }
+
+    // moving the buffer does not move the copy
+    const auto moved = std::move(staging);
+    ASSERT_TRUE(std::ranges::equal(moved.entry().texture_description_view().data, data));
+}
+
+TEST(tlv_compressed_value, invalid)
+{
+    const auto data = create_patterned_vec(1024u);
+    auto value = *game::tlv_compress(game::TLVType::BYTE_ARRAY, data, 0.1f);
+
+    ASSERT_NO_THROW(game::TLVCompressedValue{value});
+    ASSERT_THROW(game::TLVCompressedValue{std::span{value}.first(8u)}, game::Exception);
+
+    // chunk end past the end of the value
+    auto bad_table = value;
+    const auto end = std::uint32_t{0xffffffffu};
+    std::memcpy(bad_table.data() + sizeof(game::TLVCompressedHeader), &end, sizeof(end));
+    ASSERT_THROW(game::TLVCompressedValue{bad_table}, game::Exception);
+
+    // the chunk itself is only checked when decompressed, a zero token followed by a zero offset is never valid
+    std::ranges::fill(std::span{value}.subspan(sizeof(game::TLVCompressedHeader) + sizeof(std::uint32_t)), std::byte{});
+    const auto compressed = game::TLVCompressedValue{value};
+    auto destination = std::vector<std::byte>(compressed.size());
+    ASSERT_THROW(compressed.decompress(destination), game::Exception);
+}
+
+TEST(tlv_compressed_value, below_threshold)
+{
+    const auto noise = create_noise_vec(1024u);
+    ASSERT_FALSE(game::tlv_compress(game::TLVType::BYTE_ARRAY, noise, 0.1f).has_value());
+
+    const auto pattern = create_patterned_vec(1024u);
+    ASSERT_FALSE(game::tlv_compress(game::TLVType::BYTE_ARRAY, pattern, 0.99f).has_value());
+}
@@ -1,5 +1,6 @@
 #include <cmath>
 #include <format>
+#include <limits>
 
 #include <gtest/gtest.h>
 
@@ -71,6 +72,38 @@ TEST(vector3, dot)
     ASSERT_EQ(game::Vector3::dot(v1, v2), 32.0f);
 }
 
+TEST(vector3, cross_matches_constant_evaluation)
+{
+    constexpr auto v1 = game::Vector3{1.1f, -2.3f, 3.7f};
+    constexpr auto v2 = game::Vector3{-0.3f, 9.1f, 0.2f};
+
+    // evaluated with the scalar code at compile time and the simd code at runtime, which must agree exactly
+    constexpr auto expected = game::Vector3::cross(v1, v2);
+    const auto result = game::Vector3::cross(v1, v2);
+
+    ASSERT_EQ(result, expected);
+}
+
+TEST(vector3, dot_matches_constant_evaluation)
+{
+    constexpr auto v1 = game::Vector3{1.1f, -2.3f, 3.7f};
+    constexpr auto v2 = game::Vector3{-0.3f, 9.1f, 0.2f};
+
+    constexpr auto expected = game::Vector3::dot(v1, v2);
+    const auto result = game::Vector3::dot(v1, v2);
+
+    ASSERT_EQ(result, expected);
+}
+
+TEST(vector3, length)
+{
+    const auto v = game::Vector3{1.1f, -2.3f, 3.7f};
+    const auto expected = std::hypot(v.x, v.y, v.z);
+
+    // no longer computed with std::hypot, so may differ by a rounding
+    ASSERT_NEAR(v.length(), expected, expected * std::numeric_limits<float>::epsilon());
+}
+
 TEST(vector3, distance)
 {
     const auto v1 = game::Vector3{1.0f, 2.0f, 3.0f};
@@ -0,0 +1,150 @@
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <numbers>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "graphics/vertex_data.h"
+#include "graphics/vertex_layout.h"
+#include "maths/vector3.h"
+#include "vertex_packer.h"
+
+namespace
+{
+
+/**
+ * Create a grid of vertices with varied normals and tangents, the bounds are deliberately non-uniform.
+ */
+auto create_vertices(std::uint32_t count) -> std::vector<game::VertexData>
+{
+    auto vertices = std::vector<game::VertexData>{};
+
+    for (auto i = 0u; i < count; ++i)
+    {
+        const auto a = static_cast<float>(i) * 0.37f;
+        const auto b = static_cast<float>(i) * 0.11f;
+
+        vertices.push_back({
+            .position = {std::sin(a) * 10.0f, std::cos(b) * 0.5f, static_cast<float>(i % 7u) - 20.0f},
+            .normal = game::Vector3::normalise({std::sin(a), std::cos(a), std::sin(b) - 0.5f}),
+            .tangent = game::Vector3::normalise({std::cos(b), -0.3f, std::sin(a)}),
+            .uv = {static_cast<float>(i % 5u) * 0.25f, std::fmod(b, 1.0f)},
+        });
+    }
+
+    return vertices;
+}
+
+}
+
+TEST(vertex_packer, half_round_trip)
+{
+    for (const auto value : {0.0f, 1.0f, -2.5f, 0.1f, 65504.0f, 6.1035156e-05f, 5.9604645e-08f})
+    {
+        const auto converted = game::from_half(game::to_half(value));
+        ASSERT_NEAR(converted, value, std::abs(value) * 0.001f);
+    }
+
+    ASSERT_EQ(game::to_half(1.0f), 0x3c00u);
+    ASSERT_EQ(game::to_half(-2.0f), 0xc000u);
+    ASSERT_EQ(game::to_half(1e6f), 0x7c00u);
+    ASSERT_TRUE(std::isnan(game::from_half(game::to_half(std::numeric_limits<float>::quiet_NaN()))));
+}
+
+TEST(vertex_packer, half_rounds_to_nearest_even)
+{
+    // 1 + 2^-11 is exactly halfway between 1 and the next half, so rounds down to the even mantissa
+    ASSERT_EQ(game::to_half(1.0f + std::ldexp(1.0f, -11)), 0x3c00u);
+    ASSERT_EQ(game::to_half(1.0f + 3.0f * std::ldexp(1.0f, -11)), 0x3c02u);
+}
+
+TEST(vertex_packer, octahedral_round_trip)
+{
+    for (auto i = 0u; i < 64u; ++i)
+    {
+        const auto theta = static_cast<float>(i) * std::numbers::pi_v<float> / 63.0f;
+        const auto phi = static_cast<float>(i) * 2.39996f;
+        const auto value =
+            game::Vector3{std::sin(theta) * std::cos(phi), std::sin(theta) * std::sin(phi), std::cos(theta)};
+
+        const auto decoded = game::octahedral_decode(game::octahedral_encode(value));
+
+        ASSERT_GT(game::Vector3::dot(decoded, value), 0.99999f);
+    }
+}
+
+TEST(vertex_packer, pack_unpack)
+{
+    const auto vertices = create_vertices(100u);
+    auto indices = std::vector<std::uint32_t>{};
+    for (auto i = 0u; i + 2u < vertices.size(); ++i)
+    {
+        indices.insert(indices.end(), {i, i + 1u, i + 2u});
+    }
+
+    const auto packed = game::pack_mesh(vertices, indices);
+    ASSERT_EQ(packed.layout.stride, 20u);
+    ASSERT_EQ(packed.vertices.size(), vertices.size() * 20u);
+
+    const auto unpacked = game::unpack_mesh(packed.view());
+    ASSERT_EQ(unpacked.indices, indices);
+    ASSERT_EQ(unpacked.vertices.size(), vertices.size());
+
+    for (auto i = 0u; i < vertices.size(); ++i)
+    {
+        const auto &expected = vertices[i];
+        const auto &actual = unpacked.vertices[i];
+
+        // unorm16 positions are accurate to 1/65535 of the extent on each axis
+        ASSERT_NEAR(actual.position.x, expected.position.x, 20.0f / 65535.0f);
+        ASSERT_NEAR(actual.position.y, expected.position.y, 1.0f / 65535.0f);
+        ASSERT_NEAR(actual.position.z, expected.position.z, 6.0f / 65535.0f);
+        ASSERT_GT(game::Vector3::dot(actual.normal, expected.normal), 0.9999f);
+        ASSERT_GT(game::Vector3::dot(actual.tangent, expected.tangent), 0.9999f);
+        ASSERT_NEAR(actual.uv.x, expected.uv.x, 0.001f);
+        ASSERT_NEAR(actual.uv.y, expected.uv.y, 0.001f);
+    }
+}
+
+TEST(vertex_packer, small_mesh_uses_16_bit_indices)
+{
+    const auto vertices = create_vertices(3u);
+    const auto indices = std::vector<std::uint32_t>{0u, 1u, 2u};
+
+    const auto packed = game::pack_mesh(vertices, indices);
+
+    ASSERT_EQ(packed.layout.index_type, game::IndexType::UINT16);
+    ASSERT_EQ(packed.indices.size(), indices.size() * 2u);
+}
+
+TEST(vertex_packer, large_mesh_uses_32_bit_indices)
+{
+    const auto vertices = create_vertices(70000u);
+    const auto indices = std::vector<std::uint32_t>{0u, 1u, 69999u};
+
+    const auto packed = game::pack_mesh(vertices, indices);
+    ASSERT_EQ(packed.layout.index_type, game::IndexType::UINT32);
+    ASSERT_EQ(packed.indices.size(), indices.size() * 4u);
+
+    ASSERT_EQ(game::unpack_mesh(packed.view()).indices, indices);
+}
+
+TEST(vertex_packer, flat_mesh)
+{
+    auto vertices = create_vertices(10u);
+    for (auto &vertex : vertices)
+    {
+        vertex.position.y = 3.0f;
+    }
+
+    const auto packed = game::pack_mesh(vertices, std::vector<std::uint32_t>{0u, 1u, 2u});
+    const auto unpacked = game::unpack_mesh(packed.view());
+
+    for (const auto &vertex : unpacked.vertices)
+    {
+        ASSERT_EQ(vertex.position.y, 3.0f);
+    }
+}
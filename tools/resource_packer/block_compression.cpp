@@ -0,0 +1,1096 @@
+#include "block_compression.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <execution>
+#include <limits>
+#include <numeric>
+#include <optional>
+#include <ranges>
+#include <span>
+#include <string>
+#include <utility>
+#include <vector>
+
+#if defined(_M_X64) || defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#include "graphics/texture.h"
+#include "utils/error.h"
+#include "utils/exception.h"
+#include "utils/formatter.h"
+
+namespace
+{
+
+/** An RGBA8 texel. */
+using Pixel = std::array<std::uint8_t, 4u>;
+
+/** A 4x4 block of texels, in row major order. */
+using Block = std::array<Pixel, 16u>;
+
+/** A point in N dimensional colour space, used for endpoint fitting. */
+template <std::size_t N>
+using Point = std::array<float, N>;
+
+/** A pair of endpoints, the line between them approximates a block. */
+template <std::size_t N>
+using Endpoints = std::pair<Point<N>, Point<N>>;
+
+/** BC7 interpolation weights for 4 bit indices. */
+constexpr auto bc7_weights =
+    std::array<std::uint32_t, 16u>{0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64};
+
+/** Number of least squares refinement passes for HIGH quality. */
+constexpr auto refinement_passes = 3u;
+
+/**
+ * Writes bits least significant first into a 128 bit block.
+ */
+class BitWriter
+{
+  public:
+    auto write(std::uint32_t value, std::uint32_t count) -> void
+    {
+        for (auto i = 0u; i < count; ++i, ++position_)
+        {
+            if ((value >> i) & 1u)
+            {
+                bytes_[position_ / 8u] |= static_cast<std::uint8_t>(1u << (position_ % 8u));
+            }
+        }
+    }
+
+    auto bytes() const -> const std::array<std::uint8_t, 16u> &
+    {
+        return bytes_;
+    }
+
+  private:
+    std::array<std::uint8_t, 16u> bytes_ = {};
+    std::uint32_t position_ = 0u;
+};
+
+/**
+ * Reads bits least significant first from a 128 bit block.
+ */
+class BitReader
+{
+  public:
+    BitReader(std::span<const std::byte> bytes)
+        : bytes_(bytes)
+    {
+    }
+
+    auto read(std::uint32_t count) -> std::uint32_t
+    {
+        auto value = 0u;
+        for (auto i = 0u; i < count; ++i, ++position_)
+        {
+            value |= ((std::to_integer<std::uint32_t>(bytes_[position_ / 8u]) >> (position_ % 8u)) & 1u) << i;
+        }
+
+        return value;
+    }
+
+  private:
+    std::span<const std::byte> bytes_;
+    std::uint32_t position_ = 0u;
+};
+
+/**
+ * Project the channels of a block into points for fitting.
+ *
+ * @param block
+ *   The block.
+ * @param first
+ *   Index of the first channel to use.
+ *
+ * @returns
+ *   The N channels starting at first of each texel.
+ */
+template <std::size_t N>
+auto to_points(const Block &block, std::size_t first) -> std::array<Point<N>, 16u>
+{
+    auto points = std::array<Point<N>, 16u>{};
+
+    for (auto i = 0u; i < 16u; ++i)
+    {
+        for (auto c = 0u; c < N; ++c)
+        {
+            points[i][c] = static_cast<float>(block[i][first + c]);
+        }
+    }
+
+    return points;
+}
+
+/**
+ * Fit endpoints to points along their principal axis, found with power iteration on the covariance matrix.
+ *
+ * @param points
+ *   The points to fit.
+ *
+ * @returns
+ *   Endpoints spanning the extent of the points along the principal axis.
+ */
+template <std::size_t N>
+auto fit_principal_axis(const std::array<Point<N>, 16u> &points) -> Endpoints<N>
+{
+    auto mean = Point<N>{};
+    auto min = points[0];
+    auto max = points[0];
+
+    for (const auto &p : points)
+    {
+        for (auto c = 0u; c < N; ++c)
+        {
+            mean[c] += p[c] / 16.0f;
+            min[c] = std::min(min[c], p[c]);
+            max[c] = std::max(max[c], p[c]);
+        }
+    }
+
+    auto covariance = std::array<Point<N>, N>{};
+    for (const auto &p : points)
+    {
+        for (auto i = 0u; i < N; ++i)
+        {
+            for (auto j = 0u; j < N; ++j)
+            {
+                covariance[i][j] += (p[i] - mean[i]) * (p[j] - mean[j]);
+            }
+        }
+    }
+
+    // the bounding box diagonal is a good starting guess and converges quickly
+    auto axis = Point<N>{};
+    for (auto c = 0u; c < N; ++c)
+    {
+        axis[c] = max[c] - min[c];
+    }
+
+    for (auto iteration = 0u; iteration < 8u; ++iteration)
+    {
+        auto next = Point<N>{};
+        for (auto i = 0u; i < N; ++i)
+        {
+            for (auto j = 0u; j < N; ++j)
+            {
+                next[i] += covariance[i][j] * axis[j];
+            }
+        }
+
+        const auto largest = std::ranges::max(next | std::views::transform([](auto v) { return std::abs(v); }));
+        if (largest == 0.0f)
+        {
+            break;
+        }
+
+        for (auto c = 0u; c < N; ++c)
+        {
+            axis[c] = next[c] / largest;
+        }
+    }
+
+    const auto length_squared = std::inner_product(axis.begin(), axis.end(), axis.begin(), 0.0f);
+    if (length_squared == 0.0f)
+    {
+        return {mean, mean};
+    }
+
+    auto t_min = std::numeric_limits<float>::max();
+    auto t_max = std::numeric_limits<float>::lowest();
+    for (const auto &p : points)
+    {
+        auto t = 0.0f;
+        for (auto c = 0u; c < N; ++c)
+        {
+            t += (p[c] - mean[c]) * axis[c];
+        }
+
+        t_min = std::min(t_min, t);
+        t_max = std::max(t_max, t);
+    }
+
+    auto endpoints = Endpoints<N>{};
+    for (auto c = 0u; c < N; ++c)
+    {
+        endpoints.first[c] = mean[c] + axis[c] * t_min / length_squared;
+        endpoints.second[c] = mean[c] + axis[c] * t_max / length_squared;
+    }
+
+    return endpoints;
+}
+
+/**
+ * Solve for the endpoints which minimise the squared error for a fixed assignment of texels to palette entries.
+ *
+ * @param points
+ *   The points being fitted.
+ * @param weights
+ *   For each point, the interpolation weight towards the second endpoint of its palette entry.
+ *
+ * @returns
+ *   The refined endpoints, or an empty optional if the system is degenerate (e.g. all weights the same).
+ */
+template <std::size_t N>
+auto refine_endpoints(const std::array<Point<N>, 16u> &points, const std::array<float, 16u> &weights)
+    -> std::optional<Endpoints<N>>
+{
+    auto aa = 0.0f;
+    auto ab = 0.0f;
+    auto bb = 0.0f;
+    auto ax = Point<N>{};
+    auto bx = Point<N>{};
+
+    for (auto i = 0u; i < 16u; ++i)
+    {
+        const auto b = weights[i];
+        const auto a = 1.0f - b;
+
+        aa += a * a;
+        ab += a * b;
+        bb += b * b;
+
+        for (auto c = 0u; c < N; ++c)
+        {
+            ax[c] += a * points[i][c];
+            bx[c] += b * points[i][c];
+        }
+    }
+
+    const auto determinant = aa * bb - ab * ab;
+    if (std::abs(determinant) < 1e-6f)
+    {
+        return std::nullopt;
+    }
+
+    auto endpoints = Endpoints<N>{};
+    for (auto c = 0u; c < N; ++c)
+    {
+        endpoints.first[c] = std::clamp((bb * ax[c] - ab * bx[c]) / determinant, 0.0f, 255.0f);
+        endpoints.second[c] = std::clamp((aa * bx[c] - ab * ax[c]) / determinant, 0.0f, 255.0f);
+    }
+
+    return endpoints;
+}
+
+/**
+ * Find the nearest palette entry for each texel, comparing the first N channels.
+ *
+ * @param block
+ *   The block.
+ * @param palette
+ *   The palette.
+ * @param indices
+ *   Out parameter for the selected index of each texel.
+ *
+ * @returns
+ *   The total squared error.
+ */
+template <std::size_t N>
+auto select_indices(const Block &block, std::span<const Pixel> palette, std::array<std::uint8_t, 16u> &indices)
+    -> std::uint32_t
+{
+    auto error = 0u;
+
+    for (auto i = 0u; i < 16u; ++i)
+    {
+        auto best = std::numeric_limits<std::uint32_t>::max();
+
+        for (auto j = 0u; j < palette.size(); ++j)
+        {
+            auto distance = 0u;
+            for (auto c = 0u; c < N; ++c)
+            {
+                const auto d = static_cast<int>(block[i][c]) - static_cast<int>(palette[j][c]);
+                distance += static_cast<std::uint32_t>(d * d);
+            }
+
+            if (distance < best)
+            {
+                best = distance;
+                indices[i] = static_cast<std::uint8_t>(j);
+            }
+        }
+
+        error += best;
+    }
+
+    return error;
+}
+
+/**
+ * Find the nearest entry of a 16 entry RGBA palette for each texel. This is the inner loop of BC7 so has an SSE2 path.
+ *
+ * @param block
+ *   The block.
+ * @param palette
+ *   The palette.
+ * @param indices
+ *   Out parameter for the selected index of each texel.
+ *
+ * @returns
+ *   The total squared error.
+ */
+auto select_indices_rgba16(
+    const Block &block,
+    const std::array<Pixel, 16u> &palette,
+    std::array<std::uint8_t, 16u> &indices) -> std::uint32_t
+{
+#if defined(_M_X64) || defined(__SSE2__)
+    // two palette entries per register as 16 bit lanes, the squared differences then sum with a single madd
+    __m128i entries[8u];
+    for (auto i = 0u; i < std::size(entries); ++i)
+    {
+        const auto &a = palette[i * 2u];
+        const auto &b = palette[i * 2u + 1u];
+        entries[i] = _mm_setr_epi16(a[0], a[1], a[2], a[3], b[0], b[1], b[2], b[3]);
+    }
+
+    auto error = 0u;
+
+    for (auto i = 0u; i < 16u; ++i)
+    {
+        const auto &p = block[i];
+        const auto texel = _mm_setr_epi16(p[0], p[1], p[2], p[3], p[0], p[1], p[2], p[3]);
+
+        auto best = std::numeric_limits<std::uint32_t>::max();
+
+        for (auto j = 0u; j < std::size(entries); ++j)
+        {
+            const auto difference = _mm_sub_epi16(entries[j], texel);
+            const auto squared = _mm_madd_epi16(difference, difference);
+            const auto sum = _mm_add_epi32(squared, _mm_shuffle_epi32(squared, _MM_SHUFFLE(2, 3, 0, 1)));
+
+            const auto first = static_cast<std::uint32_t>(_mm_cvtsi128_si32(sum));
+            const auto second = static_cast<std::uint32_t>(_mm_cvtsi128_si32(_mm_srli_si128(sum, 8)));
+
+            if (first < best)
+            {
+                best = first;
+                indices[i] = static_cast<std::uint8_t>(j * 2u);
+            }
+
+            if (second < best)
+            {
+                best = second;
+                indices[i] = static_cast<std::uint8_t>(j * 2u + 1u);
+            }
+        }
+
+        error += best;
+    }
+
+    return error;
+#else
+    return select_indices<4u>(block, palette, indices);
+#endif
+}
+
+/**
+ * Quantise a colour to RGB565.
+ */
+auto to_565(const Point<3u> &colour) -> std::uint16_t
+{
+    const auto quantise = [](float value, float max)
+    { return static_cast<std::uint32_t>(std::lround(std::clamp(value, 0.0f, 255.0f) * max / 255.0f)); };
+
+    return static_cast<std::uint16_t>(
+        (quantise(colour[0], 31.0f) << 11u) | (quantise(colour[1], 63.0f) << 5u) | quantise(colour[2], 31.0f));
+}
+
+/**
+ * Expand an RGB565 colour to RGBA8.
+ */
+auto from_565(std::uint16_t colour) -> Pixel
+{
+    const auto r = static_cast<std::uint32_t>((colour >> 11u) & 0x1fu);
+    const auto g = static_cast<std::uint32_t>((colour >> 5u) & 0x3fu);
+    const auto b = static_cast<std::uint32_t>(colour & 0x1fu);
+
+    return {
+        static_cast<std::uint8_t>((r << 3u) | (r >> 2u)),
+        static_cast<std::uint8_t>((g << 2u) | (g >> 4u)),
+        static_cast<std::uint8_t>((b << 3u) | (b >> 2u)),
+        0xffu};
+}
+
+/**
+ * Build the BC1 palette for a pair of endpoints.
+ *
+ * @param c0
+ *   First endpoint.
+ * @param c1
+ *   Second endpoint.
+ * @param four_colour
+ *   True to always use four colour mode (as BC3 does), otherwise the mode depends on the endpoint order.
+ *
+ * @returns
+ *   The palette, in three colour mode the last entry is transparent black.
+ */
+auto bc1_palette(std::uint16_t c0, std::uint16_t c1, bool four_colour) -> std::array<Pixel, 4u>
+{
+    const auto a = from_565(c0);
+    const auto b = from_565(c1);
+    auto palette = std::array<Pixel, 4u>{a, b, Pixel{}, Pixel{}};
+
+    for (auto c = 0u; c < 3u; ++c)
+    {
+        if (four_colour || (c0 > c1))
+        {
+            palette[2][c] = static_cast<std::uint8_t>((2u * a[c] + b[c]) / 3u);
+            palette[3][c] = static_cast<std::uint8_t>((a[c] + 2u * b[c]) / 3u);
+        }
+        else
+        {
+            palette[2][c] = static_cast<std::uint8_t>((a[c] + b[c]) / 2u);
+        }
+    }
+
+    palette[2][3] = 0xffu;
+    palette[3][3] = static_cast<std::uint8_t>((four_colour || (c0 > c1)) ? 0xffu : 0x00u);
+
+    return palette;
+}
+
+/**
+ * Encode the colour of a block as BC1, always in four colour mode (except for a single colour block where the mode
+ * does not matter).
+ */
+auto encode_bc1(const Block &block, game::CompressionQuality quality) -> std::array<std::byte, 8u>
+{
+    struct Candidate
+    {
+        std::uint16_t c0;
+        std::uint16_t c1;
+        std::array<std::uint8_t, 16u> indices;
+        std::uint32_t error;
+    };
+
+    const auto points = to_points<3u>(block, 0u);
+
+    const auto evaluate = [&block](const Endpoints<3u> &endpoints)
+    {
+        auto candidate =
+            Candidate{.c0 = to_565(endpoints.first), .c1 = to_565(endpoints.second), .indices = {}, .error = 0u};
+
+        // four colour mode requires c0 > c1
+        if (candidate.c0 < candidate.c1)
+        {
+            std::ranges::swap(candidate.c0, candidate.c1);
+        }
+
+        const auto palette = bc1_palette(candidate.c0, candidate.c1, true);
+        // a single colour block only needs the first entry, which avoids ambiguity over the mode
+        const auto entries = candidate.c0 == candidate.c1 ? std::span{palette}.first(1u) : std::span{palette};
+        candidate.error = select_indices<3u>(block, entries, candidate.indices);
+
+        return candidate;
+    };
+
+    auto best = evaluate(fit_principal_axis(points));
+
+    if (quality == game::CompressionQuality::HIGH)
+    {
+        constexpr auto weights = std::array<float, 4u>{0.0f, 1.0f, 1.0f / 3.0f, 2.0f / 3.0f};
+
+        for (auto pass = 0u; pass < refinement_passes; ++pass)
+        {
+            auto point_weights = std::array<float, 16u>{};
+            std::ranges::transform(best.indices, point_weights.begin(), [&](auto index) { return weights[index]; });
+
+            const auto refined = refine_endpoints(points, point_weights);
+            if (!refined)
+            {
+                break;
+            }
+
+            const auto candidate = evaluate(*refined);
+            if (candidate.error >= best.error)
+            {
+                break;
+            }
+
+            best = candidate;
+        }
+    }
+
+    auto indices = std::uint32_t{};
+    for (auto i = 0u; i < 16u; ++i)
+    {
+        indices |= static_cast<std::uint32_t>(best.indices[i]) << (i * 2u);
+    }
+
+    auto encoded = std::array<std::byte, 8u>{};
+    std::memcpy(encoded.data(), &best.c0, sizeof(best.c0));
+    std::memcpy(encoded.data() + 2u, &best.c1, sizeof(best.c1));
+    std::memcpy(encoded.data() + 4u, &indices, sizeof(indices));
+
+    return encoded;
+}
+
+/**
+ * Build the BC4 palette for a pair of endpoints.
+ */
+auto bc4_palette(std::uint8_t r0, std::uint8_t r1) -> std::array<Pixel, 8u>
+{
+    auto palette = std::array<Pixel, 8u>{};
+    palette[0][0] = r0;
+    palette[1][0] = r1;
+
+    if (r0 > r1)
+    {
+        for (auto i = 1u; i < 7u; ++i)
+        {
+            palette[i + 1u][0] = static_cast<std::uint8_t>(((7u - i) * r0 + i * r1) / 7u);
+        }
+    }
+    else
+    {
+        for (auto i = 1u; i < 5u; ++i)
+        {
+            palette[i + 1u][0] = static_cast<std::uint8_t>(((5u - i) * r0 + i * r1) / 5u);
+        }
+
+        palette[6][0] = 0x00u;
+        palette[7][0] = 0xffu;
+    }
+
+    return palette;
+}
+
+/**
+ * Encode a single channel of a block as BC4.
+ */
+auto encode_bc4(const Block &block, std::size_t channel, game::CompressionQuality quality) -> std::array<std::byte, 8u>
+{
+    struct Candidate
+    {
+        std::uint8_t r0;
+        std::uint8_t r1;
+        std::array<std::uint8_t, 16u> indices;
+        std::uint32_t error;
+    };
+
+    // move the channel to red so the generic helpers can be used
+    auto values = Block{};
+    for (auto i = 0u; i < 16u; ++i)
+    {
+        values[i][0] = block[i][channel];
+    }
+
+    const auto evaluate = [&values](std::uint8_t r0, std::uint8_t r1)
+    {
+        auto candidate = Candidate{.r0 = r0, .r1 = r1, .indices = {}, .error = 0u};
+        const auto palette = bc4_palette(r0, r1);
+        candidate.error = select_indices<1u>(values, palette, candidate.indices);
+        return candidate;
+    };
+
+    const auto [min, max] = std::ranges::minmax(values | std::views::transform([](const auto &v) { return v[0]; }));
+
+    // eight value mode spanning the full range
+    auto best = evaluate(max, min);
+
+    if (quality == game::CompressionQuality::HIGH)
+    {
+        // six value mode gets exact 0 and 255 for free, so fit the endpoints to everything else
+        auto inner_min = std::uint8_t{0xff};
+        auto inner_max = std::uint8_t{0x00};
+        for (const auto &v : values)
+        {
+            if ((v[0] != 0x00u) && (v[0] != 0xffu))
+            {
+                inner_min = std::min(inner_min, v[0]);
+                inner_max = std::max(inner_max, v[0]);
+            }
+        }
+
+        if (inner_min <= inner_max)
+        {
+            if (const auto candidate = evaluate(inner_min, inner_max); candidate.error < best.error)
+            {
+                best = candidate;
+            }
+        }
+
+        // refine the eight value mode
+        if (best.r0 > best.r1)
+        {
+            const auto points = to_points<1u>(values, 0u);
+
+            for (auto pass = 0u; pass < refinement_passes; ++pass)
+            {
+                auto weights = std::array<float, 16u>{};
+                std::ranges::transform(
+                    best.indices,
+                    weights.begin(),
+                    [](auto index)
+                    { return index < 2u ? static_cast<float>(index) : static_cast<float>(index - 1u) / 7.0f; });
+
+                const auto refined = refine_endpoints(points, weights);
+                if (!refined)
+                {
+                    break;
+                }
+
+                const auto r0 = static_cast<std::uint8_t>(std::lround(refined->first[0]));
+                const auto r1 = static_cast<std::uint8_t>(std::lround(refined->second[0]));
+                if (r0 <= r1)
+                {
+                    break;
+                }
+
+                const auto candidate = evaluate(r0, r1);
+                if (candidate.error >= best.error)
+                {
+                    break;
+                }
+
+                best = candidate;
+            }
+        }
+    }
+
+    auto bits = static_cast<std::uint64_t>(best.r0) | (static_cast<std::uint64_t>(best.r1) << 8u);
+    for (auto i = 0u; i < 16u; ++i)
+    {
+        bits |= static_cast<std::uint64_t>(best.indices[i]) << (16u + i * 3u);
+    }
+
+    auto encoded = std::array<std::byte, 8u>{};
+    std::memcpy(encoded.data(), &bits, sizeof(bits));
+
+    return encoded;
+}
+
+/**
+ * Build the BC7 mode 6 palette for a pair of (unquantised 8 bit) endpoints.
+ */
+auto bc7_palette(const Pixel &a, const Pixel &b) -> std::array<Pixel, 16u>
+{
+    auto palette = std::array<Pixel, 16u>{};
+
+    for (auto i = 0u; i < 16u; ++i)
+    {
+        for (auto c = 0u; c < 4u; ++c)
+        {
+            palette[i][c] =
+                static_cast<std::uint8_t>(((64u - bc7_weights[i]) * a[c] + bc7_weights[i] * b[c] + 32u) >> 6u);
+        }
+    }
+
+    return palette;
+}
+
+/**
+ * Quantise an endpoint to the 7 bits + p-bit of BC7 mode 6.
+ *
+ * @param endpoint
+ *   The endpoint.
+ * @param p_bit
+ *   The shared least significant bit.
+ *
+ * @returns
+ *   The 7 bit components.
+ */
+auto bc7_quantise(const Point<4u> &endpoint, std::uint32_t p_bit) -> Pixel
+{
+    auto quantised = Pixel{};
+    for (auto c = 0u; c < 4u; ++c)
+    {
+        const auto value = std::lround((std::clamp(endpoint[c], 0.0f, 255.0f) - static_cast<float>(p_bit)) / 2.0f);
+        quantised[c] = static_cast<std::uint8_t>(std::clamp(value, 0l, 127l));
+    }
+
+    return quantised;
+}
+
+/**
+ * Expand a 7 bit + p-bit endpoint to 8 bits.
+ */
+auto bc7_expand(const Pixel &quantised, std::uint32_t p_bit) -> Pixel
+{
+    auto expanded = Pixel{};
+    for (auto c = 0u; c < 4u; ++c)
+    {
+        expanded[c] = static_cast<std::uint8_t>((quantised[c] << 1u) | p_bit);
+    }
+
+    return expanded;
+}
+
+/**
+ * Encode a block as BC7 using mode 6 (single subset, RGBA, 4 bit indices).
+ */
+auto encode_bc7(const Block &block, game::CompressionQuality quality) -> std::array<std::byte, 16u>
+{
+    struct Candidate
+    {
+        Pixel a;
+        Pixel b;
+        std::uint32_t p_a;
+        std::uint32_t p_b;
+        std::array<std::uint8_t, 16u> indices;
+        std::uint32_t error;
+    };
+
+    const auto points = to_points<4u>(block, 0u);
+
+    const auto evaluate = [&block](const Endpoints<4u> &endpoints, std::uint32_t p_a, std::uint32_t p_b)
+    {
+        auto candidate = Candidate{
+            .a = bc7_quantise(endpoints.first, p_a),
+            .b = bc7_quantise(endpoints.second, p_b),
+            .p_a = p_a,
+            .p_b = p_b,
+            .indices = {},
+            .error = 0u};
+
+        const auto palette = bc7_palette(bc7_expand(candidate.a, p_a), bc7_expand(candidate.b, p_b));
+        candidate.error = select_indices_rgba16(block, palette, candidate.indices);
+
+        return candidate;
+    };
+
+    // pick the p-bit for an endpoint which best reproduces it on its own
+    const auto best_p_bit = [](const Point<4u> &endpoint)
+    {
+        const auto endpoint_error = [&endpoint](std::uint32_t p_bit)
+        {
+            const auto expanded = bc7_expand(bc7_quantise(endpoint, p_bit), p_bit);
+            auto error = 0.0f;
+            for (auto c = 0u; c < 4u; ++c)
+            {
+                error += (endpoint[c] - expanded[c]) * (endpoint[c] - expanded[c]);
+            }
+
+            return error;
+        };
+
+        return endpoint_error(0u) <= endpoint_error(1u) ? 0u : 1u;
+    };
+
+    const auto search = [&](const Endpoints<4u> &endpoints)
+    {
+        if (quality == game::CompressionQuality::FAST)
+        {
+            return evaluate(endpoints, best_p_bit(endpoints.first), best_p_bit(endpoints.second));
+        }
+
+        auto best = evaluate(endpoints, 0u, 0u);
+        for (const auto &[p_a, p_b] : {std::pair{0u, 1u}, std::pair{1u, 0u}, std::pair{1u, 1u}})
+        {
+            if (const auto candidate = evaluate(endpoints, p_a, p_b); candidate.error < best.error)
+            {
+                best = candidate;
+            }
+        }
+
+        return best;
+    };
+
+    auto best = search(fit_principal_axis(points));
+
+    if (quality == game::CompressionQuality::HIGH)
+    {
+        for (auto pass = 0u; (pass < refinement_passes) && (best.error > 0u); ++pass)
+        {
+            auto weights = std::array<float, 16u>{};
+            std::ranges::transform(
+                best.indices,
+                weights.begin(),
+                [](auto index) { return static_cast<float>(bc7_weights[index]) / 64.0f; });
+
+            const auto refined = refine_endpoints(points, weights);
+            if (!refined)
+            {
+                break;
+            }
+
+            const auto candidate = search(*refined);
+            if (candidate.error >= best.error)
+            {
+                break;
+            }
+
+            best = candidate;
+        }
+    }
+
+    // the msb of the first index is implicitly zero, so flip the endpoints if needed
+    if (best.indices[0] >= 8u)
+    {
+        std::ranges::swap(best.a, best.b);
+        std::ranges::swap(best.p_a, best.p_b);
+        std::ranges::transform(
+            best.indices, best.indices.begin(), [](auto index) { return static_cast<std::uint8_t>(15u - index); });
+    }
+
+    auto writer = BitWriter{};
+    writer.write(1u << 6u, 7u);
+
+    for (auto c = 0u; c < 4u; ++c)
+    {
+        writer.write(best.a[c], 7u);
+        writer.write(best.b[c], 7u);
+    }
+
+    writer.write(best.p_a, 1u);
+    writer.write(best.p_b, 1u);
+
+    writer.write(best.indices[0], 3u);
+    for (auto i = 1u; i < 16u; ++i)
+    {
+        writer.write(best.indices[i], 4u);
+    }
+
+    auto encoded = std::array<std::byte, 16u>{};
+    std::memcpy(encoded.data(), writer.bytes().data(), encoded.size());
+
+    return encoded;
+}
+
+/**
+ * Decode a BC1 colour block.
+ */
+auto decode_bc1(std::span<const std::byte> bytes, bool four_colour) -> Block
+{
+    auto c0 = std::uint16_t{};
+    auto c1 = std::uint16_t{};
+    auto indices = std::uint32_t{};
+    std::memcpy(&c0, bytes.data(), sizeof(c0));
+    std::memcpy(&c1, bytes.data() + 2u, sizeof(c1));
+    std::memcpy(&indices, bytes.data() + 4u, sizeof(indices));
+
+    const auto palette = bc1_palette(c0, c1, four_colour);
+
+    auto block = Block{};
+    for (auto i = 0u; i < 16u; ++i)
+    {
+        block[i] = palette[(indices >> (i * 2u)) & 0x3u];
+    }
+
+    return block;
+}
+
+/**
+ * Decode a BC4 block into a single channel of a block.
+ */
+auto decode_bc4(std::span<const std::byte> bytes, Block &block, std::size_t channel) -> void
+{
+    auto bits = std::uint64_t{};
+    std::memcpy(&bits, bytes.data(), sizeof(bits));
+
+    const auto palette =
+        bc4_palette(static_cast<std::uint8_t>(bits & 0xffu), static_cast<std::uint8_t>((bits >> 8u) & 0xffu));
+
+    for (auto i = 0u; i < 16u; ++i)
+    {
+        block[i][channel] = palette[(bits >> (16u + i * 3u)) & 0x7u][0];
+    }
+}
+
+/**
+ * Decode a BC7 mode 6 block.
+ */
+auto decode_bc7(std::span<const std::byte> bytes) -> Block
+{
+    auto reader = BitReader{bytes};
+    game::ensure(reader.read(7u) == (1u << 6u), "only BC7 mode 6 is supported");
+
+    auto a = Pixel{};
+    auto b = Pixel{};
+    for (auto c = 0u; c < 4u; ++c)
+    {
+        a[c] = static_cast<std::uint8_t>(reader.read(7u));
+        b[c] = static_cast<std::uint8_t>(reader.read(7u));
+    }
+
+    const auto p_a = reader.read(1u);
+    const auto p_b = reader.read(1u);
+    const auto palette = bc7_palette(bc7_expand(a, p_a), bc7_expand(b, p_b));
+
+    auto block = Block{};
+    block[0] = palette[reader.read(3u)];
+    for (auto i = 1u; i < 16u; ++i)
+    {
+        block[i] = palette[reader.read(4u)];
+    }
+
+    return block;
+}
+
+/**
+ * Get the size of a compressed block.
+ */
+auto block_size(game::TextureFormat format) -> std::size_t
+{
+    switch (format)
+    {
+        using enum game::TextureFormat;
+        case BC1:
+        case BC4: return 8u;
+        case BC3:
+        case BC5:
+        case BC7: return 16u;
+        default: throw game::Exception("not a block compressed format: {}", format);
+    }
+}
+
+}
+
+namespace game
+{
+
+auto compress_image(
+    std::span<const std::byte> pixels,
+    std::uint32_t width,
+    std::uint32_t height,
+    std::uint32_t channels,
+    TextureFormat format,
+    CompressionQuality quality) -> std::vector<std::byte>
+{
+    ensure((channels == 3u) || (channels == 4u), "unsupported number of channels: {}", channels);
+    ensure(pixels.size() == std::size_t{width} * height * channels, "pixel data size mismatch");
+
+    const auto encoded_size = block_size(format);
+    const auto blocks_x = (width + 3u) / 4u;
+    const auto blocks_y = (height + 3u) / 4u;
+
+    auto compressed = std::vector<std::byte>(std::size_t{blocks_x} * blocks_y * encoded_size);
+
+    auto rows = std::vector<std::uint32_t>(blocks_y);
+    std::iota(rows.begin(), rows.end(), 0u);
+
+    // rows of blocks are independent, nothing in here can throw as that would terminate
+    std::for_each(
+        std::execution::par,
+        rows.cbegin(),
+        rows.cend(),
+        [&](std::uint32_t block_y)
+        {
+            for (auto block_x = 0u; block_x < blocks_x; ++block_x)
+            {
+                // fetch the block, replicating edge texels for partial blocks
+                auto block = Block{};
+                for (auto i = 0u; i < 16u; ++i)
+                {
+                    const auto x = std::min(block_x * 4u + i % 4u, width - 1u);
+                    const auto y = std::min(block_y * 4u + i / 4u, height - 1u);
+                    const auto *texel = pixels.data() + (std::size_t{y} * width + x) * channels;
+
+                    for (auto c = 0u; c < 4u; ++c)
+                    {
+                        block[i][c] = c < channels ? std::to_integer<std::uint8_t>(texel[c]) : std::uint8_t{0xff};
+                    }
+                }
+
+                auto *out = compressed.data() + (std::size_t{block_y} * blocks_x + block_x) * encoded_size;
+
+                const auto write = [&out](const auto &encoded)
+                {
+                    std::memcpy(out, encoded.data(), encoded.size());
+                    out += encoded.size();
+                };
+
+                switch (format)
+                {
+                    using enum TextureFormat;
+                    case BC1: write(encode_bc1(block, quality)); break;
+                    case BC3:
+                        write(encode_bc4(block, 3u, quality));
+                        write(encode_bc1(block, quality));
+                        break;
+                    case BC4: write(encode_bc4(block, 0u, quality)); break;
+                    case BC5:
+                        write(encode_bc4(block, 0u, quality));
+                        write(encode_bc4(block, 1u, quality));
+                        break;
+                    case BC7: write(encode_bc7(block, quality)); break;
+                    default: break;
+                }
+            }
+        });
+
+    return compressed;
+}
+
+auto decompress_image(
+    std::span<const std::byte> blocks,
+    std::uint32_t width,
+    std::uint32_t height,
+    TextureFormat format) -> std::vector<std::byte>
+{
+    const auto encoded_size = block_size(format);
+    const auto blocks_x = (width + 3u) / 4u;
+    const auto blocks_y = (height + 3u) / 4u;
+
+    ensure(blocks.size() == std::size_t{blocks_x} * blocks_y * encoded_size, "compressed data size mismatch");
+
+    auto pixels = std::vector<std::byte>(std::size_t{width} * height * 4u);
+
+    for (auto block_y = 0u; block_y < blocks_y; ++block_y)
+    {
+        for (auto block_x = 0u; block_x < blocks_x; ++block_x)
+        {
+            const auto encoded =
+                blocks.subspan((std::size_t{block_y} * blocks_x + block_x) * encoded_size, encoded_size);
+
+            auto block = Block{};
+            block.fill({0x00u, 0x00u, 0x00u, 0xffu});
+
+            switch (format)
+            {
+                using enum TextureFormat;
+                case BC1: block = decode_bc1(encoded, false); break;
+                case BC3:
+                    block = decode_bc1(encoded.subspan(8u), true);
+                    decode_bc4(encoded, block, 3u);
+                    break;
+                case BC4: decode_bc4(encoded, block, 0u); break;
+                case BC5:
+                    decode_bc4(encoded, block, 0u);
+                    decode_bc4(encoded.subspan(8u), block, 1u);
+                    break;
+                case BC7: block = decode_bc7(encoded); break;
+                default: break;
+            }
+
+            // write back the texels inside the image, partial blocks are clipped
+            for (auto i = 0u; i < 16u; ++i)
+            {
+                const auto x = block_x * 4u + i % 4u;
+                const auto y = block_y * 4u + i / 4u;
+
+                if ((x < width) && (y < height))
+                {
+                    std::memcpy(pixels.data() + (std::size_t{y} * width + x) * 4u, block[i].data(), 4u);
+                }
+            }
+        }
+    }
+
+    return pixels;
+}
+
+auto to_string(CompressionQuality obj) -> std::string
+{
+    switch (obj)
+    {
+        using enum CompressionQuality;
+        case FAST: return "FAST";
+        case HIGH: return "HIGH";
+    }
+
+    return "UNKNOWN";
+}
+
+}
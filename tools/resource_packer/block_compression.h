@@ -0,0 +1,97 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string>
+#include <vector>
+
+#include "graphics/texture.h"
+
+namespace game
+{
+
+/**
+ * Enumeration of block compression quality levels.
+ */
+enum class CompressionQuality
+{
+    /** Endpoints from a single principal axis fit. */
+    FAST,
+
+    /** Endpoints are iteratively refined with a least squares fit and all p-bit combinations are tried for BC7. */
+    HIGH
+};
+
+/**
+ * Compress a single image (one mip level) into a block compressed format. Images which are not a multiple of 4 texels
+ * in each dimension have their edge texels replicated to fill the partial blocks.
+ *
+ * The blocks are compressed in parallel, with SSE2 used for palette searches where available.
+ *
+ * The channels used by each format are:
+ *  - BC1: RGB
+ *  - BC3: RGBA
+ *  - BC4: R
+ *  - BC5: RG
+ *  - BC7: RGBA (always encoded with mode 6)
+ *
+ * @param pixels
+ *   The pixels to compress, tightly packed rows of width * channels bytes.
+ * @param width
+ *   Width of the image.
+ * @param height
+ *   Height of the image.
+ * @param channels
+ *   Number of channels per pixel, must be 3 or 4. Three channel images have an implicit alpha of 255.
+ * @param format
+ *   The block compressed format to compress to.
+ * @param quality
+ *   The quality to compress with.
+ *
+ * @returns
+ *   The compressed blocks, in row major order.
+ */
+auto compress_image(
+    std::span<const std::byte> pixels,
+    std::uint32_t width,
+    std::uint32_t height,
+    std::uint32_t channels,
+    TextureFormat format,
+    CompressionQuality quality) -> std::vector<std::byte>;
+
+/**
+ * Decompress a block compressed image. This is intended for testing and tooling, BC7 only supports mode 6 blocks.
+ *
+ * Channels not stored by a format are decompressed as 0 (or 255 for alpha).
+ *
+ * @param blocks
+ *   The compressed blocks.
+ * @param width
+ *   Width of the image.
+ * @param height
+ *   Height of the image.
+ * @param format
+ *   The block compressed format of the blocks.
+ *
+ * @returns
+ *   The decompressed image as tightly packed RGBA8.
+ */
+auto decompress_image(
+    std::span<const std::byte> blocks,
+    std::uint32_t width,
+    std::uint32_t height,
+    TextureFormat format) -> std::vector<std::byte>;
+
+/**
+ * Converts a compression quality to a string.
+ *
+ * @param obj
+ *   The compression quality to convert.
+ *
+ * @returns
+ *   The string representation of the compression quality.
+ */
+auto to_string(CompressionQuality obj) -> std::string;
+
+}
@@ -0,0 +1,128 @@
+#include "cook_cache.h"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <format>
+#include <fstream>
+#include <functional>
+#include <iterator>
+#include <optional>
+#include <span>
+#include <string>
+#include <system_error>
+#include <thread>
+#include <vector>
+
+#include "utils/error.h"
+#include "utils/hash.h"
+
+namespace
+{
+
+/** Number of bytes of a source asset hashed at a time when computing its cook key. */
+constexpr auto key_chunk_size = std::size_t{64u * 1024u};
+
+/** Number of stores started by this process, to give every temporary file a unique name. */
+auto store_count = std::atomic<std::uint64_t>{};
+
+}
+
+namespace game
+{
+
+CookCache::CookCache(const std::filesystem::path &directory)
+    : directory_(directory)
+{
+    std::filesystem::create_directories(directory_);
+}
+
+auto CookCache::load(std::uint64_t key) const -> std::optional<std::vector<std::byte>>
+{
+    auto file = std::ifstream{path(key), std::ios::binary};
+    if (!file)
+    {
+        return std::nullopt;
+    }
+
+    auto blob_hash = std::uint64_t{};
+    if (!file.read(reinterpret_cast<char *>(&blob_hash), sizeof(blob_hash)))
+    {
+        return std::nullopt;
+    }
+
+    const auto contents = std::vector<char>{std::istreambuf_iterator<char>{file}, std::istreambuf_iterator<char>{}};
+    const auto blob = std::as_bytes(std::span{contents});
+
+    if (fnv1a(blob) != blob_hash)
+    {
+        return std::nullopt;
+    }
+
+    return std::vector<std::byte>{std::ranges::cbegin(blob), std::ranges::cend(blob)};
+}
+
+auto CookCache::store(std::uint64_t key, std::span<const std::byte> blob) const -> void
+{
+    const auto final_path = path(key);
+
+    // identical assets cooked at the same time have the same key, so each store needs its own temporary file (thread
+    // ids are only unique among running threads, so the count covers the same thread storing twice)
+    auto tmp_path = final_path;
+    tmp_path +=
+        std::format(".{:x}.{}.tmp", std::hash<std::thread::id>{}(std::this_thread::get_id()), store_count++);
+
+    {
+        const auto blob_hash = fnv1a(blob);
+
+        auto file = std::ofstream{tmp_path, std::ios::binary};
+        file.write(reinterpret_cast<const char *>(&blob_hash), sizeof(blob_hash));
+        file.write(reinterpret_cast<const char *>(blob.data()), blob.size());
+        ensure(!!file, "failed to write cache file {}", tmp_path.string());
+    }
+
+    // write then rename so a crash mid write never leaves a file under the real name
+    auto error = std::error_code{};
+    std::filesystem::rename(tmp_path, final_path, error);
+
+    if (error)
+    {
+        // renaming can fail when another store of the same key is renaming at the same time, its blob is just as good
+        std::filesystem::remove(tmp_path, error);
+        ensure(std::filesystem::exists(final_path), "failed to store cache file {}", final_path.string());
+    }
+}
+
+auto CookCache::path(std::uint64_t key) const -> std::filesystem::path
+{
+    return directory_ / std::format("{:016x}.tlv", key);
+}
+
+auto cook_key(const std::filesystem::path &path, std::span<const std::uint32_t> settings) -> std::uint64_t
+{
+    auto file = std::ifstream{path, std::ios::binary};
+    ensure(!!file, "failed to open {}", path.string());
+
+    const auto filename = path.filename().string();
+
+    auto hash = fnv1a(std::as_bytes(settings));
+    hash = fnv1a(std::as_bytes(std::span{filename}), hash);
+
+    // this runs for every asset on every run, even when everything is cached, so stream the contents through a small
+    // buffer rather than reading whole files into memory
+    auto chunk = std::vector<char>(key_chunk_size);
+    while (file)
+    {
+        file.read(chunk.data(), static_cast<std::streamsize>(chunk.size()));
+        const auto read = static_cast<std::size_t>(file.gcount());
+
+        hash = fnv1a(std::as_bytes(std::span{chunk}.first(read)), hash);
+    }
+
+    ensure(file.eof(), "failed to read {}", path.string());
+
+    return hash;
+}
+
+}
@@ -0,0 +1,91 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <optional>
+#include <span>
+#include <vector>
+
+namespace game
+{
+
+/**
+ * A cache of cooked TLV blobs on disk, keyed on a hash of everything that went into the cook (source content and packer
+ * settings). Each key is stored in its own file so the cache can be used concurrently from multiple threads.
+ *
+ * A cache file has the following layout:
+ *
+ * +-----------+ -.
+ * | Blob hash |  | 8 bytes
+ * +-----------+ -+
+ * |   Blob    |  | Rest of the file
+ * +-----------+ -'
+ *
+ * The blob hash is checked on load, so a partially written or otherwise corrupt file is treated as a miss. Each store
+ * writes to its own temporary file before renaming it into place, so identical cooks (which share a key) can store
+ * concurrently.
+ */
+class CookCache
+{
+  public:
+    /**
+     * Construct a new cook cache, creating the directory if it does not exist.
+     *
+     * @param directory
+     *   Directory to store cached blobs in.
+     */
+    CookCache(const std::filesystem::path &directory);
+
+    /**
+     * Load a cached blob.
+     *
+     * @param key
+     *   The cook key.
+     *
+     * @returns
+     *   The cached blob if it exists and is valid, otherwise an empty optional.
+     */
+    auto load(std::uint64_t key) const -> std::optional<std::vector<std::byte>>;
+
+    /**
+     * Store a blob in the cache, replacing any existing blob for the key.
+     *
+     * @param key
+     *   The cook key.
+     * @param blob
+     *   The cooked blob.
+     */
+    auto store(std::uint64_t key, std::span<const std::byte> blob) const -> void;
+
+  private:
+    /**
+     * Get the path of the cache file for a key.
+     *
+     * @param key
+     *   The cook key.
+     *
+     * @returns
+     *   Path to the cache file.
+     */
+    auto path(std::uint64_t key) const -> std::filesystem::path;
+
+    /** Directory to store cached blobs in. */
+    std::filesystem::path directory_;
+};
+
+/**
+ * Compute the cache key for a source asset. This covers everything that affects the cooked output: the file name (as
+ * the asset name is derived from it), the file contents and the packer settings.
+ *
+ * @param path
+ *   Path to the source asset.
+ * @param settings
+ *   Every packer setting which affects the cooked output.
+ *
+ * @returns
+ *   The cook key.
+ */
+auto cook_key(const std::filesystem::path &path, std::span<const std::uint32_t> settings) -> std::uint64_t;
+
+}
@@ -1,13 +1,29 @@
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <charconv>
+#include <chrono>
 #include <cstddef>
 #include <cstdint>
+#include <deque>
 #include <filesystem>
 #include <format>
 #include <fstream>
+#include <functional>
+#include <future>
 #include <iostream>
+#include <iterator>
+#include <map>
 #include <memory>
+#include <optional>
 #include <print>
 #include <ranges>
-#include <set>
+#include <span>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <thread>
+#include <vector>
 
 #include <assimp/Importer.hpp>
 #include <assimp/Logger.hpp>
@@ -22,14 +38,31 @@
 #include "graphics/texture.h"
 #include "graphics/vertex_data.h"
 #include "maths/vector3.h"
+#include "tlv/tlv_sink.h"
 #include "tlv/tlv_writer.h"
 #include "utils/auto_release.h"
 #include "utils/error.h"
 #include "utils/exception.h"
 #include "utils/log.h"
+#include "utils/hash.h"
+#include "utils/thread_pool.h"
+
+#include "block_compression.h"
+#include "cook_cache.h"
+#include "manifest.h"
+#include "mesh_optimiser.h"
+#include "mip_generator.h"
+#include "vertex_packer.h"
 
 namespace
 {
+
+/**
+ * Version of the cook output. This should be bumped whenever a cook function changes what it writes, so that stale
+ * cache entries are no longer used.
+ */
+constexpr auto cook_version = std::uint32_t{5u};
+
 game::TextureFormat to_texture_format(int num_channels)
 {
     switch (num_channels)
@@ -53,6 +86,605 @@ game::TextureUsage to_texture_usage(std::string_view path)
 
     throw game::Exception("unsupported usage type: {}", path);
 }
+
+/**
+ * Pick the block compressed format for a texture. Colour textures use BC7, data textures are picked by what they hold:
+ * tangent space normal maps (".normal") only need x and y so use BC5, single channel masks (".mask") use BC4 and
+ * anything else uses BC1 or BC3 depending on whether it has alpha.
+ *
+ * @param path
+ *   Path to the texture.
+ * @param usage
+ *   Usage of the texture.
+ * @param num_channels
+ *   Number of channels in the source image.
+ *
+ * @returns
+ *   The compressed format to use.
+ */
+auto to_compressed_format(std::string_view path, game::TextureUsage usage, int num_channels) -> game::TextureFormat
+{
+    if (usage == game::TextureUsage::SRGB)
+    {
+        return game::TextureFormat::BC7;
+    }
+    else if (path.contains(".normal"))
+    {
+        return game::TextureFormat::BC5;
+    }
+    else if (path.contains(".mask"))
+    {
+        return game::TextureFormat::BC4;
+    }
+
+    return num_channels == 4 ? game::TextureFormat::BC3 : game::TextureFormat::BC1;
+}
+
+/**
+ * Check if a path is an image that can be cooked.
+ *
+ * @param path
+ *   The path to check.
+ *
+ * @returns
+ *   True if the path is an image, false otherwise.
+ */
+auto is_image(const std::filesystem::path &path) -> bool
+{
+    return (path.extension() == ".png") || (path.extension() == ".jpg");
+}
+
+/**
+ * Options parsed from the command line.
+ */
+struct Options
+{
+    /** Number of assets to cook concurrently. */
+    std::size_t jobs;
+
+    /** Directory containing the source assets. */
+    std::filesystem::path asset_dir;
+
+    /** Path to write the packed resource file to, with a manifest each bundle is written to "<out_path>.<bundle>". */
+    std::filesystem::path out_path;
+
+    /** Manifest assigning assets to bundles, empty to write a single file. */
+    std::filesystem::path manifest_path;
+
+    /** Directory for the cook cache, empty if the cache is disabled. */
+    std::filesystem::path cache_dir;
+
+    /** Quality to block compress textures with, empty if textures are left uncompressed. */
+    std::optional<game::CompressionQuality> texture_compression;
+
+    /** Whether to write meshes in the packed (quantised) vertex format rather than as VertexData. */
+    bool pack_vertices;
+
+    /** Whether to store identical payloads once. */
+    bool deduplicate;
+
+    /** Fraction of its size LZ4 has to save for a payload to be stored compressed, empty to disable compression. */
+    std::optional<float> min_compression_saving;
+};
+
+/**
+ * The result of cooking a single source asset.
+ */
+struct CookResult
+{
+    /** Path of the source asset. */
+    std::filesystem::path path;
+
+    /** Cooked TLV blob, released once it has been written to the archive. */
+    std::vector<std::byte> blob;
+
+    /** Whether the blob came from the cook cache. */
+    bool cache_hit;
+
+    /** Time taken to produce the blob. */
+    std::chrono::nanoseconds duration;
+};
+
+/**
+ * Parse the command line.
+ *
+ * @param args
+ *   The command line arguments, including the program name.
+ *
+ * @returns
+ *   The parsed options.
+ */
+auto parse_options(std::span<char *> args) -> Options
+{
+    auto options = Options{
+        .jobs = std::max(std::thread::hardware_concurrency(), 1u),
+        .asset_dir = {},
+        .out_path = {},
+        .manifest_path = {},
+        .cache_dir = {},
+        .texture_compression = game::CompressionQuality::HIGH,
+        .pack_vertices = false,
+        .deduplicate = true,
+        .min_compression_saving = 0.1f};
+    auto positional = std::vector<std::string_view>{};
+    auto use_cache = true;
+
+    for (auto i = 1u; i < args.size(); ++i)
+    {
+        const auto arg = std::string_view{args[i]};
+
+        if (arg == "--jobs")
+        {
+            game::ensure(i + 1u < args.size(), "--jobs requires a value");
+            const auto value = std::string_view{args[++i]};
+
+            const auto [ptr, ec] = std::from_chars(value.data(), value.data() + value.size(), options.jobs);
+            game::ensure(
+                (ec == std::errc{}) && (ptr == value.data() + value.size()) && (options.jobs > 0u),
+                "invalid job count: {}",
+                value);
+        }
+        else if (arg == "--cache-dir")
+        {
+            game::ensure(i + 1u < args.size(), "--cache-dir requires a value");
+            options.cache_dir = args[++i];
+        }
+        else if (arg == "--no-cache")
+        {
+            use_cache = false;
+        }
+        else if (arg == "--manifest")
+        {
+            game::ensure(i + 1u < args.size(), "--manifest requires a value");
+            options.manifest_path = args[++i];
+        }
+        else if (arg == "--no-dedup")
+        {
+            options.deduplicate = false;
+        }
+        else if (arg == "--lz4-threshold")
+        {
+            game::ensure(i + 1u < args.size(), "--lz4-threshold requires a value");
+            const auto value = std::string_view{args[++i]};
+
+            auto percent = float{};
+            const auto [ptr, ec] = std::from_chars(value.data(), value.data() + value.size(), percent);
+            game::ensure(
+                (ec == std::errc{}) && (ptr == value.data() + value.size()) && (percent >= 0.0f) && (percent < 100.0f),
+                "invalid lz4 threshold: {}",
+                value);
+
+            options.min_compression_saving = percent / 100.0f;
+        }
+        else if (arg == "--no-lz4")
+        {
+            options.min_compression_saving.reset();
+        }
+        else if (arg == "--texture-compression")
+        {
+            game::ensure(i + 1u < args.size(), "--texture-compression requires a value");
+            const auto value = std::string_view{args[++i]};
+
+            if (value == "none")
+            {
+                options.texture_compression.reset();
+            }
+            else if (value == "fast")
+            {
+                options.texture_compression = game::CompressionQuality::FAST;
+            }
+            else if (value == "high")
+            {
+                options.texture_compression = game::CompressionQuality::HIGH;
+            }
+            else
+            {
+                throw game::Exception("invalid texture compression: {}", value);
+            }
+        }
+        else if (arg == "--vertex-format")
+        {
+            game::ensure(i + 1u < args.size(), "--vertex-format requires a value");
+            const auto value = std::string_view{args[++i]};
+
+            if (value == "float")
+            {
+                options.pack_vertices = false;
+            }
+            else if (value == "packed")
+            {
+                options.pack_vertices = true;
+            }
+            else
+            {
+                throw game::Exception("invalid vertex format: {}", value);
+            }
+        }
+        else
+        {
+            positional.push_back(arg);
+        }
+    }
+
+    game::ensure(
+        positional.size() == 2u,
+        "usage: ./resource_packer.exe [--jobs N] [--cache-dir DIR | --no-cache] "
+        "[--texture-compression none|fast|high] [--vertex-format float|packed] [--no-dedup] "
+        "[--lz4-threshold PERCENT | --no-lz4] [--manifest FILE] <asset_dir> <out_path>");
+
+    options.asset_dir = positional[0];
+    options.out_path = positional[1];
+
+    if (!use_cache)
+    {
+        options.cache_dir.clear();
+    }
+    else if (options.cache_dir.empty())
+    {
+        // default to keeping the cache alongside the output
+        options.cache_dir = options.out_path;
+        options.cache_dir += ".cache";
+    }
+
+    return options;
+}
+
+/**
+ * Cook an image into a TLV texture description.
+ *
+ * @param path
+ *   Path to the image.
+ * @param compression
+ *   Quality to block compress the texture with, empty to leave it uncompressed.
+ * @param min_compression_saving
+ *   Fraction of its size LZ4 has to save for the data to be stored compressed, empty to leave it uncompressed.
+ *
+ * @returns
+ *   TLV buffer containing the texture.
+ */
+auto cook_texture(
+    const std::filesystem::path &path,
+    std::optional<game::CompressionQuality> compression,
+    std::optional<float> min_compression_saving) -> std::vector<std::byte>
+{
+    const auto path_str = path.string();
+    const auto filename = path.filename().string();
+    const auto asset_name = filename.substr(0, filename.find("."));
+
+    auto w = int{};
+    auto h = int{};
+    auto num_channels = int{};
+
+    game::ensure(::stbi_info(path_str.c_str(), &w, &h, &num_channels) == 1, "failed to get image info");
+    auto raw_data = std::unique_ptr<::stbi_uc, void (*)(void *)>(
+        ::stbi_load(path_str.c_str(), &w, &h, &num_channels, 0), ::stbi_image_free);
+    game::ensure(raw_data.get() != nullptr, "failed to load image {}", path_str);
+
+    std::println("packing path: {} {} {} {} {}", asset_name, path.extension().string(), w, h, num_channels);
+
+    const auto width = static_cast<std::uint32_t>(w);
+    const auto height = static_cast<std::uint32_t>(h);
+    const auto usage = to_texture_usage(path_str);
+
+    // decode and filter offline so loading at runtime is a straight copy of every level
+    auto mips = game::generate_mip_chain(
+        {reinterpret_cast<const std::byte *>(raw_data.get()), static_cast<std::size_t>(w * h * num_channels)},
+        width,
+        height,
+        static_cast<std::uint32_t>(num_channels),
+        usage == game::TextureUsage::SRGB);
+
+    const auto mip_levels = game::mip_level_count(width, height);
+
+    auto format = to_texture_format(num_channels);
+    auto data = std::vector<std::byte>{};
+
+    if (compression)
+    {
+        // each level is compressed on its own, filtering has to happen on the uncompressed pixels
+        const auto source_format = format;
+        format = to_compressed_format(path_str, usage, num_channels);
+
+        auto offset = std::size_t{};
+        for (auto level = 0u; level < mip_levels; ++level)
+        {
+            const auto level_size = game::mip_level_size(source_format, width, height, level);
+            const auto compressed = game::compress_image(
+                std::span{mips}.subspan(offset, level_size),
+                std::max(width >> level, 1u),
+                std::max(height >> level, 1u),
+                static_cast<std::uint32_t>(num_channels),
+                format,
+                *compression);
+
+            data.insert(std::ranges::end(data), std::ranges::cbegin(compressed), std::ranges::cend(compressed));
+            offset += level_size;
+        }
+
+        game::log::info("compressed {} to {} ({} -> {} bytes)", asset_name, format, mips.size(), data.size());
+    }
+    else
+    {
+        data = std::move(mips);
+    }
+
+    auto writer = game::TLVWriter{};
+    writer.set_compression(min_compression_saving);
+    writer.write(
+        asset_name,
+        game::TextureDescriptionView{
+            .width = width,
+            .height = height,
+            .format = format,
+            .usage = usage,
+            .mip_levels = mip_levels,
+            .data = data});
+
+    if (writer.compressed_bytes() != 0u)
+    {
+        game::log::info("lz4 saved {} bytes in {}", writer.compressed_bytes(), asset_name);
+    }
+
+    return writer.yield();
+}
+
+/**
+ * Cook all the meshes in a model into TLV mesh data.
+ *
+ * @param path
+ *   Path to the model.
+ * @param pack_vertices
+ *   Whether to write meshes in the packed vertex format.
+ * @param min_compression_saving
+ *   Fraction of its size LZ4 has to save for a payload to be stored compressed, empty to leave them uncompressed.
+ *
+ * @returns
+ *   TLV buffer containing all meshes in the model.
+ */
+auto cook_model(const std::filesystem::path &path, bool pack_vertices, std::optional<float> min_compression_saving)
+    -> std::vector<std::byte>
+{
+    const auto path_str = path.string();
+
+    // importers are not shared between threads, each cook gets its own
+    auto importer = ::Assimp::Importer{};
+    const auto *scene = importer.ReadFile(
+        path_str.c_str(), ::aiProcess_Triangulate | ::aiProcess_FlipUVs | ::aiProcess_CalcTangentSpace);
+
+    game::ensure((scene != nullptr), "failed to load model {}", path_str);
+
+    const auto loaded_meshes = std::span<::aiMesh *>(scene->mMeshes, scene->mMeshes + scene->mNumMeshes);
+
+    auto writer = game::TLVWriter{};
+    writer.set_compression(min_compression_saving);
+
+    for (const auto *mesh : loaded_meshes)
+    {
+        game::log::info("packing {}", mesh->mName.C_Str());
+
+        const auto to_vector3 = [](const ::aiVector3D &v) { return game::Vector3{v.x, v.y, v.z}; };
+        const auto positions = std::span<::aiVector3D>{mesh->mVertices, mesh->mVertices + mesh->mNumVertices} |
+                               std::views::transform(to_vector3);
+        const auto normals = std::span<::aiVector3D>{mesh->mNormals, mesh->mNormals + mesh->mNumVertices} |
+                             std::views::transform(to_vector3);
+
+        auto uvs = std::vector<game::UV>{};
+        auto tangents = std::vector<game::Vector3>{};
+        for (auto i = 0u; i < mesh->mNumVertices; ++i)
+        {
+            uvs.push_back({mesh->mTextureCoords[0][i].x, mesh->mTextureCoords[0][i].y});
+            tangents.push_back({mesh->mTangents[i].x, mesh->mTangents[i].y, mesh->mTangents[i].z});
+        }
+
+        auto indices = std::vector<std::uint32_t>{};
+        for (auto i = 0u; i < mesh->mNumFaces; ++i)
+        {
+            const auto &face = mesh->mFaces[i];
+            for (auto j = 0u; j < face.mNumIndices; ++j)
+            {
+                indices.push_back(face.mIndices[j]);
+            }
+        }
+
+        const auto vertices = std::views::zip_transform(
+                                  []<class... A>(A &&...a) { return game::VertexData{std::forward<A>(a)...}; },
+                                  positions,
+                                  normals,
+                                  tangents,
+                                  uvs) |
+                              std::ranges::to<std::vector>();
+
+        const auto before = game::analyse_vertex_cache(indices, vertices.size());
+        const auto optimised = game::optimise_mesh(vertices, indices);
+        const auto after = game::analyse_vertex_cache(optimised.indices, optimised.vertices.size());
+
+        game::log::info(
+            "optimised {}: vertices {} -> {}, acmr {:.3f} -> {:.3f}, atvr {:.3f} -> {:.3f}",
+            mesh->mName.C_Str(),
+            vertices.size(),
+            optimised.vertices.size(),
+            before.acmr,
+            after.acmr,
+            before.atvr,
+            after.atvr);
+
+        if (pack_vertices)
+        {
+            const auto packed = game::pack_mesh(optimised.vertices, optimised.indices);
+            const auto float_size = optimised.vertices.size() * sizeof(game::VertexData) +
+                                    optimised.indices.size() * sizeof(std::uint32_t);
+
+            game::log::info(
+                "packed {}: {} -> {} bytes",
+                mesh->mName.C_Str(),
+                float_size,
+                packed.vertices.size() + packed.indices.size());
+
+            writer.write(mesh->mName.C_Str(), packed.view());
+        }
+        else
+        {
+            writer.write(mesh->mName.C_Str(), optimised.vertices, optimised.indices);
+        }
+    }
+
+    if (writer.compressed_bytes() != 0u)
+    {
+        game::log::info("lz4 saved {} bytes in {}", writer.compressed_bytes(), path.filename().string());
+    }
+
+    return writer.yield();
+}
+
+/**
+ * Get the packer settings which affect the cooked output, for the cook key.
+ *
+ * @param options
+ *   The packer options.
+ *
+ * @returns
+ *   The settings.
+ */
+auto cook_settings(const Options &options) -> std::array<std::uint32_t, 5u>
+{
+    return {
+        cook_version,
+        game::tlv_version,
+        options.texture_compression ? static_cast<std::uint32_t>(*options.texture_compression) + 1u : 0u,
+        options.pack_vertices ? 1u : 0u,
+        options.min_compression_saving ? std::bit_cast<std::uint32_t>(*options.min_compression_saving) : 0xffffffffu};
+}
+
+/**
+ * Cook a source asset, using the cache if possible.
+ *
+ * @param path
+ *   Path to the source asset.
+ * @param cache
+ *   The cook cache, may be null if caching is disabled.
+ * @param options
+ *   The packer options.
+ *
+ * @returns
+ *   The result of the cook.
+ */
+auto cook(const std::filesystem::path &path, const game::CookCache *cache, const Options &options) -> CookResult
+{
+    const auto start = std::chrono::steady_clock::now();
+
+    const auto key = cache != nullptr ? game::cook_key(path, cook_settings(options)) : std::uint64_t{};
+    if (cache != nullptr)
+    {
+        if (auto blob = cache->load(key); blob)
+        {
+            return {
+                .path = path,
+                .blob = std::move(*blob),
+                .cache_hit = true,
+                .duration = std::chrono::steady_clock::now() - start};
+        }
+    }
+
+    auto blob = is_image(path) ? cook_texture(path, options.texture_compression, options.min_compression_saving)
+                               : cook_model(path, options.pack_vertices, options.min_compression_saving);
+    if (cache != nullptr)
+    {
+        cache->store(key, blob);
+    }
+
+    return {
+        .path = path,
+        .blob = std::move(blob),
+        .cache_hit = false,
+        .duration = std::chrono::steady_clock::now() - start};
+}
+
+/**
+ * Load the manifest.
+ *
+ * @param path
+ *   Path to the manifest, may be empty.
+ *
+ * @returns
+ *   The manifest, or an empty manifest (which puts everything in the shared bundle) if the path is empty.
+ */
+auto load_manifest(const std::filesystem::path &path) -> game::Manifest
+{
+    if (path.empty())
+    {
+        return {};
+    }
+
+    auto file = std::ifstream{path};
+    game::ensure(!!file, "failed to open manifest {}", path.string());
+
+    const auto source = std::string{std::istreambuf_iterator<char>{file}, std::istreambuf_iterator<char>{}};
+    return {source};
+}
+
+/**
+ * An archive being written for a single bundle.
+ */
+struct BundleWriter
+{
+    /**
+     * Construct a new bundle writer, starting the archive.
+     *
+     * @param path
+     *   Path to write the archive to.
+     * @param deduplicate
+     *   Whether to store identical payloads once.
+     */
+    BundleWriter(const std::filesystem::path &path, bool deduplicate)
+        : sink(path)
+        , writer(sink)
+    {
+        writer.set_deduplication(deduplicate);
+        writer.write_header();
+    }
+
+    /** Sink for the archive, streams straight to the output file. */
+    game::FileTLVSink sink;
+
+    /** Writer for the archive, payloads are only shared within a bundle as references are offsets into it. */
+    game::TLVWriter writer;
+};
+
+/**
+ * Log a summary of the cook, so it is clear where the time went.
+ *
+ * @param results
+ *   The results of all cooks.
+ */
+auto log_summary(std::span<const CookResult> results) -> void
+{
+    using namespace std::chrono;
+
+    const auto total = [](auto &&range)
+    {
+        const auto durations = range | std::views::transform(&CookResult::duration);
+        return duration_cast<milliseconds>(std::ranges::fold_left(durations, nanoseconds{}, std::plus<>{}));
+    };
+
+    auto hits = results | std::views::filter(&CookResult::cache_hit);
+    auto misses = results | std::views::filter([](const auto &r) { return !r.cache_hit; });
+
+    game::log::info(
+        "cook cache: {} hits ({}), {} misses ({})",
+        std::ranges::distance(hits),
+        total(hits),
+        std::ranges::distance(misses),
+        total(misses));
+
+    auto slowest = misses | std::views::transform([](const auto &r) { return &r; }) | std::ranges::to<std::vector>();
+    std::ranges::sort(slowest, std::ranges::greater{}, &CookResult::duration);
+
+    for (const auto *result : slowest | std::views::take(5))
+    {
+        game::log::info("  {} {}", result->path.filename().string(), duration_cast<milliseconds>(result->duration));
+    }
+}
+
 }
 
 auto main(int argc, char **argv) -> int
@@ -61,102 +693,115 @@ auto main(int argc, char **argv) -> int
     {
         std::println("resource packer");
 
-        game::ensure(argc == 3, "usage: ./resource_packer.exe <asset_dir> <out_path>");
+        const auto options = parse_options({argv, static_cast<std::size_t>(argc)});
+        const auto start = std::chrono::steady_clock::now();
+
+        const auto cache = options.cache_dir.empty() ? std::optional<game::CookCache>{}
+                                                     : std::optional<game::CookCache>{options.cache_dir};
 
-        const auto image_extensions = std::set<std::string>{".png", ".jpg"};
+        // directory iteration order is unspecified, so sort to keep the output stable
+        auto paths = std::filesystem::directory_iterator{options.asset_dir} |
+                     std::views::transform([](const auto &entry) { return entry.path(); }) |
+                     std::views::filter([](const auto &path)
+                                        { return is_image(path) || (path.extension() == ".obj"); }) |
+                     std::ranges::to<std::vector>();
+        std::ranges::sort(paths);
 
-        auto writer = game::TLVWriter{};
+        // the assimp log stream is global so attach it once up front rather than from the workers
+        auto stream = ::aiGetPredefinedLogStream(::aiDefaultLogStream_STDOUT, nullptr);
+        ::aiAttachLogStream(&stream);
 
-        for (const auto &entry : std::filesystem::directory_iterator{argv[1]})
+        const auto manifest = load_manifest(options.manifest_path);
+        for (const auto asset : manifest.assets())
         {
-            const auto path = entry.path().string();
-            const auto ext = entry.path().extension().string();
-            const auto filename = entry.path().filename().string();
-            const auto asset_name = filename.substr(0, filename.find("."));
+            game::ensure(
+                std::ranges::contains(paths, options.asset_dir / asset), "manifest asset {} does not exist", asset);
+        }
 
-            if (image_extensions.contains(ext))
+        // stream straight to the outputs, so only the blobs currently in flight are ever held in memory, without a
+        // manifest there is a single bundle written to the output path as is
+        auto bundles = std::map<std::string, BundleWriter, std::less<>>{};
+        for (const auto &name : manifest.bundles())
+        {
+            auto path = options.out_path;
+            if (!options.manifest_path.empty())
             {
-                auto w = int{};
-                auto h = int{};
-                auto num_channels = int{};
-
-                game::ensure(::stbi_info(path.c_str(), &w, &h, &num_channels) == 1, "failed to get image info");
-                auto raw_data = std::unique_ptr<::stbi_uc, void (*)(void *)>(
-                    ::stbi_load(path.c_str(), &w, &h, &num_channels, 0), ::stbi_image_free);
-
-                std::println("packing path: {} {} {} {} {}", asset_name, ext, w, h, num_channels);
-
-                writer.write(
-                    asset_name,
-                    w,
-                    h,
-                    to_texture_format(num_channels),
-                    to_texture_usage(path),
-                    {reinterpret_cast<const std::byte *>(raw_data.get()),
-                     static_cast<std::size_t>(w * h * num_channels)});
+                path += std::format(".{}", name);
             }
-            else if (ext == ".obj")
-            {
-                auto stream = aiGetPredefinedLogStream(aiDefaultLogStream_STDOUT, NULL);
-                aiAttachLogStream(&stream);
 
-                auto importer = ::Assimp::Importer{};
-                const auto *scene = importer.ReadFile(
-                    path.c_str(), ::aiProcess_Triangulate | ::aiProcess_FlipUVs | ::aiProcess_CalcTangentSpace);
+            bundles.try_emplace(name, path, options.deduplicate);
+        }
+
+        auto results = std::vector<CookResult>{};
+
+        {
+            auto pool = game::ThreadPool{options.jobs};
 
-                game::ensure((scene != nullptr), "failed to load model {}", path);
+            const auto *cook_cache = cache ? &*cache : nullptr;
+
+            // limit how far ahead of the merge the cooks can get, enough to keep every worker busy whilst a slow cook
+            // holds up the merge without letting finished blobs pile up
+            const auto window = options.jobs * 2u;
+            auto cooked = std::deque<std::future<CookResult>>{};
+            auto next = std::ranges::begin(paths);
+
+            const auto submit_next = [&]
+            {
+                const auto &path = *next++;
+                cooked.push_back(
+                    pool.submit([&path, cook_cache, &options] { return cook(path, cook_cache, options); }));
+            };
+
+            while ((next != std::ranges::end(paths)) && (cooked.size() < window))
+            {
+                submit_next();
+            }
 
-                const auto loaded_meshes = std::span<::aiMesh *>(scene->mMeshes, scene->mMeshes + scene->mNumMeshes);
+            // merge in path order regardless of which cook finished first, so the output is identical for any
+            // number of jobs
+            while (!cooked.empty())
+            {
+                auto result = cooked.front().get();
+                cooked.pop_front();
 
-                for (const auto *mesh : loaded_meshes)
+                if (next != std::ranges::end(paths))
                 {
-                    game::log::info("packing {}", mesh->mName.C_Str());
-
-                    const auto to_vector3 = [](const ::aiVector3D &v) { return game::Vector3{v.x, v.y, v.z}; };
-                    const auto positions =
-                        std::span<::aiVector3D>{mesh->mVertices, mesh->mVertices + mesh->mNumVertices} |
-                        std::views::transform(to_vector3);
-                    const auto normals = std::span<::aiVector3D>{mesh->mNormals, mesh->mNormals + mesh->mNumVertices} |
-                                         std::views::transform(to_vector3);
-
-                    auto uvs = std::vector<game::UV>{};
-                    auto tangents = std::vector<game::Vector3>{};
-                    for (auto i = 0u; i < mesh->mNumVertices; ++i)
-                    {
-                        uvs.push_back({mesh->mTextureCoords[0][i].x, mesh->mTextureCoords[0][i].y});
-                        tangents.push_back({mesh->mTangents[i].x, mesh->mTangents[i].y, mesh->mTangents[i].z});
-                    }
-
-                    auto indices = std::vector<std::uint32_t>{};
-                    for (auto i = 0u; i < mesh->mNumFaces; ++i)
-                    {
-                        const auto &face = mesh->mFaces[i];
-                        for (auto j = 0u; j < face.mNumIndices; ++j)
-                        {
-                            indices.push_back(face.mIndices[j]);
-                        }
-                    }
-
-                    const auto vertices =
-                        std::views::zip_transform(
-                            []<class... A>(A &&...a) { return game::VertexData{std::forward<A>(a)...}; },
-                            positions,
-                            normals,
-                            tangents,
-                            uvs) |
-                        std::ranges::to<std::vector>();
-
-                    writer.write(mesh->mName.C_Str(), vertices, indices);
+                    submit_next();
                 }
+
+                bundles.find(manifest.bundle(result.path.filename().string()))->second.writer.append(result.blob);
+
+                // only the timings are needed from here on
+                result.blob = {};
+                results.push_back(std::move(result));
             }
         }
 
-        const auto resource_data = writer.yield();
+        if (cache)
+        {
+            log_summary(results);
+        }
 
-        game::log::info("writing resource {} bytes", resource_data.size());
+        for (auto &bundle : bundles | std::views::values)
+        {
+            bundle.writer.write_index();
+        }
 
-        std::ofstream out{argv[2], std::ios::binary};
-        out.write(reinterpret_cast<const char *>(resource_data.data()), resource_data.size());
+        game::log::info(
+            "packed {} assets with {} jobs in {}",
+            paths.size(),
+            options.jobs,
+            std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start));
+
+        for (const auto &[name, bundle] : bundles)
+        {
+            game::log::info("wrote bundle {} {} bytes", name, bundle.sink.size());
+
+            if (options.deduplicate)
+            {
+                game::log::info("  deduplication saved {} bytes", bundle.writer.deduplicated_bytes());
+            }
+        }
     }
     catch (game::Exception &e)
     {
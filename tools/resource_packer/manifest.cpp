@@ -0,0 +1,126 @@
+#include "manifest.h"
+
+#include <algorithm>
+#include <cctype>
+#include <ranges>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "resources/bundle.h"
+#include "utils/error.h"
+
+namespace
+{
+
+/**
+ * Remove leading and trailing whitespace (including any carriage return) from a string.
+ *
+ * @param str
+ *   The string to trim.
+ *
+ * @returns
+ *   View of the trimmed string.
+ */
+auto trim(std::string_view str) -> std::string_view
+{
+    const auto is_space = [](char c) { return std::isspace(static_cast<unsigned char>(c)) != 0; };
+
+    while (!str.empty() && is_space(str.front()))
+    {
+        str.remove_prefix(1u);
+    }
+
+    while (!str.empty() && is_space(str.back()))
+    {
+        str.remove_suffix(1u);
+    }
+
+    return str;
+}
+
+/**
+ * Check if a bundle name is valid, as it becomes part of a file name it is limited to a safe set of characters.
+ *
+ * @param name
+ *   The name to check.
+ *
+ * @returns
+ *   True if the name is valid, false otherwise.
+ */
+auto is_valid_bundle_name(std::string_view name) -> bool
+{
+    const auto is_valid_char = [](char c)
+    { return (std::isalnum(static_cast<unsigned char>(c)) != 0) || (c == '_') || (c == '-'); };
+
+    return !name.empty() && std::ranges::all_of(name, is_valid_char);
+}
+
+}
+
+namespace game
+{
+
+Manifest::Manifest()
+    : bundles_({std::string{shared_bundle}})
+    , assets_()
+{
+}
+
+Manifest::Manifest(std::string_view source)
+    : Manifest()
+{
+    auto current = std::string{};
+    auto line_number = 0u;
+
+    for (const auto raw_line : source | std::views::split('\n'))
+    {
+        ++line_number;
+
+        const auto line = trim(std::string_view{raw_line});
+        if (line.empty() || line.starts_with('#'))
+        {
+            continue;
+        }
+
+        if (line.starts_with('['))
+        {
+            ensure(line.ends_with(']'), "line {}: unterminated bundle name", line_number);
+
+            current = line.substr(1u, line.size() - 2u);
+            ensure(is_valid_bundle_name(current), "line {}: invalid bundle name '{}'", line_number, current);
+
+            // the shared bundle always exists, so listing it only adds assets to it
+            if (current != shared_bundle)
+            {
+                ensure(!std::ranges::contains(bundles_, current), "line {}: duplicate bundle {}", line_number, current);
+                bundles_.push_back(current);
+            }
+
+            continue;
+        }
+
+        ensure(!current.empty(), "line {}: asset {} is not in a bundle", line_number, line);
+
+        const auto [asset, inserted] = assets_.emplace(line, current);
+        ensure(inserted, "line {}: {} is already in bundle {}", line_number, line, asset->second);
+    }
+}
+
+auto Manifest::bundle(std::string_view asset) const -> std::string_view
+{
+    const auto entry = assets_.find(asset);
+    return entry == std::ranges::end(assets_) ? shared_bundle : std::string_view{entry->second};
+}
+
+auto Manifest::bundles() const -> const std::vector<std::string> &
+{
+    return bundles_;
+}
+
+auto Manifest::assets() const -> std::vector<std::string_view>
+{
+    return assets_ | std::views::keys | std::ranges::to<std::vector<std::string_view>>();
+}
+
+}
@@ -0,0 +1,79 @@
+#pragma once
+
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "utils/string_map.h"
+
+namespace game
+{
+
+/**
+ * Describes which bundle each asset is packed into, so the game only has to map the assets a level needs.
+ *
+ * A manifest is a text file of sections, each a bundle name in square brackets followed by the assets (file names in
+ * the asset directory) in that bundle, one per line. Blank lines and lines starting with # are ignored:
+ *
+ *   # used by every level
+ *   [shared]
+ *   right.srgb.jpg
+ *
+ *   [apple]
+ *   barrel.obj
+ *
+ * Any asset not listed goes in the shared bundle (see shared_bundle). An asset can only be listed once, anything used
+ * by more than one level belongs in the shared bundle.
+ */
+class Manifest
+{
+  public:
+    /**
+     * Construct an empty manifest, which puts every asset in the shared bundle.
+     */
+    Manifest();
+
+    /**
+     * Construct a manifest by parsing it, will throw if it is malformed.
+     *
+     * @param source
+     *   The text of the manifest.
+     */
+    Manifest(std::string_view source);
+
+    /**
+     * Get the bundle an asset belongs to.
+     *
+     * @param asset
+     *   Name of the asset.
+     *
+     * @returns
+     *   Name of the bundle.
+     */
+    auto bundle(std::string_view asset) const -> std::string_view;
+
+    /**
+     * Get the names of all bundles, the shared bundle first followed by the rest in the order they were listed.
+     *
+     * @returns
+     *   Bundle names.
+     */
+    auto bundles() const -> const std::vector<std::string> &;
+
+    /**
+     * Get the names of all the assets listed in the manifest.
+     *
+     * @returns
+     *   Asset names, in no particular order.
+     */
+    auto assets() const -> std::vector<std::string_view>;
+
+  private:
+    /** All bundle names, shared first. */
+    std::vector<std::string> bundles_;
+
+    /** Bundle of each listed asset. */
+    StringMap<std::string> assets_;
+};
+
+}
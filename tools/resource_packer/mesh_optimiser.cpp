@@ -0,0 +1,333 @@
+#include "mesh_optimiser.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <span>
+#include <unordered_map>
+#include <vector>
+
+#include "graphics/vertex_data.h"
+#include "utils/error.h"
+#include "utils/hash.h"
+
+namespace
+{
+
+/** Marker for a vertex which has not been remapped yet. */
+constexpr auto unmapped = std::numeric_limits<std::uint32_t>::max();
+
+/** Size of the cache modeled when scoring vertices, see optimise_vertex_cache. */
+constexpr auto forsyth_cache_size = 32u;
+
+// tuning values from Tom Forsyth's original article
+
+constexpr auto cache_decay_power = 1.5f;
+constexpr auto last_triangle_score = 0.75f;
+constexpr auto valence_boost_scale = 2.0f;
+constexpr auto valence_boost_power = 0.5f;
+
+/**
+ * Hash a vertex by its bytes, VertexData is all floats with no padding so this is well defined.
+ */
+struct VertexHash
+{
+    auto operator()(const game::VertexData &vertex) const -> std::size_t
+    {
+        return static_cast<std::size_t>(game::fnv1a(std::as_bytes(std::span{&vertex, 1u})));
+    }
+};
+
+/**
+ * Compare vertices by their bytes, this keeps welding exact (e.g. 0.0 and -0.0 are not merged).
+ */
+struct VertexEqual
+{
+    auto operator()(const game::VertexData &a, const game::VertexData &b) const -> bool
+    {
+        return std::memcmp(&a, &b, sizeof(game::VertexData)) == 0;
+    }
+};
+
+static_assert(sizeof(game::VertexData) == sizeof(float) * 11u, "VertexData must not contain padding");
+
+/**
+ * Score a vertex for the Forsyth optimiser, higher scores mean triangles using the vertex should be emitted sooner.
+ *
+ * @param cache_position
+ *   Position of the vertex in the modeled cache, negative if not in the cache.
+ * @param remaining
+ *   Number of triangles using the vertex which have not been emitted.
+ *
+ * @returns
+ *   The score for the vertex.
+ */
+auto vertex_score(int cache_position, std::uint32_t remaining) -> float
+{
+    if (remaining == 0u)
+    {
+        // no triangles left so this vertex no longer matters
+        return -1.0f;
+    }
+
+    auto score = 0.0f;
+
+    if (cache_position >= 0)
+    {
+        if (cache_position < 3)
+        {
+            // used by the last triangle, deliberately scored lower so we don't favour strips
+            score = last_triangle_score;
+        }
+        else
+        {
+            const auto scale = 1.0f / static_cast<float>(forsyth_cache_size - 3u);
+            score = std::pow(1.0f - static_cast<float>(cache_position - 3) * scale, cache_decay_power);
+        }
+    }
+
+    // boost vertices with few remaining triangles so we get rid of lone triangles quickly
+    return score + valence_boost_scale * std::pow(static_cast<float>(remaining), -valence_boost_power);
+}
+
+}
+
+namespace game
+{
+
+auto weld_vertices(std::span<const VertexData> vertices, std::span<const std::uint32_t> indices) -> MeshBuffers
+{
+    auto welded = MeshBuffers{};
+    auto unique = std::unordered_map<VertexData, std::uint32_t, VertexHash, VertexEqual>{};
+    auto remap = std::vector<std::uint32_t>(vertices.size());
+
+    unique.reserve(vertices.size());
+
+    for (auto i = 0u; i < vertices.size(); ++i)
+    {
+        const auto [iter, inserted] =
+            unique.try_emplace(vertices[i], static_cast<std::uint32_t>(welded.vertices.size()));
+        if (inserted)
+        {
+            welded.vertices.push_back(vertices[i]);
+        }
+
+        remap[i] = iter->second;
+    }
+
+    welded.indices.reserve(indices.size());
+    for (const auto index : indices)
+    {
+        ensure(index < vertices.size(), "index out of range: {}", index);
+        welded.indices.push_back(remap[index]);
+    }
+
+    return welded;
+}
+
+auto optimise_vertex_cache(std::span<const std::uint32_t> indices, std::size_t vertex_count)
+    -> std::vector<std::uint32_t>
+{
+    ensure(indices.size() % 3u == 0u, "indices are not a triangle list");
+
+    const auto triangle_count = indices.size() / 3u;
+
+    // build vertex to triangle adjacency, the active triangles for vertex v are kept at the front of its range so
+    // removing an emitted triangle is a swap
+
+    auto remaining = std::vector<std::uint32_t>(vertex_count);
+    for (const auto index : indices)
+    {
+        ensure(index < vertex_count, "index out of range: {}", index);
+        ++remaining[index];
+    }
+
+    auto offsets = std::vector<std::uint32_t>(vertex_count + 1u);
+    for (auto v = 0u; v < vertex_count; ++v)
+    {
+        offsets[v + 1u] = offsets[v] + remaining[v];
+    }
+
+    auto adjacency = std::vector<std::uint32_t>(indices.size());
+    auto cursor = offsets;
+    for (auto i = 0u; i < indices.size(); ++i)
+    {
+        adjacency[cursor[indices[i]]++] = static_cast<std::uint32_t>(i / 3u);
+    }
+
+    auto cache_position = std::vector<int>(vertex_count, -1);
+    auto vertex_scores = std::vector<float>(vertex_count);
+    for (auto v = 0u; v < vertex_count; ++v)
+    {
+        vertex_scores[v] = vertex_score(-1, remaining[v]);
+    }
+
+    const auto triangle_score = [&](std::size_t triangle)
+    {
+        return vertex_scores[indices[triangle * 3u + 0u]] + vertex_scores[indices[triangle * 3u + 1u]] +
+               vertex_scores[indices[triangle * 3u + 2u]];
+    };
+
+    auto emitted = std::vector<bool>(triangle_count);
+    auto best = std::size_t{};
+    auto best_score = -1.0f;
+
+    for (auto t = 0u; t < triangle_count; ++t)
+    {
+        if (const auto score = triangle_score(t); score > best_score)
+        {
+            best = t;
+            best_score = score;
+        }
+    }
+
+    auto optimised = std::vector<std::uint32_t>{};
+    optimised.reserve(indices.size());
+
+    auto cache = std::vector<std::uint32_t>{};
+    auto new_cache = std::vector<std::uint32_t>{};
+    auto next_unemitted = std::size_t{};
+
+    for (auto i = 0u; i < triangle_count; ++i)
+    {
+        if (best_score < 0.0f)
+        {
+            // nothing in the cache touches a remaining triangle, so just start again from the next one
+            while (emitted[next_unemitted])
+            {
+                ++next_unemitted;
+            }
+
+            best = next_unemitted;
+        }
+
+        const auto triangle = indices.subspan(best * 3u, 3u);
+        emitted[best] = true;
+        optimised.insert(std::ranges::end(optimised), std::ranges::cbegin(triangle), std::ranges::cend(triangle));
+
+        new_cache.clear();
+
+        for (const auto v : triangle)
+        {
+            // remove the emitted triangle from the active range of the vertex
+            const auto active = std::span{adjacency}.subspan(offsets[v], remaining[v]);
+            std::ranges::swap(*std::ranges::find(active, best), active.back());
+            --remaining[v];
+
+            if (!std::ranges::contains(new_cache, v))
+            {
+                new_cache.push_back(v);
+            }
+        }
+
+        for (const auto v : cache)
+        {
+            if (!std::ranges::contains(triangle, v))
+            {
+                new_cache.push_back(v);
+            }
+        }
+
+        // update positions, anything that fell off the end of the cache is marked as not cached
+        for (auto position = 0u; position < new_cache.size(); ++position)
+        {
+            const auto v = new_cache[position];
+            cache_position[v] = position < forsyth_cache_size ? static_cast<int>(position) : -1;
+            vertex_scores[v] = vertex_score(cache_position[v], remaining[v]);
+        }
+
+        // only triangles touching vertices whose score changed need rescoring
+        best_score = -1.0f;
+        for (const auto v : new_cache)
+        {
+            for (const auto t : std::span{adjacency}.subspan(offsets[v], remaining[v]))
+            {
+                if (const auto score = triangle_score(t); score > best_score)
+                {
+                    best = t;
+                    best_score = score;
+                }
+            }
+        }
+
+        if (new_cache.size() > forsyth_cache_size)
+        {
+            new_cache.resize(forsyth_cache_size);
+        }
+
+        std::ranges::swap(cache, new_cache);
+    }
+
+    return optimised;
+}
+
+auto optimise_vertex_fetch(std::span<const VertexData> vertices, std::span<const std::uint32_t> indices)
+    -> MeshBuffers
+{
+    auto optimised = MeshBuffers{};
+    auto remap = std::vector<std::uint32_t>(vertices.size(), unmapped);
+
+    optimised.indices.reserve(indices.size());
+
+    for (const auto index : indices)
+    {
+        ensure(index < vertices.size(), "index out of range: {}", index);
+
+        if (remap[index] == unmapped)
+        {
+            remap[index] = static_cast<std::uint32_t>(optimised.vertices.size());
+            optimised.vertices.push_back(vertices[index]);
+        }
+
+        optimised.indices.push_back(remap[index]);
+    }
+
+    return optimised;
+}
+
+auto optimise_mesh(std::span<const VertexData> vertices, std::span<const std::uint32_t> indices) -> MeshBuffers
+{
+    const auto welded = weld_vertices(vertices, indices);
+    const auto cache_optimised = optimise_vertex_cache(welded.indices, welded.vertices.size());
+
+    return optimise_vertex_fetch(welded.vertices, cache_optimised);
+}
+
+auto analyse_vertex_cache(std::span<const std::uint32_t> indices, std::size_t vertex_count, std::size_t cache_size)
+    -> VertexCacheStatistics
+{
+    ensure(indices.size() % 3u == 0u, "indices are not a triangle list");
+
+    // a vertex is in a FIFO cache if fewer than cache_size misses have happened since it was inserted
+    auto inserted_at = std::vector<std::size_t>(vertex_count, std::numeric_limits<std::size_t>::max());
+    auto misses = std::size_t{};
+    auto unique = std::size_t{};
+
+    for (const auto index : indices)
+    {
+        ensure(index < vertex_count, "index out of range: {}", index);
+
+        if (inserted_at[index] == std::numeric_limits<std::size_t>::max())
+        {
+            ++unique;
+        }
+        else if (misses - inserted_at[index] < cache_size)
+        {
+            continue;
+        }
+
+        inserted_at[index] = misses;
+        ++misses;
+    }
+
+    const auto triangle_count = indices.size() / 3u;
+
+    return {
+        .acmr = triangle_count == 0u ? 0.0f : static_cast<float>(misses) / static_cast<float>(triangle_count),
+        .atvr = unique == 0u ? 0.0f : static_cast<float>(misses) / static_cast<float>(unique)};
+}
+
+}
@@ -0,0 +1,108 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+#include "graphics/vertex_data.h"
+
+namespace game
+{
+
+/**
+ * Owning vertex and index buffers for a mesh being cooked.
+ */
+struct MeshBuffers
+{
+    std::vector<VertexData> vertices;
+    std::vector<std::uint32_t> indices;
+};
+
+/**
+ * Statistics for how well an index buffer uses the post-transform vertex cache.
+ */
+struct VertexCacheStatistics
+{
+    /** Average cache miss ratio, transformed vertices per triangle. 0.5 is ideal for a regular grid, 3 is the worst. */
+    float acmr;
+
+    /** Average transform to vertex ratio, transformed vertices per unique vertex. 1 is ideal. */
+    float atvr;
+};
+
+/**
+ * Merge bitwise identical vertices and remap the indices to match.
+ *
+ * @param vertices
+ *   The vertices to weld.
+ * @param indices
+ *   The indices into vertices.
+ *
+ * @returns
+ *   Buffers with no duplicate vertices, the vertices are in order of first occurrence.
+ */
+auto weld_vertices(std::span<const VertexData> vertices, std::span<const std::uint32_t> indices) -> MeshBuffers;
+
+/**
+ * Reorder triangles to improve post-transform vertex cache hit rate, using Tom Forsyth's linear-speed vertex cache
+ * optimisation. The result is not tuned for a specific cache size so works well across hardware.
+ *
+ * @param indices
+ *   Triangle list indices, size must be a multiple of three.
+ * @param vertex_count
+ *   Number of vertices referenced by the indices.
+ *
+ * @returns
+ *   The reordered indices.
+ */
+auto optimise_vertex_cache(std::span<const std::uint32_t> indices, std::size_t vertex_count)
+    -> std::vector<std::uint32_t>;
+
+/**
+ * Reorder vertices into the order they are first referenced by the indices, so vertex fetch walks memory linearly.
+ * Vertices which are never referenced are removed.
+ *
+ * @param vertices
+ *   The vertices to reorder.
+ * @param indices
+ *   The indices into vertices.
+ *
+ * @returns
+ *   The reordered buffers.
+ */
+auto optimise_vertex_fetch(std::span<const VertexData> vertices, std::span<const std::uint32_t> indices)
+    -> MeshBuffers;
+
+/**
+ * Weld, cache optimise and then fetch optimise a mesh.
+ *
+ * @param vertices
+ *   The vertices of the mesh.
+ * @param indices
+ *   Triangle list indices, size must be a multiple of three.
+ *
+ * @returns
+ *   The optimised buffers, these render identically to the input.
+ */
+auto optimise_mesh(std::span<const VertexData> vertices, std::span<const std::uint32_t> indices) -> MeshBuffers;
+
+/**
+ * Simulate a FIFO post-transform vertex cache to measure how well an index buffer uses it.
+ *
+ * @param indices
+ *   Triangle list indices, size must be a multiple of three.
+ * @param vertex_count
+ *   Number of vertices referenced by the indices.
+ * @param cache_size
+ *   Number of entries in the simulated cache.
+ *
+ * @returns
+ *   The cache statistics.
+ */
+auto analyse_vertex_cache(
+    std::span<const std::uint32_t> indices,
+    std::size_t vertex_count,
+    std::size_t cache_size = 16u) -> VertexCacheStatistics;
+
+}
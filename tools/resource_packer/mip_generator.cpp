@@ -0,0 +1,172 @@
+#include "mip_generator.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <utility>
+#include <vector>
+
+#include "utils/error.h"
+
+namespace
+{
+
+/**
+ * The source texels (along one axis) that contribute to a destination texel and their weights.
+ */
+struct Taps
+{
+    std::array<std::uint32_t, 3u> index;
+    std::array<float, 3u> weight;
+    std::uint32_t count;
+};
+
+/**
+ * Compute the box filter taps for a destination texel along one axis.
+ *
+ * @param source_size
+ *   Size of the source level along the axis.
+ * @param index
+ *   Index of the destination texel along the axis.
+ *
+ * @returns
+ *   Taps for the destination texel.
+ */
+auto box_taps(std::uint32_t source_size, std::uint32_t index) -> Taps
+{
+    if (source_size == 1u)
+    {
+        return {.index = {0u}, .weight = {1.0f}, .count = 1u};
+    }
+
+    if (source_size % 2u == 0u)
+    {
+        return {.index = {index * 2u, index * 2u + 1u}, .weight = {0.5f, 0.5f}, .count = 2u};
+    }
+
+    // odd sized source of 2n+1 texels maps onto n texels, so each destination texel covers 2 + 1/n source texels
+    const auto n = static_cast<float>(source_size / 2u);
+    const auto size = static_cast<float>(source_size);
+    const auto x = static_cast<float>(index);
+
+    return {
+        .index = {index * 2u, index * 2u + 1u, index * 2u + 2u},
+        .weight = {(n - x) / size, n / size, (x + 1.0f) / size},
+        .count = 3u};
+}
+
+/**
+ * Convert an sRGB encoded value to linear.
+ *
+ * @param value
+ *   sRGB value in the range [0, 1].
+ *
+ * @returns
+ *   Linear value in the range [0, 1].
+ */
+auto srgb_to_linear(float value) -> float
+{
+    return value <= 0.04045f ? value / 12.92f : std::pow((value + 0.055f) / 1.055f, 2.4f);
+}
+
+/**
+ * Convert a linear value to sRGB encoded.
+ *
+ * @param value
+ *   Linear value in the range [0, 1].
+ *
+ * @returns
+ *   sRGB value in the range [0, 1].
+ */
+auto linear_to_srgb(float value) -> float
+{
+    return value <= 0.0031308f ? value * 12.92f : 1.055f * std::pow(value, 1.0f / 2.4f) - 0.055f;
+}
+
+}
+
+namespace game
+{
+
+auto generate_mip_chain(
+    std::span<const std::byte> pixels,
+    std::uint32_t width,
+    std::uint32_t height,
+    std::uint32_t channels,
+    bool srgb) -> std::vector<std::byte>
+{
+    ensure(width > 0u && height > 0u, "image must not be empty");
+    ensure(pixels.size() == std::size_t{width} * height * channels, "pixel data size mismatch");
+
+    const auto is_colour = [channels](std::uint32_t channel) { return (channels != 4u) || (channel != 3u); };
+
+    auto srgb_lut = std::array<float, 256u>{};
+    for (auto i = 0u; i < srgb_lut.size(); ++i)
+    {
+        srgb_lut[i] = srgb_to_linear(static_cast<float>(i) / 255.0f);
+    }
+
+    // convert level 0 to (linear) floats, all filtering happens at this precision
+    auto level = std::vector<float>(pixels.size());
+    for (auto i = 0u; i < pixels.size(); ++i)
+    {
+        const auto value = std::to_integer<std::uint8_t>(pixels[i]);
+        level[i] = (srgb && is_colour(i % channels)) ? srgb_lut[value] : static_cast<float>(value) / 255.0f;
+    }
+
+    auto chain = std::vector<std::byte>{std::ranges::cbegin(pixels), std::ranges::cend(pixels)};
+
+    auto level_width = width;
+    auto level_height = height;
+
+    while ((level_width > 1u) || (level_height > 1u))
+    {
+        const auto next_width = std::max(level_width / 2u, 1u);
+        const auto next_height = std::max(level_height / 2u, 1u);
+
+        auto next = std::vector<float>(std::size_t{next_width} * next_height * channels);
+
+        for (auto y = 0u; y < next_height; ++y)
+        {
+            const auto y_taps = box_taps(level_height, y);
+
+            for (auto x = 0u; x < next_width; ++x)
+            {
+                const auto x_taps = box_taps(level_width, x);
+                auto *out = next.data() + (std::size_t{y} * next_width + x) * channels;
+
+                for (auto ty = 0u; ty < y_taps.count; ++ty)
+                {
+                    for (auto tx = 0u; tx < x_taps.count; ++tx)
+                    {
+                        const auto weight = y_taps.weight[ty] * x_taps.weight[tx];
+                        const auto *in =
+                            level.data() + (std::size_t{y_taps.index[ty]} * level_width + x_taps.index[tx]) * channels;
+
+                        for (auto c = 0u; c < channels; ++c)
+                        {
+                            out[c] += in[c] * weight;
+                        }
+                    }
+                }
+            }
+        }
+
+        for (auto i = 0u; i < next.size(); ++i)
+        {
+            const auto value = (srgb && is_colour(i % channels)) ? linear_to_srgb(next[i]) : next[i];
+            chain.push_back(static_cast<std::byte>(std::lround(std::clamp(value, 0.0f, 1.0f) * 255.0f)));
+        }
+
+        level = std::move(next);
+        level_width = next_width;
+        level_height = next_height;
+    }
+
+    return chain;
+}
+
+}
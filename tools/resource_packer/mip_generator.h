@@ -0,0 +1,40 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+namespace game
+{
+
+/**
+ * Generate a full mip chain for an 8 bit per channel image, down to 1x1.
+ *
+ * Each level is half the size of the previous (rounded down, minimum of 1) and is filtered with a box filter over the
+ * exact footprint of the destination texel, so odd sized levels are handled without shifting the image. Filtering is
+ * always done from the full precision result of the previous level, not the quantised one.
+ *
+ * @param pixels
+ *   The level 0 pixels, tightly packed rows of width * channels bytes.
+ * @param width
+ *   Width of level 0.
+ * @param height
+ *   Height of level 0.
+ * @param channels
+ *   Number of channels per pixel, if this is 4 the last channel is treated as alpha.
+ * @param srgb
+ *   True if the colour channels are sRGB encoded, in which case they are filtered in linear space. Alpha is always
+ *   linear.
+ *
+ * @returns
+ *   All levels tightly packed one after another, starting with a copy of level 0.
+ */
+auto generate_mip_chain(
+    std::span<const std::byte> pixels,
+    std::uint32_t width,
+    std::uint32_t height,
+    std::uint32_t channels,
+    bool srgb) -> std::vector<std::byte>;
+
+}
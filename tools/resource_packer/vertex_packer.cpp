@@ -0,0 +1,317 @@
+#include "vertex_packer.h"
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <span>
+#include <vector>
+
+#include "graphics/mesh_data.h"
+#include "graphics/vertex_data.h"
+#include "graphics/vertex_layout.h"
+#include "maths/vector3.h"
+#include "mesh_optimiser.h"
+#include "utils/error.h"
+
+namespace
+{
+
+/**
+ * A vertex in the packed format, see pack_mesh.
+ */
+struct PackedVertex
+{
+    std::array<std::uint16_t, 3u> position;
+    std::uint16_t padding;
+    std::array<std::int16_t, 2u> normal;
+    std::array<std::int16_t, 2u> tangent;
+    std::array<std::uint16_t, 2u> uv;
+};
+
+static_assert(sizeof(PackedVertex) == 20u, "PackedVertex must not contain padding");
+
+/**
+ * Layout of PackedVertex.
+ */
+auto packed_vertex_layout(game::IndexType index_type, const game::Vector3 &offset, const game::Vector3 &scale)
+    -> game::VertexLayout
+{
+    return {
+        .stride = sizeof(PackedVertex),
+        .index_type = index_type,
+        .position_offset = offset,
+        .position_scale = scale,
+        .attributes = {
+            {.location = 0u,
+             .components = 3u,
+             .type = game::VertexAttributeType::UNORM16,
+             .offset = offsetof(PackedVertex, position)},
+            {.location = 1u,
+             .components = 2u,
+             .type = game::VertexAttributeType::SNORM16,
+             .offset = offsetof(PackedVertex, normal)},
+            {.location = 2u,
+             .components = 2u,
+             .type = game::VertexAttributeType::SNORM16,
+             .offset = offsetof(PackedVertex, tangent)},
+            {.location = 3u,
+             .components = 2u,
+             .type = game::VertexAttributeType::HALF_FLOAT,
+             .offset = offsetof(PackedVertex, uv)},
+        }};
+}
+
+/**
+ * Normalise a vector, falling back to +z for a zero vector (which some importers produce for degenerate triangles).
+ */
+auto safe_normalise(const game::Vector3 &value) -> game::Vector3
+{
+    return value.length() == 0.0f ? game::Vector3{0.0f, 0.0f, 1.0f} : game::Vector3::normalise(value);
+}
+
+/**
+ * Component wise reciprocal.
+ */
+auto reciprocal(const game::Vector3 &value) -> game::Vector3
+{
+    return {1.0f / value.x, 1.0f / value.y, 1.0f / value.z};
+}
+
+}
+
+namespace game
+{
+
+auto PackedMesh::view() const -> PackedMeshData
+{
+    return {.layout = layout, .vertices = vertices, .indices = indices};
+}
+
+auto to_half(float value) -> std::uint16_t
+{
+    const auto bits = std::bit_cast<std::uint32_t>(value);
+    const auto sign = static_cast<std::uint16_t>((bits >> 16u) & 0x8000u);
+    const auto exponent = static_cast<int>((bits >> 23u) & 0xffu);
+    auto mantissa = bits & 0x7fffffu;
+
+    if (exponent == 0xff)
+    {
+        // infinity or nan, keep nans as nans
+        return static_cast<std::uint16_t>(sign | 0x7c00u | (mantissa != 0u ? 0x200u : 0u));
+    }
+
+    const auto half_exponent = exponent - 127 + 15;
+
+    if (half_exponent >= 0x1f)
+    {
+        return static_cast<std::uint16_t>(sign | 0x7c00u);
+    }
+
+    if (half_exponent <= 0)
+    {
+        // subnormal (or zero) half, shift in the implicit bit and round
+        if (half_exponent < -10)
+        {
+            return sign;
+        }
+
+        mantissa |= 0x800000u;
+        const auto shift = static_cast<std::uint32_t>(14 - half_exponent);
+        auto half_mantissa = mantissa >> shift;
+        const auto remainder = mantissa & ((1u << shift) - 1u);
+        const auto halfway = 1u << (shift - 1u);
+
+        if ((remainder > halfway) || ((remainder == halfway) && (half_mantissa & 1u)))
+        {
+            ++half_mantissa;
+        }
+
+        return static_cast<std::uint16_t>(sign | half_mantissa);
+    }
+
+    // normal half, round the mantissa to nearest even, a carry correctly bumps the exponent (even up to infinity)
+    auto half = (static_cast<std::uint32_t>(half_exponent) << 10u) | (mantissa >> 13u);
+    const auto remainder = mantissa & 0x1fffu;
+
+    if ((remainder > 0x1000u) || ((remainder == 0x1000u) && (half & 1u)))
+    {
+        ++half;
+    }
+
+    return static_cast<std::uint16_t>(sign | half);
+}
+
+auto from_half(std::uint16_t value) -> float
+{
+    const auto sign = (value & 0x8000u) != 0u ? -1.0f : 1.0f;
+    const auto exponent = (value >> 10u) & 0x1fu;
+    const auto mantissa = value & 0x3ffu;
+
+    if (exponent == 0u)
+    {
+        return sign * std::ldexp(static_cast<float>(mantissa), -24);
+    }
+
+    if (exponent == 0x1fu)
+    {
+        return mantissa == 0u ? sign * std::numeric_limits<float>::infinity() : std::numeric_limits<float>::quiet_NaN();
+    }
+
+    return sign * std::ldexp(static_cast<float>(mantissa | 0x400u), static_cast<int>(exponent) - 25);
+}
+
+auto octahedral_encode(const Vector3 &value) -> std::array<std::int16_t, 2u>
+{
+    const auto sign = [](float v) { return v >= 0.0f ? 1.0f : -1.0f; };
+    const auto to_snorm = [](float v)
+    { return static_cast<std::int16_t>(std::lround(std::clamp(v, -1.0f, 1.0f) * 32767.0f)); };
+
+    // project onto the octahedron |x| + |y| + |z| = 1
+    const auto l1 = std::abs(value.x) + std::abs(value.y) + std::abs(value.z);
+    auto x = value.x / l1;
+    auto y = value.y / l1;
+
+    // fold the lower hemisphere over the diagonals
+    if (value.z < 0.0f)
+    {
+        const auto folded_x = (1.0f - std::abs(y)) * sign(x);
+        const auto folded_y = (1.0f - std::abs(x)) * sign(y);
+        x = folded_x;
+        y = folded_y;
+    }
+
+    return {to_snorm(x), to_snorm(y)};
+}
+
+auto octahedral_decode(const std::array<std::int16_t, 2u> &value) -> Vector3
+{
+    // matches the shader, snorm values are clamped as -32768 is below -1
+    auto x = std::max(static_cast<float>(value[0]) / 32767.0f, -1.0f);
+    auto y = std::max(static_cast<float>(value[1]) / 32767.0f, -1.0f);
+    const auto z = 1.0f - std::abs(x) - std::abs(y);
+
+    const auto t = std::max(-z, 0.0f);
+    x += x >= 0.0f ? -t : t;
+    y += y >= 0.0f ? -t : t;
+
+    return Vector3::normalise({x, y, z});
+}
+
+auto pack_mesh(std::span<const VertexData> vertices, std::span<const std::uint32_t> indices) -> PackedMesh
+{
+    ensure(!vertices.empty(), "cannot pack an empty mesh");
+
+    auto min = vertices.front().position;
+    auto max = vertices.front().position;
+    for (const auto &vertex : vertices)
+    {
+        const auto &p = vertex.position;
+        min = {std::min(min.x, p.x), std::min(min.y, p.y), std::min(min.z, p.z)};
+        max = {std::max(max.x, p.x), std::max(max.y, p.y), std::max(max.z, p.z)};
+    }
+
+    // a flat axis has no extent, any non zero scale will do and keeps the normal/tangent transforms invertible
+    const auto extent = max - min;
+    const auto scale = Vector3{
+        extent.x == 0.0f ? 1.0f : extent.x, extent.y == 0.0f ? 1.0f : extent.y, extent.z == 0.0f ? 1.0f : extent.z};
+    const auto inverse_scale = reciprocal(scale);
+
+    const auto index_type =
+        vertices.size() <= std::numeric_limits<std::uint16_t>::max() + 1u ? IndexType::UINT16 : IndexType::UINT32;
+
+    auto packed = PackedMesh{
+        .layout = packed_vertex_layout(index_type, min, scale),
+        .vertices = std::vector<std::byte>(vertices.size() * sizeof(PackedVertex)),
+        .indices = {}};
+
+    const auto to_unorm = [](float v)
+    { return static_cast<std::uint16_t>(std::lround(std::clamp(v, 0.0f, 1.0f) * 65535.0f)); };
+
+    for (auto i = 0u; i < vertices.size(); ++i)
+    {
+        const auto &vertex = vertices[i];
+        const auto position = (vertex.position - min) * inverse_scale;
+
+        const auto packed_vertex = PackedVertex{
+            .position = {to_unorm(position.x), to_unorm(position.y), to_unorm(position.z)},
+            .padding = 0u,
+            .normal = octahedral_encode(safe_normalise(vertex.normal * scale)),
+            .tangent = octahedral_encode(safe_normalise(vertex.tangent * inverse_scale)),
+            .uv = {to_half(vertex.uv.x), to_half(vertex.uv.y)}};
+
+        std::memcpy(packed.vertices.data() + i * sizeof(PackedVertex), &packed_vertex, sizeof(packed_vertex));
+    }
+
+    if (index_type == IndexType::UINT16)
+    {
+        for (const auto index : indices)
+        {
+            ensure(index < vertices.size(), "index out of range: {}", index);
+            const auto narrow = static_cast<std::uint16_t>(index);
+            const auto *bytes = reinterpret_cast<const std::byte *>(&narrow);
+            packed.indices.insert(std::ranges::end(packed.indices), bytes, bytes + sizeof(narrow));
+        }
+    }
+    else
+    {
+        const auto bytes = std::as_bytes(indices);
+        packed.indices.assign(std::ranges::cbegin(bytes), std::ranges::cend(bytes));
+    }
+
+    return packed;
+}
+
+auto unpack_mesh(const PackedMeshData &mesh) -> MeshBuffers
+{
+    ensure(mesh.layout.stride == sizeof(PackedVertex), "not a packed mesh");
+
+    const auto &scale = mesh.layout.position_scale;
+    const auto inverse_scale = reciprocal(scale);
+
+    auto unpacked = MeshBuffers{};
+
+    for (auto offset = std::size_t{}; offset < mesh.vertices.size(); offset += sizeof(PackedVertex))
+    {
+        auto packed_vertex = PackedVertex{};
+        std::memcpy(&packed_vertex, mesh.vertices.data() + offset, sizeof(packed_vertex));
+
+        const auto position = Vector3{
+            static_cast<float>(packed_vertex.position[0]) / 65535.0f,
+            static_cast<float>(packed_vertex.position[1]) / 65535.0f,
+            static_cast<float>(packed_vertex.position[2]) / 65535.0f};
+
+        unpacked.vertices.push_back({
+            .position = mesh.layout.position_offset + position * scale,
+            .normal = Vector3::normalise(octahedral_decode(packed_vertex.normal) * inverse_scale),
+            .tangent = Vector3::normalise(octahedral_decode(packed_vertex.tangent) * scale),
+            .uv = {from_half(packed_vertex.uv[0]), from_half(packed_vertex.uv[1])},
+        });
+    }
+
+    const auto size = index_size(mesh.layout.index_type);
+    for (auto offset = std::size_t{}; offset < mesh.indices.size(); offset += size)
+    {
+        auto index = std::uint32_t{};
+        if (mesh.layout.index_type == IndexType::UINT16)
+        {
+            auto narrow = std::uint16_t{};
+            std::memcpy(&narrow, mesh.indices.data() + offset, sizeof(narrow));
+            index = narrow;
+        }
+        else
+        {
+            std::memcpy(&index, mesh.indices.data() + offset, sizeof(index));
+        }
+
+        unpacked.indices.push_back(index);
+    }
+
+    return unpacked;
+}
+
+}
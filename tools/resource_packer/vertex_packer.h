@@ -0,0 +1,120 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+#include "graphics/mesh_data.h"
+#include "graphics/vertex_data.h"
+#include "graphics/vertex_layout.h"
+#include "maths/vector3.h"
+#include "mesh_optimiser.h"
+
+namespace game
+{
+
+/**
+ * Owning buffers for a mesh in a packed vertex format.
+ */
+struct PackedMesh
+{
+    /** Layout of the buffers. */
+    VertexLayout layout;
+
+    /** Interleaved vertex data. */
+    std::vector<std::byte> vertices;
+
+    /** Index data. */
+    std::vector<std::byte> indices;
+
+    /**
+     * Get a view of the mesh, e.g. for writing to a TLV.
+     *
+     * @returns
+     *   View of the mesh.
+     */
+    auto view() const -> PackedMeshData;
+};
+
+/**
+ * Convert a float to a half float, rounding to nearest even. Values too large for a half become infinity.
+ *
+ * @param value
+ *   The value to convert.
+ *
+ * @returns
+ *   The bits of the half float.
+ */
+auto to_half(float value) -> std::uint16_t;
+
+/**
+ * Convert a half float to a float, this is exact.
+ *
+ * @param value
+ *   The bits of the half float.
+ *
+ * @returns
+ *   The value as a float.
+ */
+auto from_half(std::uint16_t value) -> float;
+
+/**
+ * Encode a unit vector with an octahedral mapping to two signed normalised 16 bit values.
+ *
+ * @param value
+ *   The vector to encode, does not need to be normalised but must not be zero.
+ *
+ * @returns
+ *   The encoded vector.
+ */
+auto octahedral_encode(const Vector3 &value) -> std::array<std::int16_t, 2u>;
+
+/**
+ * Decode an octahedral encoded vector.
+ *
+ * @param value
+ *   The encoded vector.
+ *
+ * @returns
+ *   The decoded unit vector.
+ */
+auto octahedral_decode(const std::array<std::int16_t, 2u> &value) -> Vector3;
+
+/**
+ * Pack a mesh into a compact vertex format, 20 bytes per vertex rather than 44:
+ *  - position: 3 x UNORM16 relative to the bounds of the mesh (padded to 8 bytes)
+ *  - normal: 2 x SNORM16 octahedral
+ *  - tangent: 2 x SNORM16 octahedral
+ *  - uv: 2 x HALF_FLOAT
+ *
+ * Indices are 16 bit if the vertex count allows, otherwise 32 bit.
+ *
+ * The dequantisation is a non-uniform scale, which is expected to be folded into the model matrix. So that shaders can
+ * transform normals and tangents with that matrix as usual they are stored in quantised space, i.e. normals are scaled
+ * by the bounds and tangents by the inverse before encoding.
+ *
+ * @param vertices
+ *   The vertices to pack.
+ * @param indices
+ *   The indices into vertices.
+ *
+ * @returns
+ *   The packed mesh.
+ */
+auto pack_mesh(std::span<const VertexData> vertices, std::span<const std::uint32_t> indices) -> PackedMesh;
+
+/**
+ * Unpack a mesh packed with pack_mesh back to VertexData, positions are returned in model space. This is intended for
+ * testing and tooling.
+ *
+ * @param mesh
+ *   The packed mesh.
+ *
+ * @returns
+ *   The unpacked mesh.
+ */
+auto unpack_mesh(const PackedMeshData &mesh) -> MeshBuffers;
+
+}